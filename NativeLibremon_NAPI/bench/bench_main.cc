@@ -0,0 +1,338 @@
+/**
+ * libremon_bench - micro-benchmarks for the native side of the addon pipeline
+ * Drives HardwareMonitor and MonitorBackend against the synthetic bridge, so
+ * it runs anywhere (no CLR, no admin rights, no hardware) and repeatably.
+ *
+ * Usage: libremon_bench [--hardware N] [--sensors N] [--fixture poll.json]
+ *                       [--iterations N] [--json]
+ */
+
+#include "hardware_monitor.h"
+#include "monitor_backend.h"
+#include "sensor_schema.h"
+#include "synthetic_bridge.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ---- Allocation counting (native operator new only; bridge strings are malloc'd) ----
+
+static std::atomic<uint64_t> g_allocCount(0);
+static std::atomic<uint64_t> g_allocBytes(0);
+
+void* operator new(size_t size) {
+	g_allocCount.fetch_add(1, std::memory_order_relaxed);
+	g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace {
+
+/**
+ * Per-thread hardware counter: retired instructions on Linux (perf_event_open),
+ * CPU cycles on Windows (QueryThreadCycleTime). Unavailable counters report n/a.
+ */
+class HardwareCounter {
+public:
+	HardwareCounter() : m_fd(-1) {
+#if defined(__linux__)
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		m_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+
+	~HardwareCounter() {
+#if defined(__linux__)
+		if (m_fd >= 0) close(m_fd);
+#endif
+	}
+
+	const char* Name() const {
+#ifdef _WIN32
+		return "cycles";
+#else
+		return "instructions";
+#endif
+	}
+
+	bool Available() const {
+#ifdef _WIN32
+		return true;
+#else
+		return m_fd >= 0;
+#endif
+	}
+
+	void Start() {
+#ifdef _WIN32
+		QueryThreadCycleTime(GetCurrentThread(), &m_start);
+#elif defined(__linux__)
+		if (m_fd >= 0) {
+			ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	uint64_t Stop() {
+#ifdef _WIN32
+		ULONG64 end = 0;
+		QueryThreadCycleTime(GetCurrentThread(), &end);
+		return end - m_start;
+#elif defined(__linux__)
+		uint64_t count = 0;
+		if (m_fd >= 0) {
+			ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(m_fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+				count = 0;
+			}
+		}
+		return count;
+#else
+		return 0;
+#endif
+	}
+
+private:
+	int m_fd;
+#ifdef _WIN32
+	ULONG64 m_start = 0;
+#endif
+};
+
+struct BenchResult {
+	std::string name;
+	uint64_t iterations = 0;
+	double nsPerOp = 0;
+	double bytesPerOp = 0;
+	double allocsPerOp = 0;
+	double counterPerSensor = -1;  // -1 when the hardware counter is unavailable
+};
+
+struct Options {
+	SyntheticBridgeOptions bridge;
+	uint64_t iterations = 2000;
+	bool json = false;
+};
+
+HardwareCounter g_counter;
+
+template <typename Fn>
+BenchResult Run(const char* name, uint64_t iterations, size_t sensors, Fn&& fn) {
+	for (uint64_t i = 0; i < iterations / 10 + 1; i++) {
+		fn();
+	}
+
+	uint64_t allocs = g_allocCount.load();
+	uint64_t bytes = g_allocBytes.load();
+	g_counter.Start();
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < iterations; i++) {
+		fn();
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	uint64_t counted = g_counter.Stop();
+
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.nsPerOp = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+	result.bytesPerOp = (double)(g_allocBytes.load() - bytes) / iterations;
+	result.allocsPerOp = (double)(g_allocCount.load() - allocs) / iterations;
+	if (g_counter.Available() && sensors > 0) {
+		result.counterPerSensor = (double)counted / iterations / sensors;
+	}
+	return result;
+}
+
+class CountingListener : public SampleListener {
+public:
+	void OnSample(const SampleFrame& frame) override {
+		m_checksum += frame.count > 0 ? frame.values[frame.count - 1] : 0.0f;
+	}
+	float m_checksum = 0;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--json") {
+			options.json = true;
+		}
+		else if (arg == "--hardware" && hasValue) {
+			options.bridge.hardware = std::atoi(argv[++i]);
+		}
+		else if (arg == "--sensors" && hasValue) {
+			options.bridge.sensorsPerHardware = std::atoi(argv[++i]);
+		}
+		else if (arg == "--fixture" && hasValue) {
+			options.bridge.fixturePath = argv[++i];
+		}
+		else if (arg == "--iterations" && hasValue) {
+			options.iterations = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else {
+			std::cerr << "Usage: libremon_bench [--hardware N] [--sensors N] [--fixture poll.json] [--iterations N] [--json]" << std::endl;
+			return false;
+		}
+	}
+	return options.iterations > 0 && options.bridge.hardware > 0 && options.bridge.sensorsPerHardware > 0;
+}
+
+void Report(const Options& options, const std::vector<BenchResult>& results) {
+	if (options.json) {
+		std::printf("{\"hardware\":%zu,\"sensors\":%zu,\"counter\":\"%s\",\"results\":[",
+			SyntheticBridge::HardwareCount(), SyntheticBridge::SensorCount(), g_counter.Name());
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchResult& r = results[i];
+			std::printf("%s{\"name\":\"%s\",\"iterations\":%llu,\"nsPerOp\":%.1f,\"bytesPerOp\":%.1f,\"allocsPerOp\":%.2f,\"%sPerSensor\":",
+				i == 0 ? "" : ",", r.name.c_str(), (unsigned long long)r.iterations, r.nsPerOp, r.bytesPerOp, r.allocsPerOp, g_counter.Name());
+			if (r.counterPerSensor < 0) {
+				std::printf("null}");
+			}
+			else {
+				std::printf("%.1f}", r.counterPerSensor);
+			}
+		}
+		std::printf("]}\n");
+		return;
+	}
+
+	std::printf("%zu hardware, %zu sensors%s%s\n\n", SyntheticBridge::HardwareCount(), SyntheticBridge::SensorCount(),
+		options.bridge.fixturePath.empty() ? "" : ", fixture ", options.bridge.fixturePath.c_str());
+	std::printf("%-20s %12s %12s %10s %14s/sensor\n", "benchmark", "ns/op", "bytes/op", "allocs/op", g_counter.Name());
+	for (const BenchResult& r : results) {
+		char counter[32] = "n/a";
+		if (r.counterPerSensor >= 0) {
+			std::snprintf(counter, sizeof(counter), "%.1f", r.counterPerSensor);
+		}
+		std::printf("%-20s %12.1f %12.1f %10.2f %21s\n", r.name.c_str(), r.nsPerOp, r.bytesPerOp, r.allocsPerOp, counter);
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!ParseArgs(argc, argv, options)) {
+		return 2;
+	}
+
+	std::string error;
+	if (!SyntheticBridge::Configure(options.bridge, error)) {
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	const BridgeApi api = SyntheticBridge::Api();
+	const size_t sensors = SyntheticBridge::SensorCount();
+	const uint64_t n = options.iterations;
+	std::vector<BenchResult> results;
+
+	// Initialize/Shutdown log to stdout; keep the report clean
+	std::streambuf* out = std::cout.rdbuf(nullptr);
+
+	HardwareConfig config;
+	config.cpu = true;
+	HardwareMonitor monitor(api);
+	if (!monitor.Initialize(config)) {
+		std::cout.rdbuf(out);
+		std::cerr << "Failed to initialize synthetic bridge" << std::endl;
+		return 1;
+	}
+
+	const std::string schemaText = monitor.GetSchema();
+	std::vector<float> values(sensors);
+
+	results.push_back(Run("schema_parse", n, sensors, [&]() {
+		SensorSchema schema;
+		SensorSchema::Parse(schemaText.c_str(), schema);
+	}));
+	results.push_back(Run("poll_json", n, sensors, [&]() {
+		std::string json = monitor.Poll();
+	}));
+	// Same poll through pollInto and a buffer reused across polls
+	std::string buffer;
+	int32_t skipped = 0;
+	results.push_back(Run("poll_buffer", n, sensors, [&]() {
+		monitor.Poll(buffer, -1, 0, skipped);
+	}));
+	results.push_back(Run("update", n, sensors, [&]() {
+		monitor.Update(kCategoryAll);
+	}));
+	results.push_back(Run("read_values", n, sensors, [&]() {
+		monitor.ReadValues(values.data(), nullptr, nullptr, (int32_t)values.size());
+	}));
+	monitor.Shutdown();
+
+	MonitorBackend* backend = MonitorBackend::Acquire(config, error, &api);
+	if (backend == nullptr) {
+		std::cout.rdbuf(out);
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	CountingListener listener;
+	backend->AddListener(&listener);
+	results.push_back(Run("backend_poll", n, sensors, [&]() {
+		std::string json = backend->Poll();
+	}));
+	// As poll() runs it: a pooled buffer, handed back once consumed
+	results.push_back(Run("backend_poll_buffer", n, sensors, [&]() {
+		std::string json = backend->AcquirePollBuffer();
+		backend->Poll(json);
+		backend->ReleasePollBuffer(std::move(json));
+	}));
+	results.push_back(Run("backend_sample", n, sensors, [&]() {
+		backend->Sample();
+	}));
+
+	// Each op swaps the filter and reloads the (re-laid-out) schema
+	bool filtered = false;
+	const std::string filter = "{\"excludeSensorTypes\":[\"Throughput\",\"Data\"]}";
+	results.push_back(Run("set_filter", n / 10 + 1, sensors, [&]() {
+		filtered = !filtered;
+		backend->SetFilter(filtered ? filter : std::string());
+		backend->GetSchema();
+	}));
+	backend->RemoveListener(&listener);
+	backend->Release();
+
+	std::cout.rdbuf(out);
+	Report(options, results);
+	return 0;
+}
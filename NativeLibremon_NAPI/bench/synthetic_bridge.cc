@@ -0,0 +1,526 @@
+#include "synthetic_bridge.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct Hardware {
+	int parent = -1;
+	std::string type;
+	std::string id;
+	std::string name;
+};
+
+struct Sensor {
+	int hardware = -1;
+	std::string type;
+	std::string id;
+	std::string name;
+	float base = 0.0f;
+};
+
+struct State {
+	std::vector<Hardware> hardware;
+	std::vector<Sensor> sensors;       // Grouped by hardware, then by type
+	std::vector<bool> excluded;        // Per sensor, from the filter
+	std::vector<float> values;         // Per sensor, advanced by Update
+	int32_t generation = 1;
+	uint64_t tick = 0;
+	std::string schemaText;
+	std::string pollJson;
+};
+
+State g_state;
+
+const char* const kHardwareTypes[] = { "Cpu", "GpuNvidia", "Motherboard", "Memory", "Storage", "Network" };
+const char* const kSensorTypes[] = { "Voltage", "Clock", "Temperature", "Load", "Fan", "Power", "Data", "Throughput" };
+
+// Same group captions as the bridge's GetSensorTypeName
+const char* GroupName(const std::string& type) {
+	if (type == "Voltage") return "Voltages";
+	if (type == "Clock") return "Clocks";
+	if (type == "Temperature") return "Temperatures";
+	if (type == "Fan") return "Fans";
+	if (type == "Control") return "Controls";
+	if (type == "Level") return "Levels";
+	if (type == "Power") return "Powers";
+	if (type == "SmallData") return "Data";
+	if (type == "Factor") return "Factors";
+	if (type == "Frequency") return "Frequencies";
+	return type.c_str();
+}
+
+void AppendEscaped(std::string& out, const std::string& text) {
+	out += '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		}
+		else if ((unsigned char)c < 0x20) {
+			char escape[8];
+			std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+			out += escape;
+		}
+		else {
+			out += c;
+		}
+	}
+	out += '"';
+}
+
+void AppendNode(std::string& out, int& id, const std::string& text, const char* extra) {
+	out += "{\"id\":";
+	out += std::to_string(id++);
+	out += ",\"Text\":";
+	AppendEscaped(out, text);
+	out += ",\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"ImageURL\":\"\"";
+	out += extra;
+	out += ",\"Children\":[";
+}
+
+void AppendHardware(std::string& out, int& id, int index) {
+	const Hardware& hw = g_state.hardware[index];
+	std::string extra = ",\"HardwareId\":";
+	AppendEscaped(extra, hw.id);
+	AppendNode(out, id, hw.name, extra.c_str());
+
+	bool first = true;
+	for (size_t i = 0; i < g_state.hardware.size(); i++) {
+		if (g_state.hardware[i].parent == index) {
+			if (!first) out += ',';
+			AppendHardware(out, id, (int)i);
+			first = false;
+		}
+	}
+
+	const std::string* group = nullptr;
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		const Sensor& sensor = g_state.sensors[i];
+		if (sensor.hardware != index || g_state.excluded[i]) {
+			continue;
+		}
+
+		if (group == nullptr || *group != sensor.type) {
+			if (group != nullptr) out += "]}";
+			if (!first) out += ',';
+			AppendNode(out, id, GroupName(sensor.type), "");
+			group = &sensor.type;
+			first = true;
+		}
+
+		char value[32];
+		std::snprintf(value, sizeof(value), "\"%.3f\"", sensor.base);
+		if (!first) out += ',';
+		out += "{\"id\":";
+		out += std::to_string(id++);
+		out += ",\"Text\":";
+		AppendEscaped(out, sensor.name);
+		out += ",\"Children\":[],\"Min\":";
+		out += value;
+		out += ",\"Value\":";
+		out += value;
+		out += ",\"Max\":";
+		out += value;
+		out += ",\"SensorId\":";
+		AppendEscaped(out, sensor.id);
+		out += ",\"Type\":";
+		AppendEscaped(out, sensor.type);
+		out += ",\"ImageURL\":\"\"}";
+		first = false;
+	}
+	if (group != nullptr) out += "]}";
+	out += "]}";
+}
+
+// Precompute the schema text and poll JSON for the current filter
+void Rebuild() {
+	std::ostringstream schema;
+	size_t visible = 0;
+	for (bool excluded : g_state.excluded) {
+		visible += excluded ? 0 : 1;
+	}
+	schema << "G\t" << g_state.generation << '\t' << g_state.hardware.size() << '\t' << visible << '\n';
+	for (size_t i = 0; i < g_state.hardware.size(); i++) {
+		const Hardware& hw = g_state.hardware[i];
+		schema << "H\t" << i << '\t' << hw.parent << '\t' << hw.type << '\t' << hw.id << '\t' << hw.name << '\n';
+	}
+	size_t index = 0;
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		if (g_state.excluded[i]) {
+			continue;
+		}
+		const Sensor& sensor = g_state.sensors[i];
+		schema << "S\t" << index++ << '\t' << sensor.hardware << '\t' << sensor.type << '\t' << sensor.id << '\t' << sensor.name << '\n';
+	}
+	g_state.schemaText = schema.str();
+
+	std::string json;
+	json.reserve(g_state.sensors.size() * 200);
+	int id = 0;
+	AppendNode(json, id, "Sensor", "");
+	AppendNode(json, id, "Synthetic", "");
+	bool first = true;
+	for (size_t i = 0; i < g_state.hardware.size(); i++) {
+		if (g_state.hardware[i].parent == -1) {
+			if (!first) json += ',';
+			AppendHardware(json, id, (int)i);
+			first = false;
+		}
+	}
+	json += "]}]}";
+	g_state.pollJson = std::move(json);
+}
+
+void Generate(int hardwareCount, int sensorsPerHardware) {
+	const int typeCount = (int)(sizeof(kSensorTypes) / sizeof(kSensorTypes[0]));
+	for (int h = 0; h < hardwareCount; h++) {
+		Hardware hw;
+		hw.type = kHardwareTypes[h % (sizeof(kHardwareTypes) / sizeof(kHardwareTypes[0]))];
+		hw.id = "/synthetic/" + std::to_string(h);
+		hw.name = "Synthetic " + hw.type + " #" + std::to_string(h);
+		g_state.hardware.push_back(hw);
+
+		// Contiguous runs per type, like the bridge's grouped output
+		for (int s = 0; s < sensorsPerHardware; s++) {
+			Sensor sensor;
+			sensor.hardware = h;
+			sensor.type = kSensorTypes[s * typeCount / sensorsPerHardware];
+			sensor.id = hw.id + "/" + sensor.type + "/" + std::to_string(s);
+			sensor.name = sensor.type + " #" + std::to_string(s);
+			sensor.base = (float)(10 + (h * 7 + s * 3) % 90);
+			g_state.sensors.push_back(sensor);
+		}
+	}
+}
+
+/**
+ * Minimal reader for the recorded poll JSON: collects HardwareId/SensorId
+ * nodes in document order, ignores everything else
+ */
+class FixtureReader {
+public:
+	explicit FixtureReader(const std::string& text) : m_text(text), m_pos(0), m_skipping(false) {}
+
+	bool Read(std::string& error) {
+		SkipSpace();
+		if (!ReadValue(-1)) {
+			error = "Malformed fixture JSON near offset " + std::to_string(m_pos);
+			return false;
+		}
+		return true;
+	}
+
+private:
+	bool ReadValue(int hardware) {
+		SkipSpace();
+		if (m_pos >= m_text.size()) return false;
+		char c = m_text[m_pos];
+		if (c == '{') return ReadObject(hardware);
+		if (c == '[') return ReadArray(hardware);
+		if (c == '"') {
+			std::string ignored;
+			return ReadString(ignored);
+		}
+		while (m_pos < m_text.size() && std::strchr(",]} \t\r\n", m_text[m_pos]) == nullptr) {
+			m_pos++;
+		}
+		return true;
+	}
+
+	bool ReadArray(int hardware) {
+		m_pos++;
+		SkipSpace();
+		if (Peek() == ']') {
+			m_pos++;
+			return true;
+		}
+		while (true) {
+			if (!ReadValue(hardware)) return false;
+			SkipSpace();
+			char c = Next();
+			if (c == ']') return true;
+			if (c != ',') return false;
+		}
+	}
+
+	bool ReadObject(int hardware) {
+		m_pos++;
+		std::string text, hardwareId, sensorId, type, value;
+		size_t childrenPos = std::string::npos;
+
+		SkipSpace();
+		if (Peek() == '}') {
+			m_pos++;
+			return true;
+		}
+		while (true) {
+			std::string key;
+			SkipSpace();
+			if (!ReadString(key)) return false;
+			SkipSpace();
+			if (Next() != ':') return false;
+			SkipSpace();
+
+			if (key == "Children") {
+				// Children come before SensorId/HardwareId in the bridge output;
+				// skip them and read them once the node is known
+				childrenPos = m_pos;
+				bool skipping = m_skipping;
+				m_skipping = true;
+				bool ok = ReadValue(hardware);
+				m_skipping = skipping;
+				if (!ok) return false;
+			}
+			else if (Peek() == '"' && (key == "Text" || key == "HardwareId" || key == "SensorId" || key == "Type" || key == "Value")) {
+				std::string field;
+				if (!ReadString(field)) return false;
+				if (key == "Text") text = field;
+				else if (key == "HardwareId") hardwareId = field;
+				else if (key == "SensorId") sensorId = field;
+				else if (key == "Type") type = field;
+				else value = field;
+			}
+			else if (!ReadValue(hardware)) {
+				return false;
+			}
+
+			SkipSpace();
+			char c = Next();
+			if (c == '}') break;
+			if (c != ',') return false;
+		}
+
+		if (m_skipping) {
+			return true;
+		}
+
+		int owner = hardware;
+		if (!hardwareId.empty()) {
+			Hardware hw;
+			hw.parent = hardware;
+			hw.id = hardwareId;
+			size_t end = hardwareId.find('/', 1);
+			hw.type = hardwareId.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+			hw.name = text;
+			g_state.hardware.push_back(hw);
+			owner = (int)g_state.hardware.size() - 1;
+		}
+		else if (!sensorId.empty() && hardware >= 0) {
+			Sensor sensor;
+			sensor.hardware = hardware;
+			sensor.type = type;
+			sensor.id = sensorId;
+			sensor.name = text;
+			// Recorded values are locale formatted ("1,232 V")
+			for (char& c : value) {
+				if (c == ',') c = '.';
+			}
+			sensor.base = value.empty() ? NAN : std::strtof(value.c_str(), nullptr);
+			g_state.sensors.push_back(sensor);
+		}
+
+		if (childrenPos != std::string::npos) {
+			size_t resume = m_pos;
+			m_pos = childrenPos;
+			bool ok = ReadValue(owner);
+			m_pos = resume;
+			return ok;
+		}
+		return true;
+	}
+
+	bool ReadString(std::string& out) {
+		if (Next() != '"') return false;
+		while (m_pos < m_text.size()) {
+			char c = m_text[m_pos++];
+			if (c == '"') return true;
+			if (c == '\\' && m_pos < m_text.size()) {
+				c = m_text[m_pos++];
+				if (c == 'u') {
+					m_pos += 4;
+					c = '?';
+				}
+				else if (c == 'n') c = '\n';
+				else if (c == 't') c = '\t';
+			}
+			out += c;
+		}
+		return false;
+	}
+
+	void SkipSpace() {
+		while (m_pos < m_text.size() && std::strchr(" \t\r\n", m_text[m_pos]) != nullptr) {
+			m_pos++;
+		}
+	}
+
+	char Peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+	char Next() { return m_pos < m_text.size() ? m_text[m_pos++] : '\0'; }
+
+	const std::string& m_text;
+	size_t m_pos;
+	bool m_skipping;   // Inside Children of a node whose identity is not known yet
+};
+
+// ---- BridgeApi implementation ----
+
+int Initialize(bool, bool, bool, bool, bool, bool, bool, bool, bool, bool, bool) {
+	return g_state.sensors.empty() ? 1 : 0;
+}
+
+char* CopyString(const std::string& text) {
+	char* copy = static_cast<char*>(std::malloc(text.size() + 1));
+	std::memcpy(copy, text.c_str(), text.size() + 1);
+	return copy;
+}
+
+int Update(int) {
+	g_state.tick++;
+	float step = (float)(g_state.tick % 16) * 0.25f;
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		g_state.values[i] = g_state.sensors[i].base + step;
+	}
+	return 0;
+}
+
+void* Poll() {
+	Update(0);
+	return CopyString(g_state.pollJson);
+}
+
+int PollInto(char* buffer, int capacity, int, int, int* skippedHardware) {
+	// The tree is fixed text, so a retry after a short buffer needs no pending state
+	int needed = (int)g_state.pollJson.size() + 1;
+	if (buffer == nullptr || capacity < needed) {
+		return -needed;
+	}
+	Update(0);
+	std::memcpy(buffer, g_state.pollJson.c_str(), needed);
+	if (skippedHardware != nullptr) {
+		*skippedHardware = 0;
+	}
+	return needed - 1;
+}
+
+void FreeString(void* ptr) {
+	std::free(ptr);
+}
+
+void Shutdown() {
+}
+
+void* GetSchema() {
+	return CopyString(g_state.schemaText);
+}
+
+int GetSchemaGeneration() {
+	return g_state.generation;
+}
+
+int ReadValues(float* values, float* mins, float* maxs, int capacity) {
+	int count = 0;
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		count += g_state.excluded[i] ? 0 : 1;
+	}
+	if (count > capacity) {
+		return -count;
+	}
+
+	int index = 0;
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		if (g_state.excluded[i]) {
+			continue;
+		}
+		values[index] = g_state.values[i];
+		if (mins != nullptr) mins[index] = g_state.sensors[i].base;
+		if (maxs != nullptr) maxs[index] = g_state.sensors[i].base + 3.75f;
+		index++;
+	}
+	return count;
+}
+
+int SetFilter(const char* filterJson) {
+	std::string types;
+	if (filterJson != nullptr) {
+		const char* list = std::strstr(filterJson, "\"excludeSensorTypes\"");
+		const char* end = list != nullptr ? std::strchr(list, ']') : nullptr;
+		if (end != nullptr) {
+			types.assign(list, end);
+		}
+	}
+
+	for (size_t i = 0; i < g_state.sensors.size(); i++) {
+		g_state.excluded[i] = !types.empty() && types.find("\"" + g_state.sensors[i].type + "\"") != std::string::npos;
+	}
+	g_state.generation++;
+	Rebuild();
+	return 0;
+}
+
+} // namespace
+
+namespace SyntheticBridge {
+
+bool Configure(const SyntheticBridgeOptions& options, std::string& error) {
+	g_state = State();
+
+	if (!options.fixturePath.empty()) {
+		std::ifstream file(options.fixturePath, std::ios::binary);
+		if (!file) {
+			error = "Cannot open fixture " + options.fixturePath;
+			return false;
+		}
+		std::stringstream text;
+		text << file.rdbuf();
+		std::string json = text.str();
+
+		FixtureReader reader(json);
+		if (!reader.Read(error)) {
+			return false;
+		}
+	}
+	else {
+		Generate(options.hardware, options.sensorsPerHardware);
+	}
+
+	if (g_state.sensors.empty()) {
+		error = "Layout has no sensors";
+		return false;
+	}
+
+	g_state.excluded.assign(g_state.sensors.size(), false);
+	g_state.values.assign(g_state.sensors.size(), 0.0f);
+	Rebuild();
+	return true;
+}
+
+BridgeApi Api() {
+	BridgeApi api;
+	api.initialize = &Initialize;
+	api.poll = &Poll;
+	api.freeString = &FreeString;
+	api.shutdown = &Shutdown;
+	api.getSchema = &GetSchema;
+	api.getSchemaGeneration = &GetSchemaGeneration;
+	api.update = &Update;
+	api.readValues = &ReadValues;
+	api.setFilter = &SetFilter;
+	api.pollInto = &PollInto;
+	return api;
+}
+
+size_t HardwareCount() {
+	return g_state.hardware.size();
+}
+
+size_t SensorCount() {
+	return g_state.sensors.size();
+}
+
+} // namespace SyntheticBridge
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bridge_api.h"
+#include <string>
+
+/**
+ * Synthetic bridge options
+ * With a fixture, the hardware/sensor layout and starting values come from a
+ * recorded poll() JSON (e.g. test/sensor-data.json) instead of being generated.
+ */
+struct SyntheticBridgeOptions {
+    int hardware = 8;             // Generated hardware entries
+    int sensorsPerHardware = 32;  // Generated sensors per hardware
+    std::string fixturePath;      // Recorded poll JSON, overrides the counts above
+};
+
+/**
+ * Synthetic Bridge - in-process stand-in for the managed LibreHardwareMonitorBridge
+ * Implements the BridgeApi contract (schema text, value vectors, poll JSON in
+ * the bridge's format, filters bumping the generation) without the CLR or any
+ * hardware. Poll and schema strings are precomputed and returned as fresh
+ * malloc copies, the way the bridge hands out HGlobal strings, so only the
+ * native side of the pipeline is measured.
+ *
+ * Filters honor excludeSensorTypes only.
+ */
+namespace SyntheticBridge {
+
+/**
+ * Build the sensor layout
+ * @param options - layout source
+ * @param error - receives a message on failure
+ * @returns true on success
+ */
+bool Configure(const SyntheticBridgeOptions& options, std::string& error);
+
+/**
+ * Function table to hand to HardwareMonitor / MonitorBackend::Acquire
+ */
+BridgeApi Api();
+
+/**
+ * Number of hardware entries / unfiltered sensors in the layout
+ */
+size_t HardwareCount();
+size_t SensorCount();
+
+} // namespace SyntheticBridge
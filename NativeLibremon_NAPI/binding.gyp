@@ -4,20 +4,30 @@
       "target_name": "librehardwaremonitor_native",
       "sources": [
         "src/addon.cc",
+        "src/anomaly_detector.cc",
+        "src/arrow_ipc.cc",
         "src/clr_host.cc",
+        "src/derived_sensors.cc",
         "src/hardware_monitor.cc",
-        "src/json_builder.cc"
+        "src/history_store.cc",
+        "src/json_builder.cc",
+        "src/monitor_backend.cc",
+        "src/native_bridge.cc",
+        "src/poll_table.cc",
+        "src/replay_bridge.cc",
+        "src/sampler.cc",
+        "src/sensor_format.cc",
+        "src/sensor_index.cc",
+        "src/sensor_schema.cc",
+        "src/shared_buffer.cc",
+        "src/state_file.cc",
+        "src/topology_diff.cc",
+        "src/topology_sink.cc",
+        "src/trace_file.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
-        "src",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/10.0.0/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.9/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.10/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.8/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.0/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/8.0.0/runtimes/win-x64/native",
-        "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64"
+        "src"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
@@ -44,38 +54,120 @@
         }
       },
       "msvs_toolset": "v142",
-      "libraries": [
-        "-lnethost"
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ],
+          "include_dirs": [
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/10.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.9/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.10/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.8/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/8.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64"
+          ],
+          "libraries": [
+            "-lnethost",
+            "-lwinmm"
+          ],
+          "copies": [
+            {
+              "destination": "<(module_root_dir)/build/Release",
+              "files": [
+                "<(module_root_dir)/../deps/LibreHardwareMonitor/LibreHardwareMonitorLib.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.Management.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.IO.Ports.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.Threading.AccessControl.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.CodeDom.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/DiskInfoToolkit.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/RAMSPDToolkit-NDD.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/HidSharp.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/hostfxr.dll",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.deps.json",
+                "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.runtimeconfig.json"
+                ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/hostpolicy.dll"
+                ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/coreclr.dll"
+                ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/clrjit.dll"
+                ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/mscordbi.dll"
+                ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/mscordaccore.dll"
+              ]
+            }
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "libremon_bench",
+      "type": "executable",
+      "sources": [
+        "bench/bench_main.cc",
+        "bench/synthetic_bridge.cc",
+        "src/anomaly_detector.cc",
+        "src/clr_host.cc",
+        "src/derived_sensors.cc",
+        "src/hardware_monitor.cc",
+        "src/history_store.cc",
+        "src/monitor_backend.cc",
+        "src/sampler.cc",
+        "src/sensor_format.cc",
+        "src/sensor_index.cc",
+        "src/sensor_schema.cc",
+        "src/state_file.cc",
+        "src/topology_diff.cc"
       ],
-      "copies": [
-        {
-          "destination": "<(module_root_dir)/build/Release",
-          "files": [
-            "<(module_root_dir)/../deps/LibreHardwareMonitor/LibreHardwareMonitorLib.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.Management.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.IO.Ports.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.Threading.AccessControl.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/System.CodeDom.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/DiskInfoToolkit.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/RAMSPDToolkit-NDD.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/HidSharp.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/hostfxr.dll",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.deps.json",
-            "<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/LibreHardwareMonitorBridge.runtimeconfig.json"
-            ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/hostpolicy.dll"
-            ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/coreclr.dll"
-            ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/clrjit.dll"
-            ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/mscordbi.dll"
-            ,"<(module_root_dir)/../managed/LibreHardwareMonitorBridge/bin/Release/net9.0/win-x64/publish/mscordaccore.dll"
+      "include_dirs": [
+        "src",
+        "bench"
+      ],
+      "defines": [
+        "UNICODE",
+        "_UNICODE"
+      ],
+      "cflags!": ["-fno-exceptions"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "cflags_cc": ["-std=c++17"],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": ["/std:c++17"]
+        },
+        "VCLinkerTool": {
+          "AdditionalLibraryDirectories": [
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/10.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.9/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.10/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.8/runtimes/win-x64/native"
           ]
         }
-      ],
+      },
+      "msvs_toolset": "v142",
       "conditions": [
         ["OS=='win'", {
           "defines": [
             "WIN32_LEAN_AND_MEAN",
             "NOMINMAX"
+          ],
+          "include_dirs": [
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/10.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.9/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.10/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.8/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/9.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64/8.0.0/runtimes/win-x64/native",
+            "C:/Program Files/dotnet/packs/Microsoft.NETCore.App.Host.win-x64"
+          ],
+          "libraries": [
+            "-lnethost",
+            "-lwinmm"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
           ]
         }]
       ]
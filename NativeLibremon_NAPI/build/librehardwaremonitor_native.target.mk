@@ -0,0 +1,185 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := librehardwaremonitor_native
+DEFS_Debug := \
+	'-DNODE_GYP_MODULE_NAME=librehardwaremonitor_native' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DNAPI_DISABLE_CPP_EXCEPTIONS' \
+	'-DUNICODE' \
+	'-D_UNICODE' \
+	'-DBUILDING_NODE_EXTENSION' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-fno-rtti \
+	-std=gnu++17
+
+INCS_Debug := \
+	-I/root/.nvm/versions/node/v20.19.5/include/node \
+	-I/root/.nvm/versions/node/v20.19.5/src \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/config \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/openssl/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/uv/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/zlib \
+	-I/root/.nvm/versions/node/v20.19.5/deps/v8/include \
+	-I/root/repo/NativeLibremon_NAPI/node_modules/node-addon-api \
+	-I$(srcdir)/src
+
+DEFS_Release := \
+	'-DNODE_GYP_MODULE_NAME=librehardwaremonitor_native' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DNAPI_DISABLE_CPP_EXCEPTIONS' \
+	'-DUNICODE' \
+	'-D_UNICODE' \
+	'-DBUILDING_NODE_EXTENSION'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-fno-rtti \
+	-std=gnu++17
+
+INCS_Release := \
+	-I/root/.nvm/versions/node/v20.19.5/include/node \
+	-I/root/.nvm/versions/node/v20.19.5/src \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/config \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/openssl/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/uv/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/zlib \
+	-I/root/.nvm/versions/node/v20.19.5/deps/v8/include \
+	-I/root/repo/NativeLibremon_NAPI/node_modules/node-addon-api \
+	-I$(srcdir)/src
+
+OBJS := \
+	$(obj).target/$(TARGET)/src/addon.o \
+	$(obj).target/$(TARGET)/src/anomaly_detector.o \
+	$(obj).target/$(TARGET)/src/arrow_ipc.o \
+	$(obj).target/$(TARGET)/src/clr_host.o \
+	$(obj).target/$(TARGET)/src/derived_sensors.o \
+	$(obj).target/$(TARGET)/src/hardware_monitor.o \
+	$(obj).target/$(TARGET)/src/history_store.o \
+	$(obj).target/$(TARGET)/src/json_builder.o \
+	$(obj).target/$(TARGET)/src/monitor_backend.o \
+	$(obj).target/$(TARGET)/src/native_bridge.o \
+	$(obj).target/$(TARGET)/src/poll_table.o \
+	$(obj).target/$(TARGET)/src/replay_bridge.o \
+	$(obj).target/$(TARGET)/src/sampler.o \
+	$(obj).target/$(TARGET)/src/sensor_format.o \
+	$(obj).target/$(TARGET)/src/sensor_index.o \
+	$(obj).target/$(TARGET)/src/sensor_schema.o \
+	$(obj).target/$(TARGET)/src/shared_buffer.o \
+	$(obj).target/$(TARGET)/src/state_file.o \
+	$(obj).target/$(TARGET)/src/topology_diff.o \
+	$(obj).target/$(TARGET)/src/topology_sink.o \
+	$(obj).target/$(TARGET)/src/trace_file.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(builddir)/nothing.a $(obj).target/node_modules/node-addon-api/nothing.a
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS :=
+
+$(obj).target/rehardwaremonitor_native.node: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/rehardwaremonitor_native.node: LIBS := $(LIBS)
+$(obj).target/rehardwaremonitor_native.node: TOOLSET := $(TOOLSET)
+$(obj).target/rehardwaremonitor_native.node: $(OBJS) $(obj).target/node_modules/node-addon-api/nothing.a FORCE_DO_CMD
+	$(call do_cmd,solink_module)
+
+all_deps += $(obj).target/rehardwaremonitor_native.node
+# Add target alias
+.PHONY: librehardwaremonitor_native
+librehardwaremonitor_native: $(builddir)/rehardwaremonitor_native.node
+
+# Copy this to the executable output path.
+$(builddir)/rehardwaremonitor_native.node: TOOLSET := $(TOOLSET)
+$(builddir)/rehardwaremonitor_native.node: $(obj).target/rehardwaremonitor_native.node FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/rehardwaremonitor_native.node
+# Short alias for building this executable.
+.PHONY: rehardwaremonitor_native.node
+rehardwaremonitor_native.node: $(obj).target/rehardwaremonitor_native.node $(builddir)/rehardwaremonitor_native.node
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/rehardwaremonitor_native.node
+
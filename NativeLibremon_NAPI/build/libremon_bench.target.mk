@@ -0,0 +1,165 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := libremon_bench
+DEFS_Debug := \
+	'-DNODE_GYP_MODULE_NAME=libremon_bench' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DUNICODE' \
+	'-D_UNICODE' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-fno-rtti \
+	-std=gnu++17 \
+	-std=c++17
+
+INCS_Debug := \
+	-I/root/.nvm/versions/node/v20.19.5/include/node \
+	-I/root/.nvm/versions/node/v20.19.5/src \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/config \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/openssl/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/uv/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/zlib \
+	-I/root/.nvm/versions/node/v20.19.5/deps/v8/include \
+	-I$(srcdir)/src \
+	-I$(srcdir)/bench
+
+DEFS_Release := \
+	'-DNODE_GYP_MODULE_NAME=libremon_bench' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DUNICODE' \
+	'-D_UNICODE'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-fno-rtti \
+	-std=gnu++17 \
+	-std=c++17
+
+INCS_Release := \
+	-I/root/.nvm/versions/node/v20.19.5/include/node \
+	-I/root/.nvm/versions/node/v20.19.5/src \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/config \
+	-I/root/.nvm/versions/node/v20.19.5/deps/openssl/openssl/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/uv/include \
+	-I/root/.nvm/versions/node/v20.19.5/deps/zlib \
+	-I/root/.nvm/versions/node/v20.19.5/deps/v8/include \
+	-I$(srcdir)/src \
+	-I$(srcdir)/bench
+
+OBJS := \
+	$(obj).target/$(TARGET)/bench/bench_main.o \
+	$(obj).target/$(TARGET)/bench/synthetic_bridge.o \
+	$(obj).target/$(TARGET)/src/anomaly_detector.o \
+	$(obj).target/$(TARGET)/src/clr_host.o \
+	$(obj).target/$(TARGET)/src/derived_sensors.o \
+	$(obj).target/$(TARGET)/src/hardware_monitor.o \
+	$(obj).target/$(TARGET)/src/history_store.o \
+	$(obj).target/$(TARGET)/src/monitor_backend.o \
+	$(obj).target/$(TARGET)/src/sampler.o \
+	$(obj).target/$(TARGET)/src/sensor_format.o \
+	$(obj).target/$(TARGET)/src/sensor_index.o \
+	$(obj).target/$(TARGET)/src/sensor_schema.o \
+	$(obj).target/$(TARGET)/src/state_file.o \
+	$(obj).target/$(TARGET)/src/topology_diff.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS := \
+	-lpthread
+
+$(builddir)/libremon_bench: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(builddir)/libremon_bench: LIBS := $(LIBS)
+$(builddir)/libremon_bench: LD_INPUTS := $(OBJS)
+$(builddir)/libremon_bench: TOOLSET := $(TOOLSET)
+$(builddir)/libremon_bench: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,link)
+
+all_deps += $(builddir)/libremon_bench
+# Add target alias
+.PHONY: libremon_bench
+libremon_bench: $(builddir)/libremon_bench
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/libremon_bench
+
@@ -0,0 +1,167 @@
+/**
+ * data.json HTTP endpoint
+ *
+ * Serves poll() output at /data.json in the layout of LibreHardwareMonitor's
+ * built-in web server, for tools that scrape it. The JSON text is taken once
+ * per sample (at most every maxAgeMs), gzipped once, and the same buffers are
+ * written to every request; concurrent requests for a stale sample share one
+ * poll. Clients revalidating with If-None-Match get a bodiless 304.
+ *
+ * Pure JavaScript: the JSON comes from a source function, so it can be fed by
+ * the addon or by a replay backend.
+ */
+
+const http = require('http');
+const zlib = require('zlib');
+const crypto = require('crypto');
+
+const DATA_PATH = '/data.json';
+
+/**
+ * One serialized sample, with its gzip variant and validators
+ */
+class CachedResponse {
+	constructor(text, takenAt) {
+		this.body = Buffer.from(text, 'utf8');
+		this.gzip = zlib.gzipSync(this.body);
+		this.takenAt = takenAt;
+		this.lastModified = new Date(takenAt).toUTCString();
+		// Strong validators; the gzip variant is a different representation
+		const hash = crypto.createHash('sha1').update(this.body).digest('base64url').slice(0, 22);
+		this.etag = '"' + hash + '"';
+		this.gzipEtag = '"' + hash + '-gz"';
+	}
+
+	matches(ifNoneMatch) {
+		if (!ifNoneMatch) return false;
+		if (ifNoneMatch.trim() === '*') return true;
+		return ifNoneMatch.split(',').some((tag) => {
+			const value = tag.trim().replace(/^W\//, '');
+			return value === this.etag || value === this.gzipEtag;
+		});
+	}
+}
+
+function acceptsGzip(header) {
+	if (!header) return false;
+	return header.split(',').some((entry) => {
+		const [coding, ...params] = entry.trim().toLowerCase().split(';');
+		if (coding !== 'gzip' && coding !== '*') return false;
+		const q = params.map((p) => p.trim()).find((p) => p.startsWith('q='));
+		return !q || parseFloat(q.slice(2)) > 0;
+	});
+}
+
+class DataServer {
+	/**
+	 * @param {object} options
+	 * @param {function(): Promise<string>} options.source - returns poll JSON text
+	 * @param {number} [options.maxAgeMs=1000] - reuse a sample for this long
+	 */
+	constructor(options) {
+		if (typeof options.source !== 'function') {
+			throw new TypeError('source must be a function returning poll JSON text');
+		}
+		const maxAgeMs = options.maxAgeMs !== undefined ? options.maxAgeMs : 1000;
+		if (!Number.isInteger(maxAgeMs) || maxAgeMs < 0) {
+			throw new TypeError('maxAgeMs must be a non-negative integer');
+		}
+		this.source = options.source;
+		this.maxAgeMs = maxAgeMs;
+		this.current = null;
+		this.pending = null;
+		this.stats = { requests: 0, samples: 0, notModified: 0, gzip: 0, errors: 0 };
+		this.server = http.createServer((req, res) => this.handle(req, res));
+	}
+
+	/**
+	 * Start listening
+	 * @param {number} port - 0 picks a free port
+	 * @param {string} [host='127.0.0.1']
+	 * @returns {Promise<{host:string, port:number}>}
+	 */
+	listen(port, host = '127.0.0.1') {
+		return new Promise((resolve, reject) => {
+			this.server.once('error', reject);
+			this.server.listen(port, host, () => {
+				this.server.off('error', reject);
+				const address = this.server.address();
+				resolve({ host: address.address, port: address.port });
+			});
+		});
+	}
+
+	close() {
+		return new Promise((resolve) => {
+			this.server.close(() => resolve());
+			if (this.server.closeAllConnections) this.server.closeAllConnections();
+		});
+	}
+
+	// Latest sample, polling only when it is older than maxAgeMs
+	sample() {
+		const now = Date.now();
+		if (this.current && now - this.current.takenAt < this.maxAgeMs) {
+			return Promise.resolve(this.current);
+		}
+		if (!this.pending) {
+			this.pending = Promise.resolve()
+				.then(() => this.source())
+				.then((text) => {
+					this.current = new CachedResponse(text, Date.now());
+					this.stats.samples++;
+					return this.current;
+				})
+				.finally(() => {
+					this.pending = null;
+				});
+		}
+		return this.pending;
+	}
+
+	handle(req, res) {
+		this.stats.requests++;
+		const path = req.url.split('?')[0];
+		if (path !== DATA_PATH) {
+			res.writeHead(404, { 'Content-Type': 'text/plain' });
+			res.end('Not found\n');
+			return;
+		}
+		if (req.method !== 'GET' && req.method !== 'HEAD') {
+			res.writeHead(405, { 'Allow': 'GET, HEAD', 'Content-Type': 'text/plain' });
+			res.end('Method not allowed\n');
+			return;
+		}
+
+		this.sample().then((cached) => {
+			const gzip = acceptsGzip(req.headers['accept-encoding']);
+			const headers = {
+				'Content-Type': 'application/json',
+				'Cache-Control': 'no-cache',
+				'Vary': 'Accept-Encoding',
+				'ETag': gzip ? cached.gzipEtag : cached.etag,
+				'Last-Modified': cached.lastModified
+			};
+			if (cached.matches(req.headers['if-none-match'])) {
+				this.stats.notModified++;
+				res.writeHead(304, headers);
+				res.end();
+				return;
+			}
+			const body = gzip ? cached.gzip : cached.body;
+			if (gzip) {
+				headers['Content-Encoding'] = 'gzip';
+				this.stats.gzip++;
+			}
+			headers['Content-Length'] = body.length;
+			res.writeHead(200, headers);
+			res.end(req.method === 'HEAD' ? undefined : body);
+		}, (err) => {
+			this.stats.errors++;
+			res.writeHead(503, { 'Content-Type': 'text/plain', 'Retry-After': '1' });
+			res.end('Sensor data unavailable: ' + err.message + '\n');
+		});
+	}
+}
+
+module.exports = { DataServer, DATA_PATH };
@@ -10,6 +10,10 @@
 
 const path = require('path');
 const fs = require('fs');
+const { EventEmitter } = require('events');
+const { SharedSampleReader, byteLengthFor } = require('./shared-buffer');
+const { DataServer } = require('./data-server');
+const { createPollView } = require('./poll-view');
 
 let nativeAddon = null;
 
@@ -37,24 +41,109 @@ function loadAddon() {
 	return nativeAddon;
 }
 
+const CATEGORIES = ['cpu', 'gpu', 'motherboard', 'memory', 'storage', 'network', 'psu', 'controller', 'battery', 'other'];
+
+// Validate the adaptive sampling config: { changeThreshold?, <category>: { minIntervalMs, maxIntervalMs } }
+function buildAdaptive(adaptive) {
+	if (adaptive === null || typeof adaptive !== 'object') {
+		throw new TypeError('adaptive must be an object');
+	}
+	const result = {};
+	for (const key of Object.keys(adaptive)) {
+		const value = adaptive[key];
+		if (key === 'changeThreshold') {
+			if (typeof value !== 'number' || !(value > 0)) {
+				throw new TypeError('adaptive.changeThreshold must be a positive number');
+			}
+			result.changeThreshold = value;
+			continue;
+		}
+		if (!CATEGORIES.includes(key)) {
+			throw new TypeError('Unknown adaptive category: ' + key);
+		}
+		const min = value && value.minIntervalMs;
+		const max = value && value.maxIntervalMs;
+		if (!Number.isInteger(min) || min < 1 || !Number.isInteger(max) || max < min) {
+			throw new TypeError('adaptive.' + key + ' needs integer minIntervalMs >= 1 and maxIntervalMs >= minIntervalMs');
+		}
+		result[key] = { minIntervalMs: min, maxIntervalMs: max };
+	}
+	return result;
+}
+
 async function init(config = {}) {
 	const addon = loadAddon();
+	// A replay shows every recorded hardware type unless told otherwise
+	const enabled = config.replay !== undefined;
 	const fullConfig = {
-		cpu: config.cpu !== undefined ? config.cpu : false,
-		gpu: config.gpu !== undefined ? config.gpu : false,
-		motherboard: config.motherboard !== undefined ? config.motherboard : false,
-		memory: config.memory !== undefined ? config.memory : false,
-		storage: config.storage !== undefined ? config.storage : false,
-		network: config.network !== undefined ? config.network : false,
-		psu: config.psu !== undefined ? config.psu : false,
-		controller: config.controller !== undefined ? config.controller : false,
-		battery: config.battery !== undefined ? config.battery : false,
+		cpu: config.cpu !== undefined ? config.cpu : enabled,
+		gpu: config.gpu !== undefined ? config.gpu : enabled,
+		motherboard: config.motherboard !== undefined ? config.motherboard : enabled,
+		memory: config.memory !== undefined ? config.memory : enabled,
+		storage: config.storage !== undefined ? config.storage : enabled,
+		network: config.network !== undefined ? config.network : enabled,
+		psu: config.psu !== undefined ? config.psu : enabled,
+		controller: config.controller !== undefined ? config.controller : enabled,
+		battery: config.battery !== undefined ? config.battery : enabled,
 		dimmDetection: config.dimmDetection !== undefined ? config.dimmDetection : false,
 		physicalNetworkOnly: config.physicalNetworkOnly !== undefined ? config.physicalNetworkOnly : true
 	};
+	if (config.cpuBudgetPercent !== undefined) {
+		if (typeof config.cpuBudgetPercent !== 'number' || !(config.cpuBudgetPercent >= 0)) {
+			throw new TypeError('cpuBudgetPercent must be a non-negative number');
+		}
+		fullConfig.cpuBudgetPercent = config.cpuBudgetPercent;
+	}
+	if (config.adaptive !== undefined) {
+		fullConfig.adaptive = buildAdaptive(config.adaptive);
+	}
+	const filter = buildFilter(config.filter);
+	if (filter) {
+		fullConfig.filter = JSON.stringify(filter);
+	}
+	if (config.replay !== undefined) {
+		if (typeof config.replay !== 'string' || config.replay === '') {
+			throw new TypeError('replay must be the path of a recorded trace');
+		}
+		const speed = config.speed !== undefined ? config.speed : 1;
+		if (typeof speed !== 'number' || !Number.isFinite(speed) || speed < 0) {
+			throw new TypeError('speed must be a non-negative number');
+		}
+		// Absolute, so every worker thread joining the replay names the same file
+		fullConfig.replay = path.resolve(config.replay);
+		fullConfig.speed = speed;
+		fullConfig.loop = config.loop !== undefined ? !!config.loop : true;
+		for (const key of ['updateMs', 'writeMs']) {
+			if (config[key] === undefined) continue;
+			if (typeof config[key] !== 'number' || !Number.isFinite(config[key]) || config[key] < 0) {
+				throw new TypeError(key + ' must be a non-negative number');
+			}
+			fullConfig[key] = config[key];
+		}
+	}
+	if (config.bridge !== undefined) {
+		if (!['auto', 'hostfxr', 'native'].includes(config.bridge)) {
+			throw new TypeError("bridge must be 'auto', 'hostfxr' or 'native'");
+		}
+		fullConfig.bridge = config.bridge;
+	}
+	if (config.stateFile !== undefined) {
+		if (typeof config.stateFile !== 'string' || config.stateFile === '') {
+			throw new TypeError('stateFile must be a file path');
+		}
+		const flushMs = config.stateFlushMs !== undefined ? config.stateFlushMs : 5000;
+		if (!Number.isInteger(flushMs) || flushMs < 100) {
+			throw new TypeError('stateFlushMs must be an integer of at least 100');
+		}
+		// Absolute, so every worker thread attaching names the same file
+		fullConfig.stateFile = path.resolve(config.stateFile);
+		fullConfig.stateFlushMs = flushMs;
+	}
 
 	try {
-		return addon.init(fullConfig);
+		await addon.init(fullConfig);
+		initialized = true;
+		syncTopology();
 	} catch(err) {
 		if (err.message && err.message.includes('.NET runtime')) {
 			throw new Error(
@@ -67,70 +156,743 @@ async function init(config = {}) {
 	}
 }
 
-function filterVirtualNetworkAdapters(data) {
-	if (!data || !data.Children) return;
-    
-	for (const child of data.Children) {
-		if (child.Children && Array.isArray(child.Children)) {
-			child.Children = child.Children.filter(item => {
-				if (!item.HardwareId || !item.HardwareId.includes('/nic/')) {
-					return true;
-				}
-				const name = item.Text || '';
-				const virtualPatterns = [
-					'-QoS Packet Scheduler',
-					'-WFP ',
-					'-VirtualBox NDIS',
-					'-Hyper-V Virtual Switch',
-					'-Native WiFi Filter',
-					'-Virtual WiFi Filter',
-					'vEthernet',
-					'vSwitch',
-					'(Kerneldebugger)'
-				];
-				const isVirtual = virtualPatterns.some(pattern => name.includes(pattern));
-				return !isVirtual;
-			});
-			filterVirtualNetworkAdapters(child);
-		}
-	}
-}
-
-function filterIndividualDIMMs(data) {
-	if (!data || !data.Children) return;
-    
-	for (const child of data.Children) {
-		if (child.Children && Array.isArray(child.Children)) {
-			child.Children = child.Children.filter(item => {
-				if (!item.HardwareId || !item.HardwareId.includes('/memory/dimm/')) {
-					return true;
-				}
-				return false;
-			});
-			filterIndividualDIMMs(child);
+const CONFIG_FLAGS = [
+	'cpu', 'gpu', 'motherboard', 'memory', 'storage', 'network', 'psu', 'controller', 'battery',
+	'dimmDetection', 'physicalNetworkOnly'
+];
+
+/**
+ * Enable or disable hardware types on the running monitor, without restarting
+ * it (the .NET runtime cannot be re-initialized in a process). Hardware of
+ * enabled types is opened and that of disabled types closed, one group at a
+ * time; the schema generation changes on the next poll or sample.
+ * Process-wide: worker threads that init() afterwards must pass the new flags.
+ * @param {object} changes - any of the init() hardware flags; others keep their value
+ * @returns {Promise<object>} the complete configuration now in effect
+ */
+async function reconfigure(changes) {
+	if (!changes || typeof changes !== 'object') {
+		throw new TypeError('Expected an object of hardware flags');
+	}
+	for (const key of Object.keys(changes)) {
+		if (!CONFIG_FLAGS.includes(key)) {
+			throw new TypeError('Unknown hardware flag: ' + key);
+		}
+		if (typeof changes[key] !== 'boolean') {
+			throw new TypeError(key + ' must be a boolean');
+		}
+	}
+	const addon = loadAddon();
+	return addon.reconfigure(changes);
+}
+
+/**
+ * Hardware flags in effect (as passed to init(), or last reconfigure())
+ */
+function getConfig() {
+	const addon = loadAddon();
+	return addon.getConfig();
+}
+
+// Legacy poll() options, as FilterPreset bits (src/hardware_monitor.h); the
+// bridge leaves their hardware out of the tree of the polls that pass them
+const FILTER_PRESETS = {
+	filterVirtualNics: 1,
+	filterDIMMs: 2
+};
+
+const FILTER_LISTS = [
+	'excludeNames',
+	'excludeHardwareIds',
+	'excludeSensorTypes',
+	'includeNames',
+	'includeHardwareIds',
+	'includeSensorTypes'
+];
+
+/**
+ * Validate a filter spec
+ * @returns {object|null} spec with only non-empty string arrays, null if empty
+ */
+function buildFilter(filter) {
+	if (filter !== null && filter !== undefined && typeof filter !== 'object') {
+		throw new TypeError('filter must be an object');
+	}
+	const spec = {};
+	for (const key of FILTER_LISTS) {
+		const list = filter ? filter[key] : undefined;
+		if (list === undefined || list === null) continue;
+		if (!Array.isArray(list) || !list.every(item => typeof item === 'string')) {
+			throw new TypeError('filter.' + key + ' must be an array of strings');
+		}
+		if (list.length > 0) spec[key] = list.slice();
+	}
+	return Object.keys(spec).length > 0 ? spec : null;
+}
+
+// FilterPreset bits of the legacy options this poll passes
+function filterPresets(options) {
+	let presets = 0;
+	for (const key of Object.keys(FILTER_PRESETS)) {
+		if (options[key]) presets |= FILTER_PRESETS[key];
+	}
+	return presets;
+}
+
+/**
+ * Replace the hardware/sensor filter. Filtered hardware is skipped by the
+ * native side: it is neither updated nor serialized, and is absent from the
+ * schema and shared buffers. The filter is process-wide (shared by worker threads);
+ * the addon keeps it and only hands the bridge one that changed.
+ * @param {object|null} filter - { excludeNames, excludeHardwareIds, excludeSensorTypes,
+ *   includeNames, includeHardwareIds, includeSensorTypes }; null clears it
+ */
+function setFilter(filter) {
+	const addon = loadAddon();
+	const spec = buildFilter(filter);
+	addon.setFilter(spec ? JSON.stringify(spec) : null);
+}
+
+/**
+ * Define (or redefine) a derived sensor, computed natively after every sample
+ * and poll. It appears as /derived/<name> in getSchema(), the sampler's value
+ * vectors and shared buffers, and under a "Derived" hardware node in poll().
+ * Process-wide, like the filter.
+ *
+ * Expressions: + - * / and parentheses over numbers and sensor ids
+ * ('/amdcpu/0/power/0', quoted or bare); sum/avg/min/max(...) over
+ * expressions and globs ('*' and '?' within a path segment, '**' across);
+ * rate(x) per second, integral(x) over seconds, abs(x). See the README.
+ * May refer to derived sensors defined earlier.
+ *
+ * @param {string} name - letters, digits, '_', '-' and '.'
+ * @param {string} expression
+ * @param {object} [options]
+ * @param {string} [options.type='Factor'] - SensorType used for grouping and formatting
+ * @returns {string} sensor id
+ */
+function defineSensor(name, expression, options = {}) {
+	if (typeof name !== 'string' || typeof expression !== 'string') {
+		throw new TypeError('defineSensor(name, expression) expects strings');
+	}
+	const type = options.type !== undefined ? options.type : 'Factor';
+	const addon = loadAddon();
+	return addon.defineSensor(name, expression, type);
+}
+
+/**
+ * Remove a derived sensor
+ * @returns {boolean} false if there was none by that name
+ */
+function removeSensor(name) {
+	const addon = loadAddon();
+	return addon.removeSensor(name);
+}
+
+/**
+ * @returns {{id:string, name:string, expression:string, type:string}[]}
+ */
+function getDerivedSensors() {
+	const addon = loadAddon();
+	return addon.getDerivedSensors();
+}
+
+/**
+ * Latest value of one sensor, from the most recent sample or poll, looked up
+ * in a native hash index (no poll tree is built). Never waits for a poll.
+ * @param {string} sensorId - e.g. '/amdcpu/0/temperature/2'
+ * @returns {number|null} null if the id is unknown or has no value
+ */
+function get(sensorId) {
+	if (typeof sensorId !== 'string') {
+		throw new TypeError('get(sensorId) expects a string');
+	}
+	const addon = loadAddon();
+	return addon.get(sensorId);
+}
+
+/**
+ * Latest values of several sensors (see get())
+ * @param {string[]} sensorIds
+ * @returns {Float32Array} one value per id, NaN if unknown or unavailable
+ */
+function getMany(sensorIds) {
+	if (!Array.isArray(sensorIds)) {
+		throw new TypeError('getMany(sensorIds) expects an array of strings');
+	}
+	const addon = loadAddon();
+	return addon.getMany(sensorIds);
+}
+
+/**
+ * Sensors matching all given criteria, with their latest values, from native
+ * inverted indexes (see get())
+ * @param {object} criteria
+ * @param {string} [criteria.hardwareType] - owning hardware's type, e.g. 'Cpu', 'GpuNvidia'
+ * @param {string} [criteria.hardwareId] - owning hardware's id, e.g. '/amdcpu/0'
+ * @param {string} [criteria.sensorType] - e.g. 'Temperature'
+ * @param {string} [criteria.namePattern] - sensor name glob ('*', '?'), case-insensitive
+ * @returns {{id:string, name:string, type:string, hardwareId:string, hardwareType:string,
+ *   index:number, value:number|null}[]} in schema order
+ */
+function query(criteria = {}) {
+	if (criteria === null || typeof criteria !== 'object') {
+		throw new TypeError('query(criteria) expects an object');
+	}
+	const addon = loadAddon();
+	return addon.query(criteria);
+}
+
+// Validate one anomaly rule: { enabled?, alpha?, threshold?, warmup? } or false
+function buildAnomalyRule(rule, where) {
+	if (rule === false) {
+		return { enabled: false };
+	}
+	if (rule === null || typeof rule !== 'object') {
+		throw new TypeError(where + ' must be an object or false');
+	}
+	const result = {};
+	if (rule.enabled !== undefined) {
+		result.enabled = !!rule.enabled;
+	}
+	if (rule.alpha !== undefined) {
+		if (typeof rule.alpha !== 'number' || !(rule.alpha > 0 && rule.alpha <= 1)) {
+			throw new TypeError(where + '.alpha must be a number in (0, 1]');
+		}
+		result.alpha = rule.alpha;
+	}
+	if (rule.threshold !== undefined) {
+		if (typeof rule.threshold !== 'number' || !(rule.threshold > 0)) {
+			throw new TypeError(where + '.threshold must be a positive number');
 		}
+		result.threshold = rule.threshold;
+	}
+	if (rule.warmup !== undefined) {
+		if (!Number.isInteger(rule.warmup) || rule.warmup < 1) {
+			throw new TypeError(where + '.warmup must be a positive integer');
+		}
+		result.warmup = rule.warmup;
+	}
+	return result;
+}
+
+/**
+ * Enable (or reconfigure) native anomaly detection over every sensor. The
+ * addon keeps an exponentially weighted mean and variance per sensor, and
+ * optionally one per slot of a repeating period (e.g. hour of day), updated
+ * after every sample and poll. Process-wide, like the filter.
+ * @param {object|null} config - null disables detection and drops all baselines
+ * @param {object} [config.defaults] - rule for every sensor type:
+ *   { alpha=0.05, threshold=4, warmup=30, enabled=true }
+ * @param {object} [config.types] - per SensorType overrides of the defaults, or false to skip a type
+ * @param {object|boolean} [config.seasonal=false] - true or { periodMs=86400000, slots=24, alpha=0.05 }
+ */
+function setAnomalyDetection(config) {
+	const addon = loadAddon();
+	if (config === null || config === undefined) {
+		addon.setAnomalyDetection(null);
+		return;
+	}
+	if (typeof config !== 'object') {
+		throw new TypeError('setAnomalyDetection(config) expects an object or null');
+	}
+	const spec = { defaults: buildAnomalyRule(config.defaults || {}, 'defaults'), types: {}, seasonal: null };
+	for (const [type, rule] of Object.entries(config.types || {})) {
+		spec.types[type] = buildAnomalyRule(rule, 'types.' + type);
+	}
+	if (config.seasonal) {
+		const seasonal = config.seasonal === true ? {} : config.seasonal;
+		const periodMs = seasonal.periodMs !== undefined ? seasonal.periodMs : 86400000;
+		const slots = seasonal.slots !== undefined ? seasonal.slots : 24;
+		const alpha = seasonal.alpha !== undefined ? seasonal.alpha : 0.05;
+		if (typeof periodMs !== 'number' || !(periodMs >= 1000)) {
+			throw new TypeError('seasonal.periodMs must be at least 1000');
+		}
+		if (!Number.isInteger(slots) || slots < 1 || slots > 1440) {
+			throw new TypeError('seasonal.slots must be an integer between 1 and 1440');
+		}
+		if (typeof alpha !== 'number' || !(alpha > 0 && alpha <= 1)) {
+			throw new TypeError('seasonal.alpha must be a number in (0, 1]');
+		}
+		spec.seasonal = { periodMs, slots, alpha };
+	}
+	addon.setAnomalyDetection(spec);
+}
+
+/**
+ * Current anomalies and the raise/clear events since a sequence number
+ * (the last 256 events are kept). Never waits for a poll.
+ * @param {object} [options]
+ * @param {number} [options.since=0] - sequence of the last event already seen
+ * @returns {{enabled:boolean, sequence:number, active:object[], events:object[]}}
+ *   events: { sequence, timestamp, state:'raised'|'cleared', id, name, type, value,
+ *   mean, score, seasonalScore, peakScore }; active entries have the same fields
+ *   without sequence and state
+ */
+function getAnomalies(options = {}) {
+	const since = options.since !== undefined ? options.since : 0;
+	if (!Number.isInteger(since) || since < 0) {
+		throw new TypeError('since must be a non-negative integer');
+	}
+	const addon = loadAddon();
+	return addon.getAnomalies(since);
+}
+
+/**
+ * Enable (or reconfigure) the native sample history. Every sample and poll
+ * is appended to a ring buffer of the last `capacity` samples of every sensor,
+ * which history() downsamples for charts. Process-wide, like the filter.
+ * Sensors that disappear read NaN from then on. Changing the capacity keeps
+ * the newest samples that fit.
+ * @param {object|null} config - null disables the history and drops all samples
+ * @param {number} [config.capacity=3600] - samples kept per sensor
+ * @param {number} [config.minIntervalMs=0] - skip samples closer than this to the previous one
+ */
+function setHistory(config) {
+	const addon = loadAddon();
+	if (config === null || config === undefined) {
+		addon.setHistory(null);
+		return;
+	}
+	if (typeof config !== 'object') {
+		throw new TypeError('setHistory(config) expects an object or null');
+	}
+	const capacity = config.capacity !== undefined ? config.capacity : 3600;
+	const minIntervalMs = config.minIntervalMs !== undefined ? config.minIntervalMs : 0;
+	if (!Number.isInteger(capacity) || capacity < 1 || capacity > 10000000) {
+		throw new TypeError('capacity must be an integer between 1 and 10000000');
+	}
+	if (typeof minIntervalMs !== 'number' || !(minIntervalMs >= 0)) {
+		throw new TypeError('minIntervalMs must be a non-negative number');
+	}
+	addon.setHistory({ capacity, minIntervalMs });
+}
+
+// ms since the Unix epoch of a Date or number
+function historyTime(value, name) {
+	const time = value instanceof Date ? value.getTime() : value;
+	if (typeof time !== 'number' || Number.isNaN(time)) {
+		throw new TypeError(name + ' must be a Date or a number of ms since the Unix epoch');
+	}
+	return time;
+}
+
+/**
+ * Stored values of sensors between two times, downsampled natively so each
+ * series has at most `points` points whatever the window covers. Windows with
+ * no more than `points` samples come back as stored (NaN where the sensor had
+ * no value); downsampled series never contain NaN.
+ * @param {string[]} sensorIds
+ * @param {Date|number} t0 - start, inclusive (-Infinity for the oldest sample)
+ * @param {Date|number} t1 - end, inclusive (Infinity for the newest sample)
+ * @param {object} [options]
+ * @param {number} [options.points=800] - points per series
+ * @param {'lttb'|'minmax'} [options.method='lttb'] - 'lttb' keeps the shape of
+ *   the line; 'minmax' keeps the minimum and maximum of each of points/2 time
+ *   buckets, so no spike is lost
+ * @returns {Promise<{rows:number, series:{id:string, known:boolean,
+ *   timestamps:Float64Array, values:Float32Array}[]}>} rows: stored samples in
+ *   the window; known: false for ids the history has never seen
+ */
+function history(sensorIds, t0, t1, options = {}) {
+	if (!Array.isArray(sensorIds) || sensorIds.some(id => typeof id !== 'string')) {
+		throw new TypeError('history(sensorIds, t0, t1) expects an array of sensor ids');
+	}
+	const from = historyTime(t0, 't0');
+	const to = historyTime(t1, 't1');
+	const points = options.points !== undefined ? options.points : 800;
+	const method = options.method !== undefined ? options.method : 'lttb';
+	if (method !== 'lttb' && method !== 'minmax') {
+		throw new TypeError("method must be 'lttb' or 'minmax'");
+	}
+	if (!Number.isInteger(points) || points < (method === 'lttb' ? 3 : 2) || points > 1000000) {
+		throw new TypeError(method === 'lttb'
+			? 'points must be an integer between 3 and 1000000'
+			: 'points must be an integer between 2 and 1000000');
+	}
+	const addon = loadAddon();
+	return addon.history(sensorIds, from, to, points, method);
+}
+
+/**
+ * Stored samples of sensors between two times as an Arrow IPC stream, for
+ * pyarrow.ipc.open_stream, Polars' read_ipc_stream, DuckDB, apache-arrow's
+ * tableFromIPC and similar. The stream is built off the main thread from the
+ * native history and handed over as the ArrayBuffer's backing store, without
+ * a copy (Electron, which disallows external buffers, gets one copy).
+ * Columns: `timestamp` (Timestamp, microseconds, UTC), then one float32 column
+ * per sensor named by its id, with nulls where the sensor had no value and
+ * field metadata SensorId, plus SensorName, SensorType, HardwareId and
+ * HardwareName for sensors in the current topology. Not downsampled.
+ * @param {string[]} sensorIds - distinct ids
+ * @param {Date|number} t0 - start, inclusive (-Infinity for the oldest sample)
+ * @param {Date|number} t1 - end, inclusive (Infinity for the newest sample)
+ * @returns {Promise<ArrayBuffer>}
+ */
+function exportArrow(sensorIds, t0, t1) {
+	if (!Array.isArray(sensorIds) || sensorIds.some(id => typeof id !== 'string')) {
+		throw new TypeError('exportArrow(sensorIds, t0, t1) expects an array of sensor ids');
+	}
+	if (new Set(sensorIds).size !== sensorIds.length) {
+		throw new TypeError('exportArrow(sensorIds, t0, t1) expects distinct sensor ids');
+	}
+	const from = historyTime(t0, 't0');
+	const to = historyTime(t1, 't1');
+	const addon = loadAddon();
+	return addon.exportArrow(sensorIds, from, to);
+}
+
+/**
+ * Lowest and highest value of sensors since the state file was created, so
+ * they survive restarts (LibreHardwareMonitor's own Min/Max in poll() start
+ * over with every process). Needs init({ stateFile }).
+ * @param {string[]} sensorIds
+ * @returns {{min:Float32Array, max:Float32Array}} NaN for ids never read
+ */
+function getExtremes(sensorIds) {
+	if (!Array.isArray(sensorIds) || sensorIds.some(id => typeof id !== 'string')) {
+		throw new TypeError('getExtremes(sensorIds) expects an array of sensor ids');
 	}
+	const addon = loadAddon();
+	return addon.getExtremes(sensorIds);
+}
+
+// Error a poll rejects with when its deadline passes
+function pollTimeoutError(deadlineMs) {
+	const error = new Error('poll() did not complete within ' + deadlineMs + ' ms');
+	error.name = 'TimeoutError';
+	error.code = 'ETIMEDOUT';
+	return error;
+}
+
+function abortReason(signal) {
+	if (signal.reason !== undefined) return signal.reason;
+	const error = new Error('The operation was aborted');
+	error.name = 'AbortError';
+	error.code = 'ABORT_ERR';
+	return error;
 }
 
+// Poll that settles as soon as it is aborted or past its deadline; the native
+// side drops it if it has not started, or discards its result unparsed
+function cancellablePoll(addon, lazy, presets, signal, deadlineMs) {
+	if (signal && signal.aborted) {
+		return Promise.reject(abortReason(signal));
+	}
+	return new Promise((resolve, reject) => {
+		const control = {};
+		let timer = null;
+		let settled = false;
+		const settle = (error, result) => {
+			if (settled) return;
+			settled = true;
+			if (timer !== null) clearTimeout(timer);
+			if (signal) signal.removeEventListener('abort', onAbort);
+			if (error) reject(error);
+			else resolve(result);
+		};
+		const onAbort = () => {
+			control.cancel(false);
+			settle(abortReason(signal));
+		};
+
+		addon.poll(false, lazy, deadlineMs !== undefined ? deadlineMs : -1, control, presets).then((result) => {
+			// undefined: the native side saw the deadline pass first
+			if (result === undefined) settle(pollTimeoutError(deadlineMs));
+			else settle(null, result);
+		}, (error) => settle(error));
+
+		if (signal) signal.addEventListener('abort', onAbort);
+		if (deadlineMs !== undefined) {
+			timer = setTimeout(() => {
+				control.cancel(true);
+				settle(pollTimeoutError(deadlineMs));
+			}, deadlineMs);
+		}
+	});
+}
+
+/**
+ * Update all enabled hardware and read the sensor tree
+ * @param {object} [options]
+ * @param {boolean} [options.lazy=false] - resolve with a view whose nodes and
+ *   fields are only created when read (see lib/poll-view.js); toJSON() gives
+ *   the classic object
+ * @param {AbortSignal} [options.signal] - abandons the poll: the promise rejects
+ *   with signal.reason at once, and the addon drops the poll if it has not
+ *   reached the bridge yet, or discards its result unparsed
+ * @param {number} [options.deadlineMs] - rejects with a TimeoutError after this
+ *   long; the bridge only updates hardware during part of it, leaving time to
+ *   write the tree, so a poll may resolve in time with some hardware at its
+ *   previous values (see UpdateEnd)
+ * @param {boolean} [options.filterVirtualNics] - legacy preset: also drop virtual
+ *   NIC / NDIS filter adapters (by name, network hardware only) for this poll
+ * @param {boolean} [options.filterDIMMs] - legacy preset: also drop individual
+ *   DIMMs (HardwareId containing /memory/dimm/) for this poll
+ */
 async function poll(options = {}) {
 	const addon = loadAddon();
-	const data = addon.poll();
-	if (options.filterVirtualNics) {
-		filterVirtualNetworkAdapters(data);
+	const { signal, deadlineMs } = options;
+	if (signal !== undefined && (signal === null || typeof signal.addEventListener !== 'function'
+		|| typeof signal.aborted !== 'boolean')) {
+		throw new TypeError('signal must be an AbortSignal');
 	}
-	if (options.filterDIMMs) {
-		filterIndividualDIMMs(data);
+	if (deadlineMs !== undefined && (typeof deadlineMs !== 'number' || !(deadlineMs >= 0)
+		|| deadlineMs > 2147483647)) {
+		throw new TypeError('deadlineMs must be a number of ms between 0 and 2147483647');
 	}
-	return data;
+	const lazy = Boolean(options.lazy);
+	const presets = filterPresets(options);
+	const result = signal !== undefined || deadlineMs !== undefined
+		? await cancellablePoll(addon, lazy, presets, signal, deadlineMs)
+		: await addon.poll(false, lazy, -1, undefined, presets);
+	// A tree the native side could not flatten comes back parsed
+	if (lazy) {
+		return result && result.nodes instanceof Int32Array ? createPollView(result) : result;
+	}
+	return result;
 }
 
 async function shutdown() {
 	const addon = loadAddon();
+	initialized = false;
+	topologyAttached = false;
 	return addon.shutdown();
 }
 
+// 'topology' listeners survive shutdown()/init(); the native sink is attached
+// while the monitor is initialized and at least one listener is registered
+const events = new EventEmitter();
+const EVENTS = ['topology'];
+let initialized = false;
+let topologyAttached = false;
+
+function emitTopology(diff) {
+	events.emit('topology', diff);
+}
+
+function syncTopology() {
+	const wanted = initialized && events.listenerCount('topology') > 0;
+	if (wanted !== topologyAttached) {
+		loadAddon().onTopology(wanted ? emitTopology : null);
+		topologyAttached = wanted;
+	}
+}
+
+function checkListener(event, listener) {
+	if (!EVENTS.includes(event)) {
+		throw new TypeError('Unknown event: ' + String(event));
+	}
+	if (typeof listener !== 'function') {
+		throw new TypeError('listener must be a function');
+	}
+}
+
+/**
+ * Subscribe to monitor events. 'topology' is emitted with a diff whenever the
+ * schema generation changes (hardware or sensors hot-plugged, filter,
+ * reconfigure() or derived sensor changes), before the first sample laid out
+ * by the new schema:
+ *   { generation, previousGeneration, timestamp,
+ *     hardware: { added: [{ index, parent, type, id, name }], removed: [{ index, id }],
+ *                 moved: [{ id, from, to }] },
+ *     sensors:  { added: [{ index, hardware, type, id, name }], removed: [{ index, id }],
+ *                 moved: [{ id, from, to }] } }
+ * Removed indices and move sources are positions in the previous generation.
+ * Changes are noticed by the next poll or sampler tick.
+ * @param {'topology'} event
+ * @param {function(object):void} listener
+ */
+function on(event, listener) {
+	checkListener(event, listener);
+	events.on(event, listener);
+	syncTopology();
+}
+
+/**
+ * Remove a listener added with on()
+ * @param {'topology'} event
+ * @param {function(object):void} listener
+ */
+function off(event, listener) {
+	checkListener(event, listener);
+	events.off(event, listener);
+	syncTopology();
+}
+
+/**
+ * Sensor layout of the value vectors (shared buffers, sampler)
+ * @returns {{generation:number, hardware:object[], sensors:object[]}}
+ */
+function getSchema() {
+	const addon = loadAddon();
+	return addon.getSchema();
+}
+
+/**
+ * Backend counters and memory figures, for long-running diagnostics
+ * @returns {{polls:number, samples:number, cancellation:{aborted:number,
+ *   timedOut:number, dropped:number, abandoned:number, truncated:number, overrunMs:number},
+ *   nativeHeapBytes:number|null,
+ *   managed:{liveBytes:number, heapSizeBytes:number, committedBytes:number,
+ *   allocatedBytes:number, gen0Collections:number, gen1Collections:number,
+ *   gen2Collections:number}|null}}
+ */
+function getStats() {
+	const addon = loadAddon();
+	return addon.getStats();
+}
+
+/**
+ * Sample a few sensors at a high rate for a short window, e.g. to catch power
+ * or clock transients shorter than the poll period. Only the hardware owning
+ * the sensors is updated; polls and the sampler carry on around the burst.
+ * @param {object} options
+ * @param {string[]} options.sensors - sensor ids (see getSchema())
+ * @param {number} [options.intervalMs=10] - time between samples (1-1000)
+ * @param {number} [options.durationMs=1000] - length of the burst (up to 60000)
+ * @returns {Promise<{sensors:string[], intervalMs:number, startedAt:number, count:number,
+ *   missed:number, truncated:boolean, timestamps:Float64Array, values:Float32Array}>}
+ *   timestamps are monotonic ms since the first sample; values[row * sensors.length + column]
+ */
+function captureBurst(options = {}) {
+	const sensors = options.sensors;
+	if (!Array.isArray(sensors) || sensors.length === 0 || !sensors.every((id) => typeof id === 'string')) {
+		return Promise.reject(new TypeError('sensors must be a non-empty array of sensor ids'));
+	}
+	const intervalMs = options.intervalMs !== undefined ? options.intervalMs : 10;
+	const durationMs = options.durationMs !== undefined ? options.durationMs : 1000;
+	if (!Number.isInteger(intervalMs) || intervalMs < 1 || intervalMs > 1000) {
+		return Promise.reject(new TypeError('intervalMs must be an integer between 1 and 1000'));
+	}
+	if (!Number.isInteger(durationMs) || durationMs < 1 || durationMs > 60000) {
+		return Promise.reject(new TypeError('durationMs must be an integer between 1 and 60000'));
+	}
+	const addon = loadAddon();
+	return addon.captureBurst(sensors, intervalMs, durationMs);
+}
+
+/**
+ * Serve poll() output at http://host:port/data.json in LibreHardwareMonitor's
+ * web server format. Each sample is serialized and gzipped once and shared by
+ * all requests (ETag / If-None-Match, gzip when accepted).
+ * @param {object} [options]
+ * @param {number} [options.port=8085] - 0 picks a free port
+ * @param {string} [options.host='127.0.0.1']
+ * @param {number} [options.maxAgeMs=1000] - how long a sample is reused
+ * @returns {Promise<{host:string, port:number, server:DataServer, close:function(): Promise<void>}>}
+ */
+async function serveDataJson(options = {}) {
+	const addon = loadAddon();
+	const dataServer = new DataServer({
+		source: () => addon.poll(true),
+		maxAgeMs: options.maxAgeMs
+	});
+	const port = options.port !== undefined ? options.port : 8085;
+	const address = await dataServer.listen(port, options.host);
+	return {
+		host: address.host,
+		port: address.port,
+		server: dataServer,
+		close: () => dataServer.close()
+	};
+}
+
+/**
+ * Record every sample (poll(), the sampler, captureBurst excluded) to a trace
+ * file that init({ replay }) can play back. The schema is written once per
+ * sensor layout, followed by binary timestamped value frames; derived
+ * sensors are not recorded, they are evaluated again on replay.
+ * @param {string} file - created or truncated
+ */
+function record(file) {
+	if (typeof file !== 'string' || file === '') {
+		throw new TypeError('Expected a file path');
+	}
+	const addon = loadAddon();
+	addon.record(path.resolve(file));
+}
+
+/**
+ * Stop recording and close the trace file
+ * @returns {{frames:number, schemas:number, bytes:number}|null} null if not recording
+ */
+function stopRecording() {
+	const addon = loadAddon();
+	return addon.stopRecording();
+}
+
+/**
+ * Start the native sampler (process-wide, shared by all worker threads)
+ * Calling it again changes the interval of the running sampler.
+ * @param {object} [options]
+ * @param {number} [options.intervalMs=1000]
+ */
+function startSampler(options = {}) {
+	const addon = loadAddon();
+	const intervalMs = options.intervalMs !== undefined ? options.intervalMs : 1000;
+	addon.startSampler(intervalMs);
+}
+
+function stopSampler() {
+	const addon = loadAddon();
+	addon.stopSampler();
+}
+
+/**
+ * Have every sample written into a SharedArrayBuffer (see lib/shared-buffer.js
+ * for the layout). Size it with byteLengthFor(getSchema().sensors.length).
+ * @param {SharedArrayBuffer} sab
+ * @returns {object} layout: schema plus headerBytes and capacity
+ */
+function attachSharedBuffer(sab) {
+	if (!(sab instanceof SharedArrayBuffer)) {
+		throw new TypeError('Expected a SharedArrayBuffer');
+	}
+	const addon = loadAddon();
+	return addon.attachSharedBuffer(new Int32Array(sab));
+}
+
+function detachSharedBuffer(sab) {
+	if (!(sab instanceof SharedArrayBuffer)) {
+		throw new TypeError('Expected a SharedArrayBuffer');
+	}
+	const addon = loadAddon();
+	return addon.detachSharedBuffer(new Int32Array(sab));
+}
+
 module.exports = {
 	init,
+	on,
+	off,
+	reconfigure,
+	getConfig,
 	poll,
-	shutdown
+	shutdown,
+	setFilter,
+	defineSensor,
+	removeSensor,
+	getDerivedSensors,
+	get,
+	getMany,
+	query,
+	setAnomalyDetection,
+	getAnomalies,
+	setHistory,
+	history,
+	exportArrow,
+	getExtremes,
+	getSchema,
+	getStats,
+	captureBurst,
+	serveDataJson,
+	record,
+	stopRecording,
+	startSampler,
+	stopSampler,
+	attachSharedBuffer,
+	detachSharedBuffer,
+	byteLengthFor,
+	SharedSampleReader,
+	DataServer
 };
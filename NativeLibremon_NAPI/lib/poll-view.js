@@ -0,0 +1,144 @@
+/**
+ * Lazy poll() views
+ *
+ * poll({ lazy: true }) resolves with the poll tree flattened natively into a few
+ * typed arrays (see src/poll_table.h for the layout). The views here read a
+ * node's fields from those arrays only when they are accessed, and build a
+ * Children array of views the first time it is read, so a poll that only looks
+ * at a few sensors allocates a few objects instead of the whole tree.
+ */
+
+const KIND_STRING = 0;
+const KIND_NUMBER = 1;
+const KIND_CHILDREN = 2;
+const KIND_TRUE = 3;
+const KIND_FALSE = 4;
+
+// Fields of the classic poll() nodes, exposed as getters on every view
+const FIELDS = ['id', 'Text', 'Min', 'Value', 'Max', 'ImageURL', 'Children', 'SensorId', 'Type', 'HardwareId',
+	'UpdateStart', 'UpdateEnd'];
+
+class PollTable {
+	constructor(table) {
+		this.keys = table.keys;
+		this.nodes = table.nodes;
+		this.props = table.props;
+		this.numbers = table.numbers;
+		this.children = table.children;
+		this.strings = table.strings;
+		this.keyIndex = new Map();
+		table.keys.forEach((key, index) => this.keyIndex.set(key, index));
+		this.childViews = [];
+	}
+
+	// Property index of a key on a node, -1 if absent
+	find(node, name) {
+		const key = this.keyIndex.get(name);
+		if (key === undefined) return -1;
+		const first = this.nodes[2 * node];
+		const end = first + this.nodes[2 * node + 1];
+		for (let p = first; p < end; p++) {
+			if (this.props[4 * p] === key) return p;
+		}
+		return -1;
+	}
+
+	value(node, p) {
+		const props = this.props;
+		switch (props[4 * p + 1]) {
+			case KIND_STRING: {
+				const offset = props[4 * p + 2];
+				const length = props[4 * p + 3];
+				return length === 0 ? '' : this.strings.toString('utf8', offset, offset + length);
+			}
+			case KIND_NUMBER: return this.numbers[props[4 * p + 2]];
+			case KIND_CHILDREN: return this.childArray(node, p);
+			case KIND_TRUE: return true;
+			case KIND_FALSE: return false;
+			default: return null;
+		}
+	}
+
+	// Children views are built once per node, so repeated reads see the same objects
+	childArray(node, p) {
+		let views = this.childViews[node];
+		if (views === undefined) {
+			const start = this.props[4 * p + 2];
+			const count = this.props[4 * p + 3];
+			views = new Array(count);
+			for (let i = 0; i < count; i++) {
+				views[i] = new PollNode(this, this.children[start + i]);
+			}
+			this.childViews[node] = views;
+		}
+		return views;
+	}
+
+	// Plain object of a node and its subtree, properties in their original order
+	materialize(node) {
+		const result = {};
+		const props = this.props;
+		const first = this.nodes[2 * node];
+		const end = first + this.nodes[2 * node + 1];
+		for (let p = first; p < end; p++) {
+			const key = this.keys[props[4 * p]];
+			if (props[4 * p + 1] === KIND_CHILDREN) {
+				const start = props[4 * p + 2];
+				const count = props[4 * p + 3];
+				const children = new Array(count);
+				for (let i = 0; i < count; i++) {
+					children[i] = this.materialize(this.children[start + i]);
+				}
+				result[key] = children;
+			} else {
+				result[key] = this.value(node, p);
+			}
+		}
+		return result;
+	}
+}
+
+/**
+ * One node of a lazy poll tree
+ * Reads like a classic node (node.Text, node.Children[0].Value, ...); absent
+ * fields read undefined. The fields are getters on the shared prototype, so
+ * Object.keys() and spreading do not see them: use toJSON() (also what
+ * JSON.stringify() calls) for the classic plain object.
+ */
+class PollNode {
+	constructor(table, index) {
+		this._table = table;
+		this._index = index;
+	}
+
+	/**
+	 * Read any property by name, including ones outside the classic fields
+	 */
+	get(name) {
+		const p = this._table.find(this._index, name);
+		return p < 0 ? undefined : this._table.value(this._index, p);
+	}
+
+	/**
+	 * The classic poll() object of this node and its subtree
+	 */
+	toJSON() {
+		return this._table.materialize(this._index);
+	}
+}
+
+for (const field of FIELDS) {
+	Object.defineProperty(PollNode.prototype, field, {
+		get() { return this.get(field); },
+		configurable: true
+	});
+}
+
+/**
+ * Root view of a table resolved by the addon's lazy poll
+ */
+function createPollView(table) {
+	return new PollNode(new PollTable(table), 0);
+}
+
+module.exports = { createPollView, PollNode };
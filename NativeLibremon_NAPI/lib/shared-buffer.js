@@ -0,0 +1,117 @@
+/**
+ * SharedArrayBuffer sample reader
+ *
+ * Pure JavaScript (does not load the native addon), so it can be required
+ * from worker threads that only received the SharedArrayBuffer and layout.
+ *
+ * Layout written by the addon (byte offsets):
+ *    0  int32    sequence     even = stable, odd = write in progress
+ *    4  int32    generation   schema generation of the values
+ *    8  int32    count        sensors in the sample (may exceed capacity)
+ *   12  int32    capacity     value slots in this buffer
+ *   16  float64  timestamp    ms since Unix epoch
+ *   64  float32  values[capacity], indexed by schema sensor index
+ */
+
+const HEADER_BYTES = 64;
+const SEQUENCE_INDEX = 0;
+const GENERATION_INDEX = 1;
+const COUNT_INDEX = 2;
+const CAPACITY_INDEX = 3;
+const TIMESTAMP_OFFSET = 16;
+
+/**
+ * Bytes needed for a buffer holding `sensorCount` values
+ * @param {number} sensorCount
+ * @returns {number}
+ */
+function byteLengthFor(sensorCount) {
+	return HEADER_BYTES + sensorCount * 4;
+}
+
+class SharedSampleReader {
+	/**
+	 * @param {SharedArrayBuffer} sab - buffer attached with attachSharedBuffer()
+	 */
+	constructor(sab) {
+		this.header = new Int32Array(sab, 0, HEADER_BYTES / 4);
+		this.timestampView = new Float64Array(sab, TIMESTAMP_OFFSET, 1);
+		this.values = new Float32Array(sab, HEADER_BYTES);
+		this.lastSequence = 0;
+	}
+
+	/**
+	 * Sequence number of the latest complete sample (0 = none yet)
+	 */
+	get sequence() {
+		return Atomics.load(this.header, SEQUENCE_INDEX) & ~1;
+	}
+
+	/**
+	 * Block until a sample newer than `lastSequence` lands (worker threads only:
+	 * Atomics.wait is not allowed on the main thread)
+	 * @param {number} [timeoutMs=Infinity]
+	 * @returns {boolean} true if a new sample is available
+	 */
+	wait(timeoutMs = Infinity) {
+		let seq = Atomics.load(this.header, SEQUENCE_INDEX);
+		while ((seq & ~1) === this.lastSequence) {
+			if (Atomics.wait(this.header, SEQUENCE_INDEX, seq, timeoutMs) === 'timed-out') {
+				return false;
+			}
+			seq = Atomics.load(this.header, SEQUENCE_INDEX);
+		}
+		return true;
+	}
+
+	/**
+	 * Same as wait() but non-blocking, usable from the main thread
+	 * @param {number} [timeoutMs=Infinity]
+	 * @returns {Promise<boolean>}
+	 */
+	async waitAsync(timeoutMs = Infinity) {
+		let seq = Atomics.load(this.header, SEQUENCE_INDEX);
+		while ((seq & ~1) === this.lastSequence) {
+			const result = Atomics.waitAsync(this.header, SEQUENCE_INDEX, seq, timeoutMs);
+			const outcome = result.async ? await result.value : result.value;
+			if (outcome === 'timed-out') {
+				return false;
+			}
+			seq = Atomics.load(this.header, SEQUENCE_INDEX);
+		}
+		return true;
+	}
+
+	/**
+	 * Copy a consistent snapshot of the latest sample
+	 * @param {Float32Array} [out] - reused destination (allocated if omitted)
+	 * @returns {{sequence:number, generation:number, count:number, timestamp:number, values:Float32Array}}
+	 */
+	read(out) {
+		for (;;) {
+			const before = Atomics.load(this.header, SEQUENCE_INDEX);
+			if (before & 1) {
+				continue; // Writer in progress, a memcpy away from done
+			}
+
+			const count = Math.min(this.header[COUNT_INDEX], this.header[CAPACITY_INDEX]);
+			if (!out || out.length < count) {
+				out = new Float32Array(count);
+			}
+			out.set(this.values.subarray(0, count));
+			const generation = this.header[GENERATION_INDEX];
+			const timestamp = this.timestampView[0];
+
+			if (Atomics.load(this.header, SEQUENCE_INDEX) === before) {
+				this.lastSequence = before;
+				return { sequence: before, generation, count, timestamp, values: out };
+			}
+		}
+	}
+}
+
+module.exports = {
+	HEADER_BYTES,
+	byteLengthFor,
+	SharedSampleReader
+};
@@ -6,6 +6,10 @@
  * - All .NET runtime DLLs
  * - JavaScript wrapper (index.js)
  * - package.json for require() compatibility
+ *
+ * With --aot the bridge is the ahead-of-time compiled
+ * LibreHardwareMonitorBridge.Native.dll (npm run build:managed:aot), which
+ * needs no .NET runtime files.
  */
 
 const fs = require('fs');
@@ -14,7 +18,9 @@ const path = require('path');
 const root = path.resolve(__dirname, '..');
 const distDir = path.join(root, '..', 'dist', 'native-libremon-napi');
 const buildDir = path.join(root, 'build', 'Release');
-const managedPublish = path.join(root, '..', 'managed', 'LibreHardwareMonitorBridge', 'bin', 'Release', 'net9.0', 'win-x64', 'publish-selfcontained');
+const aot = process.argv.includes('--aot');
+const managedPublish = path.join(root, '..', 'managed', 'LibreHardwareMonitorBridge', 'bin', 'Release', 'net9.0', 'win-x64',
+    aot ? 'publish-aot' : 'publish-selfcontained');
 
 // Clean dist directory
 if (fs.existsSync(distDir)) {
@@ -39,10 +45,10 @@ if (!fs.existsSync(addonSrc)) {
 console.log('✓ Copying native addon...');
 fs.copyFileSync(addonSrc, addonDst);
 
-// 2. Copy all .NET runtime DLLs
+// 2. Copy all .NET runtime DLLs (or just the native bridge with --aot)
 if (!fs.existsSync(managedPublish)) {
     console.error('❌ Managed runtime not found:', managedPublish);
-    console.error('   Run "npm run build:managed" first');
+    console.error(`   Run "npm run ${aot ? 'build:managed:aot' : 'build:managed'}" first`);
     process.exit(1);
 }
 
@@ -60,8 +66,8 @@ for (const file of fs.readdirSync(managedPublish)) {
 
 console.log(`  Copied ${dllCount} DLL files`);
 
-// 3. Copy nethost.dll if not already present
-if (!fs.existsSync(path.join(distDir, 'nethost.dll'))) {
+// 3. Copy nethost.dll if not already present (the native bridge does not use it)
+if (!aot && !fs.existsSync(path.join(distDir, 'nethost.dll'))) {
     try {
         const programFiles = process.env['ProgramFiles'] || 'C:\\Program Files';
         const packsRoot = path.join(programFiles, 'dotnet', 'packs', 'Microsoft.NETCore.App.Host.win-x64');
@@ -86,13 +92,18 @@ if (!fs.existsSync(path.join(distDir, 'nethost.dll'))) {
     }
 }
 
-// 4. Copy JavaScript wrapper
-const indexJs = path.join(root, 'lib', 'index.js');
+// 4. Copy JavaScript wrapper (index.js plus the helper modules it requires)
+const libDir = path.join(root, 'lib');
+const indexJs = path.join(libDir, 'index.js');
 const indexDst = path.join(distDir, 'index.js');
 
 if (fs.existsSync(indexJs)) {
     console.log('✓ Copying index.js...');
-    fs.copyFileSync(indexJs, indexDst);
+    for (const file of fs.readdirSync(libDir)) {
+        if (file.endsWith('.js')) {
+            fs.copyFileSync(path.join(libDir, file), path.join(distDir, file));
+        }
+    }
 } else {
     console.warn('⚠ index.js not found in lib/, creating minimal version');
     fs.writeFileSync(indexDst, `// Generated wrapper
@@ -151,9 +162,10 @@ await monitor.shutdown();
 ## Contents
 
 - \`librehardwaremonitor_native.node\` - Native N-API addon
-- \`LibreHardwareMonitorBridge.dll\` - .NET bridge
+${aot ? `- \`LibreHardwareMonitorBridge.Native.dll\` - Ahead-of-time compiled bridge (no .NET runtime needed)
+` : `- \`LibreHardwareMonitorBridge.dll\` - .NET bridge
 - \`*.dll\` - Self-contained .NET 9.0 runtime (~200 files)
-- \`index.js\` - JavaScript API wrapper
+`}- \`index.js\` - JavaScript API wrapper
 `;
 
 fs.writeFileSync(path.join(distDir, 'README.md'), readme);
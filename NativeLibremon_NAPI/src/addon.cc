@@ -1,12 +1,70 @@
 #include <napi.h>
-#include "clr_host.h"
-#include "hardware_monitor.h"
+#include "arrow_ipc.h"
+#include "history_store.h"
+#include "monitor_backend.h"
+#include "native_bridge.h"
+#include "poll_table.h"
+#include "replay_bridge.h"
+#include "shared_buffer.h"
+#include "state_file.h"
+#include "topology_sink.h"
+#include "trace_file.h"
 #include <string>
+#include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
 
-// Global instances
-static CLRHost* g_clrHost = nullptr;
-static HardwareMonitor* g_hardwareMonitor = nullptr;
+// Per-environment state (main thread and each worker_thread get their own).
+// The backend it points at is process-wide and reference counted.
+struct AddonData {
+  MonitorBackend* backend = nullptr;
+  std::vector<SharedBufferSink*> sharedBuffers;
+  TopologySink* topology = nullptr;
+  std::unique_ptr<TraceWriter> recorder;
+  std::string bridge;     // "hostfxr", "native" or "replay"
+
+  void DetachSharedBuffers() {
+    for (SharedBufferSink* sink : sharedBuffers) {
+      backend->RemoveListener(sink);
+      sink->Close();
+    }
+    sharedBuffers.clear();
+  }
+
+  void DetachTopology() {
+    if (topology != nullptr) {
+      backend->RemoveListener(topology);
+      topology->Close();
+      topology = nullptr;
+    }
+  }
+
+  TraceStats StopRecording() {
+    TraceStats stats;
+    if (recorder) {
+      backend->RemoveListener(recorder.get());
+      stats = recorder->Close();
+      recorder.reset();
+    }
+    return stats;
+  }
+
+  ~AddonData() {
+    // Environment teardown drops this environment's reference
+    if (backend != nullptr) {
+      DetachSharedBuffers();
+      DetachTopology();
+      StopRecording();
+      backend->Release();
+      backend = nullptr;
+    }
+  }
+};
 
 static bool getBoolOrDefault(Napi::Env env, const Napi::Object& obj, const char* key, bool defVal) {
   if (!obj.Has(key)) return defVal;
@@ -34,8 +92,10 @@ Napi::Value Init(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   auto deferred = Napi::Promise::Deferred::New(env);
 
+  AddonData* data = env.GetInstanceData<AddonData>();
+
   try {
-    if (g_hardwareMonitor != nullptr) {
+    if (data->backend != nullptr) {
       Napi::Error::New(env, "Hardware monitor already initialized").ThrowAsJavaScriptException();
       deferred.Reject(env.Undefined());
       return deferred.Promise();
@@ -67,25 +127,105 @@ Napi::Value Init(const Napi::CallbackInfo& info) {
       "[NAPI] init flags: cpu=%d gpu=%d motherboard=%d memory=%d storage=%d network=%d psu=%d controller=%d battery=%d dimmDetection=%d physicalNetworkOnly=%d\n",
       hwConfig.cpu, hwConfig.gpu, hwConfig.motherboard, hwConfig.memory, hwConfig.storage, hwConfig.network, hwConfig.psu, hwConfig.controller, hwConfig.battery, hwConfig.dimmDetection, hwConfig.physicalNetworkOnly);
 
-    if (g_clrHost == nullptr) {
-      g_clrHost = new CLRHost();
-      if (!g_clrHost->Initialize()) {
-        delete g_clrHost;
-        g_clrHost = nullptr;
-        Napi::Error::New(env, "Failed to initialize .NET runtime").ThrowAsJavaScriptException();
+    // Optional recorded trace, played back in place of the hardware
+    std::string error;
+    std::string bridge = "hostfxr";
+    const BridgeApi* api = nullptr;
+    if (config.Has("replay") && config.Get("replay").IsString()) {
+      ReplayOptions replay;
+      if (config.Get("speed").IsNumber()) {
+        replay.speed = config.Get("speed").As<Napi::Number>().DoubleValue();
+      }
+      replay.loop = getBoolOrDefault(env, config, "loop", true);
+      if (config.Get("updateMs").IsNumber()) {
+        replay.updateMs = config.Get("updateMs").As<Napi::Number>().DoubleValue();
+      }
+      if (config.Get("writeMs").IsNumber()) {
+        replay.writeMs = config.Get("writeMs").As<Napi::Number>().DoubleValue();
+      }
+      if (!ReplayBridge::Open(config.Get("replay").As<Napi::String>().Utf8Value(), replay, error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
         deferred.Reject(env.Undefined());
         return deferred.Promise();
       }
+      api = ReplayBridge::Api();
+      bridge = "replay";
+    } else {
+      // "auto" takes the ahead-of-time compiled bridge when it was deployed
+      std::string requested = config.Get("bridge").IsString()
+        ? config.Get("bridge").As<Napi::String>().Utf8Value() : "auto";
+      if (requested == "native" || (requested == "auto" && NativeBridge::Available())) {
+        api = NativeBridge::Load(error);
+        if (api == nullptr) {
+          Napi::Error::New(env, error).ThrowAsJavaScriptException();
+          deferred.Reject(env.Undefined());
+          return deferred.Promise();
+        }
+        bridge = "native";
+      }
     }
 
-    g_hardwareMonitor = new HardwareMonitor(g_clrHost);
-    if (!g_hardwareMonitor->Initialize(hwConfig)) {
-      delete g_hardwareMonitor;
-      g_hardwareMonitor = nullptr;
-      Napi::Error::New(env, "Failed to initialize hardware monitor").ThrowAsJavaScriptException();
+    // Attaches to the backend if another environment already started it
+    data->backend = MonitorBackend::Acquire(hwConfig, error, api);
+    if (data->backend == nullptr) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
       deferred.Reject(env.Undefined());
       return deferred.Promise();
     }
+    data->bridge = bridge;
+
+    // Optional filter spec, already serialized to JSON by the JS wrapper
+    if (config.Has("filter") && config.Get("filter").IsString()) {
+      if (!data->backend->SetFilter(config.Get("filter").As<Napi::String>().Utf8Value())) {
+        data->backend->Release();
+        data->backend = nullptr;
+        Napi::Error::New(env, "Invalid filter specification").ThrowAsJavaScriptException();
+        deferred.Reject(env.Undefined());
+        return deferred.Promise();
+      }
+    }
+
+    // Optional state file, restored now and flushed in the background (process-wide)
+    if (config.Has("stateFile") && config.Get("stateFile").IsString()) {
+      StateOptions state;
+      state.path = config.Get("stateFile").As<Napi::String>().Utf8Value();
+      if (config.Get("stateFlushMs").IsNumber()) {
+        state.flushIntervalMs = config.Get("stateFlushMs").As<Napi::Number>().Uint32Value();
+      }
+      if (!data->backend->AttachState(state, error)) {
+        data->backend->Release();
+        data->backend = nullptr;
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        deferred.Reject(env.Undefined());
+        return deferred.Promise();
+      }
+    }
+
+    // Optional CPU budget for the native sampler (process-wide, last init wins)
+    if (config.Has("cpuBudgetPercent") && config.Get("cpuBudgetPercent").IsNumber()) {
+      data->backend->GetSampler().SetCpuBudget(config.Get("cpuBudgetPercent").As<Napi::Number>().DoubleValue());
+    }
+
+    // Optional adaptive per-category intervals, validated by the JS wrapper (process-wide, last init wins)
+    if (config.Has("adaptive") && config.Get("adaptive").IsObject()) {
+      Napi::Object adaptive = config.Get("adaptive").As<Napi::Object>();
+      AdaptiveConfig adaptiveConfig;
+      if (adaptive.Has("changeThreshold") && adaptive.Get("changeThreshold").IsNumber()) {
+        adaptiveConfig.changeThreshold = adaptive.Get("changeThreshold").As<Napi::Number>().DoubleValue();
+      }
+      for (int i = 0; i < kCategoryCount; i++) {
+        Napi::Value entry = adaptive.Get(CategoryName(i));
+        if (!entry.IsObject()) continue;
+        Napi::Object range = entry.As<Napi::Object>();
+        if (range.Get("minIntervalMs").IsNumber()) {
+          adaptiveConfig.ranges[i].minIntervalMs = range.Get("minIntervalMs").As<Napi::Number>().Uint32Value();
+        }
+        if (range.Get("maxIntervalMs").IsNumber()) {
+          adaptiveConfig.ranges[i].maxIntervalMs = range.Get("maxIntervalMs").As<Napi::Number>().Uint32Value();
+        }
+      }
+      data->backend->GetSampler().SetAdaptive(adaptiveConfig);
+    }
 
     deferred.Resolve(env.Undefined());
 
@@ -99,16 +239,37 @@ Napi::Value Init(const Napi::CallbackInfo& info) {
 
 class PollWorker : public Napi::AsyncWorker {
 public:
-    PollWorker(Napi::Env env, HardwareMonitor* monitor)
-        : Napi::AsyncWorker(env), monitor(monitor), deferred(Napi::Promise::Deferred::New(env)) {}
+    // Holds its own backend reference so a shutdown() or worker exit
+    // while the poll is in flight cannot tear the monitor down under it
+    // control: set for polls the caller can cancel or gave a deadline
+    PollWorker(Napi::Env env, MonitorBackend* backend, bool raw, bool lazy,
+               std::shared_ptr<PollControl> control = nullptr, uint32_t filterPresets = 0)
+        : Napi::AsyncWorker(env), backend(backend), raw(raw), lazy(lazy), control(std::move(control)),
+          filterPresets(filterPresets),
+          jsonData(backend->AcquirePollBuffer()), deferred(Napi::Promise::Deferred::New(env)) {
+        backend->AddRef();
+    }
+
+    ~PollWorker() override {
+        backend->ReleasePollBuffer(std::move(jsonData));
+        backend->Release();
+    }
 
     void Execute() override {
-        if (monitor == nullptr) {
-            SetError("Hardware monitor not initialized");
-            return;
-        }
         try {
-            jsonData = monitor->Poll();
+            if (!control) {
+                backend->Poll(jsonData, filterPresets);
+            } else if (!backend->Poll(*control, jsonData, filterPresets)) {
+                // Cancelled or expired while queued or waiting for another poll
+                backend->CountCancelledPoll(*control, false);
+                cancelled = true;
+                return;
+            }
+            if (control && control->Check() != PollControl::kActive) {
+                return;
+            }
+            // Flattened here, off the JS thread; falls back to JSON.parse if the shape is unexpected
+            tableOk = lazy && table.Parse(jsonData);
         } catch (const std::exception& e) {
             SetError(e.what());
         }
@@ -117,9 +278,27 @@ public:
     void OnOK() override {
         Napi::Env env = Env();
         Napi::HandleScope scope(env);
+
+        // The caller has stopped waiting: resolve with undefined without building anything
+        if (!cancelled && control && control->Check() != PollControl::kActive) {
+            backend->CountCancelledPoll(*control, true);
+            cancelled = true;
+        }
+        if (cancelled) {
+            deferred.Resolve(env.Undefined());
+            return;
+        }
         
         try {
+            if (tableOk) {
+                deferred.Resolve(TableToJs(env));
+                return;
+            }
             Napi::Value jsonStr = Napi::String::New(env, jsonData);
+            if (raw) {
+                deferred.Resolve(jsonStr);
+                return;
+            }
             Napi::Object json = env.Global().Get("JSON").As<Napi::Object>();
             Napi::Function parse = json.Get("parse").As<Napi::Function>();
             Napi::Value result = parse.Call({jsonStr});
@@ -138,65 +317,1272 @@ public:
     Napi::Promise GetPromise() { return deferred.Promise(); }
 
 private:
-    HardwareMonitor* monitor;
+    Napi::Object TableToJs(Napi::Env env) {
+        Napi::Array keys = Napi::Array::New(env, table.keys.size());
+        for (size_t i = 0; i < table.keys.size(); i++) {
+            keys.Set((uint32_t)i, Napi::String::New(env, table.keys[i]));
+        }
+        Napi::Int32Array nodes = Napi::Int32Array::New(env, table.nodes.size());
+        std::copy(table.nodes.begin(), table.nodes.end(), nodes.Data());
+        Napi::Int32Array props = Napi::Int32Array::New(env, table.props.size());
+        std::copy(table.props.begin(), table.props.end(), props.Data());
+        Napi::Float64Array numbers = Napi::Float64Array::New(env, table.numbers.size());
+        std::copy(table.numbers.begin(), table.numbers.end(), numbers.Data());
+        Napi::Int32Array children = Napi::Int32Array::New(env, table.children.size());
+        std::copy(table.children.begin(), table.children.end(), children.Data());
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("keys", keys);
+        result.Set("nodes", nodes);
+        result.Set("props", props);
+        result.Set("numbers", numbers);
+        result.Set("children", children);
+        result.Set("strings", Napi::Buffer<char>::Copy(env, table.strings.data(), table.strings.size()));
+        return result;
+    }
+
+    MonitorBackend* backend;
+    bool raw;
+    bool lazy;
+    std::shared_ptr<PollControl> control;
+    uint32_t filterPresets;
+    bool cancelled = false;
+    bool tableOk = false;
+    PollTable table;
     std::string jsonData;
     Napi::Promise::Deferred deferred;
 };
 
+// poll(raw, lazy, deadlineMs, control, filterPresets): raw resolves with the JSON
+// text instead of parsing it, lazy with the tree flattened into arrays (see
+// PollTable, lib/poll-view.js). With a control object (which receives
+// cancel(timedOut)) or a deadlineMs >= 0, the poll resolves with undefined once
+// it has been cancelled or is past its deadline. filterPresets: FilterPreset bits
+// for this poll only.
 Napi::Value Poll(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
   
-  if (g_hardwareMonitor == nullptr) {
+  if (data->backend == nullptr) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").Value());
+    return deferred.Promise();
+  }
+
+  bool raw = info.Length() > 0 && info[0].IsBoolean() && info[0].As<Napi::Boolean>().Value();
+  bool lazy = info.Length() > 1 && info[1].IsBoolean() && info[1].As<Napi::Boolean>().Value();
+  double deadlineMs = info.Length() > 2 && info[2].IsNumber() ? info[2].As<Napi::Number>().DoubleValue() : -1;
+  bool cancellable = info.Length() > 3 && info[3].IsObject();
+  uint32_t filterPresets = info.Length() > 4 && info[4].IsNumber() ? info[4].As<Napi::Number>().Uint32Value() : 0;
+
+  std::shared_ptr<PollControl> control;
+  if (cancellable || deadlineMs >= 0) {
+    control = std::make_shared<PollControl>();
+    if (deadlineMs >= 0) {
+      control->hasDeadline = true;
+      control->deadline = std::chrono::steady_clock::now() +
+          std::chrono::microseconds((int64_t)(std::min(deadlineMs, 1e9) * 1000.0));
+    }
+  }
+  if (cancellable) {
+    // Keeps only the control alive: it may be called after the poll is gone
+    std::shared_ptr<PollControl> handle = control;
+    info[3].As<Napi::Object>().Set("cancel", Napi::Function::New(env, [handle](const Napi::CallbackInfo& call) {
+      bool timedOut = call.Length() > 0 && call[0].ToBoolean().Value();
+      handle->Cancel(timedOut ? PollControl::kTimedOut : PollControl::kAborted);
+    }));
+  }
+
+  PollWorker* worker = new PollWorker(env, data->backend, raw, lazy, std::move(control), filterPresets);
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+static Napi::Object ConfigToJs(Napi::Env env, const HardwareConfig& config) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("cpu", Napi::Boolean::New(env, config.cpu));
+  result.Set("gpu", Napi::Boolean::New(env, config.gpu));
+  result.Set("motherboard", Napi::Boolean::New(env, config.motherboard));
+  result.Set("memory", Napi::Boolean::New(env, config.memory));
+  result.Set("storage", Napi::Boolean::New(env, config.storage));
+  result.Set("network", Napi::Boolean::New(env, config.network));
+  result.Set("psu", Napi::Boolean::New(env, config.psu));
+  result.Set("controller", Napi::Boolean::New(env, config.controller));
+  result.Set("battery", Napi::Boolean::New(env, config.battery));
+  result.Set("dimmDetection", Napi::Boolean::New(env, config.dimmDetection));
+  result.Set("physicalNetworkOnly", Napi::Boolean::New(env, config.physicalNetworkOnly));
+  return result;
+}
+
+class ReconfigureWorker : public Napi::AsyncWorker {
+public:
+    // Opening hardware (storage, DIMM SPD) can take seconds; runs off the main thread
+    ReconfigureWorker(Napi::Env env, MonitorBackend* backend, const HardwareConfig& config)
+        : Napi::AsyncWorker(env), backend(backend), config(config), deferred(Napi::Promise::Deferred::New(env)) {
+        backend->AddRef();
+    }
+
+    ~ReconfigureWorker() override {
+        backend->Release();
+    }
+
+    void Execute() override {
+        try {
+            std::string error;
+            if (!backend->Reconfigure(config, error)) {
+                SetError(error);
+            }
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    void OnOK() override {
+        Napi::HandleScope scope(Env());
+        deferred.Resolve(ConfigToJs(Env(), config));
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred.Reject(e.Value());
+    }
+
+    Napi::Promise GetPromise() { return deferred.Promise(); }
+
+private:
+    MonitorBackend* backend;
+    HardwareConfig config;
+    Napi::Promise::Deferred deferred;
+};
+
+// reconfigure(changes): flags missing from changes keep their current value
+Napi::Value Reconfigure(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+
+  if (data->backend == nullptr) {
     auto deferred = Napi::Promise::Deferred::New(env);
     deferred.Reject(Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").Value());
     return deferred.Promise();
   }
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected configuration object").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  PollWorker* worker = new PollWorker(env, g_hardwareMonitor);
+  Napi::Object changes = info[0].As<Napi::Object>();
+  HardwareConfig config = data->backend->GetConfig();
+  config.cpu = getBoolOrDefault(env, changes, "cpu", config.cpu);
+  config.gpu = getBoolOrDefault(env, changes, "gpu", config.gpu);
+  config.motherboard = getBoolOrDefault(env, changes, "motherboard", config.motherboard);
+  config.memory = getBoolOrDefault(env, changes, "memory", config.memory);
+  config.storage = getBoolOrDefault(env, changes, "storage", config.storage);
+  config.network = getBoolOrDefault(env, changes, "network", config.network);
+  config.psu = getBoolOrDefault(env, changes, "psu", config.psu);
+  config.controller = getBoolOrDefault(env, changes, "controller", config.controller);
+  config.battery = getBoolOrDefault(env, changes, "battery", config.battery);
+  config.dimmDetection = getBoolOrDefault(env, changes, "dimmDetection", config.dimmDetection);
+  config.physicalNetworkOnly = getBoolOrDefault(env, changes, "physicalNetworkOnly", config.physicalNetworkOnly);
+
+  ReconfigureWorker* worker = new ReconfigureWorker(env, data->backend, config);
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+class BurstWorker : public Napi::AsyncWorker {
+public:
+    BurstWorker(Napi::Env env, MonitorBackend* backend, std::vector<std::string> sensors,
+                uint32_t intervalMs, uint32_t durationMs)
+        : Napi::AsyncWorker(env), backend(backend), sensors(std::move(sensors)),
+          intervalMs(intervalMs), durationMs(durationMs), deferred(Napi::Promise::Deferred::New(env)) {
+        backend->AddRef();
+    }
+
+    ~BurstWorker() override {
+        backend->Release();
+    }
+
+    void Execute() override {
+        try {
+            backend->CaptureBurst(sensors, intervalMs, durationMs, capture);
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
+
+        size_t rows = capture.timestamps.size();
+        Napi::Float64Array timestamps = Napi::Float64Array::New(env, rows);
+        std::copy(capture.timestamps.begin(), capture.timestamps.end(), timestamps.Data());
+        Napi::Float32Array values = Napi::Float32Array::New(env, capture.values.size());
+        std::copy(capture.values.begin(), capture.values.end(), values.Data());
+
+        Napi::Array ids = Napi::Array::New(env, capture.sensors.size());
+        for (size_t i = 0; i < capture.sensors.size(); i++) {
+            ids[i] = Napi::String::New(env, capture.sensors[i]);
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("sensors", ids);
+        result.Set("intervalMs", Napi::Number::New(env, capture.intervalMs));
+        result.Set("startedAt", Napi::Number::New(env, capture.startedAt));
+        result.Set("count", Napi::Number::New(env, (double)rows));
+        result.Set("missed", Napi::Number::New(env, capture.missed));
+        result.Set("truncated", Napi::Boolean::New(env, capture.truncated));
+        result.Set("timestamps", timestamps);
+        result.Set("values", values);
+        deferred.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred.Reject(e.Value());
+    }
+
+    Napi::Promise GetPromise() { return deferred.Promise(); }
+
+private:
+    MonitorBackend* backend;
+    std::vector<std::string> sensors;
+    uint32_t intervalMs;
+    uint32_t durationMs;
+    BurstCapture capture;
+    Napi::Promise::Deferred deferred;
+};
+
+// captureBurst(sensorIds, intervalMs, durationMs) - arguments validated by the JS wrapper
+Napi::Value CaptureBurst(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+
+  if (data->backend == nullptr) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").Value());
+    return deferred.Promise();
+  }
+  if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Expected (sensorIds, intervalMs, durationMs)").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Array ids = info[0].As<Napi::Array>();
+  std::vector<std::string> sensors;
+  for (uint32_t i = 0; i < ids.Length(); i++) {
+    sensors.push_back(ids.Get(i).ToString().Utf8Value());
+  }
+
+  BurstWorker* worker = new BurstWorker(env, data->backend, std::move(sensors),
+      info[1].As<Napi::Number>().Uint32Value(), info[2].As<Napi::Number>().Uint32Value());
   worker->Queue();
   return worker->GetPromise();
 }
 
 Napi::Value Shutdown(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+
   try {
-    if (g_hardwareMonitor != nullptr) {
-      g_hardwareMonitor->Shutdown();
-      delete g_hardwareMonitor;
-      g_hardwareMonitor = nullptr;
+    // Only the last environment to shut down actually stops the monitor
+    if (data->backend != nullptr) {
+      data->DetachSharedBuffers();
+      data->DetachTopology();
+      data->StopRecording();
+      data->backend->Release();
+      data->backend = nullptr;
     }
 
-    if (g_clrHost != nullptr) {
-      g_clrHost->Shutdown();
-      delete g_clrHost;
-      g_clrHost = nullptr;
+    return env.Undefined();
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+}
+
+static MonitorBackend* RequireBackend(Napi::Env env) {
+  AddonData* data = env.GetInstanceData<AddonData>();
+  if (data->backend == nullptr) {
+    Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").ThrowAsJavaScriptException();
+  }
+  return data->backend;
+}
+
+static Napi::Object SchemaToJs(Napi::Env env, const SensorSchema& schema) {
+  Napi::Array hardware = Napi::Array::New(env, schema.hardware.size());
+  for (size_t i = 0; i < schema.hardware.size(); i++) {
+    const HardwareInfo& hw = schema.hardware[i];
+    Napi::Object item = Napi::Object::New(env);
+    item.Set("index", Napi::Number::New(env, (double)i));
+    item.Set("parent", Napi::Number::New(env, hw.parent));
+    item.Set("type", Napi::String::New(env, hw.type));
+    item.Set("id", Napi::String::New(env, hw.id));
+    item.Set("name", Napi::String::New(env, hw.name));
+    hardware.Set((uint32_t)i, item);
+  }
+
+  Napi::Array sensors = Napi::Array::New(env, schema.sensors.size());
+  for (size_t i = 0; i < schema.sensors.size(); i++) {
+    const SensorInfo& sensor = schema.sensors[i];
+    Napi::Object item = Napi::Object::New(env);
+    item.Set("index", Napi::Number::New(env, (double)i));
+    item.Set("hardware", Napi::Number::New(env, sensor.hardware));
+    item.Set("type", Napi::String::New(env, sensor.type));
+    item.Set("id", Napi::String::New(env, sensor.id));
+    item.Set("name", Napi::String::New(env, sensor.name));
+    sensors.Set((uint32_t)i, item);
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("generation", Napi::Number::New(env, schema.generation));
+  result.Set("hardware", hardware);
+  result.Set("sensors", sensors);
+  return result;
+}
+
+Napi::Value GetSchema(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  try {
+    return SchemaToJs(env, *backend->GetSchema());
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+}
+
+Napi::Value SetFilter(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  std::string filterJson;
+  if (info.Length() > 0 && info[0].IsString()) {
+    filterJson = info[0].As<Napi::String>().Utf8Value();
+  } else if (info.Length() > 0 && !info[0].IsNull() && !info[0].IsUndefined()) {
+    Napi::TypeError::New(env, "Expected filter JSON string, null or undefined").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  try {
+    if (!backend->SetFilter(filterJson)) {
+      Napi::Error::New(env, "Invalid filter specification").ThrowAsJavaScriptException();
     }
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
 
+// defineSensor(name, expression, type) - type defaults to Factor in the JS wrapper
+Napi::Value DefineSensor(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsString()) {
+    Napi::TypeError::New(env, "Expected (name, expression, type)").ThrowAsJavaScriptException();
     return env.Undefined();
+  }
+
+  DerivedDefinition definition;
+  definition.name = info[0].As<Napi::String>().Utf8Value();
+  definition.expression = info[1].As<Napi::String>().Utf8Value();
+  definition.type = info[2].As<Napi::String>().Utf8Value();
+
+  try {
+    std::string error;
+    if (!backend->DefineSensor(definition, error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return Napi::String::New(env, std::string(DerivedSensors::kHardwareId) + "/" + definition.name);
+}
+
+Napi::Value RemoveSensor(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected sensor name").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return Napi::Boolean::New(env, backend->RemoveSensor(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value GetDerivedSensors(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  std::vector<DerivedDefinition> definitions = backend->GetDerivedSensors();
+  Napi::Array result = Napi::Array::New(env, definitions.size());
+  for (size_t i = 0; i < definitions.size(); i++) {
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("id", Napi::String::New(env, std::string(DerivedSensors::kHardwareId) + "/" + definitions[i].name));
+    entry.Set("name", Napi::String::New(env, definitions[i].name));
+    entry.Set("expression", Napi::String::New(env, definitions[i].expression));
+    entry.Set("type", Napi::String::New(env, definitions[i].type));
+    result[i] = entry;
+  }
+  return result;
+}
+
+static Napi::Value ValueToJs(Napi::Env env, float value) {
+  if (std::isnan(value)) return env.Null();
+  return Napi::Number::New(env, value);
+}
+
+// get(sensorId) - latest value, null if unknown or not available
+Napi::Value Get(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected sensor id").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<std::string> ids(1, info[0].As<Napi::String>().Utf8Value());
+  float value = NAN;
+  try {
+    backend->GetValues(ids, &value);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return ValueToJs(env, value);
+}
+
+// getMany(ids) - Float32Array of latest values, NaN for unknown ids
+Napi::Value GetMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of sensor ids").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array list = info[0].As<Napi::Array>();
+  std::vector<std::string> ids(list.Length());
+  for (uint32_t i = 0; i < list.Length(); i++) {
+    Napi::Value id = list[i];
+    if (!id.IsString()) {
+      Napi::TypeError::New(env, "Sensor ids must be strings").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    ids[i] = id.As<Napi::String>().Utf8Value();
+  }
+
+  Napi::Float32Array values = Napi::Float32Array::New(env, ids.size());
+  try {
+    backend->GetValues(ids, values.Data());
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return values;
+}
+
+// query({ hardwareType, hardwareId, sensorType, namePattern }) - matching sensors with values
+Napi::Value Query(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected a query object").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object spec = info[0].As<Napi::Object>();
+  SensorQuery query;
+  std::string* fields[] = { &query.hardwareType, &query.hardwareId, &query.sensorType, &query.namePattern };
+  const char* names[] = { "hardwareType", "hardwareId", "sensorType", "namePattern" };
+  for (size_t i = 0; i < 4; i++) {
+    Napi::Value value = spec.Get(names[i]);
+    if (value.IsString()) {
+      *fields[i] = value.As<Napi::String>().Utf8Value();
+    } else if (!value.IsUndefined() && !value.IsNull()) {
+      Napi::TypeError::New(env, std::string(names[i]) + " must be a string").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  std::vector<uint32_t> positions;
+  std::vector<float> values;
+  std::shared_ptr<const SensorIndex> index;
+  try {
+    index = backend->Query(query, positions, values);
   } catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Undefined();
   }
+
+  const SensorSchema& schema = index->Schema();
+  Napi::Array result = Napi::Array::New(env, positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    const SensorInfo& sensor = schema.sensors[positions[i]];
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("id", Napi::String::New(env, sensor.id));
+    entry.Set("name", Napi::String::New(env, sensor.name));
+    entry.Set("type", Napi::String::New(env, sensor.type));
+    if (sensor.hardware >= 0 && sensor.hardware < (int)schema.hardware.size()) {
+      entry.Set("hardwareId", Napi::String::New(env, schema.hardware[sensor.hardware].id));
+      entry.Set("hardwareType", Napi::String::New(env, schema.hardware[sensor.hardware].type));
+    }
+    entry.Set("index", Napi::Number::New(env, (double)positions[i]));
+    entry.Set("value", ValueToJs(env, values[i]));
+    result[(uint32_t)i] = entry;
+  }
+  return result;
 }
 
-static void AtExit(void* arg) {
-  if (g_hardwareMonitor != nullptr) {
-    g_hardwareMonitor->Shutdown();
-    delete g_hardwareMonitor;
-    g_hardwareMonitor = nullptr;
+static AnomalyRule RuleFromJs(Napi::Object spec, const AnomalyRule& base) {
+  AnomalyRule rule = base;
+  if (spec.Has("enabled") && spec.Get("enabled").IsBoolean()) {
+    rule.enabled = spec.Get("enabled").As<Napi::Boolean>().Value();
+  }
+  if (spec.Has("alpha") && spec.Get("alpha").IsNumber()) {
+    rule.alpha = spec.Get("alpha").As<Napi::Number>().DoubleValue();
   }
-  if (g_clrHost != nullptr) {
-    g_clrHost->Shutdown();
-    delete g_clrHost;
-    g_clrHost = nullptr;
+  if (spec.Has("threshold") && spec.Get("threshold").IsNumber()) {
+    rule.threshold = spec.Get("threshold").As<Napi::Number>().DoubleValue();
+  }
+  if (spec.Has("warmup") && spec.Get("warmup").IsNumber()) {
+    rule.warmup = spec.Get("warmup").As<Napi::Number>().Uint32Value();
+  }
+  return rule;
+}
+
+// setAnomalyDetection(config | null) - config normalized by the JS wrapper:
+// { defaults, types: { <SensorType>: rule }, seasonal: { periodMs, slots, alpha } | null }
+Napi::Value SetAnomalyDetection(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  try {
+    if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+      backend->SetAnomalyDetection(nullptr);
+      return env.Undefined();
+    }
+    if (!info[0].IsObject()) {
+      Napi::TypeError::New(env, "Expected anomaly config object or null").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Object spec = info[0].As<Napi::Object>();
+    AnomalyConfig config;
+    if (spec.Get("defaults").IsObject()) {
+      config.defaults = RuleFromJs(spec.Get("defaults").As<Napi::Object>(), config.defaults);
+    }
+    if (spec.Get("types").IsObject()) {
+      Napi::Object types = spec.Get("types").As<Napi::Object>();
+      Napi::Array names = types.GetPropertyNames();
+      for (uint32_t i = 0; i < names.Length(); i++) {
+        std::string name = names.Get(i).As<Napi::String>().Utf8Value();
+        Napi::Value rule = types.Get(name);
+        if (rule.IsObject()) {
+          config.types.emplace_back(name, RuleFromJs(rule.As<Napi::Object>(), config.defaults));
+        }
+      }
+    }
+    if (spec.Get("seasonal").IsObject()) {
+      Napi::Object seasonal = spec.Get("seasonal").As<Napi::Object>();
+      config.seasonal = true;
+      config.seasonPeriodMs = seasonal.Get("periodMs").As<Napi::Number>().DoubleValue();
+      config.seasonSlots = seasonal.Get("slots").As<Napi::Number>().Uint32Value();
+      config.seasonAlpha = seasonal.Get("alpha").As<Napi::Number>().DoubleValue();
+    }
+    backend->SetAnomalyDetection(&config);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+static Napi::Object AnomalyToJs(Napi::Env env, const AnomalyEvent& event) {
+  Napi::Object entry = Napi::Object::New(env);
+  entry.Set("sequence", Napi::Number::New(env, (double)event.sequence));
+  entry.Set("timestamp", Napi::Number::New(env, event.timestamp));
+  entry.Set("state", Napi::String::New(env, event.raised ? "raised" : "cleared"));
+  entry.Set("id", Napi::String::New(env, event.sensorId));
+  entry.Set("name", Napi::String::New(env, event.name));
+  entry.Set("type", Napi::String::New(env, event.type));
+  entry.Set("value", Napi::Number::New(env, event.value));
+  entry.Set("mean", Napi::Number::New(env, event.mean));
+  entry.Set("score", Napi::Number::New(env, event.score));
+  entry.Set("seasonalScore", Napi::Number::New(env, event.seasonalScore));
+  entry.Set("peakScore", Napi::Number::New(env, event.peakScore));
+  return entry;
+}
+
+// getAnomalies(sinceSequence)
+Napi::Value GetAnomalies(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  uint64_t since = 0;
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    double value = info[0].As<Napi::Number>().DoubleValue();
+    since = value > 0 ? (uint64_t)value : 0;
+  }
+
+  AnomalyReport report = backend->GetAnomalies(since);
+  Napi::Array active = Napi::Array::New(env, report.active.size());
+  for (size_t i = 0; i < report.active.size(); i++) {
+    Napi::Object entry = AnomalyToJs(env, report.active[i]);
+    entry.Delete("sequence");
+    entry.Delete("state");
+    active[(uint32_t)i] = entry;
+  }
+  Napi::Array events = Napi::Array::New(env, report.events.size());
+  for (size_t i = 0; i < report.events.size(); i++) {
+    events[(uint32_t)i] = AnomalyToJs(env, report.events[i]);
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("enabled", Napi::Boolean::New(env, report.enabled));
+  result.Set("sequence", Napi::Number::New(env, (double)report.sequence));
+  result.Set("active", active);
+  result.Set("events", events);
+  return result;
+}
+
+class ExportArrowWorker : public Napi::AsyncWorker {
+public:
+    ExportArrowWorker(Napi::Env env, MonitorBackend* backend, std::shared_ptr<HistoryStore> store,
+                      std::vector<std::string> ids, double from, double to)
+        : Napi::AsyncWorker(env), backend(backend), store(std::move(store)), ids(std::move(ids)),
+          from(from), to(to), deferred(Napi::Promise::Deferred::New(env)) {
+        backend->AddRef();
+    }
+
+    ~ExportArrowWorker() override {
+        std::free(stream);
+        backend->Release();
+    }
+
+    void Execute() override {
+        try {
+            HistoryWindow window;
+            store->Window(ids, from, to, window);
+
+            // Names and types from the current layout; sensors that went away only have their id
+            std::shared_ptr<const SensorSchema> schema = backend->GetSchema();
+            std::unordered_map<std::string, size_t> positions;
+            for (size_t i = 0; i < schema->sensors.size(); i++) {
+                positions.emplace(schema->sensors[i].id, i);
+            }
+            std::vector<ArrowColumn> columns(ids.size());
+            for (size_t i = 0; i < ids.size(); i++) {
+                columns[i].name = ids[i];
+                columns[i].metadata.emplace_back("SensorId", ids[i]);
+                auto found = positions.find(ids[i]);
+                if (found == positions.end()) continue;
+                const SensorInfo& sensor = schema->sensors[found->second];
+                columns[i].metadata.emplace_back("SensorName", sensor.name);
+                columns[i].metadata.emplace_back("SensorType", sensor.type);
+                if (sensor.hardware >= 0 && (size_t)sensor.hardware < schema->hardware.size()) {
+                    columns[i].metadata.emplace_back("HardwareId", schema->hardware[sensor.hardware].id);
+                    columns[i].metadata.emplace_back("HardwareName", schema->hardware[sensor.hardware].name);
+                }
+            }
+
+            stream = ArrowIpc::WriteStream(window, columns, bytes);
+            if (stream == nullptr) {
+                SetError("Out of memory for the Arrow stream");
+            }
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
+
+        // The stream becomes the ArrayBuffer's backing store; runtimes that
+        // refuse external buffers (Electron's V8 memory cage) get one copy
+        napi_value buffer;
+        napi_status status = napi_create_external_arraybuffer(env, stream, bytes, FreeStream,
+                                                              reinterpret_cast<void*>(bytes), &buffer);
+        if (status == napi_ok) {
+            stream = nullptr;
+            Napi::MemoryManagement::AdjustExternalMemory(env, (int64_t)bytes);
+            deferred.Resolve(Napi::Value(env, buffer));
+            return;
+        }
+        Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, bytes);
+        std::memcpy(copy.Data(), stream, bytes);
+        deferred.Resolve(copy);
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred.Reject(e.Value());
+    }
+
+    Napi::Promise GetPromise() { return deferred.Promise(); }
+
+private:
+    static void FreeStream(napi_env env, void* data, void* hint) {
+        std::free(data);
+        int64_t change = -(int64_t)reinterpret_cast<size_t>(hint);
+        napi_adjust_external_memory(env, change, &change);
+    }
+
+    MonitorBackend* backend;
+    std::shared_ptr<HistoryStore> store;
+    std::vector<std::string> ids;
+    double from;
+    double to;
+    uint8_t* stream = nullptr;
+    size_t bytes = 0;
+    Napi::Promise::Deferred deferred;
+};
+
+// exportArrow(sensorIds, from, to) - arguments validated by the JS wrapper
+Napi::Value ExportArrow(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (data->backend == nullptr) {
+    deferred.Reject(Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").Value());
+    return deferred.Promise();
+  }
+  if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Expected (sensorIds, from, to)").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::shared_ptr<HistoryStore> store = data->backend->GetHistory();
+  if (!store) {
+    deferred.Reject(Napi::Error::New(env, "History is not enabled. Call setHistory() first.").Value());
+    return deferred.Promise();
+  }
+
+  Napi::Array ids = info[0].As<Napi::Array>();
+  std::vector<std::string> sensors;
+  for (uint32_t i = 0; i < ids.Length(); i++) {
+    sensors.push_back(ids.Get(i).ToString().Utf8Value());
+  }
+
+  ExportArrowWorker* worker = new ExportArrowWorker(env, data->backend, std::move(store), std::move(sensors),
+      info[1].As<Napi::Number>().DoubleValue(), info[2].As<Napi::Number>().DoubleValue());
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+// getExtremes(ids) - { min, max } Float32Arrays kept across restarts, NaN for unknown ids
+Napi::Value GetExtremes(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of sensor ids").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array list = info[0].As<Napi::Array>();
+  std::vector<std::string> ids(list.Length());
+  for (uint32_t i = 0; i < list.Length(); i++) {
+    ids[i] = list.Get(i).ToString().Utf8Value();
+  }
+
+  Napi::Float32Array min = Napi::Float32Array::New(env, ids.size());
+  Napi::Float32Array max = Napi::Float32Array::New(env, ids.size());
+  if (!backend->GetExtremes(ids, min.Data(), max.Data())) {
+    Napi::Error::New(env, "No state file attached. Pass stateFile to init().").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("min", min);
+  result.Set("max", max);
+  return result;
+}
+
+// setHistory(config | null) - config { capacity, minIntervalMs } validated by the JS wrapper
+Napi::Value SetHistory(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+    backend->SetHistory(nullptr);
+    return env.Undefined();
+  }
+  if (!info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected history config object or null").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object spec = info[0].As<Napi::Object>();
+  HistoryConfig config;
+  if (spec.Get("capacity").IsNumber()) {
+    config.capacity = spec.Get("capacity").As<Napi::Number>().Uint32Value();
+  }
+  if (spec.Get("minIntervalMs").IsNumber()) {
+    config.minIntervalMs = spec.Get("minIntervalMs").As<Napi::Number>().DoubleValue();
+  }
+  if (config.capacity == 0) {
+    Napi::RangeError::New(env, "History capacity must be at least 1").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  try {
+    backend->SetHistory(&config);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+class HistoryWorker : public Napi::AsyncWorker {
+public:
+    HistoryWorker(Napi::Env env, MonitorBackend* backend, std::shared_ptr<HistoryStore> store,
+                  std::vector<std::string> ids, double from, double to, uint32_t points, HistoryMethod method)
+        : Napi::AsyncWorker(env), backend(backend), store(std::move(store)), ids(std::move(ids)),
+          from(from), to(to), points(points), method(method), deferred(Napi::Promise::Deferred::New(env)) {
+        backend->AddRef();
+    }
+
+    ~HistoryWorker() override {
+        backend->Release();
+    }
+
+    void Execute() override {
+        try {
+            store->Query(ids, from, to, points, method, result);
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
+
+        Napi::Array series = Napi::Array::New(env, result.series.size());
+        for (size_t i = 0; i < result.series.size(); i++) {
+            const HistorySeries& source = result.series[i];
+            Napi::Float64Array timestamps = Napi::Float64Array::New(env, source.timestamps.size());
+            std::copy(source.timestamps.begin(), source.timestamps.end(), timestamps.Data());
+            Napi::Float32Array values = Napi::Float32Array::New(env, source.values.size());
+            std::copy(source.values.begin(), source.values.end(), values.Data());
+
+            Napi::Object entry = Napi::Object::New(env);
+            entry.Set("id", Napi::String::New(env, source.id));
+            entry.Set("known", Napi::Boolean::New(env, source.known));
+            entry.Set("timestamps", timestamps);
+            entry.Set("values", values);
+            series[(uint32_t)i] = entry;
+        }
+
+        Napi::Object output = Napi::Object::New(env);
+        output.Set("rows", Napi::Number::New(env, result.rows));
+        output.Set("series", series);
+        deferred.Resolve(output);
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred.Reject(e.Value());
+    }
+
+    Napi::Promise GetPromise() { return deferred.Promise(); }
+
+private:
+    MonitorBackend* backend;
+    std::shared_ptr<HistoryStore> store;
+    std::vector<std::string> ids;
+    double from;
+    double to;
+    uint32_t points;
+    HistoryMethod method;
+    HistoryResult result;
+    Napi::Promise::Deferred deferred;
+};
+
+// history(sensorIds, from, to, points, method) - arguments validated by the JS wrapper
+Napi::Value History(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (data->backend == nullptr) {
+    deferred.Reject(Napi::Error::New(env, "Hardware monitor not initialized. Call init() first.").Value());
+    return deferred.Promise();
+  }
+  if (info.Length() < 5 || !info[0].IsArray() || !info[1].IsNumber() || !info[2].IsNumber() ||
+      !info[3].IsNumber() || !info[4].IsString()) {
+    Napi::TypeError::New(env, "Expected (sensorIds, from, to, points, method)").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::shared_ptr<HistoryStore> store = data->backend->GetHistory();
+  if (!store) {
+    deferred.Reject(Napi::Error::New(env, "History is not enabled. Call setHistory() first.").Value());
+    return deferred.Promise();
+  }
+
+  Napi::Array ids = info[0].As<Napi::Array>();
+  std::vector<std::string> sensors;
+  for (uint32_t i = 0; i < ids.Length(); i++) {
+    sensors.push_back(ids.Get(i).ToString().Utf8Value());
+  }
+  HistoryMethod method = info[4].As<Napi::String>().Utf8Value() == "minmax"
+      ? HistoryMethod::kMinMax : HistoryMethod::kLttb;
+  uint32_t points = std::max(info[3].As<Napi::Number>().Uint32Value(),
+      method == HistoryMethod::kMinMax ? 2u : 3u);
+
+  HistoryWorker* worker = new HistoryWorker(env, data->backend, std::move(store), std::move(sensors),
+      info[1].As<Napi::Number>().DoubleValue(), info[2].As<Napi::Number>().DoubleValue(), points, method);
+  worker->Queue();
+  return worker->GetPromise();
+}
+
+static Napi::Object GovernorToJs(Napi::Env env, const GovernorStats& stats) {
+  const double intervalMs = stats.tickMs;
+  Napi::Array categories = Napi::Array::New(env, stats.categories.size());
+  for (size_t i = 0; i < stats.categories.size(); i++) {
+    const CategoryRate& rate = stats.categories[i];
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("category", Napi::String::New(env, CategoryName(rate.category)));
+    entry.Set("intervalMs", Napi::Number::New(env, intervalMs * rate.stretch));
+    entry.Set("throttled", Napi::Boolean::New(env, rate.budgetFactor > 1));
+    if (rate.minStretch > 0) {
+      Napi::Object adaptive = Napi::Object::New(env);
+      adaptive.Set("minIntervalMs", Napi::Number::New(env, intervalMs * rate.minStretch));
+      adaptive.Set("maxIntervalMs", Napi::Number::New(env, intervalMs * rate.maxStretch));
+      adaptive.Set("changeRate", Napi::Number::New(env, rate.changeRate));
+      entry.Set("adaptive", adaptive);
+    } else {
+      entry.Set("adaptive", env.Null());
+    }
+    entry.Set("costMs", Napi::Number::New(env, rate.costNs / 1e6));
+    entry.Set("cpuPercent", Napi::Number::New(env, intervalMs > 0 ? rate.costNs / (intervalMs * 1e6 * rate.stretch) * 100.0 : 0));
+    entry.Set("updates", Napi::Number::New(env, (double)rate.updates));
+    categories[i] = entry;
+  }
+
+  Napi::Array decisions = Napi::Array::New(env, stats.decisions.size());
+  for (size_t i = 0; i < stats.decisions.size(); i++) {
+    const GovernorDecision& decision = stats.decisions[i];
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("timestamp", Napi::Number::New(env, decision.timestamp));
+    entry.Set("category", Napi::String::New(env, CategoryName(decision.category)));
+    entry.Set("action", Napi::String::New(env, decision.toStretch > decision.fromStretch ? "throttle" : "relax"));
+    entry.Set("fromIntervalMs", Napi::Number::New(env, intervalMs * decision.fromStretch));
+    entry.Set("toIntervalMs", Napi::Number::New(env, intervalMs * decision.toStretch));
+    entry.Set("usagePercent", Napi::Number::New(env, decision.usagePercent));
+    decisions[i] = entry;
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("running", Napi::Boolean::New(env, stats.running));
+  result.Set("intervalMs", Napi::Number::New(env, stats.intervalMs));
+  result.Set("tickMs", Napi::Number::New(env, intervalMs));
+  result.Set("adaptive", Napi::Boolean::New(env, stats.adaptive));
+  result.Set("changeThreshold", Napi::Number::New(env, stats.changeThreshold));
+  result.Set("cpuBudgetPercent", stats.budgetPercent > 0 ? Napi::Number::New(env, stats.budgetPercent) : env.Null());
+  result.Set("cpuPercent", Napi::Number::New(env, stats.usagePercent));
+  result.Set("budgetUnreachable", Napi::Boolean::New(env, stats.budgetUnreachable));
+  result.Set("categories", categories);
+  result.Set("decisions", decisions);
+
+  // Tick start delays; percentiles are bucket upper bounds
+  const JitterStats& jitter = stats.jitter;
+  int used = JitterStats::kBuckets;
+  while (used > 0 && jitter.counts[used - 1] == 0) used--;
+  Napi::Array histogram = Napi::Array::New(env, used);
+  double percentiles[2] = { NAN, NAN };
+  const double ranks[2] = { 0.5, 0.99 };
+  uint64_t seen = 0;
+  for (int i = 0; i < used; i++) {
+    double upToMs = i < JitterStats::kBuckets - 1 ? (double)(1u << i) / 1000.0 : INFINITY;
+    seen += jitter.counts[i];
+    for (int r = 0; r < 2; r++) {
+      if (std::isnan(percentiles[r]) && seen >= ranks[r] * jitter.ticks) {
+        percentiles[r] = std::min(upToMs, jitter.maxUs / 1000.0);
+      }
+    }
+    Napi::Object bucket = Napi::Object::New(env);
+    bucket.Set("upToMs", Napi::Number::New(env, upToMs));
+    bucket.Set("count", Napi::Number::New(env, (double)jitter.counts[i]));
+    histogram[i] = bucket;
+  }
+  Napi::Object delays = Napi::Object::New(env);
+  delays.Set("ticks", Napi::Number::New(env, (double)jitter.ticks));
+  delays.Set("missedTicks", Napi::Number::New(env, (double)jitter.missedTicks));
+  delays.Set("meanMs", Napi::Number::New(env, jitter.ticks > 0 ? jitter.sumUs / jitter.ticks / 1000.0 : 0));
+  delays.Set("p50Ms", Napi::Number::New(env, jitter.ticks > 0 ? percentiles[0] : 0));
+  delays.Set("p99Ms", Napi::Number::New(env, jitter.ticks > 0 ? percentiles[1] : 0));
+  delays.Set("maxMs", Napi::Number::New(env, jitter.maxUs / 1000.0));
+  delays.Set("histogram", histogram);
+  result.Set("jitter", delays);
+  return result;
+}
+
+Napi::Value GetConfig(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+  return ConfigToJs(env, backend->GetConfig());
+}
+
+Napi::Value GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  BackendStats stats = backend->GetStats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("bridge", Napi::String::New(env, env.GetInstanceData<AddonData>()->bridge));
+  result.Set("polls", Napi::Number::New(env, (double)stats.polls));
+  result.Set("samples", Napi::Number::New(env, (double)stats.samples));
+  Napi::Object cancellation = Napi::Object::New(env);
+  cancellation.Set("aborted", Napi::Number::New(env, (double)stats.pollsAborted));
+  cancellation.Set("timedOut", Napi::Number::New(env, (double)stats.pollsTimedOut));
+  cancellation.Set("dropped", Napi::Number::New(env, (double)stats.pollsDropped));
+  cancellation.Set("abandoned", Napi::Number::New(env, (double)stats.pollsAbandoned));
+  cancellation.Set("truncated", Napi::Number::New(env, (double)stats.pollsTruncated));
+  cancellation.Set("overrunMs", Napi::Number::New(env, (double)stats.pollOverrunUs / 1000.0));
+  result.Set("cancellation", cancellation);
+  Napi::Object pollBuffer = Napi::Object::New(env);
+  pollBuffer.Set("polls", Napi::Number::New(env, (double)stats.pollBuffer.polls));
+  pollBuffer.Set("copies", Napi::Number::New(env, (double)stats.pollBuffer.copies));
+  pollBuffer.Set("copiedBytes", Napi::Number::New(env, (double)stats.pollBuffer.copiedBytes));
+  pollBuffer.Set("allocations", Napi::Number::New(env, (double)stats.pollBuffer.allocations));
+  result.Set("pollBuffer", pollBuffer);
+  result.Set("nativeHeapBytes", stats.nativeHeapBytes >= 0
+    ? Napi::Number::New(env, (double)stats.nativeHeapBytes) : env.Null());
+
+  if (stats.hasManaged) {
+    Napi::Object managed = Napi::Object::New(env);
+    managed.Set("liveBytes", Napi::Number::New(env, (double)stats.managed.liveBytes));
+    managed.Set("heapSizeBytes", Napi::Number::New(env, (double)stats.managed.heapSizeBytes));
+    managed.Set("committedBytes", Napi::Number::New(env, (double)stats.managed.committedBytes));
+    managed.Set("allocatedBytes", Napi::Number::New(env, (double)stats.managed.allocatedBytes));
+    managed.Set("gen0Collections", Napi::Number::New(env, (double)stats.managed.gen0Collections));
+    managed.Set("gen1Collections", Napi::Number::New(env, (double)stats.managed.gen1Collections));
+    managed.Set("gen2Collections", Napi::Number::New(env, (double)stats.managed.gen2Collections));
+    result.Set("managed", managed);
+  } else {
+    result.Set("managed", env.Null());
+  }
+  result.Set("sampler", GovernorToJs(env, backend->GetSampler().GetGovernorStats()));
+
+  StateStats state;
+  if (backend->GetStateStats(state)) {
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("path", Napi::String::New(env, state.path));
+    entry.Set("restored", Napi::Boolean::New(env, state.restored));
+    entry.Set("restoredSavedAt", state.restored ? Napi::Number::New(env, state.restoredSavedAt) : env.Null());
+    entry.Set("restoredSensors", Napi::Number::New(env, state.restoredSensors));
+    entry.Set("restoredRows", Napi::Number::New(env, state.restoredRows));
+    entry.Set("flushes", Napi::Number::New(env, (double)state.flushes));
+    entry.Set("bytes", Napi::Number::New(env, (double)state.bytes));
+    entry.Set("lastFlushMs", Napi::Number::New(env, state.lastFlushMs));
+    entry.Set("error", state.error.empty() ? env.Null() : Napi::String::New(env, state.error));
+    result.Set("state", entry);
+  } else {
+    result.Set("state", env.Null());
+  }
+  return result;
+}
+
+Napi::Value StartSampler(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected interval in milliseconds").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int64_t intervalMs = info[0].As<Napi::Number>().Int64Value();
+  if (intervalMs < 1) {
+    Napi::RangeError::New(env, "Interval must be at least 1 ms").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  backend->GetSampler().Start((uint32_t)intervalMs);
+  return env.Undefined();
+}
+
+Napi::Value StopSampler(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  if (data->backend != nullptr) {
+    data->backend->GetSampler().Stop();
+  }
+  return env.Undefined();
+}
+
+Napi::Value AttachSharedBuffer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsTypedArray() ||
+      info[0].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array) {
+    Napi::TypeError::New(env, "Expected an Int32Array over a SharedArrayBuffer").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Int32Array view = info[0].As<Napi::Int32Array>();
+  for (SharedBufferSink* sink : data->sharedBuffers) {
+    if (sink->Data() == reinterpret_cast<const uint8_t*>(view.Data())) {
+      Napi::Error::New(env, "Buffer already attached").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  try {
+    std::shared_ptr<const SensorSchema> schema = backend->GetSchema();
+
+    SharedBufferSink* sink = SharedBufferSink::Create(env, view);
+    if (sink == nullptr) return env.Undefined();
+    data->sharedBuffers.push_back(sink);
+    backend->AddListener(sink);
+
+    Napi::Object layout = SchemaToJs(env, *schema);
+    layout.Set("headerBytes", Napi::Number::New(env, (double)SharedBufferSink::kHeaderBytes));
+    layout.Set("capacity", Napi::Number::New(env, (double)sink->Capacity()));
+    return layout;
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+}
+
+Napi::Value DetachSharedBuffer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+
+  if (info.Length() < 1 || !info[0].IsTypedArray() ||
+      info[0].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array) {
+    Napi::TypeError::New(env, "Expected an Int32Array over a SharedArrayBuffer").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const uint8_t* target = reinterpret_cast<const uint8_t*>(info[0].As<Napi::Int32Array>().Data());
+  for (auto it = data->sharedBuffers.begin(); it != data->sharedBuffers.end(); ++it) {
+    if ((*it)->Data() == target) {
+      data->backend->RemoveListener(*it);
+      (*it)->Close();
+      data->sharedBuffers.erase(it);
+      return Napi::Boolean::New(env, true);
+    }
+  }
+  return Napi::Boolean::New(env, false);
+}
+
+// onTopology(callback): call callback with a diff for every schema change
+// (see TopologySink); onTopology(null) stops
+Napi::Value OnTopology(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull())) {
+    Napi::TypeError::New(env, "Expected a function or null").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  data->DetachTopology();
+  if (info[0].IsFunction()) {
+    data->topology = TopologySink::Create(env, info[0].As<Napi::Function>());
+    backend->AddListener(data->topology);
+  }
+  return env.Undefined();
+}
+
+Napi::Value Record(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  MonitorBackend* backend = RequireBackend(env);
+  if (backend == nullptr) return env.Undefined();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a file path").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (data->recorder) {
+    Napi::Error::New(env, "Already recording").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string error;
+  std::unique_ptr<TraceWriter> recorder = TraceWriter::Create(info[0].As<Napi::String>().Utf8Value(), error);
+  if (!recorder) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  backend->AddListener(recorder.get());
+  data->recorder = std::move(recorder);
+  return env.Undefined();
+}
+
+Napi::Value StopRecording(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonData* data = env.GetInstanceData<AddonData>();
+  if (!data->recorder) {
+    return env.Null();
+  }
+
+  TraceStats stats = data->StopRecording();
+  if (!stats.error.empty()) {
+    Napi::Error::New(env, "Recording failed: " + stats.error).ThrowAsJavaScriptException();
+    return env.Undefined();
   }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("frames", Napi::Number::New(env, (double)stats.frames));
+  result.Set("schemas", Napi::Number::New(env, (double)stats.schemas));
+  result.Set("bytes", Napi::Number::New(env, (double)stats.bytes));
+  return result;
 }
 
 Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
-  napi_add_env_cleanup_hook(env, AtExit, nullptr);
+  // Deleted (releasing the backend reference) when this environment exits
+  env.SetInstanceData<AddonData>(new AddonData());
   exports.Set("init", Napi::Function::New(env, Init));
   exports.Set("poll", Napi::Function::New(env, Poll));
   exports.Set("shutdown", Napi::Function::New(env, Shutdown));
+  exports.Set("reconfigure", Napi::Function::New(env, Reconfigure));
+  exports.Set("getConfig", Napi::Function::New(env, GetConfig));
+  exports.Set("getSchema", Napi::Function::New(env, GetSchema));
+  exports.Set("setFilter", Napi::Function::New(env, SetFilter));
+  exports.Set("defineSensor", Napi::Function::New(env, DefineSensor));
+  exports.Set("removeSensor", Napi::Function::New(env, RemoveSensor));
+  exports.Set("getDerivedSensors", Napi::Function::New(env, GetDerivedSensors));
+  exports.Set("get", Napi::Function::New(env, Get));
+  exports.Set("getMany", Napi::Function::New(env, GetMany));
+  exports.Set("query", Napi::Function::New(env, Query));
+  exports.Set("setAnomalyDetection", Napi::Function::New(env, SetAnomalyDetection));
+  exports.Set("getAnomalies", Napi::Function::New(env, GetAnomalies));
+  exports.Set("setHistory", Napi::Function::New(env, SetHistory));
+  exports.Set("history", Napi::Function::New(env, History));
+  exports.Set("exportArrow", Napi::Function::New(env, ExportArrow));
+  exports.Set("getExtremes", Napi::Function::New(env, GetExtremes));
+  exports.Set("getStats", Napi::Function::New(env, GetStats));
+  exports.Set("captureBurst", Napi::Function::New(env, CaptureBurst));
+  exports.Set("startSampler", Napi::Function::New(env, StartSampler));
+  exports.Set("stopSampler", Napi::Function::New(env, StopSampler));
+  exports.Set("attachSharedBuffer", Napi::Function::New(env, AttachSharedBuffer));
+  exports.Set("detachSharedBuffer", Napi::Function::New(env, DetachSharedBuffer));
+  exports.Set("onTopology", Napi::Function::New(env, OnTopology));
+  exports.Set("record", Napi::Function::New(env, Record));
+  exports.Set("stopRecording", Napi::Function::New(env, StopRecording));
   return exports;
 }
 
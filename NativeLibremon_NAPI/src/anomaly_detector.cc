@@ -0,0 +1,344 @@
+#include "anomaly_detector.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+// Score below which a raised sensor clears, relative to its threshold
+const double kClearRatio = 0.75;
+
+// Per-sample bookkeeping of one baseline: which sensors seed it (first
+// value) and which are past warmup and get scored. Integer work with
+// branches, kept out of the arithmetic kernel.
+void CountKernel(const double* weight, const uint32_t* warmup, uint32_t* count,
+                 double* first, double* trusted, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		bool participates = weight[i] != 0;
+		first[i] = participates && count[i] == 0 ? 1.0 : 0.0;
+		trusted[i] = participates && count[i] >= warmup[i] ? 1.0 : 0.0;
+		count[i] += participates ? 1 : 0;
+	}
+}
+
+// One EWMA step over n sensors. Scores each input against the baseline it
+// had before, then folds it in. Pure arithmetic: weight 0 leaves a sensor's
+// state (and score) unchanged, inputs are NaN-free, deviations are floored
+// by adding (0.001 + 1% of the mean)^2 to the variance, and scores stay
+// squared. Without compares, selects or calls the loop vectorizes under
+// default floating-point flags.
+void EwmaKernel(const double* __restrict input, const double* __restrict weight,
+                const double* __restrict alpha, const double* __restrict first,
+                const double* __restrict trusted, double* __restrict mean, double* __restrict var,
+                double* __restrict squaredScore, double* __restrict previousMean, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		double w = weight[i];
+		double m = mean[i];
+		double d = w * (input[i] - m);
+		double floor = 0.001 + 0.01 * std::fabs(m);
+		double z2 = d * d / (var[i] + floor * floor);
+		// The first value seeds the mean
+		double rate = alpha[i] + (1.0 - alpha[i]) * first[i];
+		double increment = w * rate * d;
+		mean[i] = m + increment;
+		var[i] = (1.0 - w * rate) * (var[i] + d * increment);
+		squaredScore[i] += trusted[i] * z2 - w * squaredScore[i];
+		previousMean[i] = m;
+	}
+}
+
+} // namespace
+
+const AnomalyRule& AnomalyConfig::RuleFor(const std::string& type) const {
+	for (const auto& entry : types) {
+		if (entry.first == type) {
+			return entry.second;
+		}
+	}
+	return defaults;
+}
+
+void AnomalyDetector::Configure(const AnomalyConfig& config) {
+	size_t slots = config.seasonal ? config.seasonSlots : 0;
+	size_t oldSlots = m_config.seasonal ? m_config.seasonSlots : 0;
+	if (!m_enabled || slots != oldSlots || config.seasonPeriodMs != m_config.seasonPeriodMs) {
+		m_season = Baseline();
+	}
+	m_config = config;
+	m_enabled = true;
+}
+
+void AnomalyDetector::Disable() {
+	m_enabled = false;
+	m_config = AnomalyConfig();
+	m_schema.reset();
+	m_sensorMasks.clear();
+	m_ewma = Baseline();
+	m_season = Baseline();
+	m_raisedCount = 0;
+
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+	m_events.clear();
+	m_active.clear();
+}
+
+void AnomalyDetector::Bind(const std::shared_ptr<const SensorSchema>& schema, const std::vector<uint32_t>& sensorMasks) {
+	size_t n = schema->sensors.size();
+	size_t slots = m_config.seasonal ? m_config.seasonSlots : 0;
+
+	// Where each sensor's state was in the previous layout
+	size_t oldCount = m_schema ? m_schema->sensors.size() : 0;
+	std::vector<int> from(n, -1);
+	if (m_schema && m_ewma.mean.size() == oldCount) {
+		std::unordered_map<std::string, int> previous;
+		previous.reserve(oldCount);
+		for (size_t j = 0; j < oldCount; j++) {
+			previous.emplace(m_schema->sensors[j].id, (int)j);
+		}
+		for (size_t i = 0; i < n; i++) {
+			auto it = previous.find(schema->sensors[i].id);
+			if (it != previous.end()) {
+				from[i] = it->second;
+			}
+		}
+	}
+	bool keepSeason = slots > 0 && m_season.mean.size() == oldCount * slots;
+
+	Baseline ewma;
+	ewma.mean.assign(n, 0);
+	ewma.var.assign(n, 0);
+	ewma.count.assign(n, 0);
+	Baseline season;
+	season.mean.assign(n * slots, 0);
+	season.var.assign(n * slots, 0);
+	season.count.assign(n * slots, 0);
+	std::vector<uint8_t> raised(n, 0);
+	std::vector<double> peak(n, 0);
+	std::vector<double> score(n, 0);
+	std::vector<double> seasonalScore(n, 0);
+	std::vector<double> previousMean(n, 0);
+
+	m_raisedCount = 0;
+	for (size_t i = 0; i < n; i++) {
+		int j = from[i];
+		if (j < 0) {
+			continue;
+		}
+		ewma.mean[i] = m_ewma.mean[j];
+		ewma.var[i] = m_ewma.var[j];
+		ewma.count[i] = m_ewma.count[j];
+		raised[i] = m_raised[j];
+		peak[i] = m_peak[j];
+		score[i] = m_score[j];
+		seasonalScore[i] = m_seasonalScore[j];
+		previousMean[i] = m_previousMean[j];
+		m_raisedCount += raised[i];
+		if (keepSeason) {
+			for (size_t slot = 0; slot < slots; slot++) {
+				season.mean[slot * n + i] = m_season.mean[slot * oldCount + j];
+				season.var[slot * n + i] = m_season.var[slot * oldCount + j];
+				season.count[slot * n + i] = m_season.count[slot * oldCount + j];
+			}
+		}
+	}
+
+	m_schema = schema;
+	m_sensorMasks = sensorMasks;
+	m_sensorMasks.resize(n, 0);
+	m_ewma = std::move(ewma);
+	m_season = std::move(season);
+	m_raised = std::move(raised);
+	m_peak = std::move(peak);
+	m_score = std::move(score);
+	m_seasonalScore = std::move(seasonalScore);
+	m_previousMean = std::move(previousMean);
+	m_weight.assign(n, 0);
+	m_input.assign(n, 0);
+	m_first.assign(n, 0);
+	m_trusted.assign(n, 0);
+	m_seasonMean.assign(n, 0);
+	ApplyRules();
+
+	// Anomalies of sensors that went away are dropped without an event
+	std::unordered_set<std::string> raisedIds;
+	for (size_t i = 0; i < n; i++) {
+		if (m_raised[i]) {
+			raisedIds.insert(schema->sensors[i].id);
+		}
+	}
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+	m_active.erase(std::remove_if(m_active.begin(), m_active.end(), [&](const AnomalyEvent& event) {
+		return raisedIds.count(event.sensorId) == 0;
+	}), m_active.end());
+}
+
+void AnomalyDetector::ApplyRules() {
+	size_t n = m_schema->sensors.size();
+	m_alpha.resize(n);
+	m_threshold.resize(n);
+	m_warmup.resize(n);
+	m_ruleEnabled.resize(n);
+	m_seasonAlpha.assign(n, m_config.seasonAlpha);
+
+	// Rules are per type; resolve each distinct type once
+	const std::string* lastType = nullptr;
+	const AnomalyRule* rule = &m_config.defaults;
+	for (size_t i = 0; i < n; i++) {
+		const std::string& type = m_schema->sensors[i].type;
+		if (lastType == nullptr || *lastType != type) {
+			rule = &m_config.RuleFor(type);
+			lastType = &type;
+		}
+		m_alpha[i] = rule->alpha;
+		m_threshold[i] = rule->threshold;
+		m_warmup[i] = std::max<uint32_t>(rule->warmup, 1);
+		m_ruleEnabled[i] = rule->enabled ? 1 : 0;
+	}
+}
+
+void AnomalyDetector::Update(const float* values, size_t count, uint32_t updatedMask, double timestamp) {
+	if (!m_enabled || !m_schema || count != m_schema->sensors.size()) {
+		return;
+	}
+	size_t n = count;
+
+	for (size_t i = 0; i < n; i++) {
+		bool participates = (m_sensorMasks[i] & updatedMask) != 0 && !std::isnan(values[i]) && m_ruleEnabled[i] != 0;
+		m_weight[i] = participates ? 1.0 : 0.0;
+		m_input[i] = participates ? values[i] : 0.0;
+	}
+
+	CountKernel(m_weight.data(), m_warmup.data(), m_ewma.count.data(), m_first.data(), m_trusted.data(), n);
+	EwmaKernel(m_input.data(), m_weight.data(), m_alpha.data(), m_first.data(), m_trusted.data(),
+	           m_ewma.mean.data(), m_ewma.var.data(), m_score.data(), m_previousMean.data(), n);
+
+	if (m_config.seasonal && m_config.seasonSlots > 0 && m_season.mean.size() == n * m_config.seasonSlots) {
+		double phase = std::fmod(timestamp, m_config.seasonPeriodMs) / m_config.seasonPeriodMs;
+		size_t slot = std::min((size_t)(phase * m_config.seasonSlots), (size_t)m_config.seasonSlots - 1);
+		size_t offset = slot * n;
+		CountKernel(m_weight.data(), m_warmup.data(), m_season.count.data() + offset,
+		            m_first.data(), m_trusted.data(), n);
+		EwmaKernel(m_input.data(), m_weight.data(), m_seasonAlpha.data(), m_first.data(), m_trusted.data(),
+		           m_season.mean.data() + offset, m_season.var.data() + offset,
+		           m_seasonalScore.data(), m_seasonMean.data(), n);
+	}
+
+	// Threshold crossings are rare; a scalar pass finds them
+	std::vector<AnomalyEvent> events;
+	bool refreshActive = m_raisedCount > 0;
+	for (size_t i = 0; i < n; i++) {
+		if (m_weight[i] == 0) {
+			continue;
+		}
+		double score = std::sqrt(std::max(m_score[i], m_config.seasonal ? m_seasonalScore[i] : 0.0));
+		if (!m_raised[i]) {
+			if (score >= m_threshold[i]) {
+				m_raised[i] = 1;
+				m_peak[i] = score;
+				m_raisedCount++;
+				events.push_back(MakeEvent(i, true, values[i], timestamp));
+				refreshActive = true;
+			}
+		} else {
+			m_peak[i] = std::max(m_peak[i], score);
+			if (score < m_threshold[i] * kClearRatio) {
+				m_raised[i] = 0;
+				m_raisedCount--;
+				events.push_back(MakeEvent(i, false, values[i], timestamp));
+			}
+		}
+	}
+
+	if (events.empty() && !refreshActive) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+	for (AnomalyEvent& event : events) {
+		event.sequence = ++m_sequence;
+		m_events.push_back(std::move(event));
+	}
+	while (m_events.size() > kMaxEvents) {
+		m_events.pop_front();
+	}
+	m_active.clear();
+	for (size_t i = 0; i < n && m_active.size() < m_raisedCount; i++) {
+		if (m_raised[i]) {
+			m_active.push_back(MakeEvent(i, true, values[i], timestamp));
+		}
+	}
+}
+
+AnomalyEvent AnomalyDetector::MakeEvent(size_t sensor, bool raised, float value, double timestamp) const {
+	const SensorInfo& info = m_schema->sensors[sensor];
+	AnomalyEvent event;
+	event.timestamp = timestamp;
+	event.raised = raised;
+	event.sensorId = info.id;
+	event.name = info.name;
+	event.type = info.type;
+	event.value = value;
+	event.mean = m_previousMean[sensor];
+	event.score = std::sqrt(m_score[sensor]);
+	event.seasonalScore = m_config.seasonal ? std::sqrt(m_seasonalScore[sensor]) : 0.0;
+	event.peakScore = m_peak[sensor];
+	return event;
+}
+
+void AnomalyDetector::ExportBaselines(const std::unordered_map<std::string, size_t>& slots,
+                                      double* mean, double* var, uint32_t* count) const {
+	if (!m_schema || m_ewma.mean.size() != m_schema->sensors.size()) {
+		return;
+	}
+	for (size_t i = 0; i < m_schema->sensors.size(); i++) {
+		auto it = slots.find(m_schema->sensors[i].id);
+		if (it == slots.end() || m_ewma.count[i] == 0) {
+			continue;
+		}
+		mean[it->second] = m_ewma.mean[i];
+		var[it->second] = m_ewma.var[i];
+		count[it->second] = m_ewma.count[i];
+	}
+}
+
+size_t AnomalyDetector::RestoreBaselines(const std::vector<std::string>& ids, const double* mean,
+                                         const double* var, const uint32_t* count) {
+	if (!m_schema || m_ewma.mean.size() != m_schema->sensors.size()) {
+		return 0;
+	}
+	std::unordered_map<std::string, size_t> persisted;
+	persisted.reserve(ids.size());
+	for (size_t j = 0; j < ids.size(); j++) {
+		if (count[j] > 0) {
+			persisted.emplace(ids[j], j);
+		}
+	}
+	size_t seeded = 0;
+	for (size_t i = 0; i < m_schema->sensors.size(); i++) {
+		auto it = persisted.find(m_schema->sensors[i].id);
+		if (it == persisted.end() || m_ewma.count[i] != 0) {
+			continue;
+		}
+		m_ewma.mean[i] = mean[it->second];
+		m_ewma.var[i] = var[it->second];
+		m_ewma.count[i] = count[it->second];
+		m_previousMean[i] = mean[it->second];
+		seeded++;
+	}
+	return seeded;
+}
+
+AnomalyReport AnomalyDetector::GetReport(uint64_t sinceSequence) {
+	AnomalyReport report;
+	report.enabled = m_enabled;
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+	report.sequence = m_sequence;
+	report.active = m_active;
+	for (const AnomalyEvent& event : m_events) {
+		if (event.sequence > sinceSequence) {
+			report.events.push_back(event);
+		}
+	}
+	return report;
+}
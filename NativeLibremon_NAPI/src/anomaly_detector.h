@@ -0,0 +1,174 @@
+#pragma once
+
+#include "sensor_schema.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Detection settings of one sensor type
+ */
+struct AnomalyRule {
+    bool enabled = true;
+    double alpha = 0.05;      // EWMA weight of each new value
+    double threshold = 4;     // Score (deviations from the baseline) that raises an anomaly
+    uint32_t warmup = 30;     // Updates before a baseline is trusted
+};
+
+/**
+ * Anomaly detection configuration (process-wide)
+ */
+struct AnomalyConfig {
+    AnomalyRule defaults;
+    std::vector<std::pair<std::string, AnomalyRule>> types;  // Per SensorType name
+
+    // Seasonal baseline: one EWMA mean/variance per slot of a repeating period
+    bool seasonal = false;
+    double seasonPeriodMs = 24 * 3600 * 1000.0;
+    uint32_t seasonSlots = 24;
+    double seasonAlpha = 0.05;
+
+    const AnomalyRule& RuleFor(const std::string& type) const;
+};
+
+/**
+ * One raised or cleared anomaly
+ */
+struct AnomalyEvent {
+    uint64_t sequence = 0;
+    double timestamp = 0;      // ms since Unix epoch
+    bool raised = true;        // false: the sensor returned to its baseline
+    std::string sensorId;
+    std::string name;
+    std::string type;
+    float value = 0;
+    double mean = 0;           // EWMA baseline before the value
+    double score = 0;          // |value - mean| in EWMA deviations
+    double seasonalScore = 0;  // Same against the current seasonal slot, 0 without one
+    double peakScore = 0;      // Largest score while raised (cleared events)
+};
+
+/**
+ * Snapshot for getAnomalies()
+ */
+struct AnomalyReport {
+    bool enabled = false;
+    uint64_t sequence = 0;              // Of the newest event
+    std::vector<AnomalyEvent> active;   // Raised and not cleared yet, latest values
+    std::vector<AnomalyEvent> events;   // Newer than the requested sequence, oldest first
+};
+
+/**
+ * Anomaly Detector - streaming per-sensor baselines over the value vector
+ *
+ * Keeps an exponentially weighted mean and variance per sensor (and per
+ * seasonal slot, if enabled) in flat arrays that are updated by branch-free
+ * arithmetic loops over the whole value vector, which the compiler vectorizes.
+ * Only sensors whose category was updated take part in a sample; NaN values
+ * are skipped. A sensor is raised once either score reaches its type's
+ * threshold and cleared when both fall below three quarters of it.
+ *
+ * Deviations are floored around 1% of the mean (plus 0.001), so a sensor
+ * that has been perfectly flat does not alarm on the smallest twitch.
+ */
+class AnomalyDetector {
+public:
+    static const size_t kMaxEvents = 256;
+
+    /**
+     * Replace the configuration
+     * Baselines are kept; seasonal ones only if the slot count is unchanged.
+     */
+    void Configure(const AnomalyConfig& config);
+
+    /**
+     * Stop detecting and drop all state
+     */
+    void Disable();
+
+    bool Enabled() const { return m_enabled.load(); }
+
+    /**
+     * Adopt a new sensor layout; baselines carry over by sensor id
+     * @param sensorMasks - per sensor category bits (derived sensors included)
+     */
+    void Bind(const std::shared_ptr<const SensorSchema>& schema, const std::vector<uint32_t>& sensorMasks);
+
+    /**
+     * Feed one value vector laid out by the bound schema
+     * @param updatedMask - categories updated for this sample
+     * @param timestamp - ms since Unix epoch
+     */
+    void Update(const float* values, size_t count, uint32_t updatedMask, double timestamp);
+
+    /**
+     * Copy the EWMA baselines of the bound sensors into per-id arrays
+     * Must not race Update. Sensors without a slot are skipped.
+     * @param slots - sensor id -> index into mean, var and count
+     */
+    void ExportBaselines(const std::unordered_map<std::string, size_t>& slots,
+                         double* mean, double* var, uint32_t* count) const;
+
+    /**
+     * Seed bound sensors that have no baseline yet (restart)
+     * Must not race Update.
+     * @returns number of sensors seeded
+     */
+    size_t RestoreBaselines(const std::vector<std::string>& ids, const double* mean,
+                            const double* var, const uint32_t* count);
+
+    /**
+     * Active anomalies and the events after a sequence number
+     * Safe to call while Update runs on another thread.
+     */
+    AnomalyReport GetReport(uint64_t sinceSequence);
+
+private:
+    struct Baseline {
+        std::vector<double> mean;
+        std::vector<double> var;
+        std::vector<uint32_t> count;
+    };
+
+    void ApplyRules();
+    AnomalyEvent MakeEvent(size_t sensor, bool raised, float value, double timestamp) const;
+
+    std::atomic<bool> m_enabled{false};
+    AnomalyConfig m_config;
+    std::shared_ptr<const SensorSchema> m_schema;
+    std::vector<uint32_t> m_sensorMasks;
+
+    // Per sensor, expanded from the type rules
+    std::vector<double> m_alpha;
+    std::vector<double> m_threshold;
+    std::vector<uint32_t> m_warmup;
+    std::vector<uint8_t> m_ruleEnabled;
+    std::vector<double> m_seasonAlpha;
+
+    // Per sensor state
+    Baseline m_ewma;
+    Baseline m_season;                 // seasonSlots x sensors, slot-major
+    std::vector<double> m_weight;      // 1 if the sensor takes part in the sample
+    std::vector<double> m_input;       // Its value, 0 if it does not
+    std::vector<double> m_first;       // Kernel scratch (see CountKernel)
+    std::vector<double> m_trusted;
+    std::vector<double> m_score;          // Squared
+    std::vector<double> m_seasonalScore;  // Squared
+    std::vector<double> m_previousMean;
+    std::vector<double> m_seasonMean;     // Seasonal slot mean before the value
+    std::vector<uint8_t> m_raised;
+    std::vector<double> m_peak;
+    size_t m_raisedCount = 0;
+
+    // Report (guarded by m_reportMutex; the rest belongs to the updating thread)
+    std::mutex m_reportMutex;
+    std::deque<AnomalyEvent> m_events;
+    std::vector<AnomalyEvent> m_active;
+    uint64_t m_sequence = 0;
+};
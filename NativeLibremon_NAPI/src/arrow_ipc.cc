@@ -0,0 +1,316 @@
+#include "arrow_ipc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+// Arrow format constants (Schema.fbs, Message.fbs)
+const int16_t kMetadataV5 = 4;
+const uint8_t kHeaderSchema = 1;
+const uint8_t kHeaderRecordBatch = 3;
+const uint8_t kTypeFloatingPoint = 3;
+const uint8_t kTypeTimestamp = 10;
+const int16_t kPrecisionSingle = 1;
+const int16_t kUnitMicrosecond = 2;
+const uint32_t kContinuation = 0xFFFFFFFF;
+
+size_t Padded(size_t bytes) {
+	return (bytes + 7) & ~(size_t)7;
+}
+
+// Minimal flatbuffer serializer. Objects are written front to back, each
+// table before what it references, so every uoffset points forward.
+class FlatBuffer {
+public:
+	using Writer = std::function<size_t(FlatBuffer&)>;
+
+	std::vector<uint8_t> data;
+
+	// Pad so that the next write at size() + extra is aligned
+	size_t Align(size_t alignment, size_t extra = 0) {
+		while ((data.size() + extra) % alignment != 0) {
+			data.push_back(0);
+		}
+		return data.size();
+	}
+
+	size_t Reserve(size_t bytes) {
+		size_t position = data.size();
+		data.resize(position + bytes, 0);
+		return position;
+	}
+
+	template <typename T>
+	void Put(size_t position, T value) {
+		std::memcpy(data.data() + position, &value, sizeof(T));
+	}
+
+	void PutOffset(size_t position, size_t target) {
+		Put<uint32_t>(position, (uint32_t)(target - position));
+	}
+
+	size_t String(const std::string& text) {
+		size_t position = Align(4);
+		Reserve(4 + text.size() + 1);
+		Put<uint32_t>(position, (uint32_t)text.size());
+		std::memcpy(data.data() + position + 4, text.data(), text.size());
+		return position;
+	}
+
+	size_t Tables(const std::vector<Writer>& tables) {
+		size_t position = Align(4);
+		Reserve(4 + 4 * tables.size());
+		Put<uint32_t>(position, (uint32_t)tables.size());
+		for (size_t i = 0; i < tables.size(); i++) {
+			size_t table = tables[i](*this);
+			PutOffset(position + 4 + 4 * i, table);
+		}
+		return position;
+	}
+
+	// Vector of 8-byte aligned structs given as raw bytes
+	size_t Structs(const void* bytes, size_t count, size_t structBytes) {
+		size_t position = Align(8, 4);
+		Reserve(4 + count * structBytes);
+		Put<uint32_t>(position, (uint32_t)count);
+		std::memcpy(data.data() + position + 4, bytes, count * structBytes);
+		return position;
+	}
+};
+
+// One flatbuffer table: scalar fields written inline, offset fields after it
+class Table {
+public:
+	template <typename T>
+	Table& Scalar(uint16_t id, T value) {
+		Field field;
+		field.id = id;
+		field.size = sizeof(T);
+		std::memcpy(field.bytes, &value, sizeof(T));
+		m_fields.push_back(field);
+		return *this;
+	}
+
+	Table& Offset(uint16_t id, FlatBuffer::Writer child) {
+		Field field;
+		field.id = id;
+		field.size = 4;
+		field.child = std::move(child);
+		m_fields.push_back(std::move(field));
+		return *this;
+	}
+
+	Table& String(uint16_t id, std::string text) {
+		return Offset(id, [text](FlatBuffer& fb) { return fb.String(text); });
+	}
+
+	size_t Write(FlatBuffer& fb) {
+		uint16_t slots = 0;
+		for (const Field& field : m_fields) {
+			slots = std::max<uint16_t>(slots, field.id + 1);
+		}
+		// Largest fields first keeps the padding small
+		std::stable_sort(m_fields.begin(), m_fields.end(),
+			[](const Field& a, const Field& b) { return a.size > b.size; });
+
+		size_t vtable = fb.Align(2);
+		fb.Reserve(4 + 2 * slots);
+		size_t table = fb.Align(4);
+		fb.Reserve(4);
+		std::vector<size_t> positions(m_fields.size());
+		for (size_t i = 0; i < m_fields.size(); i++) {
+			positions[i] = fb.Align(m_fields[i].size);
+			fb.Reserve(m_fields[i].size);
+			std::memcpy(fb.data.data() + positions[i], m_fields[i].bytes, m_fields[i].size);
+		}
+
+		fb.Put<uint16_t>(vtable, (uint16_t)(4 + 2 * slots));
+		fb.Put<uint16_t>(vtable + 2, (uint16_t)(fb.data.size() - table));
+		for (size_t i = 0; i < m_fields.size(); i++) {
+			fb.Put<uint16_t>(vtable + 4 + 2 * m_fields[i].id, (uint16_t)(positions[i] - table));
+		}
+		fb.Put<int32_t>(table, (int32_t)(table - vtable));
+
+		for (size_t i = 0; i < m_fields.size(); i++) {
+			if (m_fields[i].child) {
+				fb.PutOffset(positions[i], m_fields[i].child(fb));
+			}
+		}
+		return table;
+	}
+
+private:
+	struct Field {
+		uint16_t id = 0;
+		size_t size = 0;
+		uint8_t bytes[8] = {};
+		FlatBuffer::Writer child;
+	};
+	std::vector<Field> m_fields;
+};
+
+struct FieldNode {
+	int64_t length;
+	int64_t nullCount;
+};
+
+struct BufferSpec {
+	int64_t offset;
+	int64_t length;
+};
+
+// Message flatbuffer, padded so the body that follows starts 8-byte aligned
+std::vector<uint8_t> Message(uint8_t headerType, FlatBuffer::Writer header, int64_t bodyLength) {
+	FlatBuffer fb;
+	fb.Reserve(4);
+	size_t root = Table()
+		.Scalar<int64_t>(3, bodyLength)
+		.Scalar<int16_t>(0, kMetadataV5)
+		.Scalar<uint8_t>(1, headerType)
+		.Offset(2, std::move(header))
+		.Write(fb);
+	fb.PutOffset(0, root);
+	// Continuation marker and length come first
+	fb.data.resize(Padded(8 + fb.data.size()) - 8, 0);
+	return std::move(fb.data);
+}
+
+FlatBuffer::Writer KeyValues(const std::vector<std::pair<std::string, std::string>>& entries) {
+	return [entries](FlatBuffer& fb) {
+		std::vector<FlatBuffer::Writer> tables;
+		for (const auto& entry : entries) {
+			tables.push_back([entry](FlatBuffer& inner) {
+				return Table().String(0, entry.first).String(1, entry.second).Write(inner);
+			});
+		}
+		return fb.Tables(tables);
+	};
+}
+
+FlatBuffer::Writer EmptyTables() {
+	return [](FlatBuffer& fb) { return fb.Tables({}); };
+}
+
+std::vector<uint8_t> SchemaMessage(const std::vector<ArrowColumn>& columns) {
+	std::vector<FlatBuffer::Writer> fields;
+	fields.push_back([](FlatBuffer& fb) {
+		return Table()
+			.String(0, "timestamp")
+			.Scalar<uint8_t>(1, 0)
+			.Scalar<uint8_t>(2, kTypeTimestamp)
+			.Offset(3, [](FlatBuffer& inner) {
+				return Table().Scalar<int16_t>(0, kUnitMicrosecond).String(1, "UTC").Write(inner);
+			})
+			.Offset(5, EmptyTables())
+			.Write(fb);
+	});
+	for (const ArrowColumn& column : columns) {
+		fields.push_back([&column](FlatBuffer& fb) {
+			return Table()
+				.String(0, column.name)
+				.Scalar<uint8_t>(1, 1)
+				.Scalar<uint8_t>(2, kTypeFloatingPoint)
+				.Offset(3, [](FlatBuffer& inner) {
+					return Table().Scalar<int16_t>(0, kPrecisionSingle).Write(inner);
+				})
+				.Offset(5, EmptyTables())
+				.Offset(6, KeyValues(column.metadata))
+				.Write(fb);
+		});
+	}
+	return Message(kHeaderSchema, [&fields](FlatBuffer& fb) {
+		return Table().Offset(1, [&fields](FlatBuffer& inner) { return inner.Tables(fields); }).Write(fb);
+	}, 0);
+}
+
+// Body layout of the record batch: timestamps, then validity and values per column
+struct BatchLayout {
+	std::vector<FieldNode> nodes;
+	std::vector<BufferSpec> buffers;
+	size_t bodyBytes = 0;
+};
+
+BatchLayout Layout(const HistoryWindow& window, size_t columns) {
+	int64_t rows = (int64_t)window.times.size();
+	BatchLayout layout;
+	auto add = [&layout](size_t bytes) {
+		layout.buffers.push_back({ (int64_t)layout.bodyBytes, (int64_t)bytes });
+		layout.bodyBytes += Padded(bytes);
+	};
+	layout.nodes.push_back({ rows, 0 });
+	add(0);                                  // No validity: never null
+	add(rows * sizeof(int64_t));
+	for (size_t c = 0; c < columns; c++) {
+		const float* values = window.values.data() + c * rows;
+		int64_t nulls = 0;
+		for (int64_t r = 0; r < rows; r++) {
+			nulls += std::isnan(values[r]) ? 1 : 0;
+		}
+		layout.nodes.push_back({ rows, nulls });
+		add(nulls > 0 ? (size_t)(rows + 7) / 8 : 0);
+		add(rows * sizeof(float));
+	}
+	return layout;
+}
+
+std::vector<uint8_t> BatchMessage(const BatchLayout& layout, int64_t rows) {
+	return Message(kHeaderRecordBatch, [&layout, rows](FlatBuffer& fb) {
+		return Table()
+			.Scalar<int64_t>(0, rows)
+			.Offset(1, [&layout](FlatBuffer& inner) {
+				return inner.Structs(layout.nodes.data(), layout.nodes.size(), sizeof(FieldNode));
+			})
+			.Offset(2, [&layout](FlatBuffer& inner) {
+				return inner.Structs(layout.buffers.data(), layout.buffers.size(), sizeof(BufferSpec));
+			})
+			.Write(fb);
+	}, (int64_t)layout.bodyBytes);
+}
+
+uint8_t* PutFrame(uint8_t* out, const std::vector<uint8_t>& metadata) {
+	uint32_t head[2] = { kContinuation, (uint32_t)metadata.size() };
+	std::memcpy(out, head, sizeof(head));
+	std::memcpy(out + 8, metadata.data(), metadata.size());
+	return out + 8 + metadata.size();
+}
+
+} // namespace
+
+uint8_t* ArrowIpc::WriteStream(const HistoryWindow& window, const std::vector<ArrowColumn>& columns, size_t& bytes) {
+	size_t rows = window.times.size();
+	BatchLayout layout = Layout(window, columns.size());
+	std::vector<uint8_t> schema = SchemaMessage(columns);
+	std::vector<uint8_t> batch = BatchMessage(layout, (int64_t)rows);
+	bytes = 8 + schema.size() + 8 + batch.size() + layout.bodyBytes + 8;
+	uint8_t* stream = static_cast<uint8_t*>(std::malloc(bytes));
+	if (stream == nullptr) {
+		return nullptr;
+	}
+
+	uint8_t* body = PutFrame(PutFrame(stream, schema), batch);
+	std::memset(body, 0, layout.bodyBytes);
+	int64_t* times = reinterpret_cast<int64_t*>(body + layout.buffers[1].offset);
+	for (size_t r = 0; r < rows; r++) {
+		times[r] = (int64_t)std::llround(window.times[r] * 1000.0);
+	}
+	for (size_t c = 0; c < columns.size(); c++) {
+		const float* values = window.values.data() + c * rows;
+		const BufferSpec& validity = layout.buffers[2 + 2 * c];
+		const BufferSpec& data = layout.buffers[3 + 2 * c];
+		std::memcpy(body + data.offset, values, rows * sizeof(float));
+		if (validity.length > 0) {
+			uint8_t* bits = body + validity.offset;
+			for (size_t r = 0; r < rows; r++) {
+				bits[r >> 3] |= (uint8_t)(std::isnan(values[r]) ? 0 : 1u << (r & 7));
+			}
+		}
+	}
+
+	// End of stream
+	uint32_t end[2] = { kContinuation, 0 };
+	std::memcpy(body + layout.bodyBytes, end, sizeof(end));
+	return stream;
+}
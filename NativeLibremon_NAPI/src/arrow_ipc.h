@@ -0,0 +1,37 @@
+#pragma once
+
+#include "history_store.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * One float column of an Arrow export
+ */
+struct ArrowColumn {
+    std::string name;
+    // Field metadata (SensorId first)
+    std::vector<std::pair<std::string, std::string>> metadata;
+};
+
+/**
+ * Arrow IPC stream writer for history windows
+ *
+ * Writes the encapsulated stream format (a Schema message, one RecordBatch
+ * message, the end-of-stream marker) that pyarrow.ipc.open_stream, Polars'
+ * read_ipc_stream and DuckDB's arrow scanner read. The schema is a
+ * non-nullable `timestamp` column (Timestamp, microseconds, UTC) followed by
+ * one nullable float32 column per sensor; NaN values are written as nulls.
+ * Message metadata is encoded with a small flatbuffer serializer, so the
+ * addon needs no Arrow or flatbuffers library.
+ */
+namespace ArrowIpc {
+    /**
+     * Build the stream of a window
+     * @param columns - one per id of the window, in the same order
+     * @param bytes - receives the stream length
+     * @returns buffer allocated with std::malloc (the caller frees it), nullptr if out of memory
+     */
+    uint8_t* WriteStream(const HistoryWindow& window, const std::vector<ArrowColumn>& columns, size_t& bytes);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Bridge API - function table HardwareMonitor calls into
+ * Filled from the managed LibreHardwareMonitorBridge on Windows, or supplied
+ * directly by an in-process backend (synthetic or recorded data) so the
+ * native pipeline can run without the CLR, e.g. in benchmarks on Linux.
+ * Strings returned by poll and getSchema are released with freeString.
+ */
+struct BridgeApi {
+    int (*initialize)(bool cpu, bool gpu, bool motherboard, bool memory,
+                      bool storage, bool network, bool psu, bool controller, bool battery,
+                      bool dimmDetection, bool physicalNetworkOnly) = nullptr;
+    void* (*poll)() = nullptr;
+    void (*freeString)(void* ptr) = nullptr;
+    void (*shutdown)() = nullptr;
+    void* (*getSchema)() = nullptr;
+    int (*getSchemaGeneration)() = nullptr;
+    int (*update)(int categoryMask) = nullptr;
+    int (*readValues)(float* values, float* mins, float* maxs, int capacity) = nullptr;
+    int (*setFilter)(const char* filterJson) = nullptr;
+    int (*getMemoryStats)(int64_t* stats, int capacity) = nullptr;  // Optional
+    int (*updateHardware)(const int32_t* indices, int count) = nullptr;  // Optional
+    int (*readSensorValues)(const int32_t* indices, float* values, int count) = nullptr;  // Optional
+    int (*reconfigure)(bool cpu, bool gpu, bool motherboard, bool memory,
+                       bool storage, bool network, bool psu, bool controller, bool battery,
+                       bool dimmDetection, bool physicalNetworkOnly) = nullptr;  // Optional
+    // Optional: poll, but stop updating hardware once budgetMs have passed;
+    // skippedHardware receives how many were left at their previous values
+    void* (*pollWithin)(int budgetMs, int* skippedHardware) = nullptr;
+    // Optional: poll into a caller-owned buffer (budgetMs < 0: no deadline), leaving
+    // the hardware of filterPresets (FilterPreset bits) out of this tree only;
+    // returns the JSON length (NUL-terminated), 0 on failure, or -(bytes needed)
+    // if capacity is too small, in which case the next call returns the same poll
+    int (*pollInto)(char* buffer, int capacity, int budgetMs, int filterPresets, int* skippedHardware) = nullptr;
+};
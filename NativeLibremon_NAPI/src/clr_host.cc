@@ -1,3 +1,6 @@
+// The CLR host is Windows-only; other platforms build with an in-process BridgeApi
+#ifdef _WIN32
+
 #include "clr_host.h"
 #include <nethost.h>
 #include <coreclr_delegates.h>
@@ -220,3 +223,5 @@ bool CLRHost::LoadAssemblyAndGetFunctionPointer(
     
 	return rc == 0;
 }
+
+#endif // _WIN32
@@ -0,0 +1,616 @@
+#include "derived_sensors.h"
+#include "sensor_format.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Glob over sensor ids: '*' and '?' stay within a path segment, '**' crosses them
+bool MatchGlob(const char* pattern, const char* text) {
+	while (*pattern != '\0') {
+		if (pattern[0] == '*' && pattern[1] == '*') {
+			pattern += 2;
+			for (const char* t = text;; t++) {
+				if (MatchGlob(pattern, t)) return true;
+				if (*t == '\0') return false;
+			}
+		}
+		if (*pattern == '*') {
+			pattern++;
+			for (const char* t = text;; t++) {
+				if (MatchGlob(pattern, t)) return true;
+				if (*t == '\0' || *t == '/') return false;
+			}
+		}
+		if (*text == '\0' || (*pattern == '?' ? *text == '/' : *pattern != *text)) {
+			return false;
+		}
+		pattern++;
+		text++;
+	}
+	return *text == '\0';
+}
+
+bool IsGlob(const std::string& id) {
+	return id.find_first_of("*?") != std::string::npos;
+}
+
+bool IsValidName(const std::string& name) {
+	if (name.empty() || name.size() > 64) {
+		return false;
+	}
+	for (char c : name) {
+		if (!std::isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.') {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+/**
+ * Recursive-descent compiler for Expression (see the grammar in the header)
+ */
+class ExpressionParser {
+public:
+	ExpressionParser(const std::string& text, const Expression::Context& context, bool strict, Expression& out)
+		: m_text(text), m_pos(0), m_context(context), m_strict(strict), m_out(out), m_depth(0), m_maxDepth(0) {}
+
+	bool Parse(std::string& error) {
+		uint32_t mask = 0;
+		bool ok = ParseExpr(mask);
+		SkipSpace();
+		if (ok && m_pos < m_text.size()) {
+			ok = Fail("Unexpected '" + std::string(1, m_text[m_pos]) + "'");
+		}
+		if (!ok) {
+			error = m_error;
+			return false;
+		}
+		m_out.m_mask = mask;
+		m_out.m_stack.assign(m_maxDepth, 0.0);
+		return true;
+	}
+
+private:
+	bool ParseExpr(uint32_t& mask) {
+		if (!ParseTerm(mask)) return false;
+		while (true) {
+			SkipSpace();
+			char c = Peek();
+			if (c != '+' && c != '-') return true;
+			m_pos++;
+			uint32_t rhs = 0;
+			if (!ParseTerm(rhs)) return false;
+			mask |= rhs;
+			Emit(c == '+' ? Expression::Op::Add : Expression::Op::Sub, -1);
+		}
+	}
+
+	bool ParseTerm(uint32_t& mask) {
+		if (!ParseUnary(mask)) return false;
+		while (true) {
+			SkipSpace();
+			char c = Peek();
+			if (c != '*' && c != '/') return true;
+			m_pos++;
+			uint32_t rhs = 0;
+			if (!ParseUnary(rhs)) return false;
+			mask |= rhs;
+			Emit(c == '*' ? Expression::Op::Mul : Expression::Op::Div, -1);
+		}
+	}
+
+	bool ParseUnary(uint32_t& mask) {
+		SkipSpace();
+		if (Peek() == '-') {
+			m_pos++;
+			if (!ParseUnary(mask)) return false;
+			Emit(Expression::Op::Neg, 0);
+			return true;
+		}
+		return ParsePrimary(mask);
+	}
+
+	bool ParsePrimary(uint32_t& mask) {
+		SkipSpace();
+		char c = Peek();
+
+		if (c == '(') {
+			m_pos++;
+			if (!ParseExpr(mask)) return false;
+			return Expect(')');
+		}
+
+		if (std::isdigit((unsigned char)c) || c == '.') {
+			const char* start = m_text.c_str() + m_pos;
+			char* end = nullptr;
+			double value = std::strtod(start, &end);
+			if (end == start) return Fail("Invalid number");
+			m_pos += (size_t)(end - start);
+			Expression::Instruction instruction;
+			instruction.op = Expression::Op::Const;
+			instruction.value = value;
+			Push(instruction, 1);
+			return true;
+		}
+
+		std::string id;
+		if (ReadSensorId(id)) {
+			if (IsGlob(id)) {
+				return Fail("Glob '" + id + "' is only allowed directly in sum/avg/min/max");
+			}
+			return EmitSensor(id, mask);
+		}
+		if (!m_error.empty()) return false;
+
+		if (std::isalpha((unsigned char)c)) {
+			return ParseCall(mask);
+		}
+		return Fail(c == '\0' ? "Unexpected end of expression" : "Unexpected '" + std::string(1, c) + "'");
+	}
+
+	bool ParseCall(uint32_t& mask) {
+		size_t start = m_pos;
+		while (m_pos < m_text.size() && (std::isalnum((unsigned char)m_text[m_pos]) || m_text[m_pos] == '_')) {
+			m_pos++;
+		}
+		std::string name = m_text.substr(start, m_pos - start);
+		SkipSpace();
+		if (Peek() != '(') return Fail("Expected '(' after " + name);
+		m_pos++;
+
+		if (name == "rate" || name == "integral" || name == "abs") {
+			uint32_t inner = 0;
+			if (!ParseExpr(inner)) return false;
+			if (!Expect(')')) return false;
+			mask |= inner;
+			Expression::Instruction instruction;
+			if (name == "abs") {
+				instruction.op = Expression::Op::Abs;
+			} else {
+				instruction.op = name == "rate" ? Expression::Op::Rate : Expression::Op::Integral;
+				instruction.operands = (uint32_t)m_out.m_states.size();
+				instruction.mask = inner;
+				Expression::State state;
+				state.output = name == "rate" ? NAN : 0.0;
+				m_out.m_states.push_back(state);
+			}
+			Push(instruction, 0);
+			return true;
+		}
+
+		Expression::Op op;
+		if (name == "sum") op = Expression::Op::Sum;
+		else if (name == "avg") op = Expression::Op::Avg;
+		else if (name == "min") op = Expression::Op::Min;
+		else if (name == "max") op = Expression::Op::Max;
+		else return Fail("Unknown function '" + name + "'");
+
+		// Glob items expand into m_indices; other items are evaluated onto the stack
+		std::vector<uint32_t> indices;
+		uint32_t operands = 0;
+		while (true) {
+			SkipSpace();
+			size_t itemStart = m_pos;
+			std::string id;
+			if (ReadSensorId(id) && IsGlob(id)) {
+				SkipSpace();
+				if (Peek() != ',' && Peek() != ')') return Fail("Glob '" + id + "' must be a whole argument");
+				Resolve(id, indices, mask);
+			} else {
+				if (!m_error.empty()) return false;
+				m_pos = itemStart;
+				if (!ParseExpr(mask)) return false;
+				operands++;
+				SkipSpace();
+			}
+			if (Peek() != ',') break;
+			m_pos++;
+		}
+		if (!Expect(')')) return false;
+
+		Expression::Instruction instruction;
+		instruction.op = op;
+		instruction.first = (uint32_t)m_out.m_indices.size();
+		instruction.count = (uint32_t)indices.size();
+		instruction.operands = operands;
+		m_out.m_indices.insert(m_out.m_indices.end(), indices.begin(), indices.end());
+		Push(instruction, 1 - (int)operands);
+		return true;
+	}
+
+	// Bare ("/a/b") or quoted ('/a/b', "/a/b") sensor id or glob
+	bool ReadSensorId(std::string& id) {
+		char c = Peek();
+		if (c == '\'' || c == '"') {
+			size_t end = m_text.find(c, m_pos + 1);
+			if (end == std::string::npos) {
+				Fail("Unterminated quoted sensor id");
+				return false;
+			}
+			id = m_text.substr(m_pos + 1, end - m_pos - 1);
+			m_pos = end + 1;
+			return true;
+		}
+		if (c != '/') {
+			return false;
+		}
+		size_t start = m_pos;
+		while (m_pos < m_text.size()) {
+			char d = m_text[m_pos];
+			if (std::isspace((unsigned char)d) || d == ',' || d == '(' || d == ')') break;
+			m_pos++;
+		}
+		id = m_text.substr(start, m_pos - start);
+		return true;
+	}
+
+	void Resolve(const std::string& pattern, std::vector<uint32_t>& indices, uint32_t& mask) {
+		const std::vector<SensorInfo>& sensors = m_context.schema->sensors;
+		size_t visible = std::min(m_context.visibleSensors, sensors.size());
+		for (size_t i = 0; i < visible; i++) {
+			if (MatchGlob(pattern.c_str(), sensors[i].id.c_str())) {
+				indices.push_back((uint32_t)i);
+				mask |= m_context.sensorMasks[i];
+			}
+		}
+	}
+
+	bool EmitSensor(const std::string& id, uint32_t& mask) {
+		const std::vector<SensorInfo>& sensors = m_context.schema->sensors;
+		size_t visible = std::min(m_context.visibleSensors, sensors.size());
+		Expression::Instruction instruction;
+		for (size_t i = 0; i < visible; i++) {
+			if (sensors[i].id == id) {
+				instruction.op = Expression::Op::Sensor;
+				instruction.first = (uint32_t)i;
+				mask |= m_context.sensorMasks[i];
+				Push(instruction, 1);
+				return true;
+			}
+		}
+		if (m_strict) {
+			return Fail("Unknown sensor '" + id + "'");
+		}
+		instruction.value = NAN;
+		Push(instruction, 1);
+		return true;
+	}
+
+	void Emit(Expression::Op op, int stackDelta) {
+		Expression::Instruction instruction;
+		instruction.op = op;
+		Push(instruction, stackDelta);
+	}
+
+	void Push(const Expression::Instruction& instruction, int stackDelta) {
+		m_out.m_program.push_back(instruction);
+		m_depth += stackDelta;
+		m_maxDepth = std::max(m_maxDepth, m_depth);
+	}
+
+	bool Expect(char c) {
+		SkipSpace();
+		if (Peek() != c) return Fail(std::string("Expected '") + c + "'");
+		m_pos++;
+		return true;
+	}
+
+	bool Fail(const std::string& message) {
+		if (m_error.empty()) {
+			m_error = message + " at position " + std::to_string(m_pos);
+		}
+		return false;
+	}
+
+	void SkipSpace() {
+		while (m_pos < m_text.size() && std::isspace((unsigned char)m_text[m_pos])) m_pos++;
+	}
+
+	char Peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+
+	const std::string& m_text;
+	size_t m_pos;
+	const Expression::Context& m_context;
+	bool m_strict;
+	Expression& m_out;
+	int m_depth;
+	int m_maxDepth;
+	std::string m_error;
+};
+
+bool Expression::Compile(const std::string& text, const Context& context, bool strict,
+                         Expression& out, std::string& error) {
+	out = Expression();
+	ExpressionParser parser(text, context, strict, out);
+	if (!parser.Parse(error)) {
+		out = Expression();
+		return false;
+	}
+	return true;
+}
+
+double Expression::Evaluate(const float* values, double nowSeconds, uint32_t updatedMask) {
+	if (m_program.empty()) {
+		return NAN;
+	}
+
+	double* stack = m_stack.data();
+	size_t top = 0;
+	for (const Instruction& instruction : m_program) {
+		switch (instruction.op) {
+		case Op::Const:
+			stack[top++] = instruction.value;
+			break;
+		case Op::Sensor:
+			stack[top++] = values[instruction.first];
+			break;
+		case Op::Add: top--; stack[top - 1] += stack[top]; break;
+		case Op::Sub: top--; stack[top - 1] -= stack[top]; break;
+		case Op::Mul: top--; stack[top - 1] *= stack[top]; break;
+		case Op::Div: top--; stack[top - 1] /= stack[top]; break;
+		case Op::Neg: stack[top - 1] = -stack[top - 1]; break;
+		case Op::Abs: stack[top - 1] = std::fabs(stack[top - 1]); break;
+		case Op::Sum:
+		case Op::Avg:
+		case Op::Min:
+		case Op::Max: {
+			double result = NAN;
+			size_t used = 0;
+			auto add = [&](double v) {
+				if (std::isnan(v)) return;
+				if (used++ == 0) {
+					result = v;
+				} else if (instruction.op == Op::Min) {
+					result = std::min(result, v);
+				} else if (instruction.op == Op::Max) {
+					result = std::max(result, v);
+				} else {
+					result += v;
+				}
+			};
+			for (uint32_t i = 0; i < instruction.count; i++) {
+				add(values[m_indices[instruction.first + i]]);
+			}
+			top -= instruction.operands;
+			for (uint32_t i = 0; i < instruction.operands; i++) {
+				add(stack[top + i]);
+			}
+			if (instruction.op == Op::Avg && used > 0) {
+				result /= (double)used;
+			}
+			stack[top++] = result;
+			break;
+		}
+		case Op::Rate:
+		case Op::Integral: {
+			State& state = m_states[instruction.operands];
+			double input = stack[top - 1];
+			// Hold between updates of the input's categories
+			if (instruction.mask == 0 || (instruction.mask & updatedMask) != 0) {
+				if (std::isnan(input)) {
+					state.primed = false;
+					if (instruction.op == Op::Rate) state.output = NAN;
+				} else {
+					double dt = nowSeconds - state.time;
+					if (state.primed && dt > 0) {
+						if (instruction.op == Op::Rate) {
+							state.output = (input - state.input) / dt;
+						} else {
+							state.output += (input + state.input) * 0.5 * dt;
+						}
+					}
+					state.primed = true;
+					state.input = input;
+					state.time = nowSeconds;
+				}
+			}
+			stack[top - 1] = state.output;
+			break;
+		}
+		}
+	}
+	return stack[0];
+}
+
+void Expression::AdoptState(const Expression& previous) {
+	if (previous.m_states.size() == m_states.size()) {
+		m_states = previous.m_states;
+	}
+}
+
+bool DerivedSensors::IsKnownType(const std::string& type) {
+	return SensorFormat::TypeIndex(type) >= 0;
+}
+
+bool DerivedSensors::Define(const DerivedDefinition& definition, const SensorSchema& schema,
+                            size_t baseSensors, std::string& error) {
+	if (!IsValidName(definition.name)) {
+		error = "Derived sensor names use letters, digits, '_', '-' and '.' (up to 64 characters)";
+		return false;
+	}
+	if (!IsKnownType(definition.type)) {
+		error = "Unknown sensor type '" + definition.type + "'";
+		return false;
+	}
+
+	auto existing = std::find_if(m_definitions.begin(), m_definitions.end(),
+		[&](const DerivedDefinition& d) { return d.name == definition.name; });
+	size_t position = (size_t)(existing - m_definitions.begin());
+
+	// Only bridge sensors and derived sensors defined earlier resolve
+	Expression::Context context;
+	context.schema = &schema;
+	context.visibleSensors = baseSensors + position;
+	context.sensorMasks = m_sensorMasks.data();
+	if (m_sensorMasks.size() < std::min(context.visibleSensors, schema.sensors.size())) {
+		error = "Sensor schema is not bound";
+		return false;
+	}
+
+	Expression compiled;
+	if (!Expression::Compile(definition.expression, context, true, compiled, error)) {
+		return false;
+	}
+
+	if (existing != m_definitions.end()) {
+		*existing = definition;
+	} else {
+		m_definitions.push_back(definition);
+	}
+	m_version++;
+	return true;
+}
+
+bool DerivedSensors::Remove(const std::string& name) {
+	auto it = std::find_if(m_definitions.begin(), m_definitions.end(),
+		[&](const DerivedDefinition& d) { return d.name == name; });
+	if (it == m_definitions.end()) {
+		return false;
+	}
+	m_definitions.erase(it);
+	m_version++;
+	return true;
+}
+
+void DerivedSensors::Bind(SensorSchema& schema, std::vector<uint32_t>& sensorMasks) {
+	size_t baseSensors = schema.sensors.size();
+	sensorMasks.resize(baseSensors);
+
+	if (!m_definitions.empty()) {
+		HardwareInfo hardware;
+		hardware.type = "Derived";
+		hardware.id = kHardwareId;
+		hardware.name = "Derived";
+		schema.hardware.push_back(hardware);
+
+		for (const DerivedDefinition& definition : m_definitions) {
+			SensorInfo sensor;
+			sensor.hardware = (int)schema.hardware.size() - 1;
+			sensor.type = definition.type;
+			sensor.id = std::string(kHardwareId) + "/" + definition.name;
+			sensor.name = definition.name;
+			schema.sensors.push_back(sensor);
+			sensorMasks.push_back(0);
+		}
+	}
+
+	std::vector<Bound> previous;
+	previous.swap(m_bound);
+	m_bound.resize(m_definitions.size());
+
+	Expression::Context context;
+	context.schema = &schema;
+	context.sensorMasks = sensorMasks.data();
+	for (size_t i = 0; i < m_definitions.size(); i++) {
+		Bound& bound = m_bound[i];
+		bound.name = m_definitions[i].name;
+		bound.text = m_definitions[i].expression;
+		context.visibleSensors = baseSensors + i;
+
+		std::string error;
+		Expression::Compile(bound.text, context, false, bound.expression, error);
+		sensorMasks[baseSensors + i] = bound.expression.DependencyMask();
+
+		// Keep integrals and extremes across hardware and definition changes
+		for (const Bound& old : previous) {
+			if (old.name == bound.name && old.text == bound.text) {
+				bound.expression.AdoptState(old.expression);
+				bound.min = old.min;
+				bound.max = old.max;
+				bound.seen = old.seen;
+				break;
+			}
+		}
+	}
+	m_sensorMasks = sensorMasks;
+}
+
+void DerivedSensors::Evaluate(float* values, size_t baseSensors, double nowSeconds, uint32_t updatedMask) {
+	for (size_t i = 0; i < m_bound.size(); i++) {
+		Bound& bound = m_bound[i];
+		double value = bound.expression.Evaluate(values, nowSeconds, updatedMask);
+		values[baseSensors + i] = (float)value;
+		if (std::isfinite(value)) {
+			bound.min = bound.seen ? std::min(bound.min, value) : value;
+			bound.max = bound.seen ? std::max(bound.max, value) : value;
+			bound.seen = true;
+		}
+	}
+}
+
+void DerivedSensors::InsertIntoPollJson(std::string& json, int firstNodeId, const float* values, size_t baseSensors) const {
+	if (m_bound.empty()) {
+		return;
+	}
+
+	// The tree ends with the computer node's hardware list: ...]}]}
+	size_t end = json.find_last_not_of(" \t\r\n");
+	if (end == std::string::npos || end < 4 || json.compare(end - 3, 4, "]}]}") != 0) {
+		return;
+	}
+	size_t insertAt = end - 3;
+	size_t previous = json.find_last_not_of(" \t\r\n", insertAt - 1);
+	bool first = previous != std::string::npos && json[previous] == '[';
+
+	int id = firstNodeId;
+	std::string node;
+	node.reserve(256 + m_bound.size() * 192);
+	node += first ? "{\"id\":" : ",{\"id\":";
+	node += std::to_string(id++);
+	node += ",\"Text\":\"Derived\",\"Children\":[";
+
+	// One group per type, in SensorType order like the bridge's nodes
+	bool firstGroup = true;
+	for (size_t t = 0; t < SensorFormat::TypeCount(); t++) {
+		const SensorTypeFormat& format = SensorFormat::Type(t);
+		bool any = false;
+		for (size_t i = 0; i < m_bound.size(); i++) {
+			if (m_definitions[i].type != format.type) {
+				continue;
+			}
+			if (!any) {
+				node += firstGroup ? "{\"id\":" : ",{\"id\":";
+				node += std::to_string(id++);
+				node += ",\"Text\":\"";
+				node += format.group;
+				node += "\",\"Children\":[";
+				firstGroup = false;
+			} else {
+				node += ",";
+			}
+			any = true;
+
+			const Bound& bound = m_bound[i];
+			node += "{\"id\":";
+			node += std::to_string(id++);
+			node += ",\"Text\":\"";
+			node += m_definitions[i].name;
+			node += "\",\"Children\":[],\"Min\":\"";
+			node += SensorFormat::FormatValue(bound.seen ? bound.min : NAN, format);
+			node += "\",\"Value\":\"";
+			node += SensorFormat::FormatValue(values[baseSensors + i], format);
+			node += "\",\"Max\":\"";
+			node += SensorFormat::FormatValue(bound.seen ? bound.max : NAN, format);
+			node += "\",\"SensorId\":\"";
+			node += kHardwareId;
+			node += "/";
+			node += m_definitions[i].name;
+			node += "\",\"Type\":\"";
+			node += format.type;
+			node += "\",\"ImageURL\":\"\"}";
+		}
+		if (any) {
+			node += "],\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"ImageURL\":\"\"}";
+		}
+	}
+
+	node += "],\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"HardwareId\":\"";
+	node += kHardwareId;
+	node += "\",\"ImageURL\":\"\"}";
+	json.insert(insertAt, node);
+}
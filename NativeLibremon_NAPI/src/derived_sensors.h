@@ -0,0 +1,178 @@
+#pragma once
+
+#include "sensor_schema.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Expression - a derived sensor's formula compiled to a flat stack program
+ *
+ * Grammar:
+ *   expr    := term (('+' | '-') term)*
+ *   term    := unary (('*' | '/') unary)*
+ *   unary   := '-' unary | primary
+ *   primary := number | sensor | call | '(' expr ')'
+ *   sensor  := '/path/id' | "'/path/id'" | '"/path/id"'
+ *   call    := sum|avg|min|max '(' item (',' item)* ')'
+ *            | rate|integral|abs '(' expr ')'
+ *   item    := expr | glob
+ *
+ * Bare sensor ids run up to whitespace, ',' or parentheses, so operators after
+ * them need a space (or a quoted id). In a glob, '*' and '?' match within one
+ * path segment and '**' matches across segments. Aggregates skip NaN inputs.
+ *
+ * rate() and integral() keep state between evaluations and only advance when
+ * a category their input depends on was updated, so staggered sampler
+ * intervals do not produce spurious zero rates. Both work in seconds.
+ */
+class Expression {
+public:
+    /**
+     * Resolution context: the sensors an expression may refer to
+     */
+    struct Context {
+        const SensorSchema* schema = nullptr;
+        size_t visibleSensors = 0;              // Only schema sensors [0, visibleSensors) resolve
+        const uint32_t* sensorMasks = nullptr;  // Per sensor: category bits its value depends on
+    };
+
+    /**
+     * Compile an expression
+     * @param strict - fail on ids that match no sensor (otherwise they read as NaN)
+     * @returns false with a message in error on syntax errors or unknown sensors
+     */
+    static bool Compile(const std::string& text, const Context& context, bool strict,
+                        Expression& out, std::string& error);
+
+    /**
+     * Evaluate against a value vector (does not allocate)
+     * @param values - value vector laid out by the context's schema
+     * @param nowSeconds - monotonic time of the sample
+     * @param updatedMask - category bits updated since the previous evaluation
+     */
+    double Evaluate(const float* values, double nowSeconds, uint32_t updatedMask);
+
+    /**
+     * Category bits the result depends on
+     */
+    uint32_t DependencyMask() const { return m_mask; }
+
+    /**
+     * Carry rate()/integral() state over from a previous compile of the same text
+     */
+    void AdoptState(const Expression& previous);
+
+private:
+    enum class Op : uint8_t {
+        Const, Sensor, Add, Sub, Mul, Div, Neg, Abs, Sum, Avg, Min, Max, Rate, Integral
+    };
+
+    struct Instruction {
+        Op op = Op::Const;
+        uint32_t first = 0;     // Sensor index, or first entry in m_indices
+        uint32_t count = 0;     // Glob-expanded sensors in m_indices
+        uint32_t operands = 0;  // Stack operands (aggregates), state slot (rate/integral)
+        uint32_t mask = 0;      // Dependency mask (rate/integral)
+        double value = 0;
+    };
+
+    struct State {
+        bool primed = false;
+        double input = 0;
+        double time = 0;
+        double output = 0;
+    };
+
+    friend class ExpressionParser;
+
+    std::vector<Instruction> m_program;
+    std::vector<uint32_t> m_indices;
+    std::vector<State> m_states;
+    std::vector<double> m_stack;
+    uint32_t m_mask = 0;
+};
+
+/**
+ * Definition of a derived (virtual) sensor
+ */
+struct DerivedDefinition {
+    std::string name;          // Sensor id is "/derived/<name>"
+    std::string expression;
+    std::string type;          // LibreHardwareMonitor SensorType name (grouping and formatting)
+};
+
+/**
+ * Derived Sensors - user-defined sensors computed natively after each sample
+ *
+ * Bound to the backend's schema as a virtual "/derived" hardware whose sensors
+ * follow the real ones in every value vector. A definition may refer to
+ * derived sensors defined before it.
+ */
+class DerivedSensors {
+public:
+    static constexpr const char* kHardwareId = "/derived";
+
+    /**
+     * Add or replace a definition, compiled against the bound schema
+     * @param schema - schema returned by the last Bind
+     * @param baseSensors - number of bridge sensors in schema
+     * @returns false with a message in error if the definition is invalid
+     */
+    bool Define(const DerivedDefinition& definition, const SensorSchema& schema,
+                size_t baseSensors, std::string& error);
+
+    /**
+     * Remove a definition
+     * Later definitions that referred to it read NaN for it from then on.
+     * @returns false if there is no such definition
+     */
+    bool Remove(const std::string& name);
+
+    bool Empty() const { return m_definitions.empty(); }
+    const std::vector<DerivedDefinition>& Definitions() const { return m_definitions; }
+
+    /**
+     * Changes on every Define/Remove; the schema must be rebound when it differs
+     */
+    uint32_t Version() const { return m_version; }
+
+    /**
+     * Append the derived hardware and sensors to a bridge schema and compile
+     * every definition against it (ids that vanished read as NaN)
+     * @param sensorMasks - per bridge sensor category bits; derived entries are appended
+     */
+    void Bind(SensorSchema& schema, std::vector<uint32_t>& sensorMasks);
+
+    /**
+     * Compute the derived values into values[baseSensors...]
+     */
+    void Evaluate(float* values, size_t baseSensors, double nowSeconds, uint32_t updatedMask);
+
+    /**
+     * Insert a hardware node with the derived sensors into poll() JSON
+     * Node ids start at firstNodeId; the JSON is left alone if it is not
+     * in the bridge's data.json layout.
+     */
+    void InsertIntoPollJson(std::string& json, int firstNodeId, const float* values, size_t baseSensors) const;
+
+    /**
+     * Check a SensorType name
+     */
+    static bool IsKnownType(const std::string& type);
+
+private:
+    struct Bound {
+        std::string name;
+        std::string text;      // Expression the state belongs to
+        Expression expression;
+        double min = 0;
+        double max = 0;
+        bool seen = false;
+    };
+
+    std::vector<DerivedDefinition> m_definitions;
+    std::vector<Bound> m_bound;
+    std::vector<uint32_t> m_sensorMasks;  // Of the bound schema, derived sensors included
+    uint32_t m_version = 0;
+};
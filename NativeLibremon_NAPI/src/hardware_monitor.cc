@@ -1,13 +1,31 @@
 #include "hardware_monitor.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include "clr_host.h"
+#endif
 
 HardwareMonitor::HardwareMonitor(CLRHost* clrHost)
 	: m_clrHost(clrHost)
 	, m_isInitialized(false)
-	, m_initializeFn(nullptr)
-	, m_pollFn(nullptr)
-	, m_freeStringFn(nullptr)
-	, m_shutdownFn(nullptr)
+	, m_bufferPolls(0)
+	, m_bufferCopies(0)
+	, m_bufferCopiedBytes(0)
+	, m_bufferAllocations(0)
+{
+}
+
+HardwareMonitor::HardwareMonitor(const BridgeApi& api)
+	: m_clrHost(nullptr)
+	, m_isInitialized(false)
+	, m_api(api)
+	, m_bufferPolls(0)
+	, m_bufferCopies(0)
+	, m_bufferCopiedBytes(0)
+	, m_bufferAllocations(0)
 {
 }
 
@@ -20,14 +38,63 @@ bool HardwareMonitor::Initialize(const HardwareConfig& config) {
 		return true; // Already initialized
 	}
     
+	// Store configuration
+	m_config = config;
+    
+	if (m_clrHost != nullptr && !LoadManagedBridge()) {
+		return false;
+	}
+    
+	if (m_api.initialize == nullptr) {
+		std::cerr << "No bridge implementation available" << std::endl;
+		return false;
+	}
+    
+	// Debug: Log hardware config being passed to C#
+	std::cout << "=== Initializing LibreHardwareMonitor ===" << std::endl;
+	std::cout << "CPU: " << (config.cpu ? "true" : "false") 
+			  << ", GPU: " << (config.gpu ? "true" : "false")
+			  << ", Motherboard: " << (config.motherboard ? "true" : "false") << std::endl;
+	std::cout << "Memory: " << (config.memory ? "true" : "false")
+			  << ", Storage: " << (config.storage ? "true" : "false")
+			  << ", Network: " << (config.network ? "true" : "false") << std::endl;
+	std::cout << "PSU: " << (config.psu ? "true" : "false")
+			  << ", Controller: " << (config.controller ? "true" : "false")
+			  << ", Battery: " << (config.battery ? "true" : "false") << std::endl;
+	std::cout << "DIMM Detection: " << (config.dimmDetection ? "true" : "false") 
+	          << ", Physical Network Only: " << (config.physicalNetworkOnly ? "true" : "false") << std::endl;
+    
+	int result = m_api.initialize(
+		config.cpu,
+		config.gpu,
+		config.motherboard,
+		config.memory,
+		config.storage,
+		config.network,
+		config.psu,
+		config.controller,
+		config.battery,
+		config.dimmDetection,
+		config.physicalNetworkOnly
+	);
+    
+	if (result != 0) {
+		std::cerr << "Managed initialization failed with code: " << result << std::endl;
+		return false;
+	}
+    
+	std::cout << "✓ Hardware monitoring initialized successfully" << std::endl;
+	m_isInitialized = true;
+	return true;
+}
+
+bool HardwareMonitor::LoadManagedBridge() {
+#ifdef _WIN32
 	if (!m_clrHost || !m_clrHost->IsInitialized()) {
 		std::cerr << "CLR host not initialized" << std::endl;
 		return false;
 	}
     
-	// Store configuration
-	m_config = config;
-    
 	// Get the path to our .node addon
 	HMODULE hModule = nullptr;
 	if (!GetModuleHandleExW(
@@ -55,69 +122,246 @@ bool HardwareMonitor::Initialize(const HardwareConfig& config) {
 	std::wcout << L"Loading managed bridge: " << bridgeDllPath << std::endl;
     
 	// Load function pointers from managed assembly
+	struct { const wchar_t* name; void** fn; } exports[] = {
+		{ L"Initialize", (void**)&m_api.initialize },
+		{ L"Poll", (void**)&m_api.poll },
+		{ L"FreeString", (void**)&m_api.freeString },
+		{ L"Shutdown", (void**)&m_api.shutdown },
+		{ L"GetSchema", (void**)&m_api.getSchema },
+		{ L"GetSchemaGeneration", (void**)&m_api.getSchemaGeneration },
+		{ L"Update", (void**)&m_api.update },
+		{ L"ReadValues", (void**)&m_api.readValues },
+		{ L"SetFilter", (void**)&m_api.setFilter },
+		{ L"GetMemoryStats", (void**)&m_api.getMemoryStats },
+		{ L"UpdateHardware", (void**)&m_api.updateHardware },
+		{ L"ReadSensorValues", (void**)&m_api.readSensorValues },
+		{ L"Reconfigure", (void**)&m_api.reconfigure },
+		{ L"PollWithin", (void**)&m_api.pollWithin },
+		{ L"PollInto", (void**)&m_api.pollInto },
+	};
+    
+	for (const auto& entry : exports) {
+		if (!LoadBridgeFunction(bridgeDllPath, entry.name, entry.fn)) {
+			std::wcerr << L"Failed to load LHM_" << entry.name << L" function" << std::endl;
+			return false;
+		}
+	}
+    
+	std::cout << "✓ Loaded all managed function pointers" << std::endl;
+	return true;
+#else
+	std::cerr << "The managed bridge requires Windows" << std::endl;
+	return false;
+#endif
+}
+
+std::string HardwareMonitor::Poll() {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
+    
+	// Call managed poll function
+	void* jsonPtr = m_api.poll();
+    
+	if (jsonPtr == nullptr) {
+		throw std::runtime_error("Managed poll function returned null");
+	}
+    
+	// Convert to std::string
+	std::string result(static_cast<char*>(jsonPtr));
+    
+	// Free the managed memory
+	m_api.freeString(jsonPtr);
+    
+	return result;
+}
+
+std::string HardwareMonitor::Poll(int32_t budgetMs, int32_t& skippedHardware) {
+	skippedHardware = 0;
+	if (m_api.pollWithin == nullptr) {
+		return Poll();
+	}
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
+
+	int skipped = 0;
+	void* jsonPtr = m_api.pollWithin((int)budgetMs, &skipped);
+	if (jsonPtr == nullptr) {
+		throw std::runtime_error("Managed poll function returned null");
+	}
+	std::string result(static_cast<char*>(jsonPtr));
+	m_api.freeString(jsonPtr);
+	skippedHardware = skipped;
+	return result;
+}
+
+void HardwareMonitor::Poll(std::string& buffer, int32_t budgetMs, uint32_t filterPresets, int32_t& skippedHardware) {
+	skippedHardware = 0;
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
+	m_bufferPolls++;
+
+	if (m_api.pollInto == nullptr) {
+		// The bridge allocates the JSON; copy it out and release it
+		int skipped = 0;
+		void* jsonPtr = budgetMs >= 0 && m_api.pollWithin != nullptr
+			? m_api.pollWithin((int)budgetMs, &skipped)
+			: m_api.poll();
+		if (jsonPtr == nullptr) {
+			throw std::runtime_error("Managed poll function returned null");
+		}
+		size_t length = std::strlen(static_cast<char*>(jsonPtr));
+		if (length > buffer.capacity()) {
+			m_bufferAllocations++;
+		}
+		buffer.assign(static_cast<char*>(jsonPtr), length);
+		m_api.freeString(jsonPtr);
+		// The bridge's own copy into its string, then ours
+		m_bufferAllocations++;
+		m_bufferCopies += 2;
+		m_bufferCopiedBytes += 2 * (uint64_t)length;
+		skippedHardware = skipped;
+		return;
+	}
+
+	// Write straight into the buffer's capacity (+1 for the NUL); grow to the
+	// size the bridge asks for and collect the same poll again. The previous
+	// poll's text is written over, so only the capacity past it is zero-filled
+	int skipped = 0;
+	size_t capacity = buffer.capacity();
+	for (;;) {
+		if (buffer.size() < capacity) {
+			buffer.resize(capacity);
+		}
+		int result = m_api.pollInto(&buffer[0], (int)capacity + 1, (int)budgetMs, (int)filterPresets, &skipped);
+		if (result > 0) {
+			buffer.resize((size_t)result);
+			m_bufferCopies++;
+			m_bufferCopiedBytes += (uint64_t)result;
+			skippedHardware = skipped;
+			return;
+		}
+		if (result == 0) {
+			buffer.clear();
+			throw std::runtime_error("Managed poll function failed");
+		}
+		// Round up so a slowly growing tree does not reallocate every poll,
+		// with headroom when one poll outgrows the buffer by more than that
+		size_t needed = (size_t)-result;
+		capacity = std::max(capacity * 3 / 2, needed + needed / 8);
+		buffer.reserve(capacity);
+		m_bufferAllocations++;
+	}
+}
+
+PollBufferStats HardwareMonitor::GetPollBufferStats() const {
+	PollBufferStats stats;
+	stats.polls = m_bufferPolls.load();
+	stats.copies = m_bufferCopies.load();
+	stats.copiedBytes = m_bufferCopiedBytes.load();
+	stats.allocations = m_bufferAllocations.load();
+	return stats;
+}
+
+#ifdef _WIN32
+bool HardwareMonitor::LoadBridgeFunction(const wchar_t* bridgeDllPath, const wchar_t* methodName, void** fn) {
 	const wchar_t* typeName = L"LibreHardwareMonitorNative.HardwareMonitorBridge, LibreHardwareMonitorBridge";
     
-	if (!m_clrHost->LoadAssemblyAndGetFunctionPointer(
-			bridgeDllPath,
-			typeName,
-			L"Initialize",
-			L"LibreHardwareMonitorNative.HardwareMonitorBridge+InitializeDelegate, LibreHardwareMonitorBridge",
-			nullptr,
-			(void**)&m_initializeFn)) {
-		std::cerr << "Failed to load LHM_Initialize function" << std::endl;
-		return false;
+	std::wstring delegateTypeName = L"LibreHardwareMonitorNative.HardwareMonitorBridge+";
+	delegateTypeName += methodName;
+	delegateTypeName += L"Delegate, LibreHardwareMonitorBridge";
+    
+	return m_clrHost->LoadAssemblyAndGetFunctionPointer(
+		bridgeDllPath,
+		typeName,
+		methodName,
+		delegateTypeName.c_str(),
+		nullptr,
+		fn);
+}
+#endif
+
+void HardwareMonitor::Update(uint32_t categoryMask) {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
 	}
     
-	if (!m_clrHost->LoadAssemblyAndGetFunctionPointer(
-			bridgeDllPath,
-			typeName,
-			L"Poll",
-			L"LibreHardwareMonitorNative.HardwareMonitorBridge+PollDelegate, LibreHardwareMonitorBridge",
-			nullptr,
-			(void**)&m_pollFn)) {
-		std::cerr << "Failed to load LHM_Poll function" << std::endl;
-		return false;
+	if (m_api.update((int)categoryMask) != 0) {
+		throw std::runtime_error("Managed update function failed");
+	}
+}
+
+std::string HardwareMonitor::GetSchema() {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
 	}
     
-	if (!m_clrHost->LoadAssemblyAndGetFunctionPointer(
-			bridgeDllPath,
-			typeName,
-			L"FreeString",
-			L"LibreHardwareMonitorNative.HardwareMonitorBridge+FreeStringDelegate, LibreHardwareMonitorBridge",
-			nullptr,
-			(void**)&m_freeStringFn)) {
-		std::cerr << "Failed to load LHM_FreeString function" << std::endl;
-		return false;
+	void* textPtr = m_api.getSchema();
+	if (textPtr == nullptr) {
+		throw std::runtime_error("Managed schema function returned null");
 	}
     
-	if (!m_clrHost->LoadAssemblyAndGetFunctionPointer(
-			bridgeDllPath,
-			typeName,
-			L"Shutdown",
-			L"LibreHardwareMonitorNative.HardwareMonitorBridge+ShutdownDelegate, LibreHardwareMonitorBridge",
-			nullptr,
-			(void**)&m_shutdownFn)) {
-		std::cerr << "Failed to load LHM_Shutdown function" << std::endl;
-		return false;
+	std::string result(static_cast<char*>(textPtr));
+	m_api.freeString(textPtr);
+	return result;
+}
+
+int32_t HardwareMonitor::GetSchemaGeneration() {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
 	}
     
-	std::cout << "✓ Loaded all managed function pointers" << std::endl;
+	return m_api.getSchemaGeneration();
+}
+
+int32_t HardwareMonitor::ReadValues(float* values, float* mins, float* maxs, int32_t capacity) {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
     
-	// Debug: Log hardware config being passed to C#
-	std::cout << "=== Initializing LibreHardwareMonitor ===" << std::endl;
-	std::cout << "CPU: " << (config.cpu ? "true" : "false") 
-			  << ", GPU: " << (config.gpu ? "true" : "false")
-			  << ", Motherboard: " << (config.motherboard ? "true" : "false") << std::endl;
-	std::cout << "Memory: " << (config.memory ? "true" : "false")
-			  << ", Storage: " << (config.storage ? "true" : "false")
-			  << ", Network: " << (config.network ? "true" : "false") << std::endl;
-	std::cout << "PSU: " << (config.psu ? "true" : "false")
-			  << ", Controller: " << (config.controller ? "true" : "false")
-			  << ", Battery: " << (config.battery ? "true" : "false") << std::endl;
-	std::cout << "DIMM Detection: " << (config.dimmDetection ? "true" : "false") 
-	          << ", Physical Network Only: " << (config.physicalNetworkOnly ? "true" : "false") << std::endl;
+	return m_api.readValues(values, mins, maxs, capacity);
+}
+
+bool HardwareMonitor::UpdateHardware(const int32_t* indices, int32_t count) {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
+    
+	if (m_api.updateHardware == nullptr) {
+		return false;
+	}
+	int result = m_api.updateHardware(indices, count);
+	if (result == -2) {
+		throw std::runtime_error("Hardware index outside the current schema");
+	}
+	if (result != 0) {
+		throw std::runtime_error("Managed hardware update function failed");
+	}
+	return true;
+}
+
+int32_t HardwareMonitor::ReadSensorValues(const int32_t* indices, float* values, int32_t count) {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
+    
+	if (m_api.readSensorValues == nullptr) {
+		return -1;
+	}
+	return m_api.readSensorValues(indices, values, count);
+}
+
+bool HardwareMonitor::Reconfigure(const HardwareConfig& config) {
+	if (!m_isInitialized) {
+		throw std::runtime_error("Hardware monitor not initialized");
+	}
     
-	int result = m_initializeFn(
+	if (m_api.reconfigure == nullptr) {
+		return false;
+	}
+	int result = m_api.reconfigure(
 		config.cpu,
 		config.gpu,
 		config.motherboard,
@@ -130,36 +374,42 @@ bool HardwareMonitor::Initialize(const HardwareConfig& config) {
 		config.dimmDetection,
 		config.physicalNetworkOnly
 	);
-    
 	if (result != 0) {
-		std::cerr << "Managed initialization failed with code: " << result << std::endl;
-		return false;
+		throw std::runtime_error("Managed reconfigure function failed");
 	}
-    
-	std::cout << "✓ Hardware monitoring initialized successfully" << std::endl;
-	m_isInitialized = true;
+	m_config = config;
 	return true;
 }
 
-std::string HardwareMonitor::Poll() {
+bool HardwareMonitor::SetFilter(const std::string& filterJson) {
 	if (!m_isInitialized) {
 		throw std::runtime_error("Hardware monitor not initialized");
 	}
     
-	// Call managed poll function
-	void* jsonPtr = m_pollFn();
-    
-	if (jsonPtr == nullptr) {
-		throw std::runtime_error("Managed poll function returned null");
+	if (m_api.setFilter == nullptr) {
+		return false;
+	}
+	return m_api.setFilter(filterJson.empty() ? nullptr : filterJson.c_str()) == 0;
+}
+
+bool HardwareMonitor::GetMemoryStats(ManagedMemoryStats& stats) {
+	if (!m_isInitialized || m_api.getMemoryStats == nullptr) {
+		return false;
 	}
     
-	// Convert to std::string
-	std::string result(static_cast<char*>(jsonPtr));
-    
-	// Free the managed memory
-	m_freeStringFn(jsonPtr);
+	int64_t fields[7] = {};
+	if (m_api.getMemoryStats(fields, 7) < 7) {
+		return false;
+	}
     
-	return result;
+	stats.liveBytes = fields[0];
+	stats.heapSizeBytes = fields[1];
+	stats.committedBytes = fields[2];
+	stats.allocatedBytes = fields[3];
+	stats.gen0Collections = fields[4];
+	stats.gen1Collections = fields[5];
+	stats.gen2Collections = fields[6];
+	return true;
 }
 
 void HardwareMonitor::Shutdown() {
@@ -168,15 +418,14 @@ void HardwareMonitor::Shutdown() {
 	}
     
 	// Call managed shutdown
-	if (m_shutdownFn != nullptr) {
-		m_shutdownFn();
+	if (m_api.shutdown != nullptr) {
+		m_api.shutdown();
 	}
     
 	std::cout << "Hardware Monitor shutdown" << std::endl;
     
 	m_isInitialized = false;
-	m_initializeFn = nullptr;
-	m_pollFn = nullptr;
-	m_freeStringFn = nullptr;
-	m_shutdownFn = nullptr;
+	if (m_clrHost != nullptr) {
+		m_api = BridgeApi();  // Reloaded by the next Initialize()
+	}
 }
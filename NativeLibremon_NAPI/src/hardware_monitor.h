@@ -1,8 +1,50 @@
 #pragma once
 
-#include "clr_host.h"
+#include "bridge_api.h"
+#include <atomic>
+#include <cstdint>
 #include <string>
 
+/**
+ * Hardware category bits for partial updates
+ * Same order as HardwareConfig; must match the bridge's Category* constants
+ */
+enum HardwareCategory : uint32_t {
+    kCategoryCpu = 1u << 0,
+    kCategoryGpu = 1u << 1,
+    kCategoryMotherboard = 1u << 2,
+    kCategoryMemory = 1u << 3,
+    kCategoryStorage = 1u << 4,
+    kCategoryNetwork = 1u << 5,
+    kCategoryPsu = 1u << 6,
+    kCategoryController = 1u << 7,
+    kCategoryBattery = 1u << 8,
+    kCategoryOther = 1u << 9,    // Hardware types without a config flag
+    kCategoryAll = 0x3FFu
+};
+
+const int kCategoryCount = 10;
+
+/**
+ * Legacy poll({ filterVirtualNics, filterDIMMs }) presets
+ * Applied by the bridge to one poll's tree; must match the bridge's Preset* constants
+ */
+enum FilterPreset : uint32_t {
+    kFilterVirtualNics = 1u << 0,   // Virtual NIC / NDIS filter adapters
+    kFilterDimms = 1u << 1          // Individual DIMMs
+};
+
+/**
+ * Lower-case name of category bit index i (matches the HardwareConfig/init() keys)
+ */
+inline const char* CategoryName(int index) {
+    static const char* const names[kCategoryCount] = {
+        "cpu", "gpu", "motherboard", "memory", "storage",
+        "network", "psu", "controller", "battery", "other"
+    };
+    return index >= 0 && index < kCategoryCount ? names[index] : "unknown";
+}
+
 /**
  * Hardware configuration flags
  * Matches LibreHardwareMonitor's Computer class properties
@@ -19,15 +61,75 @@ struct HardwareConfig {
     bool battery = false;
     bool dimmDetection = false;  // Enable individual DIMM SPD detection (costly)
     bool physicalNetworkOnly = false;  // Only detect physical network adapters (not virtual/NDIS filters)
+
+    bool operator==(const HardwareConfig& other) const {
+        return cpu == other.cpu && gpu == other.gpu && motherboard == other.motherboard
+            && memory == other.memory && storage == other.storage && network == other.network
+            && psu == other.psu && controller == other.controller && battery == other.battery
+            && dimmDetection == other.dimmDetection && physicalNetworkOnly == other.physicalNetworkOnly;
+    }
+    bool operator!=(const HardwareConfig& other) const { return !(*this == other); }
+
+    /**
+     * HardwareCategory bits of the enabled hardware (plus kCategoryOther)
+     */
+    uint32_t CategoryMask() const {
+        uint32_t mask = kCategoryOther;
+        if (cpu) mask |= kCategoryCpu;
+        if (gpu) mask |= kCategoryGpu;
+        if (motherboard) mask |= kCategoryMotherboard;
+        if (memory) mask |= kCategoryMemory;
+        if (storage) mask |= kCategoryStorage;
+        if (network) mask |= kCategoryNetwork;
+        if (psu) mask |= kCategoryPsu;
+        if (controller) mask |= kCategoryController;
+        if (battery) mask |= kCategoryBattery;
+        return mask;
+    }
+};
+
+/**
+ * Managed heap statistics reported by the bridge (see GetMemoryStats)
+ */
+struct ManagedMemoryStats {
+    int64_t liveBytes = 0;        // GC.GetTotalMemory(false)
+    int64_t heapSizeBytes = 0;
+    int64_t committedBytes = 0;
+    int64_t allocatedBytes = 0;   // Total allocated since process start
+    int64_t gen0Collections = 0;
+    int64_t gen1Collections = 0;
+    int64_t gen2Collections = 0;
 };
 
+/**
+ * Boundary cost of Poll(buffer, ...) calls, cumulative
+ * (the JSON text handed to JS is one more copy per poll, not counted here)
+ */
+struct PollBufferStats {
+    uint64_t polls = 0;
+    uint64_t copies = 0;          // Copies of the JSON into native memory
+    uint64_t copiedBytes = 0;
+    uint64_t allocations = 0;     // Heap allocations at the boundary (bridge strings, buffer growth)
+};
+
+class CLRHost;
+
 /**
  * Hardware Monitor - wraps LibreHardwareMonitor functionality
  * Manages the Computer instance and sensor polling
  */
 class HardwareMonitor {
 public:
+    /**
+     * Use the managed bridge loaded through the CLR host (Windows only)
+     */
     HardwareMonitor(CLRHost* clrHost);
+
+    /**
+     * Use an in-process bridge implementation (synthetic/recorded backends)
+     */
+    explicit HardwareMonitor(const BridgeApi& api);
+
     ~HardwareMonitor();
     
     /**
@@ -43,6 +145,103 @@ public:
      */
     std::string Poll();
     
+    /**
+     * Poll within a time budget
+     * Hardware the bridge has not reached when the budget runs out keeps its
+     * previous values (and UpdateStart/UpdateEnd). Bridges that cannot do this
+     * poll everything.
+     * @param budgetMs - time the bridge may spend updating
+     * @param skippedHardware - receives the number of hardware not updated
+     * @returns JSON string matching LibreHardwareMonitor web endpoint format
+     */
+    std::string Poll(int32_t budgetMs, int32_t& skippedHardware);
+    
+    /**
+     * Poll into a reusable buffer
+     * With a bridge that implements pollInto the JSON is written straight into
+     * the buffer's capacity, which only grows when a poll does not fit, so
+     * steady-state polls allocate nothing. Other bridges' strings are copied in.
+     * Calls must be serialized (as Poll is by MonitorBackend).
+     * @param buffer - receives the JSON; its capacity is kept between calls
+     * @param budgetMs - time the bridge may spend updating, < 0 for no deadline
+     * @param filterPresets - FilterPreset bits left out of this tree (pollInto bridges only)
+     * @param skippedHardware - receives the number of hardware not updated
+     */
+    void Poll(std::string& buffer, int32_t budgetMs, uint32_t filterPresets, int32_t& skippedHardware);
+    
+    /**
+     * Copy and allocation counts of Poll(buffer, ...)
+     */
+    PollBufferStats GetPollBufferStats() const;
+    
+    /**
+     * Update the hardware of the selected categories (no JSON is built)
+     * @param categoryMask - bitwise OR of HardwareCategory values
+     */
+    void Update(uint32_t categoryMask);
+    
+    /**
+     * Get the current sensor schema text (see SensorSchema::Parse)
+     */
+    std::string GetSchema();
+    
+    /**
+     * Get the current schema generation (changes on hardware add/remove)
+     */
+    int32_t GetSchemaGeneration();
+    
+    /**
+     * Copy the current sensor values in schema order
+     * @param values - output array, NaN for missing values
+     * @param mins - optional output array of minimums (may be nullptr)
+     * @param maxs - optional output array of maximums (may be nullptr)
+     * @param capacity - length of the output arrays
+     * @returns sensor count, or -count if capacity is too small
+     */
+    int32_t ReadValues(float* values, float* mins, float* maxs, int32_t capacity);
+    
+    /**
+     * Update only the given hardware, without its sub-hardware
+     * @param indices - schema hardware indices
+     * @param count - number of indices
+     * @returns false if the bridge cannot update single hardware (use Update)
+     */
+    bool UpdateHardware(const int32_t* indices, int32_t count);
+    
+    /**
+     * Copy the current values of the given sensors
+     * @param indices - schema sensor indices
+     * @param values - output array of count values, NaN for missing values
+     * @param count - number of indices
+     * @returns count, -1 if the bridge cannot read single sensors (use ReadValues),
+     *          -2 if an index is outside the current schema
+     */
+    int32_t ReadSensorValues(const int32_t* indices, float* values, int32_t count);
+    
+    /**
+     * Enable or disable hardware types on the running monitor
+     * Hardware of newly enabled types is opened, that of disabled types closed;
+     * the schema generation changes as it does for hot-plugged hardware.
+     * @param config - complete new configuration
+     * @returns false if the bridge cannot reconfigure (re-initialize instead)
+     */
+    bool Reconfigure(const HardwareConfig& config);
+    
+    /**
+     * Replace the bridge's hardware/sensor filter
+     * Filtered hardware is skipped by Update, Poll and the schema.
+     * @param filterJson - JSON filter spec (see README), empty to clear
+     * @returns true on success
+     */
+    bool SetFilter(const std::string& filterJson);
+    
+    /**
+     * Read the managed heap statistics
+     * @param stats - output
+     * @returns false if the bridge does not report them
+     */
+    bool GetMemoryStats(ManagedMemoryStats& stats);
+    
     /**
      * Shutdown hardware monitoring and release resources
      */
@@ -58,16 +257,26 @@ private:
     bool m_isInitialized;
     HardwareConfig m_config;
     
-    // Function pointers to managed bridge functions
-    typedef int (*LHM_InitializeFn)(bool cpu, bool gpu, bool motherboard, bool memory,
-                                     bool storage, bool network, bool psu, bool controller, bool battery, 
-                                     bool dimmDetection, bool physicalNetworkOnly);
-    typedef void* (*LHM_PollFn)();
-    typedef void (*LHM_FreeStringFn)(void* ptr);
-    typedef void (*LHM_ShutdownFn)();
-    
-    LHM_InitializeFn m_initializeFn;
-    LHM_PollFn m_pollFn;
-    LHM_FreeStringFn m_freeStringFn;
-    LHM_ShutdownFn m_shutdownFn;
+    // Bridge functions (loaded from the managed assembly, or supplied)
+    BridgeApi m_api;
+    // Poll(buffer, ...) counters; read without the poll lock
+    std::atomic<uint64_t> m_bufferPolls;
+    std::atomic<uint64_t> m_bufferCopies;
+    std::atomic<uint64_t> m_bufferCopiedBytes;
+    std::atomic<uint64_t> m_bufferAllocations;
+    
+    /**
+     * Fill m_api from LibreHardwareMonitorBridge.dll (Windows only)
+     * @returns true on success
+     */
+    bool LoadManagedBridge();
+    
+    /**
+     * Resolve one static method of HardwareMonitorBridge
+     * @param bridgeDllPath - full path to LibreHardwareMonitorBridge.dll
+     * @param methodName - managed method name (delegate type is <methodName>Delegate)
+     * @param fn - output function pointer
+     * @returns true on success
+     */
+    bool LoadBridgeFunction(const wchar_t* bridgeDllPath, const wchar_t* methodName, void** fn);
 };
@@ -0,0 +1,370 @@
+#include "history_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+// Largest-Triangle-Three-Buckets over n points (n > points >= 3)
+void Lttb(const double* x, const float* y, size_t n, uint32_t points, HistorySeries& out) {
+	out.timestamps.reserve(points);
+	out.values.reserve(points);
+	out.timestamps.push_back(x[0]);
+	out.values.push_back(y[0]);
+
+	double every = (double)(n - 2) / (points - 2);
+	size_t a = 0;
+	for (uint32_t i = 0; i < points - 2; i++) {
+		// Average of the next bucket (the last point for the last bucket)
+		size_t nextStart = (size_t)((i + 1) * every) + 1;
+		size_t nextEnd = std::min((size_t)((i + 2) * every) + 1, n);
+		if (nextStart >= nextEnd) {
+			nextStart = n - 1;
+			nextEnd = n;
+		}
+		double avgX = 0, avgY = 0;
+		for (size_t j = nextStart; j < nextEnd; j++) {
+			avgX += x[j];
+			avgY += y[j];
+		}
+		avgX /= (double)(nextEnd - nextStart);
+		avgY /= (double)(nextEnd - nextStart);
+
+		// Point of this bucket spanning the largest triangle with the previous pick
+		size_t start = (size_t)(i * every) + 1;
+		size_t end = std::min((size_t)((i + 1) * every) + 1, n - 1);
+		double ax = x[a], ay = y[a];
+		double best = -1;
+		size_t pick = start;
+		for (size_t j = start; j < end; j++) {
+			double area = std::fabs((ax - avgX) * (y[j] - ay) - (ax - x[j]) * (avgY - ay));
+			if (area > best) {
+				best = area;
+				pick = j;
+			}
+		}
+		out.timestamps.push_back(x[pick]);
+		out.values.push_back(y[pick]);
+		a = pick;
+	}
+
+	out.timestamps.push_back(x[n - 1]);
+	out.values.push_back(y[n - 1]);
+}
+
+// Minimum and maximum of each bucket of rows, in the order they occurred
+void MinMax(const double* times, const float* values, const std::vector<size_t>& bucketStarts,
+            HistorySeries& out) {
+	for (size_t b = 0; b + 1 < bucketStarts.size(); b++) {
+		size_t start = bucketStarts[b];
+		size_t end = bucketStarts[b + 1];
+		// Comparisons with NaN are false, so gaps drop out; the loop has no
+		// branches and vectorizes
+		float low = std::numeric_limits<float>::infinity();
+		float high = -std::numeric_limits<float>::infinity();
+		for (size_t r = start; r < end; r++) {
+			float v = values[r];
+			low = v < low ? v : low;
+			high = v > high ? v : high;
+		}
+		if (!(low <= high)) {
+			continue;  // Empty bucket, or only NaN
+		}
+
+		size_t lowAt = start, highAt = start;
+		while (values[lowAt] != low) lowAt++;
+		while (values[highAt] != high) highAt++;
+		size_t first = std::min(lowAt, highAt);
+		size_t second = std::max(lowAt, highAt);
+		out.timestamps.push_back(times[first]);
+		out.values.push_back(values[first]);
+		if (second != first) {
+			out.timestamps.push_back(times[second]);
+			out.values.push_back(values[second]);
+		}
+	}
+}
+
+} // namespace
+
+HistoryStore::HistoryStore(const HistoryConfig& config)
+	: m_config(config)
+{
+	Reset();
+}
+
+void HistoryStore::Configure(const HistoryConfig& config) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (config.capacity == m_config.capacity) {
+		m_config = config;
+		return;
+	}
+	HistorySnapshot snapshot;
+	ExportLocked(snapshot);
+	m_config = config;
+	ImportLocked(snapshot);
+}
+
+void HistoryStore::Export(HistorySnapshot& snapshot) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	ExportLocked(snapshot);
+}
+
+void HistoryStore::Import(const HistorySnapshot& snapshot) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	ImportLocked(snapshot);
+}
+
+void HistoryStore::ExportLocked(HistorySnapshot& snapshot) const {
+	size_t capacity = m_config.capacity;
+	snapshot.config = m_config;
+	snapshot.times.resize(m_count);
+	GatherLocked(m_times.data(), 0, m_count, snapshot.times.data());
+	snapshot.ids.clear();
+	snapshot.ids.reserve(m_columns.size());
+	snapshot.values.resize(m_columns.size() * m_count);
+	float* out = snapshot.values.data();
+	for (const auto& entry : m_columns) {
+		snapshot.ids.push_back(entry.first);
+		GatherLocked(m_values.data() + (size_t)entry.second * capacity, 0, m_count, out);
+		out += m_count;
+	}
+}
+
+void HistoryStore::ImportLocked(const HistorySnapshot& snapshot) {
+	Reset();
+	size_t capacity = m_config.capacity;
+	size_t rows = snapshot.times.size();
+	size_t skip = rows > capacity ? rows - capacity : 0;
+	size_t kept = rows - skip;
+	if (snapshot.values.size() < snapshot.ids.size() * rows) {
+		return;
+	}
+
+	std::copy(snapshot.times.begin() + skip, snapshot.times.end(), m_times.begin());
+	m_values.assign(snapshot.ids.size() * capacity, kNaN);
+	for (size_t c = 0; c < snapshot.ids.size(); c++) {
+		const float* column = snapshot.values.data() + c * rows + skip;
+		std::copy(column, column + kept, m_values.begin() + c * capacity);
+		m_columns.emplace(snapshot.ids[c], (uint32_t)c);
+	}
+	m_count = kept;
+	m_head = kept % capacity;
+	m_written = kept;
+	// Every column counts as written just now; the next sample binds them
+	m_lastWritten.assign(snapshot.ids.size(), m_written);
+}
+
+void HistoryStore::Reset() {
+	m_times.assign(m_config.capacity, 0);
+	m_values.clear();
+	m_head = 0;
+	m_count = 0;
+	m_written = 0;
+	m_columns.clear();
+	m_free.clear();
+	m_lastWritten.clear();
+	m_schema.reset();
+	m_columnOf.clear();
+	m_orphans.clear();
+}
+
+void HistoryStore::BindLocked(const SampleFrame& frame) {
+	const SensorSchema& schema = *frame.schema;
+	size_t capacity = m_config.capacity;
+	size_t columnCount = m_lastWritten.size();
+	std::vector<uint8_t> used(columnCount, 0);
+
+	m_columnOf.resize(schema.sensors.size());
+	for (size_t i = 0; i < schema.sensors.size(); i++) {
+		const std::string& id = schema.sensors[i].id;
+		auto found = m_columns.find(id);
+		uint32_t column;
+		if (found != m_columns.end()) {
+			column = found->second;
+		} else if (!m_free.empty()) {
+			column = m_free.back();   // All NaN already
+			m_free.pop_back();
+			m_columns.emplace(id, column);
+		} else {
+			column = (uint32_t)m_lastWritten.size();
+			m_values.resize(m_values.size() + capacity, kNaN);
+			m_lastWritten.push_back(0);
+			used.push_back(0);
+			m_columns.emplace(id, column);
+		}
+		m_columnOf[i] = column;
+		used[column] = 1;
+	}
+
+	// Columns of sensors that went away read NaN from now on
+	m_orphans.clear();
+	for (const auto& entry : m_columns) {
+		if (!used[entry.second]) {
+			m_orphans.push_back(entry.second);
+		}
+	}
+	m_schema = frame.schema;
+}
+
+void HistoryStore::OnSample(const SampleFrame& frame) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!frame.schema) {
+		return;
+	}
+	size_t capacity = m_config.capacity;
+	double last = m_count > 0 ? m_times[(m_head + capacity - 1) % capacity] : -std::numeric_limits<double>::infinity();
+	if (m_count > 0 && frame.timestamp - last < m_config.minIntervalMs) {
+		return;
+	}
+	if (frame.schema != m_schema) {
+		BindLocked(frame);
+	}
+
+	// Wall clock steps backwards would break the time search
+	m_times[m_head] = std::max(frame.timestamp, last);
+	size_t count = std::min(frame.count, m_columnOf.size());
+	for (size_t i = 0; i < count; i++) {
+		uint32_t column = m_columnOf[i];
+		m_values[column * capacity + m_head] = frame.values[i];
+		m_lastWritten[column] = m_written;
+	}
+	for (size_t i = 0; i < m_orphans.size(); i++) {
+		uint32_t column = m_orphans[i];
+		m_values[column * capacity + m_head] = kNaN;
+		// Every value overwritten: give the column back
+		if (m_written - m_lastWritten[column] >= capacity) {
+			for (auto it = m_columns.begin(); it != m_columns.end(); ++it) {
+				if (it->second == column) {
+					m_columns.erase(it);
+					break;
+				}
+			}
+			m_free.push_back(column);
+			m_orphans[i--] = m_orphans.back();
+			m_orphans.pop_back();
+		}
+	}
+
+	m_head = (m_head + 1) % capacity;
+	m_count = std::min(m_count + 1, capacity);
+	m_written++;
+}
+
+template <typename T>
+void HistoryStore::GatherLocked(const T* ring, size_t first, size_t count, T* out) const {
+	size_t capacity = m_config.capacity;
+	size_t start = (m_head + capacity - m_count + first) % capacity;
+	size_t head = std::min(count, capacity - start);
+	std::memcpy(out, ring + start, head * sizeof(T));
+	std::memcpy(out + head, ring, (count - head) * sizeof(T));
+}
+
+void HistoryStore::RangeLocked(double from, double to, size_t& first, size_t& rows) const {
+	size_t capacity = m_config.capacity;
+	size_t oldest = (m_head + capacity - m_count) % capacity;
+	auto timeAt = [&](size_t row) { return m_times[(oldest + row) % capacity]; };
+
+	size_t low = 0, high = m_count;
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (timeAt(mid) < from) low = mid + 1; else high = mid;
+	}
+	first = low;
+	high = m_count;
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (timeAt(mid) <= to) low = mid + 1; else high = mid;
+	}
+	rows = low - first;
+}
+
+void HistoryStore::Window(const std::vector<std::string>& ids, double from, double to, HistoryWindow& window) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t capacity = m_config.capacity;
+	size_t first, rows;
+	RangeLocked(from, to, first, rows);
+
+	window.times.resize(rows);
+	GatherLocked(m_times.data(), first, rows, window.times.data());
+	window.known.assign(ids.size(), 0);
+	window.values.resize(ids.size() * rows);
+	for (size_t s = 0; s < ids.size(); s++) {
+		float* out = window.values.data() + s * rows;
+		auto found = m_columns.find(ids[s]);
+		if (found == m_columns.end()) {
+			std::fill(out, out + rows, kNaN);
+			continue;
+		}
+		window.known[s] = 1;
+		GatherLocked(m_values.data() + (size_t)found->second * capacity, first, rows, out);
+	}
+}
+
+void HistoryStore::Query(const std::vector<std::string>& ids, double from, double to, uint32_t points,
+                         HistoryMethod method, HistoryResult& result) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t capacity = m_config.capacity;
+	size_t first, rows;
+	RangeLocked(from, to, first, rows);
+
+	result.rows = (uint32_t)rows;
+	result.series.assign(ids.size(), HistorySeries());
+	std::vector<double> times(rows);
+	GatherLocked(m_times.data(), first, rows, times.data());
+
+	// Bucket bounds in rows, shared by every sensor (min/max)
+	std::vector<size_t> bucketStarts;
+	if (method == HistoryMethod::kMinMax && rows > points) {
+		uint32_t buckets = std::max<uint32_t>(points / 2, 1);
+		double span = times[rows - 1] - times[0];
+		bucketStarts.reserve(buckets + 1);
+		size_t row = 0;
+		for (uint32_t b = 0; b < buckets; b++) {
+			bucketStarts.push_back(row);
+			double end = times[0] + span * (b + 1) / buckets;
+			while (row < rows && (times[row] < end || b + 1 == buckets)) row++;
+		}
+		bucketStarts.push_back(rows);
+	}
+
+	std::vector<float> values(rows);
+	std::vector<double> x;
+	std::vector<float> y;
+	for (size_t s = 0; s < ids.size(); s++) {
+		HistorySeries& series = result.series[s];
+		series.id = ids[s];
+		auto found = m_columns.find(ids[s]);
+		if (found == m_columns.end()) {
+			continue;
+		}
+		series.known = true;
+		GatherLocked(m_values.data() + (size_t)found->second * capacity, first, rows, values.data());
+
+		if (rows <= points) {
+			series.timestamps = times;
+			series.values = values;
+		} else if (method == HistoryMethod::kMinMax) {
+			MinMax(times.data(), values.data(), bucketStarts, series);
+		} else {
+			// LTTB over the sensor's non-NaN samples
+			x.clear();
+			y.clear();
+			for (size_t r = 0; r < rows; r++) {
+				if (!std::isnan(values[r])) {
+					x.push_back(times[r]);
+					y.push_back(values[r]);
+				}
+			}
+			if (x.size() <= points) {
+				series.timestamps = x;
+				series.values = y;
+			} else {
+				Lttb(x.data(), y.data(), x.size(), points, series);
+			}
+		}
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "monitor_backend.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * History configuration (process-wide)
+ */
+struct HistoryConfig {
+    uint32_t capacity = 3600;      // Samples kept per sensor; the oldest are overwritten
+    double minIntervalMs = 0;      // Samples closer than this to the previous one are skipped
+};
+
+/**
+ * Downsampling of a history query
+ */
+enum class HistoryMethod {
+    kLttb,      // Largest-Triangle-Three-Buckets: the points that keep the line's shape
+    kMinMax     // Per time bucket the minimum and the maximum, in time order
+};
+
+/**
+ * One sensor's downsampled series
+ */
+struct HistorySeries {
+    std::string id;
+    bool known = false;                // Sensor has a column in the store
+    std::vector<double> timestamps;    // ms since Unix epoch
+    std::vector<float> values;
+};
+
+/**
+ * Result of a history query
+ */
+struct HistoryResult {
+    uint32_t rows = 0;                 // Stored samples inside the window
+    std::vector<HistorySeries> series;
+};
+
+/**
+ * Raw rows of a few sensors between two times
+ */
+struct HistoryWindow {
+    std::vector<double> times;         // ms since Unix epoch, oldest first
+    std::vector<uint8_t> known;        // Per id: it has a column in the store
+    std::vector<float> values;         // times.size() per id, id-major; NaN for unknown ids
+};
+
+/**
+ * Complete contents of a history store, for persistence
+ */
+struct HistorySnapshot {
+    HistoryConfig config;
+    std::vector<double> times;         // Stored rows, oldest first
+    std::vector<std::string> ids;      // Every column, including sensors that went away
+    std::vector<float> values;         // times.size() per id, id-major
+};
+
+/**
+ * History Store - ring buffer of recent samples for charting
+ *
+ * Attached to the backend as a SampleListener. Values are stored column-major,
+ * one ring of capacity floats per sensor id, next to one ring of timestamps,
+ * so a query reads each sensor's window as at most two contiguous runs. Columns
+ * follow sensor ids across schema generations; a sensor that disappears reads
+ * NaN from then on, and its column is freed once all its values have been
+ * overwritten.
+ *
+ * Queries downsample natively to a fixed number of points per sensor: LTTB,
+ * or min/max per time bucket (one vectorizable min/max pass per bucket, then
+ * a scan for their positions). NaN values are gaps and never selected.
+ */
+class HistoryStore : public SampleListener {
+public:
+    explicit HistoryStore(const HistoryConfig& config);
+
+    void OnSample(const SampleFrame& frame) override;
+
+    /**
+     * Replace the configuration; a new capacity keeps the newest samples that fit
+     */
+    void Configure(const HistoryConfig& config);
+
+    /**
+     * Every stored row of sensors between two times, without downsampling
+     * @param from, to - ms since Unix epoch, inclusive
+     */
+    void Window(const std::vector<std::string>& ids, double from, double to, HistoryWindow& window);
+
+    /**
+     * Copy out every stored row and column
+     */
+    void Export(HistorySnapshot& snapshot);
+
+    /**
+     * Replace the contents with a snapshot's newest rows that fit the capacity
+     * Columns attach to sensors by id on the next sample.
+     */
+    void Import(const HistorySnapshot& snapshot);
+
+    /**
+     * Downsampled values of sensors between two times
+     * Windows with at most `points` samples come back as stored. Safe to call
+     * while OnSample runs on the sampling thread.
+     * @param ids - sensor identifiers; unknown ones get empty series
+     * @param from, to - ms since Unix epoch, inclusive
+     * @param points - points per series (at least 3 for LTTB, 2 for min/max)
+     */
+    void Query(const std::vector<std::string>& ids, double from, double to, uint32_t points,
+               HistoryMethod method, HistoryResult& result);
+
+private:
+    void Reset();
+    void ExportLocked(HistorySnapshot& snapshot) const;
+    void ImportLocked(const HistorySnapshot& snapshot);
+    void BindLocked(const SampleFrame& frame);
+    // Logical rows with from <= time <= to
+    void RangeLocked(double from, double to, size_t& first, size_t& rows) const;
+    // Copy logical rows [first, first + count) of a ring (capacity entries) into out
+    template <typename T>
+    void GatherLocked(const T* ring, size_t first, size_t count, T* out) const;
+
+    std::mutex m_mutex;
+    HistoryConfig m_config;
+
+    std::vector<double> m_times;       // capacity, non-decreasing in logical order
+    std::vector<float> m_values;       // capacity per column, column-major
+    size_t m_head = 0;                 // Physical row the next sample goes to
+    size_t m_count = 0;                // Stored rows
+    uint64_t m_written = 0;            // Rows ever written
+
+    std::unordered_map<std::string, uint32_t> m_columns;    // Sensor id -> column
+    std::vector<uint32_t> m_free;                           // Columns to reuse
+    std::vector<uint64_t> m_lastWritten;                    // Per column: m_written of its last value
+    std::shared_ptr<const SensorSchema> m_schema;
+    std::vector<uint32_t> m_columnOf;                       // Per value position of m_schema
+    std::vector<uint32_t> m_orphans;                        // Columns not in m_schema (written NaN)
+};
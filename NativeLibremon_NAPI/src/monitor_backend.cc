@@ -0,0 +1,807 @@
+#include "monitor_backend.h"
+#include "history_store.h"
+#include "state_file.h"
+#ifdef _WIN32
+#include "clr_host.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <malloc.h>
+#include <mmsystem.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Bytes in use on the C runtime heap (the addon's and the CLR host's native
+// allocations), -1 where the runtime cannot report it
+int64_t NativeHeapBytes() {
+#ifdef _WIN32
+	_HEAPINFO entry;
+	entry._pentry = nullptr;
+	int64_t used = 0;
+	int status;
+	while ((status = _heapwalk(&entry)) == _HEAPOK) {
+		if (entry._useflag == _USEDENTRY) {
+			used += (int64_t)entry._size;
+		}
+	}
+	return status == _HEAPEND ? used : -1;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+	return (int64_t)(info.uordblks + info.hblkhd);
+#else
+	return -1;
+#endif
+}
+
+// Category bit index of a LibreHardwareMonitor HardwareType name
+// (mirrors the bridge's GetCategoryBit)
+int CategoryIndexOf(const std::string& type) {
+	if (type == "Cpu") return 0;
+	if (type == "GpuNvidia" || type == "GpuAmd" || type == "GpuIntel") return 1;
+	if (type == "Motherboard" || type == "SuperIO" || type == "EmbeddedController") return 2;
+	if (type == "Memory") return 3;
+	if (type == "Storage") return 4;
+	if (type == "Network") return 5;
+	if (type == "Psu") return 6;
+	if (type == "Cooler") return 7;
+	if (type == "Battery") return 8;
+	return 9;
+}
+
+// Largest burst buffer (values) CaptureBurst will allocate
+const size_t kMaxBurstValues = 16u << 20;
+
+// How often a cancellable poll waiting for another one checks whether it is still wanted
+const std::chrono::milliseconds kPollWaitSlice(5);
+// Poll buffers kept for reuse: enough for the polls usually in flight at once
+const size_t kPollBuffersKept = 4;
+// Share of the time left that a poll with a deadline keeps back from the bridge's
+// hardware updates, at least, for serializing the tree and handing it over
+const int64_t kPollMarginDivisor = 4;
+
+// Millisecond sleeps for the lifetime of the object; Windows otherwise
+// rounds them up to the 15.6 ms system tick
+struct TimerResolution {
+	TimerResolution() {
+#ifdef _WIN32
+		timeBeginPeriod(1);
+#endif
+	}
+	~TimerResolution() {
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+};
+
+} // namespace
+
+std::mutex MonitorBackend::s_mutex;
+MonitorBackend* MonitorBackend::s_instance = nullptr;
+CLRHost* MonitorBackend::s_clrHost = nullptr;
+
+MonitorBackend::MonitorBackend(const HardwareConfig& config)
+	: m_refCount(1)
+	, m_config(config)
+	, m_api(nullptr)
+	, m_hardwareMonitor(nullptr)
+	, m_sampler(new Sampler(this))
+	, m_derivedVersion(0)
+	, m_bridgeGeneration(0)
+	, m_generation(0)
+	, m_baseHardwareCount(0)
+	, m_baseSensorCount(0)
+	, m_sequence(0)
+	, m_pollCount(0)
+	, m_sampleCount(0)
+	, m_pollsAborted(0)
+	, m_pollsTimedOut(0)
+	, m_pollsDropped(0)
+	, m_pollsAbandoned(0)
+	, m_pollsTruncated(0)
+	, m_pollOverrunUs(0)
+	, m_listenerCount(0)
+	, m_lookups(false)
+	, m_latestTimestamp(0)
+{
+}
+
+MonitorBackend::~MonitorBackend() {
+	// Sampler thread calls back into the monitor; stop it first
+	m_sampler->Stop();
+
+	// Last image, while the history and baselines it collects still exist
+	if (m_state) {
+		RemoveListener(m_state.get());
+		m_state->Stop();
+		m_state.reset();
+	}
+
+	if (m_hardwareMonitor != nullptr) {
+		m_hardwareMonitor->Shutdown();
+		delete m_hardwareMonitor;
+		m_hardwareMonitor = nullptr;
+	}
+}
+
+MonitorBackend* MonitorBackend::Acquire(const HardwareConfig& config, std::string& error,
+                                       const BridgeApi* api) {
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	if (s_instance != nullptr) {
+		if (s_instance->m_config != config) {
+			error = "Hardware monitor already running in this process with a different configuration";
+			return nullptr;
+		}
+		if (s_instance->m_api != api) {
+			error = "Hardware monitor already running in this process with a different bridge (hostfxr, native or replay)";
+			return nullptr;
+		}
+		s_instance->m_refCount++;
+		return s_instance;
+	}
+
+	MonitorBackend* backend = nullptr;
+	if (api != nullptr) {
+		backend = new MonitorBackend(config);
+		backend->m_api = api;
+		backend->m_hardwareMonitor = new HardwareMonitor(*api);
+	} else {
+#ifdef _WIN32
+		if (s_clrHost == nullptr) {
+			CLRHost* host = new CLRHost();
+			if (!host->Initialize()) {
+				delete host;
+				error = "Failed to initialize .NET runtime";
+				return nullptr;
+			}
+			s_clrHost = host;
+		}
+
+		backend = new MonitorBackend(config);
+		backend->m_hardwareMonitor = new HardwareMonitor(s_clrHost);
+#else
+		error = "The managed bridge requires Windows";
+		return nullptr;
+#endif
+	}
+	if (!backend->m_hardwareMonitor->Initialize(config)) {
+		delete backend;
+		error = "Failed to initialize hardware monitor";
+		return nullptr;
+	}
+
+	s_instance = backend;
+	return backend;
+}
+
+void MonitorBackend::AddRef() {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	m_refCount++;
+}
+
+void MonitorBackend::Release() {
+	// Shutdown happens under s_mutex so a concurrent Acquire() cannot start
+	// a new Computer while the managed bridge is still closing this one
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (--m_refCount > 0) {
+		return;
+	}
+
+	if (s_instance == this) {
+		s_instance = nullptr;
+	}
+	delete this;
+}
+
+std::string MonitorBackend::Poll() {
+	std::string json;
+	Poll(json);
+	return json;
+}
+
+void MonitorBackend::Poll(std::string& json, uint32_t filterPresets) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	PollLocked(-1, filterPresets, json);
+}
+
+bool MonitorBackend::Poll(PollControl& control, std::string& json, uint32_t filterPresets) {
+	// Wait for the poll in flight in slices, giving up once this one is not wanted
+	std::unique_lock<std::timed_mutex> lock(m_pollMutex, std::defer_lock);
+	while (!lock.try_lock_for(kPollWaitSlice)) {
+		if (control.Check() != PollControl::kActive) {
+			return false;
+		}
+	}
+	if (control.Check() != PollControl::kActive) {
+		return false;
+	}
+
+	if (!control.hasDeadline) {
+		PollLocked(-1, filterPresets, json);
+		return true;
+	}
+
+	// The bridge stops updating hardware at the budget, then still has to write
+	// the tree; keep back a quarter of the time left, or what that tail took on
+	// recent truncated polls if more, so that the poll lands before the deadline
+	auto start = std::chrono::steady_clock::now();
+	int64_t leftUs = std::chrono::duration_cast<std::chrono::microseconds>(control.deadline - start).count();
+	int64_t marginUs = std::max<int64_t>(leftUs / kPollMarginDivisor, m_pollOverrunUs.load());
+	int32_t budgetMs = (int32_t)std::max<int64_t>(0, std::min<int64_t>((leftUs - marginUs) / 1000, INT32_MAX));
+	int32_t skipped = PollLocked(budgetMs, filterPresets, json);
+	if (skipped > 0) {
+		int64_t overrunUs = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count() - (int64_t)budgetMs * 1000;
+		// Smoothed over about 8 polls
+		int64_t smoothed = m_pollOverrunUs.load();
+		m_pollOverrunUs.store(smoothed + (std::max<int64_t>(0, overrunUs) - smoothed) / 8);
+	}
+	return true;
+}
+
+std::string MonitorBackend::AcquirePollBuffer() {
+	std::lock_guard<std::mutex> lock(m_bufferMutex);
+	if (m_pollBuffers.empty()) {
+		return std::string();
+	}
+	std::string buffer = std::move(m_pollBuffers.back());
+	m_pollBuffers.pop_back();
+	return buffer;
+}
+
+void MonitorBackend::ReleasePollBuffer(std::string&& buffer) {
+	// Not cleared: the next poll writes over the text instead of zero-filling it again
+	std::lock_guard<std::mutex> lock(m_bufferMutex);
+	if (m_pollBuffers.size() < kPollBuffersKept) {
+		m_pollBuffers.push_back(std::move(buffer));
+	}
+}
+
+void MonitorBackend::CountCancelledPoll(const PollControl& control, bool ran) {
+	(control.state.load() == PollControl::kAborted ? m_pollsAborted : m_pollsTimedOut)++;
+	(ran ? m_pollsAbandoned : m_pollsDropped)++;
+}
+
+int32_t MonitorBackend::PollLocked(int32_t budgetMs, uint32_t filterPresets, std::string& json) {
+	int32_t skipped = 0;
+	m_hardwareMonitor->Poll(json, budgetMs, filterPresets, skipped);
+	if (skipped > 0) {
+		m_pollsTruncated++;
+	}
+	m_pollCount++;
+
+	// The poll already updated the hardware; reading the values is cheap
+	bool derived = !m_derived.Empty();
+	if (derived || m_listenerCount.load() > 0 || m_lookups.load() || m_anomalies.Enabled()) {
+		ReadValuesLocked(kCategoryAll);
+		PublishLocked();
+	}
+	if (derived) {
+		// Node ids past anything the bridge can have used (one per hardware, group and sensor)
+		int firstNodeId = 2 + (int)(m_baseHardwareCount + 2 * m_baseSensorCount);
+		m_derived.InsertIntoPollJson(json, firstNodeId, m_values.data(), m_baseSensorCount);
+	}
+	return skipped;
+}
+
+void MonitorBackend::Sample() {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	m_hardwareMonitor->Update(kCategoryAll);
+	ReadValuesLocked(kCategoryAll);
+	PublishLocked();
+}
+
+void MonitorBackend::Sample(uint32_t categoryMask, uint64_t* cpuTicks, double* changes) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	for (int i = 0; i < kCategoryCount; i++) {
+		uint32_t bit = 1u << i;
+		if ((categoryMask & bit) == 0) {
+			continue;
+		}
+		uint64_t start = ThreadCpu::Ticks();
+		m_hardwareMonitor->Update(bit);
+		cpuTicks[i] += ThreadCpu::Ticks() - start;
+	}
+	ReadValuesLocked(categoryMask);
+	PublishLocked();
+	if (changes != nullptr) {
+		MeasureChangesLocked(categoryMask, changes);
+	}
+}
+
+void MonitorBackend::CaptureBurst(const std::vector<std::string>& sensorIds, uint32_t intervalMs,
+                                  uint32_t durationMs, BurstCapture& capture) {
+	using clock = std::chrono::steady_clock;
+	if (sensorIds.empty()) {
+		throw std::invalid_argument("No sensors selected");
+	}
+	if (intervalMs == 0) {
+		intervalMs = 1;
+	}
+
+	std::vector<int32_t> sensors;
+	std::vector<int32_t> hardware;
+	uint32_t categoryMask = 0;
+	int32_t generation;
+	size_t sensorCount;
+	{
+		std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+		RefreshSchemaLocked();
+		std::unordered_map<std::string, int32_t> index;
+		for (size_t i = 0; i < m_schema->sensors.size(); i++) {
+			index.emplace(m_schema->sensors[i].id, (int32_t)i);
+		}
+		for (const std::string& id : sensorIds) {
+			auto it = index.find(id);
+			if (it == index.end()) {
+				throw std::invalid_argument("Unknown sensor: " + id);
+			}
+			if ((size_t)it->second >= m_baseSensorCount) {
+				throw std::invalid_argument("Derived sensors cannot be captured in a burst: " + id);
+			}
+			sensors.push_back(it->second);
+			int32_t owner = m_schema->sensors[it->second].hardware;
+			if (std::find(hardware.begin(), hardware.end(), owner) == hardware.end()) {
+				hardware.push_back(owner);
+			}
+			categoryMask |= 1u << m_sensorCategory[it->second];
+		}
+		generation = m_bridgeGeneration;
+		sensorCount = m_baseSensorCount;
+	}
+
+	// Preallocate everything; the loop itself does not allocate
+	size_t columns = sensors.size();
+	size_t rows = std::max<size_t>(1, (durationMs + intervalMs - 1) / intervalMs);
+	if (rows * columns > kMaxBurstValues) {
+		throw std::invalid_argument("Burst too large; shorten it or select fewer sensors");
+	}
+	capture = BurstCapture();
+	capture.sensors = sensorIds;
+	capture.intervalMs = intervalMs;
+	capture.timestamps.reserve(rows);
+	capture.values.reserve(rows * columns);
+	std::vector<float> all;  // Full value vector, if the bridge cannot read single sensors
+	std::vector<float> row(columns);
+	bool singleHardware = true;
+
+	TimerResolution resolution;
+	const auto interval = std::chrono::milliseconds(intervalMs);
+	const auto start = clock::now();
+	capture.startedAt = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+
+	for (uint64_t tick = 0; capture.timestamps.size() < rows;) {
+		{
+			std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+			if (m_hardwareMonitor->GetSchemaGeneration() != generation) {
+				capture.truncated = true;
+				break;
+			}
+			if (!singleHardware || !m_hardwareMonitor->UpdateHardware(hardware.data(), (int32_t)hardware.size())) {
+				singleHardware = false;
+				m_hardwareMonitor->Update(categoryMask);
+			}
+
+			int32_t read = m_hardwareMonitor->ReadSensorValues(sensors.data(), row.data(), (int32_t)columns);
+			if (read == -1) {
+				all.resize(sensorCount);
+				read = m_hardwareMonitor->ReadValues(all.data(), nullptr, nullptr, (int32_t)all.size());
+				if (read >= 0) {
+					for (size_t i = 0; i < columns; i++) {
+						row[i] = sensors[i] < read ? all[sensors[i]] : NAN;
+					}
+				}
+			}
+			if (read < 0) {
+				capture.truncated = true;
+				break;
+			}
+		}
+
+		auto now = clock::now();
+		capture.timestamps.push_back(std::chrono::duration<double, std::milli>(now - start).count());
+		capture.values.insert(capture.values.end(), row.begin(), row.end());
+
+		// Keep the grid: skip ticks an overrunning update already ran into
+		uint64_t due = (uint64_t)((now - start) / interval) + 1;
+		if (due > tick + 1) {
+			capture.missed += (uint32_t)(due - tick - 1);
+		}
+		tick = std::max(tick + 1, due);
+		if (tick >= rows) {
+			break;
+		}
+		std::this_thread::sleep_until(start + interval * tick);
+	}
+}
+
+double MonitorBackend::GetValues(const std::vector<std::string>& ids, float* values) {
+	EnableLookups();
+	std::lock_guard<std::mutex> lock(m_latestMutex);
+	for (size_t i = 0; i < ids.size(); i++) {
+		int position = m_latestIndex->Find(ids[i]);
+		values[i] = position >= 0 && (size_t)position < m_latestValues.size() ? m_latestValues[position] : NAN;
+	}
+	return m_latestTimestamp;
+}
+
+std::shared_ptr<const SensorIndex> MonitorBackend::Query(const SensorQuery& query, std::vector<uint32_t>& positions,
+                                                         std::vector<float>& values) {
+	EnableLookups();
+	std::lock_guard<std::mutex> lock(m_latestMutex);
+	m_latestIndex->Select(query, positions);
+	values.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); i++) {
+		values[i] = positions[i] < m_latestValues.size() ? m_latestValues[positions[i]] : NAN;
+	}
+	return m_latestIndex;
+}
+
+void MonitorBackend::EnableLookups() {
+	if (m_lookups.load()) {
+		return;
+	}
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	if (m_lookups.load()) {
+		return;
+	}
+	// Nothing was copied before now; start from the values the bridge holds
+	ReadValuesLocked(0);
+	SnapshotLocked((double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0);
+	m_lookups = true;
+}
+
+std::shared_ptr<const SensorSchema> MonitorBackend::GetSchema() {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	RefreshSchemaLocked();
+	return m_schema;
+}
+
+bool MonitorBackend::DefineSensor(const DerivedDefinition& definition, std::string& error) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	RefreshSchemaLocked();
+	return m_derived.Define(definition, *m_schema, m_baseSensorCount, error);
+}
+
+bool MonitorBackend::RemoveSensor(const std::string& name) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	return m_derived.Remove(name);
+}
+
+std::vector<DerivedDefinition> MonitorBackend::GetDerivedSensors() {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	return m_derived.Definitions();
+}
+
+void MonitorBackend::SetAnomalyDetection(const AnomalyConfig* config) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	if (config == nullptr) {
+		m_anomalies.Disable();
+		return;
+	}
+	RefreshSchemaLocked();
+	m_anomalies.Configure(*config);
+	m_anomalies.Bind(m_schema, m_sensorMasks);
+	RestoreBaselinesLocked();
+}
+
+void MonitorBackend::RestoreBaselinesLocked() {
+	if (!m_restoredBaselines || !m_anomalies.Enabled()) {
+		return;
+	}
+	const PersistedState& state = *m_restoredBaselines;
+	m_anomalies.RestoreBaselines(state.ids, state.mean.data(), state.var.data(), state.count.data());
+	m_restoredBaselines.reset();
+}
+
+AnomalyReport MonitorBackend::GetAnomalies(uint64_t sinceSequence) {
+	return m_anomalies.GetReport(sinceSequence);
+}
+
+void MonitorBackend::SetHistory(const HistoryConfig* config) {
+	std::lock_guard<std::mutex> lock(m_historyMutex);
+	if (config == nullptr) {
+		if (m_history) {
+			RemoveListener(m_history.get());
+			m_history.reset();
+		}
+		return;
+	}
+	if (m_history) {
+		m_history->Configure(*config);
+		return;
+	}
+	m_history = std::make_shared<HistoryStore>(*config);
+	AddListener(m_history.get());
+}
+
+std::shared_ptr<HistoryStore> MonitorBackend::GetHistory() {
+	std::lock_guard<std::mutex> lock(m_historyMutex);
+	return m_history;
+}
+
+bool MonitorBackend::AttachState(const StateOptions& options, std::string& error) {
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+	if (m_state) {
+		if (m_state->Options().path != options.path) {
+			error = "A different state file is attached: " + m_state->Options().path;
+			return false;
+		}
+		return true;
+	}
+
+	auto restored = std::unique_ptr<PersistedState>(new PersistedState());
+	std::unique_ptr<StatePersister> persister = StatePersister::Open(options, *restored, error);
+	if (!persister) {
+		return false;
+	}
+
+	// History samples go into a new store; one another environment already
+	// started keeps its own
+	if (restored->history.config.capacity > 0) {
+		std::lock_guard<std::mutex> historyLock(m_historyMutex);
+		if (!m_history) {
+			m_history = std::make_shared<HistoryStore>(restored->history.config);
+			m_history->Import(restored->history);
+			AddListener(m_history.get());
+		}
+		restored->history = HistorySnapshot();
+	}
+	{
+		std::lock_guard<std::timed_mutex> pollLock(m_pollMutex);
+		m_restoredBaselines = std::move(restored);
+		RestoreBaselinesLocked();
+	}
+
+	m_state = std::move(persister);
+	AddListener(m_state.get());
+	m_state->Start([this](PersistedState& state, const std::unordered_map<std::string, size_t>& slots) {
+		{
+			std::lock_guard<std::timed_mutex> pollLock(m_pollMutex);
+			if (m_anomalies.Enabled()) {
+				m_anomalies.ExportBaselines(slots, state.mean.data(), state.var.data(), state.count.data());
+			}
+		}
+		std::shared_ptr<HistoryStore> history = GetHistory();
+		if (history) {
+			history->Export(state.history);
+		}
+	});
+	return true;
+}
+
+bool MonitorBackend::GetStateStats(StateStats& stats) {
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+	if (!m_state) {
+		return false;
+	}
+	stats = m_state->GetStats();
+	return true;
+}
+
+bool MonitorBackend::GetExtremes(const std::vector<std::string>& ids, float* min, float* max) {
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+	if (!m_state) {
+		return false;
+	}
+	m_state->GetExtremes(ids, min, max);
+	return true;
+}
+
+bool MonitorBackend::SetFilter(const std::string& filterJson) {
+	std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+	// Re-sending an unchanged filter would still rebuild the bridge's schema
+	if (filterJson == m_filterJson) {
+		return true;
+	}
+	if (!m_hardwareMonitor->SetFilter(filterJson)) {
+		return false;
+	}
+	m_filterJson = filterJson;
+	return true;
+}
+
+bool MonitorBackend::Reconfigure(const HardwareConfig& config, std::string& error) {
+	{
+		// m_config is also read by Acquire() and GetConfig()
+		std::lock_guard<std::mutex> instanceLock(s_mutex);
+		std::lock_guard<std::timed_mutex> lock(m_pollMutex);
+		if (config == m_config) {
+			return true;
+		}
+		if (!m_hardwareMonitor->Reconfigure(config)) {
+			error = "The bridge cannot be reconfigured; call shutdown() and init() instead";
+			return false;
+		}
+		m_config = config;
+	}
+
+	// Outside s_mutex: the sampler reads the configuration under its own locks
+	m_sampler->SetEnabledCategories(config.CategoryMask());
+	return true;
+}
+
+HardwareConfig MonitorBackend::GetConfig() const {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	return m_config;
+}
+
+BackendStats MonitorBackend::GetStats() {
+	BackendStats stats;
+	stats.polls = m_pollCount.load();
+	stats.samples = m_sampleCount.load();
+	stats.pollsAborted = m_pollsAborted.load();
+	stats.pollsTimedOut = m_pollsTimedOut.load();
+	stats.pollsDropped = m_pollsDropped.load();
+	stats.pollsAbandoned = m_pollsAbandoned.load();
+	stats.pollsTruncated = m_pollsTruncated.load();
+	stats.pollOverrunUs = m_pollOverrunUs.load();
+	stats.pollBuffer = m_hardwareMonitor->GetPollBufferStats();
+	stats.nativeHeapBytes = NativeHeapBytes();
+	// The GC statistics APIs are thread-safe; no need for m_pollMutex
+	stats.hasManaged = m_hardwareMonitor->GetMemoryStats(stats.managed);
+	return stats;
+}
+
+void MonitorBackend::AddListener(SampleListener* listener) {
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+	m_listeners.push_back(listener);
+	m_listenerCount = m_listeners.size();
+}
+
+void MonitorBackend::RemoveListener(SampleListener* listener) {
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+	m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+	m_listenerCount = m_listeners.size();
+}
+
+void MonitorBackend::RefreshSchemaLocked() {
+	int32_t generation = m_hardwareMonitor->GetSchemaGeneration();
+	if (m_schema && m_bridgeGeneration == generation && m_derivedVersion == m_derived.Version()) {
+		return;
+	}
+
+	auto schema = std::make_shared<SensorSchema>();
+	if (!SensorSchema::Parse(m_hardwareMonitor->GetSchema().c_str(), *schema)) {
+		throw std::runtime_error("Failed to parse sensor schema");
+	}
+	m_bridgeGeneration = generation;
+	m_derivedVersion = m_derived.Version();
+	m_baseHardwareCount = schema->hardware.size();
+	m_baseSensorCount = schema->sensors.size();
+
+	// Sub-hardware is updated with its top-level parent, so it shares its category
+	int hardwareCount = (int)schema->hardware.size();
+	m_sensorCategory.resize(schema->sensors.size());
+	m_sensorMasks.assign(schema->sensors.size(), 0);
+	for (size_t i = 0; i < schema->sensors.size(); i++) {
+		int hw = schema->sensors[i].hardware;
+		for (int depth = 0; hw >= 0 && hw < hardwareCount && schema->hardware[hw].parent >= 0 && depth < 8; depth++) {
+			hw = schema->hardware[hw].parent;
+		}
+		bool known = hw >= 0 && hw < hardwareCount;
+		m_sensorCategory[i] = (uint8_t)(known ? CategoryIndexOf(schema->hardware[hw].type) : kCategoryCount - 1);
+		m_sensorMasks[i] = 1u << m_sensorCategory[i];
+	}
+
+	// Derived sensors follow the bridge's; either side changing is a new generation
+	m_derived.Bind(*schema, m_sensorMasks);
+	schema->generation = ++m_generation;
+	m_values.assign(schema->sensors.size(), 0.0f);
+	m_sampledValues.assign(m_baseSensorCount, NAN);
+	std::shared_ptr<const SensorSchema> previous = std::move(m_schema);
+	m_schema = schema;
+	m_index.reset();
+	if (m_anomalies.Enabled()) {
+		m_anomalies.Bind(m_schema, m_sensorMasks);
+	}
+
+	if (previous && m_listenerCount.load() > 0) {
+		TopologyDiff diff = TopologyDiff::Compute(previous, m_schema);
+		diff.timestamp = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+		std::lock_guard<std::mutex> lock(m_listenerMutex);
+		for (SampleListener* listener : m_listeners) {
+			listener->OnTopology(diff);
+		}
+	}
+}
+
+const std::shared_ptr<const SensorIndex>& MonitorBackend::IndexLocked() {
+	if (!m_index) {
+		m_index = std::make_shared<SensorIndex>(m_schema);
+	}
+	return m_index;
+}
+
+void MonitorBackend::MeasureChangesLocked(uint32_t categoryMask, double* changes) {
+	for (int i = 0; i < kCategoryCount; i++) {
+		changes[i] = NAN;
+	}
+
+	size_t count = std::min(m_values.size(), std::min(m_sampledValues.size(), m_sensorCategory.size()));
+	for (size_t i = 0; i < count; i++) {
+		int category = m_sensorCategory[i];
+		if ((categoryMask & (1u << category)) == 0) {
+			continue;
+		}
+		float value = m_values[i];
+		float previous = m_sampledValues[i];
+		m_sampledValues[i] = value;
+		if (std::isnan(value) || std::isnan(previous)) {
+			continue;
+		}
+		// Relative to the magnitude, but values near zero count in absolute units
+		double change = std::fabs((double)value - previous) / std::max(1.0, std::fabs((double)previous));
+		if (std::isnan(changes[category]) || change > changes[category]) {
+			changes[category] = change;
+		}
+	}
+}
+
+void MonitorBackend::ReadValuesLocked(uint32_t updatedMask) {
+	RefreshSchemaLocked();
+
+	int32_t count = m_hardwareMonitor->ReadValues(m_values.data(), nullptr, nullptr, (int32_t)m_baseSensorCount);
+	if (count < 0) {
+		// Sensors appeared since the schema was read; take the new layout
+		RefreshSchemaLocked();
+		count = m_hardwareMonitor->ReadValues(m_values.data(), nullptr, nullptr, (int32_t)m_baseSensorCount);
+		if (count < 0) {
+			throw std::runtime_error("Sensor layout changed while reading values");
+		}
+	}
+
+	if (!m_derived.Empty()) {
+		double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		m_derived.Evaluate(m_values.data(), m_baseSensorCount, now, updatedMask);
+	}
+	if (updatedMask != 0 && m_anomalies.Enabled()) {
+		double timestamp = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		m_anomalies.Update(m_values.data(), m_values.size(), updatedMask, timestamp);
+	}
+}
+
+void MonitorBackend::PublishLocked() {
+	SampleFrame frame;
+	frame.sequence = ++m_sequence;
+	m_sampleCount++;
+	frame.timestamp = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+	frame.schema = m_schema;
+	frame.values = m_values.data();
+	frame.count = m_values.size();
+	frame.bridgeHardwareCount = m_baseHardwareCount;
+	frame.bridgeSensorCount = m_baseSensorCount;
+
+	if (m_lookups.load()) {
+		SnapshotLocked(frame.timestamp);
+	}
+
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+	for (SampleListener* listener : m_listeners) {
+		listener->OnSample(frame);
+	}
+}
+
+void MonitorBackend::SnapshotLocked(double timestamp) {
+	const std::shared_ptr<const SensorIndex>& index = IndexLocked();
+	std::lock_guard<std::mutex> lock(m_latestMutex);
+	m_latestIndex = index;
+	m_latestValues.assign(m_values.begin(), m_values.end());
+	m_latestTimestamp = timestamp;
+}
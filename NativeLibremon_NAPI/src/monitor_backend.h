@@ -0,0 +1,439 @@
+#pragma once
+
+#include "anomaly_detector.h"
+#include "bridge_api.h"
+#include "derived_sensors.h"
+#include "hardware_monitor.h"
+#include "sampler.h"
+#include "sensor_index.h"
+#include "sensor_schema.h"
+#include "topology_diff.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class HistoryStore;
+struct HistoryConfig;
+class StatePersister;
+struct PersistedState;
+struct StateOptions;
+struct StateStats;
+
+/**
+ * One published sample: the value vector plus the schema it is laid out by
+ * Only valid for the duration of SampleListener::OnSample.
+ */
+struct SampleFrame {
+    uint32_t sequence = 0;
+    double timestamp = 0;      // ms since Unix epoch, taken after the update
+    std::shared_ptr<const SensorSchema> schema;
+    const float* values = nullptr;
+    size_t count = 0;
+    size_t bridgeHardwareCount = 0;  // Leading schema entries from the bridge;
+    size_t bridgeSensorCount = 0;    // the derived ones follow
+};
+
+/**
+ * Cancellation and deadline of one poll
+ * Shared by the poll's worker and the JS side that may abandon it; the first
+ * reason to end the poll wins.
+ */
+struct PollControl {
+    enum State : int { kActive = 0, kAborted = 1, kTimedOut = 2 };
+
+    std::atomic<int> state{ kActive };
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+
+    /**
+     * End the poll (no-op once it has ended)
+     * @returns the final state
+     */
+    int Cancel(State reason) {
+        int expected = kActive;
+        state.compare_exchange_strong(expected, reason);
+        return state.load();
+    }
+
+    /**
+     * Current state; times the poll out once its deadline has passed
+     */
+    int Check() {
+        if (hasDeadline && std::chrono::steady_clock::now() >= deadline) {
+            return Cancel(kTimedOut);
+        }
+        return state.load();
+    }
+};
+
+/**
+ * Backend counters and memory figures for long-running (soak) diagnostics
+ */
+struct BackendStats {
+    uint64_t polls = 0;              // JSON polls served
+    uint64_t samples = 0;            // Value vectors published (sampler ticks and polls)
+    uint64_t pollsAborted = 0;       // Polls cancelled through their AbortSignal
+    uint64_t pollsTimedOut = 0;      // Polls past their deadline before they were delivered
+    uint64_t pollsDropped = 0;       // Of those two, polls that never reached the bridge
+    uint64_t pollsAbandoned = 0;     // Of those two, bridge results discarded unparsed
+    uint64_t pollsTruncated = 0;     // Polls whose bridge skipped hardware to meet the deadline
+    int64_t pollOverrunUs = 0;       // Time those ran past their bridge budget, smoothed
+    PollBufferStats pollBuffer;      // Copies and allocations between bridge and poll buffers
+    int64_t nativeHeapBytes = -1;    // Bytes in use on the C runtime heap, -1 if unknown
+    bool hasManaged = false;
+    ManagedMemoryStats managed;
+};
+
+/**
+ * Result of a high-rate burst on a few sensors (see MonitorBackend::CaptureBurst)
+ */
+struct BurstCapture {
+    std::vector<std::string> sensors;  // Sensor ids, column order of values
+    uint32_t intervalMs = 0;
+    double startedAt = 0;              // ms since Unix epoch at the first sample
+    std::vector<double> timestamps;    // Monotonic ms since the first sample, one per row
+    std::vector<float> values;         // Row-major: timestamps.size() x sensors.size()
+    uint32_t missed = 0;               // Ticks skipped because an update overran the interval
+    bool truncated = false;            // Stopped early: the sensor layout changed
+};
+
+/**
+ * Receives every sample the backend takes (sampler ticks and polls)
+ * Called on the sampling thread with the backend's poll lock held, so
+ * implementations must be quick and must not call back into the backend.
+ */
+class SampleListener {
+public:
+    virtual ~SampleListener() = default;
+    virtual void OnSample(const SampleFrame& frame) = 0;
+
+    /**
+     * A new schema generation replaced the previous one (not called for the first)
+     * Comes before the first sample laid out by the new schema.
+     */
+    virtual void OnTopology(const TopologyDiff&) {}
+};
+
+/**
+ * Monitor Backend - process-wide owner of the hardware monitor
+ * Shared by every Node.js environment that loads the addon (main thread
+ * and worker_threads). Each environment that called init() holds one
+ * reference, as does every in-flight poll; the hardware monitor is shut
+ * down when the last reference is released.
+ */
+class MonitorBackend {
+public:
+    /**
+     * Get a reference to the running backend, starting it if needed
+     * @param config - hardware types to enable (must match a running backend)
+     * @param error - receives a message on failure
+     * @param api - in-process bridge to use instead of the managed one
+     *              (benchmarks, replay); must match a running backend's
+     * @returns backend with one reference held by the caller, or nullptr
+     */
+    static MonitorBackend* Acquire(const HardwareConfig& config, std::string& error,
+                                   const BridgeApi* api = nullptr);
+
+    /**
+     * Take an additional reference (e.g. for an async worker)
+     */
+    void AddRef();
+
+    /**
+     * Drop a reference; the last one shuts the hardware monitor down
+     */
+    void Release();
+
+    /**
+     * Poll all enabled sensors
+     * Serialized: the managed Computer instance is not thread-safe
+     * @returns JSON string matching LibreHardwareMonitor web endpoint format
+     */
+    std::string Poll();
+
+    /**
+     * Poll all enabled sensors into a reusable buffer (see AcquirePollBuffer)
+     * @param json - receives the poll JSON; its capacity is reused
+     * @param filterPresets - FilterPreset bits the bridge leaves out of this poll's tree
+     */
+    void Poll(std::string& json, uint32_t filterPresets = 0);
+
+    /**
+     * Poll unless cancelled, within the deadline of control
+     * Waits for an in-flight poll only as long as the poll is still wanted,
+     * and lets the bridge update hardware for only part of the time left, so
+     * that a truncated tree is still written before the deadline (hardware
+     * it does not reach keeps its previous values).
+     * @param json - receives the poll JSON; its capacity is reused
+     * @param filterPresets - FilterPreset bits the bridge leaves out of this poll's tree
+     * @returns false if the poll was dropped without calling the bridge
+     */
+    bool Poll(PollControl& control, std::string& json, uint32_t filterPresets = 0);
+
+    /**
+     * Take a poll buffer that keeps the capacity of earlier polls
+     * It may still hold an earlier poll's text, which the next poll replaces.
+     * Return it with ReleasePollBuffer once its text has been consumed.
+     */
+    std::string AcquirePollBuffer();
+
+    /**
+     * Hand a poll buffer back for reuse (a few are kept, the rest freed)
+     */
+    void ReleasePollBuffer(std::string&& buffer);
+
+    /**
+     * Count a poll that ended through its control (see BackendStats)
+     * @param ran - the bridge produced a result, which is being discarded
+     */
+    void CountCancelledPoll(const PollControl& control, bool ran);
+
+    /**
+     * Update all hardware and publish the value vector to the listeners
+     * Used by the sampler; builds no JSON.
+     */
+    void Sample();
+
+    /**
+     * Update the selected categories one at a time, then publish
+     * @param categoryMask - HardwareCategory bits to update (0: publish only)
+     * @param cpuTicks - adds the calling thread's ThreadCpu::Ticks spent per category bit index
+     * @param changes - optional; per updated category bit index, the largest relative
+     *   change of one of its sensors since the category's previous Sample (NaN if none)
+     */
+    void Sample(uint32_t categoryMask, uint64_t* cpuTicks, double* changes = nullptr);
+
+    /**
+     * Sample a few sensors at a high rate for a short time
+     * Updates only the hardware owning the sensors (or their categories, if the
+     * bridge cannot update single hardware) and records into a buffer sized up
+     * front. The poll lock is taken per sample, so polls and the sampler carry
+     * on in between. Blocks the calling thread for durationMs.
+     * @param sensorIds - sensor identifiers (throws std::invalid_argument if unknown)
+     * @param intervalMs - time between sample starts
+     * @param durationMs - length of the burst
+     * @param capture - output
+     */
+    void CaptureBurst(const std::vector<std::string>& sensorIds, uint32_t intervalMs,
+                      uint32_t durationMs, BurstCapture& capture);
+
+    /**
+     * Current sensor schema (reloaded from the bridge when the generation changes)
+     */
+    std::shared_ptr<const SensorSchema> GetSchema();
+
+    /**
+     * Latest values of the given sensors, without waiting for an in-flight poll
+     * Values are from the most recent sample or poll (the first lookup reads
+     * the bridge's current values); unknown ids read NaN.
+     * @param ids - sensor identifiers
+     * @param values - receives one value per id
+     * @returns ms since Unix epoch of the sample the values are from
+     */
+    double GetValues(const std::vector<std::string>& ids, float* values);
+
+    /**
+     * Sensors matching a query, with their latest values (see GetValues)
+     * @param positions - receives the matches' value vector positions, in schema order
+     * @param values - receives one value per match
+     * @returns index whose schema the positions refer to
+     */
+    std::shared_ptr<const SensorIndex> Query(const SensorQuery& query, std::vector<uint32_t>& positions,
+                                             std::vector<float>& values);
+
+    /**
+     * Add or replace a derived sensor (process-wide)
+     * Shows up in the schema, every sample and poll() JSON from the next update on.
+     * @returns false with a message in error if the definition does not compile
+     */
+    bool DefineSensor(const DerivedDefinition& definition, std::string& error);
+
+    /**
+     * Remove a derived sensor
+     * @returns false if there is no derived sensor by that name
+     */
+    bool RemoveSensor(const std::string& name);
+
+    /**
+     * Current derived sensor definitions, in value vector order
+     */
+    std::vector<DerivedDefinition> GetDerivedSensors();
+
+    /**
+     * Enable or reconfigure anomaly detection (process-wide)
+     * @param config - rules and seasonal baseline; nullptr disables detection and drops all baselines
+     */
+    void SetAnomalyDetection(const AnomalyConfig* config);
+
+    /**
+     * Active anomalies and events newer than a sequence; does not wait for an in-flight poll
+     */
+    AnomalyReport GetAnomalies(uint64_t sinceSequence);
+
+    /**
+     * Enable or reconfigure the sample history (process-wide)
+     * @param config - capacity and interval; nullptr disables the history and drops all samples
+     */
+    void SetHistory(const HistoryConfig* config);
+
+    /**
+     * Current history store, nullptr if disabled; queries keep it alive while it is replaced
+     */
+    std::shared_ptr<HistoryStore> GetHistory();
+
+    /**
+     * Persist state to a memory-mapped file and restore what it holds (process-wide)
+     * Restores the history ring (enabling the history with the persisted
+     * capacity if it is off), sensor extremes and, once detection is enabled,
+     * anomaly baselines, all matched by sensor id. Attaching the same path
+     * again is a no-op.
+     * @param error - receives a message on failure
+     * @returns false if another file is attached or the file cannot be opened
+     */
+    bool AttachState(const StateOptions& options, std::string& error);
+
+    /**
+     * State persistence figures
+     * @returns false if no state file is attached
+     */
+    bool GetStateStats(StateStats& stats);
+
+    /**
+     * Lowest and highest values of sensors, kept across restarts in the state file
+     * @returns false if no state file is attached
+     */
+    bool GetExtremes(const std::vector<std::string>& ids, float* min, float* max);
+
+    /**
+     * Replace the process-wide hardware/sensor filter
+     * Takes effect on the next poll or sample; bumps the schema generation
+     * unless the filter is unchanged.
+     * @param filterJson - JSON filter spec, empty to clear
+     * @returns true if the bridge accepted the filter
+     */
+    bool SetFilter(const std::string& filterJson);
+
+    /**
+     * Enable or disable hardware types without re-initializing (process-wide)
+     * Takes effect immediately; the schema generation changes on the next poll
+     * or sample if hardware was opened or closed. Environments that init()
+     * later must pass the new configuration.
+     * @param config - complete new configuration
+     * @param error - receives a message on failure
+     * @returns true on success
+     */
+    bool Reconfigure(const HardwareConfig& config, std::string& error);
+
+    /**
+     * Counters and memory figures; does not wait for an in-flight poll
+     */
+    BackendStats GetStats();
+
+    /**
+     * Register/unregister a sample listener
+     * RemoveListener returns only once no OnSample call is in progress.
+     */
+    void AddListener(SampleListener* listener);
+    void RemoveListener(SampleListener* listener);
+
+    /**
+     * Native sampler shared by all environments
+     */
+    Sampler& GetSampler() { return *m_sampler; }
+
+    /**
+     * Current configuration (as started, or last reconfigured)
+     */
+    HardwareConfig GetConfig() const;
+
+private:
+    MonitorBackend(const HardwareConfig& config);
+    ~MonitorBackend();
+
+    // Callers must hold m_pollMutex
+    // budgetMs < 0: no deadline; returns the hardware the bridge skipped
+    int32_t PollLocked(int32_t budgetMs, uint32_t filterPresets, std::string& json);
+    void RefreshSchemaLocked();
+    void ReadValuesLocked(uint32_t updatedMask);  // Bridge values, then derived ones
+    void PublishLocked();
+    void SnapshotLocked(double timestamp);        // Copy m_values for lookups
+    void RestoreBaselinesLocked();                // Seed anomaly baselines from the state file
+    void MeasureChangesLocked(uint32_t categoryMask, double* changes);
+    const std::shared_ptr<const SensorIndex>& IndexLocked();
+
+    // Start keeping the lookup snapshot (first GetValues/Query)
+    void EnableLookups();
+
+    // Guards s_instance and every reference count change
+    static std::mutex s_mutex;
+    static MonitorBackend* s_instance;
+    // The .NET runtime cannot be unloaded from a process, so the host
+    // stays resident once created and is reused by later backends
+    static CLRHost* s_clrHost;
+
+    int m_refCount;
+    HardwareConfig m_config;
+    const BridgeApi* m_api;            // In-process bridge, nullptr for the managed one
+    HardwareMonitor* m_hardwareMonitor;
+    std::unique_ptr<Sampler> m_sampler;
+    std::timed_mutex m_pollMutex;     // Timed, so that cancelled polls stop waiting
+    // Filter set through init()/setFilter() (guarded by m_pollMutex)
+    std::string m_filterJson;
+
+    // Latest value vector, laid out by m_schema (guarded by m_pollMutex)
+    std::shared_ptr<const SensorSchema> m_schema;
+    std::vector<float> m_values;
+    // Per bridge sensor: category bit index, and the value at the category's last Sample
+    std::vector<uint8_t> m_sensorCategory;
+    // Per sensor (derived included): category bits its value depends on
+    std::vector<uint32_t> m_sensorMasks;
+    std::vector<float> m_sampledValues;
+    // Schema composition: bridge sensors first, then derived ones
+    DerivedSensors m_derived;
+    AnomalyDetector m_anomalies;
+    uint32_t m_derivedVersion;
+    int32_t m_bridgeGeneration;
+    int32_t m_generation;
+    size_t m_baseHardwareCount;
+    size_t m_baseSensorCount;
+    uint32_t m_sequence;
+    std::atomic<uint64_t> m_pollCount;
+    std::atomic<uint64_t> m_sampleCount;
+    std::atomic<uint64_t> m_pollsAborted;
+    std::atomic<uint64_t> m_pollsTimedOut;
+    std::atomic<uint64_t> m_pollsDropped;
+    std::atomic<uint64_t> m_pollsAbandoned;
+    std::atomic<uint64_t> m_pollsTruncated;
+    // Time truncated polls ran past their bridge budget, smoothed (written under m_pollMutex)
+    std::atomic<int64_t> m_pollOverrunUs;
+
+    // Poll buffers between polls, so steady-state polls reuse their capacity
+    std::mutex m_bufferMutex;
+    std::vector<std::string> m_pollBuffers;
+
+    std::mutex m_listenerMutex;
+    std::vector<SampleListener*> m_listeners;
+    std::atomic<size_t> m_listenerCount;
+
+    std::mutex m_historyMutex;
+    std::shared_ptr<HistoryStore> m_history;
+
+    std::mutex m_stateMutex;
+    std::unique_ptr<StatePersister> m_state;
+    // Anomaly baselines read from the state file, until detection is enabled
+    // (guarded by m_pollMutex)
+    std::unique_ptr<PersistedState> m_restoredBaselines;
+
+    // Lookup index of m_schema, built on first use (guarded by m_pollMutex)
+    std::shared_ptr<const SensorIndex> m_index;
+    // Copy of the latest value vector for lookups, so they never wait for a
+    // poll; only kept once a lookup was made (guarded by m_latestMutex)
+    std::atomic<bool> m_lookups;
+    std::mutex m_latestMutex;
+    std::shared_ptr<const SensorIndex> m_latestIndex;
+    std::vector<float> m_latestValues;
+    double m_latestTimestamp;
+};
@@ -0,0 +1,102 @@
+#include "native_bridge.h"
+
+#ifdef _WIN32
+#include <iostream>
+#include <mutex>
+#include <windows.h>
+
+namespace {
+
+int g_marker = 0;
+
+std::mutex g_mutex;
+HMODULE g_library = nullptr;
+BridgeApi g_api;
+
+std::wstring LibraryPath() {
+	HMODULE addon = nullptr;
+	if (!GetModuleHandleExW(
+		GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+		(LPCWSTR)&g_marker,
+		&addon)) {
+		return std::wstring();
+	}
+
+	wchar_t path[MAX_PATH];
+	DWORD length = GetModuleFileNameW(addon, path, MAX_PATH);
+	if (length == 0 || length >= MAX_PATH) {
+		return std::wstring();
+	}
+	std::wstring directory(path, length);
+	directory.erase(directory.find_last_of(L"\\/") + 1);
+	return directory + L"LibreHardwareMonitorBridge.Native.dll";
+}
+
+} // namespace
+
+bool NativeBridge::Available() {
+	std::wstring path = LibraryPath();
+	return !path.empty() && GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+const BridgeApi* NativeBridge::Load(std::string& error) {
+	std::lock_guard<std::mutex> lock(g_mutex);
+	if (g_library != nullptr) {
+		return &g_api;
+	}
+
+	std::wstring path = LibraryPath();
+	// Dependencies resolve from the library's own folder
+	HMODULE library = path.empty() ? nullptr
+		: LoadLibraryExW(path.c_str(), nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+	if (library == nullptr) {
+		error = std::string("Failed to load ") + kFileName + " (error " + std::to_string(GetLastError()) + ")";
+		return nullptr;
+	}
+	std::wcerr << L"Loading native bridge: " << path << std::endl;
+
+	BridgeApi api;
+	struct { const char* name; void** fn; } exports[] = {
+		{ "LHM_Initialize", (void**)&api.initialize },
+		{ "LHM_Poll", (void**)&api.poll },
+		{ "LHM_FreeString", (void**)&api.freeString },
+		{ "LHM_Shutdown", (void**)&api.shutdown },
+		{ "LHM_GetSchema", (void**)&api.getSchema },
+		{ "LHM_GetSchemaGeneration", (void**)&api.getSchemaGeneration },
+		{ "LHM_Update", (void**)&api.update },
+		{ "LHM_ReadValues", (void**)&api.readValues },
+		{ "LHM_SetFilter", (void**)&api.setFilter },
+		{ "LHM_GetMemoryStats", (void**)&api.getMemoryStats },
+		{ "LHM_UpdateHardware", (void**)&api.updateHardware },
+		{ "LHM_ReadSensorValues", (void**)&api.readSensorValues },
+		{ "LHM_Reconfigure", (void**)&api.reconfigure },
+		{ "LHM_PollWithin", (void**)&api.pollWithin },
+		{ "LHM_PollInto", (void**)&api.pollInto },
+	};
+
+	for (const auto& entry : exports) {
+		*entry.fn = (void*)GetProcAddress(library, entry.name);
+		if (*entry.fn == nullptr) {
+			// Keep the library loaded: a NativeAOT runtime does not support unloading
+			error = std::string(kFileName) + " does not export " + entry.name;
+			return nullptr;
+		}
+	}
+
+	g_api = api;
+	g_library = library;
+	return &g_api;
+}
+
+#else
+
+bool NativeBridge::Available() {
+	return false;
+}
+
+const BridgeApi* NativeBridge::Load(std::string& error) {
+	error = "The native bridge requires Windows";
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "bridge_api.h"
+#include <string>
+
+/**
+ * Native Bridge - the ahead-of-time compiled LibreHardwareMonitorBridge
+ * LibreHardwareMonitorBridge.Native.dll (dotnet publish -p:NativeAot=true)
+ * exports the bridge methods as plain C functions (LHM_Initialize, LHM_Poll,
+ * ...), so it is loaded with LoadLibrary instead of hostfxr: no runtime
+ * files, no JIT. Windows only.
+ *
+ * The library is loaded once per process and never unloaded (a NativeAOT
+ * runtime cannot be torn down).
+ */
+namespace NativeBridge {
+
+/**
+ * File name of the library, looked up next to the addon
+ */
+constexpr const char* kFileName = "LibreHardwareMonitorBridge.Native.dll";
+
+/**
+ * Whether the library is present next to the addon
+ */
+bool Available();
+
+/**
+ * Load the library and resolve its exports
+ * @returns function table to hand to MonitorBackend::Acquire, or nullptr
+ *          (with error set)
+ */
+const BridgeApi* Load(std::string& error);
+
+} // namespace NativeBridge
@@ -0,0 +1,289 @@
+#include "poll_table.h"
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+
+const int kMaxDepth = 64;
+
+class Parser {
+public:
+	Parser(const std::string& json, PollTable& table)
+		: m_p(json.c_str())
+		, m_end(json.c_str() + json.size())
+		, m_table(table)
+	{
+	}
+
+	bool Run() {
+		int32_t root;
+		if (!Object(0, root)) {
+			return false;
+		}
+		SkipSpace();
+		return m_p == m_end;
+	}
+
+private:
+	void SkipSpace() {
+		while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) {
+			m_p++;
+		}
+	}
+
+	bool Literal(const char* text) {
+		for (; *text != '\0'; text++, m_p++) {
+			if (m_p >= m_end || *m_p != *text) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static int Hex(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	bool CodeUnit(uint32_t& unit) {
+		if (m_end - m_p < 4) {
+			return false;
+		}
+		unit = 0;
+		for (int i = 0; i < 4; i++) {
+			int digit = Hex(*m_p++);
+			if (digit < 0) {
+				return false;
+			}
+			unit = (unit << 4) | (uint32_t)digit;
+		}
+		return true;
+	}
+
+	static void AppendUtf8(std::string& out, uint32_t code) {
+		if (code < 0x80) {
+			out += (char)code;
+		} else if (code < 0x800) {
+			out += (char)(0xC0 | (code >> 6));
+			out += (char)(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			out += (char)(0xE0 | (code >> 12));
+			out += (char)(0x80 | ((code >> 6) & 0x3F));
+			out += (char)(0x80 | (code & 0x3F));
+		} else {
+			out += (char)(0xF0 | (code >> 18));
+			out += (char)(0x80 | ((code >> 12) & 0x3F));
+			out += (char)(0x80 | ((code >> 6) & 0x3F));
+			out += (char)(0x80 | (code & 0x3F));
+		}
+	}
+
+	// Appends the unescaped string at m_p (opening quote) to out
+	bool String(std::string& out) {
+		if (m_p >= m_end || *m_p != '"') {
+			return false;
+		}
+		m_p++;
+		while (m_p < m_end) {
+			const char* run = m_p;
+			while (m_p < m_end && *m_p != '"' && *m_p != '\\') {
+				m_p++;
+			}
+			out.append(run, m_p - run);
+			if (m_p >= m_end) {
+				return false;
+			}
+			if (*m_p++ == '"') {
+				return true;
+			}
+			if (m_p >= m_end) {
+				return false;
+			}
+			char escape = *m_p++;
+			switch (escape) {
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u': {
+					uint32_t code;
+					if (!CodeUnit(code)) {
+						return false;
+					}
+					// Surrogate pair; a lone surrogate becomes U+FFFD like TextDecoder would
+					if (code >= 0xD800 && code < 0xDC00) {
+						uint32_t low;
+						if (m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u') {
+							m_p += 2;
+							if (!CodeUnit(low)) {
+								return false;
+							}
+							code = low >= 0xDC00 && low < 0xE000
+								? 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00) : 0xFFFD;
+						} else {
+							code = 0xFFFD;
+						}
+					} else if (code >= 0xDC00 && code < 0xE000) {
+						code = 0xFFFD;
+					}
+					AppendUtf8(out, code);
+					break;
+				}
+				default:
+					return false;
+			}
+		}
+		return false;
+	}
+
+	int32_t KeyIndex(const std::string& key) {
+		auto found = m_keys.find(key);
+		if (found != m_keys.end()) {
+			return found->second;
+		}
+		int32_t index = (int32_t)m_table.keys.size();
+		m_table.keys.push_back(key);
+		m_keys.emplace(key, index);
+		return index;
+	}
+
+	bool Children(int depth, int32_t& start, int32_t& count) {
+		m_p++;  // '['
+		std::vector<int32_t> nodes;
+		SkipSpace();
+		if (m_p < m_end && *m_p == ']') {
+			m_p++;
+		} else {
+			for (;;) {
+				int32_t node;
+				SkipSpace();
+				if (!Object(depth, node)) {
+					return false;
+				}
+				nodes.push_back(node);
+				SkipSpace();
+				if (m_p < m_end && *m_p == ',') {
+					m_p++;
+				} else if (m_p < m_end && *m_p == ']') {
+					m_p++;
+					break;
+				} else {
+					return false;
+				}
+			}
+		}
+		start = (int32_t)m_table.children.size();
+		count = (int32_t)nodes.size();
+		m_table.children.insert(m_table.children.end(), nodes.begin(), nodes.end());
+		return true;
+	}
+
+	bool Object(int depth, int32_t& node) {
+		if (depth >= kMaxDepth || m_p >= m_end || *m_p != '{') {
+			return false;
+		}
+		m_p++;
+		node = (int32_t)(m_table.nodes.size() / 2);
+		m_table.nodes.push_back(0);
+		m_table.nodes.push_back(0);
+
+		// Children's properties are appended while this object is open; its own go in at the end
+		std::vector<int32_t> props;
+		SkipSpace();
+		if (m_p < m_end && *m_p == '}') {
+			m_p++;
+		} else {
+			for (;;) {
+				SkipSpace();
+				m_key.clear();
+				if (!String(m_key)) {
+					return false;
+				}
+				int32_t key = KeyIndex(m_key);
+				SkipSpace();
+				if (m_p >= m_end || *m_p++ != ':') {
+					return false;
+				}
+				SkipSpace();
+				if (m_p >= m_end) {
+					return false;
+				}
+
+				int32_t kind, a = 0, b = 0;
+				char c = *m_p;
+				if (c == '"') {
+					size_t offset = m_table.strings.size();
+					if (!String(m_table.strings)) {
+						return false;
+					}
+					kind = PollTable::kString;
+					a = (int32_t)offset;
+					b = (int32_t)(m_table.strings.size() - offset);
+				} else if (c == '[') {
+					if (!Children(depth + 1, a, b)) {
+						return false;
+					}
+					kind = PollTable::kChildren;
+				} else if (c == 't' || c == 'f' || c == 'n') {
+					kind = c == 't' ? PollTable::kTrue : c == 'f' ? PollTable::kFalse : PollTable::kNull;
+					if (!Literal(c == 't' ? "true" : c == 'f' ? "false" : "null")) {
+						return false;
+					}
+				} else if (c == '-' || (c >= '0' && c <= '9')) {
+					char* after = nullptr;
+					double value = std::strtod(m_p, &after);
+					if (after == m_p || after > m_end) {
+						return false;
+					}
+					m_p = after;
+					kind = PollTable::kNumber;
+					a = (int32_t)m_table.numbers.size();
+					m_table.numbers.push_back(value);
+				} else {
+					return false;
+				}
+				props.insert(props.end(), { key, kind, a, b });
+
+				SkipSpace();
+				if (m_p < m_end && *m_p == ',') {
+					m_p++;
+				} else if (m_p < m_end && *m_p == '}') {
+					m_p++;
+					break;
+				} else {
+					return false;
+				}
+			}
+		}
+
+		m_table.nodes[2 * node] = (int32_t)(m_table.props.size() / 4);
+		m_table.nodes[2 * node + 1] = (int32_t)(props.size() / 4);
+		m_table.props.insert(m_table.props.end(), props.begin(), props.end());
+		return true;
+	}
+
+	const char* m_p;
+	const char* m_end;
+	PollTable& m_table;
+	std::unordered_map<std::string, int32_t> m_keys;
+	std::string m_key;
+};
+
+} // namespace
+
+bool PollTable::Parse(const std::string& json) {
+	keys.clear();
+	nodes.clear();
+	props.clear();
+	numbers.clear();
+	children.clear();
+	strings.clear();
+	strings.reserve(json.size() / 2);
+	return Parser(json, *this).Run();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Poll Table - poll() JSON flattened into arrays for lazy JS views
+ *
+ * Parsed on the poll's worker thread; lib/poll-view.js wraps the arrays in
+ * view objects that decode a node's fields and children only when they are
+ * read, instead of JSON.parse creating every node of the tree up front.
+ *
+ * Every object in the tree is a node (root = 0, then in document order).
+ * Its properties are kept in document order, so the classic object can be
+ * rebuilt exactly:
+ *   nodes[2n], nodes[2n + 1]   first property, property count
+ *   props[4p .. 4p + 3]        key (index into keys), kind, a, b
+ * kString: a, b = byte offset and length in strings
+ * kNumber: a = index into numbers
+ * kChildren: a, b = start and count in children (an array of objects)
+ * kTrue, kFalse, kNull: no data
+ */
+struct PollTable {
+    enum Kind : int32_t { kString = 0, kNumber = 1, kChildren = 2, kTrue = 3, kFalse = 4, kNull = 5 };
+
+    std::vector<std::string> keys;    // Property names, in first-seen order
+    std::vector<int32_t> nodes;
+    std::vector<int32_t> props;
+    std::vector<double> numbers;
+    std::vector<int32_t> children;    // Node indices, one run per Children array
+    std::string strings;              // Unescaped UTF-8
+
+    /**
+     * Flatten a poll JSON tree
+     * @returns false if the text is not a tree of this shape (arrays of anything
+     *          but objects, objects nested as plain values); JSON.parse it instead
+     */
+    bool Parse(const std::string& json);
+};
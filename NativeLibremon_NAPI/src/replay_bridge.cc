@@ -0,0 +1,999 @@
+#include "replay_bridge.h"
+#include "hardware_monitor.h"
+#include "sensor_format.h"
+#include "sensor_schema.h"
+#include "trace_file.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// A recorded schema, as the filter leaves it, with the tree structure poll() walks
+struct Layout {
+	SensorSchema schema;
+	std::vector<int> hardwareSource;          // Per hardware: its index in the recorded schema
+	std::vector<uint32_t> categories;         // Per hardware: HardwareCategory bit of its top-level parent
+	std::vector<int> source;                  // Per sensor: its index in the recorded schema
+	std::vector<std::vector<int>> children;   // Per hardware: sub-hardware, in order
+	std::vector<std::vector<int>> sensors;    // Per hardware: its sensors, in type group order
+	std::vector<int> topLevel;
+};
+
+// The bridge's HardwareFilter: names are substrings, HardwareIds prefixes,
+// sensor types SensorType names (case-insensitive, unknown ones ignored)
+struct Filter {
+	std::vector<std::string> excludeNames;
+	std::vector<std::string> excludeIdPrefixes;
+	std::vector<std::string> includeNames;
+	std::vector<std::string> includeIdPrefixes;
+	uint64_t excludeSensorTypes = 0;
+	uint64_t includeSensorTypes = 0;  // 0 = every type
+
+	bool HasInclude() const { return !includeNames.empty() || !includeIdPrefixes.empty(); }
+};
+
+// Preset bits of PollInto (FilterPreset in hardware_monitor.h)
+const int kPresetVirtualNics = 1 << 0;
+const int kPresetDimms = 1 << 1;
+const char* const kVirtualNicNames[] = {
+	"-QoS Packet Scheduler", "-WFP ", "-VirtualBox NDIS", "-Hyper-V Virtual Switch",
+	"-Native WiFi Filter", "-Virtual WiFi Filter", "vEthernet", "vSwitch", "(Kerneldebugger)"
+};
+
+struct State {
+	std::mutex mutex;
+	std::unique_ptr<TraceReader> reader;
+	std::string path;
+	ReplayOptions options;
+	std::vector<SensorSchema> recorded;
+	std::vector<Layout> layouts;     // Per recorded schema, filtered
+	Filter filter;
+	uint32_t categories = kCategoryAll;  // HardwareCategory bits enabled by Initialize/Reconfigure
+	bool running = false;
+
+	std::chrono::steady_clock::time_point start;
+	uint64_t steps = 0;
+	int active = -1;                 // Layout of the current frame
+	int32_t generation = 0;
+	std::vector<float> values;       // values/mins/maxs in the recorded schema's order
+	std::vector<float> mins;
+	std::vector<float> maxs;
+	std::vector<std::vector<int>> hardwareSensors;  // Per recorded hardware: its sensors
+	std::vector<double> updateStart; // Per recorded hardware: monotonic ms around its last update
+	std::vector<double> updateEnd;
+	std::string pollJson;            // Last poll tree, reused by every poll
+	bool pollPending = false;        // PollInto: pollJson did not fit the caller's buffer yet
+	int pollSkipped = 0;             // Hardware the pending poll skipped
+};
+
+State g_state;
+
+const SensorTypeFormat& FormatOf(const std::string& type, SensorTypeFormat& fallback) {
+	int index = SensorFormat::TypeIndex(type);
+	if (index >= 0) {
+		return SensorFormat::Type(index);
+	}
+	fallback = { type.c_str(), type.c_str(), 1, "" };
+	return fallback;
+}
+
+// Filter spec as the JS wrapper serializes it: an object of string arrays
+class FilterParser {
+public:
+	explicit FilterParser(const char* json)
+		: m_p(json)
+	{
+	}
+
+	bool Run(Filter& filter) {
+		SkipSpace();
+		if (*m_p++ != '{') {
+			return false;
+		}
+		SkipSpace();
+		if (*m_p == '}') {
+			m_p++;
+			return AtEnd();
+		}
+		for (;;) {
+			std::string key;
+			std::vector<std::string> list;
+			SkipSpace();
+			if (!String(key)) {
+				return false;
+			}
+			SkipSpace();
+			if (*m_p++ != ':') {
+				return false;
+			}
+			SkipSpace();
+			if (!List(list)) {
+				return false;
+			}
+			Assign(filter, key, list);
+			SkipSpace();
+			char next = *m_p++;
+			if (next == '}') {
+				return AtEnd();
+			}
+			if (next != ',') {
+				return false;
+			}
+		}
+	}
+
+private:
+	void SkipSpace() {
+		while (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r') {
+			m_p++;
+		}
+	}
+
+	bool AtEnd() {
+		SkipSpace();
+		return *m_p == '\0';
+	}
+
+	static void AppendUtf8(std::string& out, uint32_t code) {
+		if (code < 0x80) {
+			out += (char)code;
+		} else if (code < 0x800) {
+			out += (char)(0xC0 | (code >> 6));
+			out += (char)(0x80 | (code & 0x3F));
+		} else {
+			out += (char)(0xE0 | (code >> 12));
+			out += (char)(0x80 | ((code >> 6) & 0x3F));
+			out += (char)(0x80 | (code & 0x3F));
+		}
+	}
+
+	bool String(std::string& out) {
+		if (*m_p++ != '"') {
+			return false;
+		}
+		for (;;) {
+			char c = *m_p++;
+			if (c == '\0') {
+				return false;
+			}
+			if (c == '"') {
+				return true;
+			}
+			if (c != '\\') {
+				out += c;
+				continue;
+			}
+			switch (*m_p++) {
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u': {
+					// Hardware names and ids are BMP text; surrogates become U+FFFD
+					uint32_t code = 0;
+					for (int i = 0; i < 4; i++) {
+						char digit = *m_p++;
+						if (digit >= '0' && digit <= '9') code = (code << 4) | (uint32_t)(digit - '0');
+						else if (digit >= 'a' && digit <= 'f') code = (code << 4) | (uint32_t)(digit - 'a' + 10);
+						else if (digit >= 'A' && digit <= 'F') code = (code << 4) | (uint32_t)(digit - 'A' + 10);
+						else return false;
+					}
+					AppendUtf8(out, code >= 0xD800 && code < 0xE000 ? 0xFFFD : code);
+					break;
+				}
+				default:
+					return false;
+			}
+		}
+	}
+
+	bool List(std::vector<std::string>& list) {
+		if (*m_p++ != '[') {
+			return false;
+		}
+		SkipSpace();
+		if (*m_p == ']') {
+			m_p++;
+			return true;
+		}
+		for (;;) {
+			std::string item;
+			SkipSpace();
+			if (!String(item)) {
+				return false;
+			}
+			list.push_back(std::move(item));
+			SkipSpace();
+			char next = *m_p++;
+			if (next == ']') {
+				return true;
+			}
+			if (next != ',') {
+				return false;
+			}
+		}
+	}
+
+	static int TypeIndexIgnoreCase(const std::string& name) {
+		for (size_t i = 0; i < SensorFormat::TypeCount(); i++) {
+			const char* type = SensorFormat::Type(i).type;
+			size_t length = std::strlen(type);
+			if (length == name.size() && std::equal(name.begin(), name.end(), type, [](char a, char b) {
+				return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+			})) {
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	static uint64_t TypeMask(const std::vector<std::string>& names) {
+		uint64_t mask = 0;
+		for (const std::string& name : names) {
+			int index = TypeIndexIgnoreCase(name);
+			if (index >= 0) {
+				mask |= 1ULL << (index & 63);
+			}
+		}
+		return mask;
+	}
+
+	static void Assign(Filter& filter, const std::string& key, std::vector<std::string>& list) {
+		// Empty patterns would match everything; the bridge drops them too
+		list.erase(std::remove(list.begin(), list.end(), std::string()), list.end());
+		if (key == "excludeNames") filter.excludeNames = std::move(list);
+		else if (key == "excludeHardwareIds") filter.excludeIdPrefixes = std::move(list);
+		else if (key == "includeNames") filter.includeNames = std::move(list);
+		else if (key == "includeHardwareIds") filter.includeIdPrefixes = std::move(list);
+		else if (key == "excludeSensorTypes") filter.excludeSensorTypes = TypeMask(list);
+		else if (key == "includeSensorTypes") filter.includeSensorTypes = TypeMask(list);
+	}
+
+	const char* m_p;
+};
+
+// HardwareCategory bit of a LibreHardwareMonitor HardwareType name (the bridge's GetCategoryBit)
+uint32_t CategoryBitOf(const std::string& type) {
+	if (type == "Cpu") return kCategoryCpu;
+	if (type == "GpuNvidia" || type == "GpuAmd" || type == "GpuIntel") return kCategoryGpu;
+	if (type == "Motherboard" || type == "SuperIO" || type == "EmbeddedController") return kCategoryMotherboard;
+	if (type == "Memory") return kCategoryMemory;
+	if (type == "Storage") return kCategoryStorage;
+	if (type == "Network") return kCategoryNetwork;
+	if (type == "Psu") return kCategoryPsu;
+	if (type == "Cooler") return kCategoryController;
+	if (type == "Battery") return kCategoryBattery;
+	return kCategoryOther;
+}
+
+// Sub-hardware is opened and updated with its top-level parent, so it shares its category
+uint32_t CategoryOf(const SensorSchema& schema, int hardware) {
+	int count = (int)schema.hardware.size();
+	for (int depth = 0; schema.hardware[hardware].parent >= 0 && schema.hardware[hardware].parent < count && depth < 8; depth++) {
+		hardware = schema.hardware[hardware].parent;
+	}
+	return CategoryBitOf(schema.hardware[hardware].type);
+}
+
+uint32_t CategoriesOf(bool cpu, bool gpu, bool motherboard, bool memory, bool storage,
+	bool network, bool psu, bool controller, bool battery) {
+	HardwareConfig config;
+	config.cpu = cpu;
+	config.gpu = gpu;
+	config.motherboard = motherboard;
+	config.memory = memory;
+	config.storage = storage;
+	config.network = network;
+	config.psu = psu;
+	config.controller = controller;
+	config.battery = battery;
+	return config.CategoryMask();
+}
+
+bool Matches(const HardwareInfo& hardware, const std::vector<std::string>& names,
+	const std::vector<std::string>& idPrefixes) {
+	for (const std::string& name : names) {
+		if (hardware.name.find(name) != std::string::npos) {
+			return true;
+		}
+	}
+	for (const std::string& prefix : idPrefixes) {
+		if (hardware.id.compare(0, prefix.size(), prefix) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MatchesIncludeDeep(const SensorSchema& schema, const std::vector<std::vector<int>>& children, int hardware) {
+	const Filter& filter = g_state.filter;
+	if (Matches(schema.hardware[hardware], filter.includeNames, filter.includeIdPrefixes)) {
+		return true;
+	}
+	for (int child : children[hardware]) {
+		if (MatchesIncludeDeep(schema, children, child)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Per recorded hardware, whether the filter or a disabled category drops it
+// (parents come before their sub-hardware)
+std::vector<bool> ExcludedHardware(const SensorSchema& schema) {
+	const Filter& filter = g_state.filter;
+	size_t count = schema.hardware.size();
+	std::vector<std::vector<int>> children(count);
+	for (size_t h = 0; h < count; h++) {
+		int parent = schema.hardware[h].parent;
+		if (parent >= 0 && parent < (int)count) {
+			children[parent].push_back((int)h);
+		}
+	}
+
+	std::vector<bool> excluded(count, false);
+	for (size_t h = 0; h < count; h++) {
+		const HardwareInfo& info = schema.hardware[h];
+		bool hasParent = info.parent >= 0 && info.parent < (int)count;
+		if ((hasParent && excluded[info.parent]) ||
+		    (!hasParent && (CategoryBitOf(info.type) & g_state.categories) == 0) ||
+		    Matches(info, filter.excludeNames, filter.excludeIdPrefixes)) {
+			excluded[h] = true;
+			continue;
+		}
+		if (!filter.HasInclude()) {
+			continue;
+		}
+
+		// Kept if it, an ancestor or a descendant matches
+		bool kept = false;
+		for (int ancestor = info.parent; ancestor >= 0 && ancestor < (int)count && !kept;
+		     ancestor = schema.hardware[ancestor].parent) {
+			kept = Matches(schema.hardware[ancestor], filter.includeNames, filter.includeIdPrefixes);
+		}
+		excluded[h] = !kept && !MatchesIncludeDeep(schema, children, (int)h);
+	}
+	return excluded;
+}
+
+bool IsSensorExcluded(const SensorInfo& sensor) {
+	const Filter& filter = g_state.filter;
+	int type = SensorFormat::TypeIndex(sensor.type);
+	uint64_t bit = type >= 0 ? 1ULL << (type & 63) : 0;
+	if ((filter.excludeSensorTypes & bit) != 0) {
+		return true;
+	}
+	return filter.includeSensorTypes != 0 && (filter.includeSensorTypes & bit) == 0;
+}
+
+// Presets only drop hardware from one poll's tree, never from the schema
+bool IsPresetExcluded(const HardwareInfo& hardware, int presets) {
+	if ((presets & kPresetDimms) != 0 && hardware.id.find("/memory/dimm/") != std::string::npos) {
+		return true;
+	}
+	if ((presets & kPresetVirtualNics) == 0 || hardware.type != "Network") {
+		return false;
+	}
+	for (const char* name : kVirtualNicNames) {
+		if (hardware.name.find(name) != std::string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void BuildLayout(Layout& layout) {
+	const SensorSchema& schema = layout.schema;
+	size_t hardwareCount = schema.hardware.size();
+	layout.children.assign(hardwareCount, {});
+	layout.sensors.assign(hardwareCount, {});
+	for (size_t h = 0; h < hardwareCount; h++) {
+		int parent = schema.hardware[h].parent;
+		if (parent >= 0 && parent < (int)hardwareCount) {
+			layout.children[parent].push_back((int)h);
+		} else {
+			layout.topLevel.push_back((int)h);
+		}
+	}
+
+	// Type groups in SensorType order, unknown types after them
+	size_t typeCount = SensorFormat::TypeCount();
+	std::vector<std::pair<size_t, int>> order;
+	order.reserve(schema.sensors.size());
+	for (size_t i = 0; i < schema.sensors.size(); i++) {
+		int type = SensorFormat::TypeIndex(schema.sensors[i].type);
+		order.emplace_back(type >= 0 ? (size_t)type : typeCount, (int)i);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<size_t, int>& a, const std::pair<size_t, int>& b) {
+		return a.first < b.first;
+	});
+	for (const auto& entry : order) {
+		int hardware = schema.sensors[entry.second].hardware;
+		if (hardware >= 0 && hardware < (int)hardwareCount) {
+			layout.sensors[hardware].push_back(entry.second);
+		}
+	}
+}
+
+// What the bridge's schema shows of a recorded one under the current filter and categories
+Layout FilterLayout(const SensorSchema& recorded) {
+	Layout layout;
+	std::vector<bool> excluded = ExcludedHardware(recorded);
+	std::vector<int> positions(recorded.hardware.size(), -1);
+	for (size_t h = 0; h < recorded.hardware.size(); h++) {
+		if (excluded[h]) {
+			continue;
+		}
+		HardwareInfo info = recorded.hardware[h];
+		if (info.parent >= 0 && info.parent < (int)positions.size()) {
+			info.parent = positions[info.parent];
+		}
+		positions[h] = (int)layout.schema.hardware.size();
+		layout.schema.hardware.push_back(std::move(info));
+		layout.hardwareSource.push_back((int)h);
+		layout.categories.push_back(CategoryOf(recorded, (int)h));
+	}
+	for (size_t i = 0; i < recorded.sensors.size(); i++) {
+		const SensorInfo& sensor = recorded.sensors[i];
+		if (sensor.hardware < 0 || sensor.hardware >= (int)positions.size() ||
+		    positions[sensor.hardware] < 0 || IsSensorExcluded(sensor)) {
+			continue;
+		}
+		SensorInfo info = sensor;
+		info.hardware = positions[sensor.hardware];
+		layout.schema.sensors.push_back(std::move(info));
+		layout.source.push_back((int)i);
+	}
+	BuildLayout(layout);
+	return layout;
+}
+
+void FilterLayouts() {
+	g_state.layouts.clear();
+	g_state.layouts.reserve(g_state.recorded.size());
+	for (const SensorSchema& recorded : g_state.recorded) {
+		g_state.layouts.push_back(FilterLayout(recorded));
+	}
+}
+
+// Switch to another recorded schema; Min/Max and update stamps carry over by id
+void Activate(int index) {
+	const SensorSchema& schema = g_state.recorded[index];
+	size_t count = schema.sensors.size();
+	size_t hardwareCount = schema.hardware.size();
+	std::vector<float> mins(count, NAN);
+	std::vector<float> maxs(count, NAN);
+	std::vector<double> updateStart(hardwareCount, 0);
+	std::vector<double> updateEnd(hardwareCount, 0);
+
+	if (g_state.active >= 0) {
+		const SensorSchema& previous = g_state.recorded[g_state.active];
+		std::unordered_map<std::string, size_t> positions;
+		positions.reserve(previous.sensors.size());
+		for (size_t i = 0; i < previous.sensors.size(); i++) {
+			positions.emplace(previous.sensors[i].id, i);
+		}
+		for (size_t i = 0; i < count; i++) {
+			auto it = positions.find(schema.sensors[i].id);
+			if (it != positions.end() && it->second < g_state.mins.size()) {
+				mins[i] = g_state.mins[it->second];
+				maxs[i] = g_state.maxs[it->second];
+			}
+		}
+
+		positions.clear();
+		for (size_t h = 0; h < previous.hardware.size(); h++) {
+			positions.emplace(previous.hardware[h].id, h);
+		}
+		for (size_t h = 0; h < hardwareCount; h++) {
+			auto it = positions.find(schema.hardware[h].id);
+			if (it != positions.end() && it->second < g_state.updateStart.size()) {
+				updateStart[h] = g_state.updateStart[it->second];
+				updateEnd[h] = g_state.updateEnd[it->second];
+			}
+		}
+	}
+
+	g_state.hardwareSensors.assign(hardwareCount, {});
+	for (size_t i = 0; i < count; i++) {
+		int hardware = schema.sensors[i].hardware;
+		if (hardware >= 0 && hardware < (int)hardwareCount) {
+			g_state.hardwareSensors[hardware].push_back((int)i);
+		}
+	}
+
+	g_state.active = index;
+	g_state.generation++;
+	g_state.values.assign(count, NAN);
+	g_state.mins = std::move(mins);
+	g_state.maxs = std::move(maxs);
+	g_state.updateStart = std::move(updateStart);
+	g_state.updateEnd = std::move(updateEnd);
+}
+
+// Frame at the current trace time
+size_t CurrentFrame() {
+	const TraceReader& reader = *g_state.reader;
+	size_t frames = reader.FrameCount();
+
+	if (g_state.options.speed <= 0) {
+		uint64_t step = g_state.steps++;
+		return g_state.options.loop ? (size_t)(step % frames) : (size_t)std::min<uint64_t>(step, frames - 1);
+	}
+
+	double first = reader.FrameTime(0);
+	double duration = reader.FrameTime(frames - 1) - first;
+	double elapsed = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - g_state.start).count() * g_state.options.speed;
+	double offset;
+	if (g_state.options.loop && frames > 1 && duration > 0) {
+		// The last frame is held for one average interval before starting over
+		offset = std::fmod(elapsed, duration + duration / (frames - 1));
+	} else {
+		offset = std::min(elapsed, duration);
+	}
+
+	double time = first + offset;
+	size_t lo = 0;
+	size_t hi = frames;
+	while (hi - lo > 1) {
+		size_t mid = (lo + hi) / 2;
+		if (reader.FrameTime(mid) <= time) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// Same clock as the bridge's UpdateStart/UpdateEnd (process.hrtime)
+double MonotonicMs() {
+	return (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count() / 1000.0;
+}
+
+// Move to the frame at the current trace time
+// @returns its values, in the recorded schema's order
+const float* Seek() {
+	size_t frame = CurrentFrame();
+	int layout = (int)g_state.reader->FrameSchema(frame);
+	if (layout != g_state.active) {
+		Activate(layout);
+	}
+	return g_state.reader->FrameValues(frame);
+}
+
+// Take one recorded hardware's values from the frame
+void UpdateOne(int hardware, const float* values) {
+	double start = MonotonicMs();
+	// Spin rather than sleep: a bridge update costs CPU, which the sampler's governor measures
+	while (MonotonicMs() - start < g_state.options.updateMs) {
+	}
+	for (int i : g_state.hardwareSensors[hardware]) {
+		float value = values[i];
+		g_state.values[i] = value;
+		if (std::isnan(value)) {
+			continue;
+		}
+		if (std::isnan(g_state.mins[i]) || value < g_state.mins[i]) g_state.mins[i] = value;
+		if (std::isnan(g_state.maxs[i]) || value > g_state.maxs[i]) g_state.maxs[i] = value;
+	}
+	g_state.updateStart[hardware] = start;
+	g_state.updateEnd[hardware] = MonotonicMs();
+}
+
+// Move to the current frame, updating the hardware of categoryMask the filter
+// keeps the way the bridge does: none that, going by its last update, would not
+// finish within budgetMs (< 0: no deadline). Skipped hardware keeps its previous values.
+// @returns the hardware skipped
+int Advance(int budgetMs = -1, uint32_t categoryMask = kCategoryAll) {
+	double deadline = MonotonicMs() + (budgetMs < 0 ? INFINITY : (double)budgetMs);
+	const float* values = Seek();
+	const Layout& layout = g_state.layouts[g_state.active];
+	int skipped = 0;
+	for (size_t h = 0; h < layout.hardwareSource.size(); h++) {
+		if ((layout.categories[h] & categoryMask) == 0) {
+			continue;
+		}
+		int hardware = layout.hardwareSource[h];
+		if (MonotonicMs() + (g_state.updateEnd[hardware] - g_state.updateStart[hardware]) >= deadline) {
+			skipped++;
+			continue;
+		}
+		UpdateOne(hardware, values);
+	}
+	return skipped;
+}
+
+// Whether the current layout has hardware in categoryMask
+bool HasHardwareIn(uint32_t categoryMask) {
+	for (uint32_t category : g_state.layouts[g_state.active].categories) {
+		if ((category & categoryMask) != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+char* CopyString(const std::string& text) {
+	char* copy = static_cast<char*>(std::malloc(text.size() + 1));
+	std::memcpy(copy, text.c_str(), text.size() + 1);
+	return copy;
+}
+
+// Hardware node the way the bridge's BuildHardwareNodes writes it
+void AppendHardware(std::string& out, const Layout& layout, int hardware, int presets, int& id) {
+	const HardwareInfo& info = layout.schema.hardware[hardware];
+	out += "{\"id\":";
+	out += std::to_string(id++);
+	out += ",\"Text\":";
+	SensorFormat::AppendJsonString(out, info.name);
+	out += ",\"Children\":[";
+
+	bool first = true;
+	const std::vector<int>& sensors = layout.sensors[hardware];
+	for (size_t i = 0; i < sensors.size();) {
+		const std::string& type = layout.schema.sensors[sensors[i]].type;
+		SensorTypeFormat fallback;
+		const SensorTypeFormat& format = FormatOf(type, fallback);
+
+		out += first ? "{\"id\":" : ",{\"id\":";
+		out += std::to_string(id++);
+		out += ",\"Text\":";
+		SensorFormat::AppendJsonString(out, format.group);
+		out += ",\"Children\":[";
+		first = false;
+
+		bool firstSensor = true;
+		for (; i < sensors.size() && layout.schema.sensors[sensors[i]].type == type; i++) {
+			const SensorInfo& sensorInfo = layout.schema.sensors[sensors[i]];
+			int sensor = layout.source[sensors[i]];
+			out += firstSensor ? "{\"id\":" : ",{\"id\":";
+			out += std::to_string(id++);
+			out += ",\"Text\":";
+			SensorFormat::AppendJsonString(out, sensorInfo.name);
+			out += ",\"Children\":[],\"Min\":";
+			SensorFormat::AppendJsonString(out, SensorFormat::FormatValue(g_state.mins[sensor], format));
+			out += ",\"Value\":";
+			SensorFormat::AppendJsonString(out, SensorFormat::FormatValue(g_state.values[sensor], format));
+			out += ",\"Max\":";
+			SensorFormat::AppendJsonString(out, SensorFormat::FormatValue(g_state.maxs[sensor], format));
+			out += ",\"SensorId\":";
+			SensorFormat::AppendJsonString(out, sensorInfo.id);
+			out += ",\"Type\":";
+			SensorFormat::AppendJsonString(out, sensorInfo.type);
+			out += ",\"ImageURL\":\"\"}";
+			firstSensor = false;
+		}
+		out += "],\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"ImageURL\":\"\"}";
+	}
+
+	// The bridge numbers sub-hardware with a counter of its own, starting at 1
+	int subId = 1;
+	for (int child : layout.children[hardware]) {
+		if (IsPresetExcluded(layout.schema.hardware[child], presets)) {
+			continue;
+		}
+		out += first ? "" : ",";
+		AppendHardware(out, layout, child, presets, subId);
+		first = false;
+	}
+
+	out += "],\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"HardwareId\":";
+	SensorFormat::AppendJsonString(out, info.id);
+	int recorded = layout.hardwareSource[hardware];
+	char times[96];
+	std::snprintf(times, sizeof(times), ",\"UpdateStart\":%.3f,\"UpdateEnd\":%.3f",
+		g_state.updateStart[recorded], g_state.updateEnd[recorded]);
+	out += times;
+	out += ",\"ImageURL\":";
+	SensorFormat::AppendJsonString(out, SensorFormat::HardwareImageUrl(info.type));
+	out += "}";
+}
+
+// ---- BridgeApi implementation ----
+
+int Initialize(bool cpu, bool gpu, bool motherboard, bool memory, bool storage, bool network,
+	bool psu, bool controller, bool battery, bool, bool) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.reader) {
+		return 1;
+	}
+	g_state.categories = CategoriesOf(cpu, gpu, motherboard, memory, storage, network, psu, controller, battery);
+	FilterLayouts();
+	g_state.running = true;
+	g_state.start = std::chrono::steady_clock::now();
+	g_state.steps = 0;
+	g_state.active = -1;
+	Advance();
+	g_state.steps = 0;  // The first update shows the first frame again
+	return 0;
+}
+
+int Update(int categoryMask) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return 1;
+	}
+	// An update of categories without hardware touches nothing, so the trace holds
+	if (HasHardwareIn((uint32_t)categoryMask)) {
+		Advance(-1, (uint32_t)categoryMask);
+	}
+	return 0;
+}
+
+// Advance and write the poll tree into g_state.pollJson (caller holds the mutex)
+// @returns the hardware skipped
+int WritePollLocked(int budgetMs, int presets) {
+	int skipped = Advance(budgetMs);
+
+	const Layout& layout = g_state.layouts[g_state.active];
+	const std::string& host = g_state.reader->Host();
+	std::string& json = g_state.pollJson;
+	json.clear();
+	json.reserve(256 + layout.schema.sensors.size() * 200);
+	json += "{\"id\":0,\"Text\":\"Sensor\",\"Min\":\"Min\",\"Value\":\"Value\",\"Max\":\"Max\",\"ImageURL\":\"\",";
+	json += "\"Children\":[{\"id\":1,\"Text\":";
+	SensorFormat::AppendJsonString(json, host.empty() ? "Replay" : host);
+	json += ",\"Min\":\"\",\"Value\":\"\",\"Max\":\"\",\"ImageURL\":\"images_icon/computer.png\",\"Children\":[";
+	int id = 2;
+	bool first = true;
+	for (int hardware : layout.topLevel) {
+		if (IsPresetExcluded(layout.schema.hardware[hardware], presets)) {
+			continue;
+		}
+		json += first ? "" : ",";
+		AppendHardware(json, layout, hardware, presets, id);
+		first = false;
+	}
+	json += "]}]}";
+	if (g_state.options.writeMs > 0) {
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(g_state.options.writeMs));
+	}
+	return skipped;
+}
+
+void* Poll() {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return nullptr;
+	}
+	WritePollLocked(-1, 0);
+	g_state.pollPending = false;
+	return CopyString(g_state.pollJson);
+}
+
+void* PollWithin(int budgetMs, int* skippedHardware) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return nullptr;
+	}
+	int skipped = WritePollLocked(std::max(0, budgetMs), 0);
+	g_state.pollPending = false;
+	if (skippedHardware != nullptr) {
+		*skippedHardware = skipped;
+	}
+	return CopyString(g_state.pollJson);
+}
+
+int PollInto(char* buffer, int capacity, int budgetMs, int filterPresets, int* skippedHardware) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return 0;
+	}
+	if (!g_state.pollPending) {
+		g_state.pollSkipped = WritePollLocked(budgetMs, filterPresets);
+	}
+	const std::string& json = g_state.pollJson;
+	if (buffer == nullptr || (size_t)capacity < json.size() + 1) {
+		g_state.pollPending = true;
+		return -(int)(json.size() + 1);
+	}
+	g_state.pollPending = false;
+	std::memcpy(buffer, json.c_str(), json.size() + 1);
+	if (skippedHardware != nullptr) {
+		*skippedHardware = g_state.pollSkipped;
+	}
+	return (int)json.size();
+}
+
+void FreeString(void* ptr) {
+	std::free(ptr);
+}
+
+void Shutdown() {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	g_state.running = false;
+	// Like the bridge, the next Initialize starts unfiltered
+	g_state.filter = Filter();
+	g_state.categories = kCategoryAll;
+	FilterLayouts();
+}
+
+void* GetSchema() {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return nullptr;
+	}
+	SensorSchema& schema = g_state.layouts[g_state.active].schema;
+	schema.generation = g_state.generation;
+	return CopyString(schema.Format(schema.hardware.size(), schema.sensors.size()));
+}
+
+int GetSchemaGeneration() {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	return g_state.generation;
+}
+
+int ReadValues(float* values, float* mins, float* maxs, int capacity) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (g_state.active < 0) {
+		return 0;
+	}
+	const std::vector<int>& source = g_state.layouts[g_state.active].source;
+	int count = (int)source.size();
+	if (count > capacity) {
+		return -count;
+	}
+	for (int i = 0; i < count; i++) {
+		values[i] = g_state.values[source[i]];
+		if (mins != nullptr) mins[i] = g_state.mins[source[i]];
+		if (maxs != nullptr) maxs[i] = g_state.maxs[source[i]];
+	}
+	return count;
+}
+
+int UpdateHardware(const int32_t* indices, int count) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return -1;
+	}
+	const float* values = Seek();
+	const Layout& layout = g_state.layouts[g_state.active];
+	for (int i = 0; i < count; i++) {
+		if (indices[i] < 0 || indices[i] >= (int)layout.hardwareSource.size()) {
+			return -2;
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		UpdateOne(layout.hardwareSource[indices[i]], values);
+	}
+	return 0;
+}
+
+int ReadSensorValues(const int32_t* indices, float* values, int count) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (g_state.active < 0) {
+		return -1;
+	}
+	const std::vector<int>& source = g_state.layouts[g_state.active].source;
+	for (int i = 0; i < count; i++) {
+		if (indices[i] < 0 || indices[i] >= (int)source.size()) {
+			return -2;
+		}
+		values[i] = g_state.values[source[indices[i]]];
+	}
+	return count;
+}
+
+int SetFilter(const char* filterJson) {
+	Filter filter;
+	if (filterJson != nullptr && !FilterParser(filterJson).Run(filter)) {
+		return -1;
+	}
+
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	g_state.filter = std::move(filter);
+	FilterLayouts();
+	// A new schema, even when the filter happens to keep everything (as the bridge does)
+	if (g_state.running) {
+		g_state.generation++;
+		g_state.pollPending = false;
+	}
+	return 0;
+}
+
+int Reconfigure(bool cpu, bool gpu, bool motherboard, bool memory, bool storage, bool network,
+	bool psu, bool controller, bool battery, bool, bool) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (!g_state.running) {
+		return 1;
+	}
+	uint32_t categories = CategoriesOf(cpu, gpu, motherboard, memory, storage, network, psu, controller, battery);
+	if (categories == g_state.categories) {
+		return 0;
+	}
+	std::vector<std::vector<int>> previous;
+	for (const Layout& layout : g_state.layouts) {
+		previous.push_back(layout.hardwareSource);
+	}
+	g_state.categories = categories;
+	FilterLayouts();
+	// Like the bridge, only hardware actually opened or closed makes a new schema
+	for (size_t i = 0; i < previous.size(); i++) {
+		if (previous[i] != g_state.layouts[i].hardwareSource) {
+			g_state.generation++;
+			g_state.pollPending = false;
+			break;
+		}
+	}
+	return 0;
+}
+
+} // namespace
+
+namespace ReplayBridge {
+
+bool Open(const std::string& path, const ReplayOptions& options, std::string& error) {
+	std::lock_guard<std::mutex> lock(g_state.mutex);
+	if (g_state.running) {
+		if (path == g_state.path) {
+			return true;
+		}
+		error = "Another trace is already being replayed in this process";
+		return false;
+	}
+
+	std::unique_ptr<TraceReader> reader(new TraceReader());
+	if (!reader->Open(path, error)) {
+		return false;
+	}
+
+	std::vector<SensorSchema> schemas(reader->Schemas().size());
+	for (size_t i = 0; i < schemas.size(); i++) {
+		const TraceReader::Schema& recorded = reader->Schemas()[i];
+		if (!SensorSchema::Parse(recorded.text.c_str(), schemas[i]) ||
+		    schemas[i].sensors.size() != recorded.sensorCount) {
+			error = "Corrupt schema record in sensor trace " + path;
+			return false;
+		}
+	}
+
+	g_state.reader = std::move(reader);
+	g_state.path = path;
+	g_state.options = options;
+	g_state.recorded = std::move(schemas);
+	g_state.filter = Filter();
+	FilterLayouts();
+	g_state.active = -1;
+	return true;
+}
+
+const BridgeApi* Api() {
+	static const BridgeApi api = [] {
+		BridgeApi table;
+		table.initialize = Initialize;
+		table.poll = Poll;
+		table.freeString = FreeString;
+		table.shutdown = Shutdown;
+		table.getSchema = GetSchema;
+		table.getSchemaGeneration = GetSchemaGeneration;
+		table.update = Update;
+		table.readValues = ReadValues;
+		table.setFilter = SetFilter;
+		table.updateHardware = UpdateHardware;
+		table.readSensorValues = ReadSensorValues;
+		table.pollWithin = PollWithin;
+		table.pollInto = PollInto;
+		table.reconfigure = Reconfigure;
+		return table;
+	}();
+	return &api;
+}
+
+} // namespace ReplayBridge
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bridge_api.h"
+#include <string>
+
+/**
+ * Replay options
+ */
+struct ReplayOptions {
+    double speed = 1;          // Trace time per wall-clock time; 0 steps one frame per update
+    bool loop = true;          // Start over after the last frame, else hold it
+    double updateMs = 0;       // CPU time each hardware update takes, to exercise poll deadlines and the CPU budget
+    double writeMs = 0;        // Time writing a poll tree takes
+};
+
+/**
+ * Replay Bridge - in-process bridge that plays back a recorded sensor trace
+ * Implements the BridgeApi contract from a trace file: the recorded schemas
+ * become schema generations (a topology change in the recording is one on
+ * replay), and each update moves to the frame at the current trace time.
+ * poll() builds the bridge's JSON tree, with Min/Max tracked over the replay
+ * per sensor id. Polls with a budget skip hardware the way the bridge does,
+ * against the simulated update and write times of ReplayOptions. Bursts
+ * (UpdateHardware) step a frame too, taking only the listed hardware from it.
+ *
+ * Filters and the Initialize/Reconfigure category flags apply on top of the
+ * recording the way the bridge applies them to live hardware (a new schema
+ * generation), and the legacy poll presets drop hardware from that poll's tree
+ * only. Updates of a category mask take only that category's hardware from the
+ * frame; an update of categories without hardware holds the frame. Values, Min and Max are kept for every
+ * recorded sensor, so clearing a filter brings them back with their history.
+ */
+namespace ReplayBridge {
+
+/**
+ * Load a trace for the next Initialize
+ * While a replay is running only the same path can be opened again (another
+ * environment joining it); the options of the running replay stay in effect.
+ * @returns true on success
+ */
+bool Open(const std::string& path, const ReplayOptions& options, std::string& error);
+
+/**
+ * Function table to hand to MonitorBackend::Acquire
+ */
+const BridgeApi* Api();
+
+} // namespace ReplayBridge
@@ -0,0 +1,487 @@
+#include "sampler.h"
+#include "monitor_backend.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+// Accounting window: long enough to average out coarse thread-time clocks
+const std::chrono::milliseconds kMinWindow(2000);
+const uint32_t kWindowTicks = 4;
+
+// Relax only with clear headroom, and only to a rate that keeps some
+const double kRelaxBelow = 0.7;
+const double kRelaxTarget = 0.9;
+
+const size_t kMaxDecisions = 32;
+
+// Adaptive intervals: a change below threshold * kCalmFraction counts as calm,
+// and kCalmUpdates calm updates in a row lengthen the interval by half
+const double kCalmFraction = 0.25;
+const uint32_t kCalmUpdates = 3;
+
+} // namespace
+
+uint64_t ThreadCpu::Ticks() {
+#ifdef _WIN32
+	ULONG64 cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &cycles);
+	return cycles;
+#else
+	return Ns();
+#endif
+}
+
+uint64_t ThreadCpu::Ns() {
+#ifdef _WIN32
+	FILETIME created, exited, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) {
+		return 0;
+	}
+	uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (k + u) * 100;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void JitterStats::Record(double delayUs) {
+	int bucket = 0;
+	while (bucket < kBuckets - 1 && delayUs >= (double)(1u << bucket)) {
+		bucket++;
+	}
+	counts[bucket]++;
+	ticks++;
+	sumUs += delayUs;
+	maxUs = std::max(maxUs, delayUs);
+}
+
+Sampler::Sampler(MonitorBackend* backend)
+	: m_backend(backend)
+	, m_stopRequested(false)
+	, m_running(false)
+	, m_intervalMs(1000)
+	, m_tickMs(1000)
+	, m_enabledMask(0)
+	, m_budgetPercent(0)
+	, m_usagePercent(0)
+	, m_budgetUnreachable(false)
+	, m_windowCpuNs(0)
+	, m_windowCpuTicks(0)
+	, m_windowSamples(0)
+{
+	for (int i = 0; i < kCategoryCount; i++) {
+		m_rates[i].category = i;
+	}
+}
+
+Sampler::~Sampler() {
+	Stop();
+}
+
+void Sampler::Start(uint32_t intervalMs) {
+	if (intervalMs == 0) {
+		intervalMs = 1;
+	}
+
+	uint32_t enabledMask = m_backend->GetConfig().CategoryMask();
+
+	std::lock_guard<std::mutex> control(m_controlMutex);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_intervalMs = intervalMs;
+
+	{
+		std::lock_guard<std::mutex> governor(m_governorMutex);
+		m_enabledMask = enabledMask;
+		RebaseLocked();
+	}
+
+	if (m_running) {
+		// Running thread picks up the new interval on its next wait
+		m_wakeup.notify_all();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> governor(m_governorMutex);
+		m_jitter = JitterStats();
+	}
+	m_stopRequested = false;
+	m_running = true;
+	m_thread = std::thread(&Sampler::Run, this);
+}
+
+void Sampler::Stop() {
+	std::lock_guard<std::mutex> control(m_controlMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_running) {
+			return;
+		}
+		m_stopRequested = true;
+		m_wakeup.notify_all();
+	}
+
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	m_running = false;
+}
+
+void Sampler::SetCpuBudget(double percent) {
+	std::lock_guard<std::mutex> lock(m_governorMutex);
+	m_budgetPercent = percent > 0 ? percent : 0;
+	m_budgetUnreachable = false;
+	if (m_budgetPercent == 0) {
+		for (CategoryRate& rate : m_rates) {
+			rate.budgetFactor = 1;
+			rate.stretch = rate.baseStretch;
+		}
+	}
+}
+
+void Sampler::SetAdaptive(const AdaptiveConfig& config) {
+	{
+		std::lock_guard<std::mutex> lock(m_governorMutex);
+		m_adaptive = config;
+		RebaseLocked();
+	}
+	// Re-arm a running sampler with the new tick
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_wakeup.notify_all();
+}
+
+void Sampler::SetEnabledCategories(uint32_t categoryMask) {
+	{
+		std::lock_guard<std::mutex> lock(m_governorMutex);
+		m_enabledMask = categoryMask;
+		RebaseLocked();
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_wakeup.notify_all();
+}
+
+GovernorStats Sampler::GetGovernorStats() {
+	GovernorStats stats;
+	stats.running = m_running.load();
+	stats.intervalMs = m_intervalMs.load();
+
+	std::lock_guard<std::mutex> lock(m_governorMutex);
+	stats.tickMs = m_tickMs.load();
+	stats.adaptive = m_adaptive.Enabled();
+	stats.changeThreshold = m_adaptive.changeThreshold;
+	stats.budgetPercent = m_budgetPercent;
+	stats.usagePercent = m_usagePercent;
+	stats.budgetUnreachable = m_budgetUnreachable;
+	for (const CategoryRate& rate : m_rates) {
+		if ((m_enabledMask & (1u << rate.category)) != 0) {
+			stats.categories.push_back(rate);
+		}
+	}
+	stats.decisions.assign(m_decisions.begin(), m_decisions.end());
+	stats.jitter = m_jitter;
+	return stats;
+}
+
+void Sampler::Run() {
+	using clock = std::chrono::steady_clock;
+	bool loggedError = false;
+	auto next = clock::now();
+	auto due = next;         // When this tick should have started
+	uint64_t missed = 0;     // Ticks skipped before it
+	uint64_t tick = 0;
+	BeginWindow();
+
+	while (true) {
+		double delayUs = std::chrono::duration<double, std::micro>(clock::now() - due).count();
+		{
+			std::lock_guard<std::mutex> governor(m_governorMutex);
+			m_jitter.Record(std::max(0.0, delayUs));
+			m_jitter.missedTicks += missed;
+		}
+		uint32_t mask = DueCategories(tick++);
+		uint64_t cpuTicks[kCategoryCount] = {};
+		double changes[kCategoryCount];
+		// Ticks between adaptive categories' due points have nothing to publish
+		if (mask != 0) {
+			try {
+				m_backend->Sample(mask, cpuTicks, changes);
+				loggedError = false;
+				std::lock_guard<std::mutex> governor(m_governorMutex);
+				AdaptLocked(mask, changes);
+			} catch (const std::exception& e) {
+				// Keep sampling; hardware errors are often transient
+				if (!loggedError) {
+					std::cerr << "Sampler: " << e.what() << std::endl;
+					loggedError = true;
+				}
+			}
+		}
+
+		for (int i = 0; i < kCategoryCount; i++) {
+			if ((mask & (1u << i)) != 0) {
+				m_categoryTicks[i] += cpuTicks[i];
+				m_categoryUpdates[i]++;
+			}
+		}
+		m_windowSamples++;
+
+		auto window = std::chrono::milliseconds(m_intervalMs.load() * kWindowTicks);
+		if (clock::now() - m_windowStart >= std::max<std::chrono::milliseconds>(window, kMinWindow)) {
+			EndWindow();
+			BeginWindow();
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto interval = std::chrono::milliseconds(m_tickMs.load());
+		next += interval;
+		due = next;
+		missed = 0;
+
+		// Fell behind (slow update): start the next sample now instead of bursting
+		auto now = clock::now();
+		if (next < now) {
+			missed = (uint64_t)((now - next) / interval);
+			due = next + interval * (int64_t)missed;
+			next = now;
+		}
+
+		// Wake early only to stop or to re-arm with a changed interval
+		while (!m_stopRequested && clock::now() < next) {
+			if (m_wakeup.wait_until(lock, next) == std::cv_status::no_timeout) {
+				auto changed = std::chrono::milliseconds(m_tickMs.load());
+				if (changed != interval) {
+					next = next - interval + changed;
+					due = next;
+					interval = changed;
+				}
+			}
+		}
+
+		if (m_stopRequested) {
+			break;
+		}
+	}
+}
+
+uint32_t Sampler::DueCategories(uint64_t tick) {
+	std::lock_guard<std::mutex> lock(m_governorMutex);
+	uint32_t mask = 0;
+	for (CategoryRate& rate : m_rates) {
+		if ((m_enabledMask & (1u << rate.category)) == 0) {
+			continue;
+		}
+		// A shortened interval takes effect at once instead of after the old one
+		if (rate.nextTick > tick + rate.stretch) {
+			rate.nextTick = tick + rate.stretch;
+		}
+		if (tick >= rate.nextTick) {
+			mask |= 1u << rate.category;
+			rate.nextTick = tick + rate.stretch;
+		}
+	}
+	return mask;
+}
+
+void Sampler::RebaseLocked() {
+	// Tick at the finest interval anyone asked for
+	uint32_t intervalMs = m_intervalMs.load();
+	uint32_t tickMs = intervalMs;
+	for (int i = 0; i < kCategoryCount; i++) {
+		const AdaptiveRange& range = m_adaptive.ranges[i];
+		if ((m_enabledMask & (1u << i)) != 0 && range.minIntervalMs > 0) {
+			tickMs = std::min(tickMs, range.minIntervalMs);
+		}
+	}
+	m_tickMs = tickMs;
+
+	for (CategoryRate& rate : m_rates) {
+		const AdaptiveRange& range = m_adaptive.ranges[rate.category];
+		if (range.minIntervalMs > 0) {
+			rate.minStretch = std::max(1u, range.minIntervalMs / tickMs);
+			rate.maxStretch = std::max(rate.minStretch, std::max(range.minIntervalMs, range.maxIntervalMs) / tickMs);
+			if (rate.baseStretch < rate.minStretch || rate.baseStretch > rate.maxStretch) {
+				rate.baseStretch = rate.minStretch;
+			}
+		} else {
+			rate.minStretch = 0;
+			rate.maxStretch = 0;
+			rate.baseStretch = std::max(1u, (intervalMs + tickMs / 2) / tickMs);
+		}
+		rate.stretch = rate.baseStretch * rate.budgetFactor;
+		rate.calmUpdates = 0;
+	}
+}
+
+void Sampler::AdaptLocked(uint32_t mask, const double* changes) {
+	double threshold = m_adaptive.changeThreshold;
+	for (CategoryRate& rate : m_rates) {
+		if ((mask & (1u << rate.category)) == 0 || rate.minStretch == 0) {
+			continue;
+		}
+		double change = changes[rate.category];
+		if (std::isnan(change)) {
+			continue;  // First sample after a schema change
+		}
+		rate.changeRate = rate.changeRate * 0.8 + change * 0.2;
+
+		uint32_t base = rate.baseStretch;
+		if (change >= threshold) {
+			// React quickly to activity
+			base = std::max(rate.minStretch, base / 2);
+			rate.calmUpdates = 0;
+		} else if (change < threshold * kCalmFraction) {
+			// Back off slowly once things settle
+			if (++rate.calmUpdates >= kCalmUpdates) {
+				base = std::min(rate.maxStretch, std::max(base + 1, base + base / 2));
+				rate.calmUpdates = 0;
+			}
+		} else {
+			rate.calmUpdates = 0;
+		}
+
+		if (base != rate.baseStretch) {
+			rate.baseStretch = base;
+			rate.stretch = base * rate.budgetFactor;
+		}
+	}
+}
+
+void Sampler::BeginWindow() {
+	m_windowStart = std::chrono::steady_clock::now();
+	m_windowCpuNs = ThreadCpu::Ns();
+	m_windowCpuTicks = ThreadCpu::Ticks();
+	m_windowSamples = 0;
+	std::memset(m_categoryTicks, 0, sizeof(m_categoryTicks));
+	std::memset(m_categoryUpdates, 0, sizeof(m_categoryUpdates));
+}
+
+void Sampler::EndWindow() {
+	double wallNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - m_windowStart).count();
+	double cpuNs = (double)(ThreadCpu::Ns() - m_windowCpuNs);
+	double cpuTicks = (double)(ThreadCpu::Ticks() - m_windowCpuTicks);
+	if (wallNs <= 0 || m_windowSamples == 0) {
+		return;
+	}
+
+	// Precise per-category ticks, scaled to the thread's measured CPU time
+	double nsPerTick = cpuTicks > 0 ? cpuNs / cpuTicks : 0;
+	double usage = cpuNs / wallNs * 100.0;
+
+	std::lock_guard<std::mutex> lock(m_governorMutex);
+	double attributedNs = 0;
+	for (CategoryRate& rate : m_rates) {
+		uint64_t updates = m_categoryUpdates[rate.category];
+		if (updates == 0) {
+			continue;  // Stretched past this window; keep the last estimate
+		}
+		double spentNs = m_categoryTicks[rate.category] * nsPerTick;
+		double cost = spentNs / updates;
+		rate.costNs = rate.updates == 0 ? cost : rate.costNs * 0.5 + cost * 0.5;
+		rate.updates += updates;
+		attributedNs += spentNs;
+	}
+
+	m_usagePercent = usage;
+	if (m_budgetPercent > 0) {
+		// Publishing, schema reloads and the wait itself are not per category
+		double overheadNsPerTick = std::max(0.0, cpuNs - attributedNs) / m_windowSamples;
+		AdjustLocked(usage, overheadNsPerTick);
+	}
+}
+
+double Sampler::PredictLocked(double overheadNsPerTick) const {
+	double ns = overheadNsPerTick;
+	for (const CategoryRate& rate : m_rates) {
+		if ((m_enabledMask & (1u << rate.category)) != 0) {
+			ns += rate.costNs / rate.stretch;
+		}
+	}
+	return ns / (m_tickMs.load() * 1e6) * 100.0;
+}
+
+void Sampler::AdjustLocked(double usagePercent, double overheadNsPerTick) {
+	// Calibrate the cost model against what was actually measured
+	double predicted = PredictLocked(overheadNsPerTick);
+	double scale = predicted > 0 ? usagePercent / predicted : 1.0;
+
+	if (usagePercent > m_budgetPercent) {
+		// Halve the rate of the category costing the most per tick until the model fits
+		while (PredictLocked(overheadNsPerTick) * scale > m_budgetPercent) {
+			CategoryRate* worst = nullptr;
+			for (CategoryRate& rate : m_rates) {
+				if ((m_enabledMask & (1u << rate.category)) == 0 || rate.budgetFactor >= kMaxStretch || rate.costNs <= 0) {
+					continue;
+				}
+				if (worst == nullptr || rate.costNs / rate.stretch > worst->costNs / worst->stretch) {
+					worst = &rate;
+				}
+			}
+			if (worst == nullptr) {
+				m_budgetUnreachable = true;
+				return;
+			}
+			RecordLocked(worst->category, worst->budgetFactor * 2, usagePercent);
+		}
+		m_budgetUnreachable = false;
+		return;
+	}
+
+	m_budgetUnreachable = false;
+	if (usagePercent >= m_budgetPercent * kRelaxBelow) {
+		return;
+	}
+
+	// One step per window: restore the cheapest throttled category first
+	CategoryRate* candidate = nullptr;
+	for (CategoryRate& rate : m_rates) {
+		if ((m_enabledMask & (1u << rate.category)) == 0 || rate.budgetFactor <= 1) {
+			continue;
+		}
+		if (candidate == nullptr || rate.costNs < candidate->costNs) {
+			candidate = &rate;
+		}
+	}
+	if (candidate == nullptr) {
+		return;
+	}
+
+	uint32_t stretch = candidate->stretch;
+	candidate->stretch = candidate->baseStretch * (candidate->budgetFactor / 2);
+	bool fits = PredictLocked(overheadNsPerTick) * scale <= m_budgetPercent * kRelaxTarget;
+	candidate->stretch = stretch;
+	if (fits) {
+		RecordLocked(candidate->category, candidate->budgetFactor / 2, usagePercent);
+	}
+}
+
+void Sampler::RecordLocked(int category, uint32_t budgetFactor, double usagePercent) {
+	CategoryRate& rate = m_rates[category];
+	GovernorDecision decision;
+	decision.timestamp = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+	decision.category = category;
+	decision.fromStretch = rate.stretch;
+	decision.toStretch = rate.baseStretch * budgetFactor;
+	decision.usagePercent = usagePercent;
+
+	rate.budgetFactor = budgetFactor;
+	rate.stretch = decision.toStretch;
+	m_decisions.push_back(decision);
+	if (m_decisions.size() > kMaxDecisions) {
+		m_decisions.pop_front();
+	}
+}
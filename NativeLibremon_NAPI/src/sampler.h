@@ -0,0 +1,215 @@
+#pragma once
+
+#include "hardware_monitor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MonitorBackend;
+
+/**
+ * CPU time of the calling thread
+ * Ticks are precise but in platform units (cycles on Windows, ns elsewhere)
+ * and only used for ratios; Ns is comparable with wall time.
+ */
+struct ThreadCpu {
+    static uint64_t Ticks();
+    static uint64_t Ns();
+};
+
+/**
+ * Interval bounds of one adaptively sampled category
+ */
+struct AdaptiveRange {
+    uint32_t minIntervalMs = 0;  // 0: category follows the sampler interval
+    uint32_t maxIntervalMs = 0;
+};
+
+/**
+ * Adaptive sampling configuration
+ * A category's interval halves (down to its minimum) when one of its sensors
+ * moves by at least changeThreshold between two of its samples, and grows
+ * (up to its maximum) after several samples in which nothing moved.
+ */
+struct AdaptiveConfig {
+    double changeThreshold = 0.02;  // Relative change, |v - prev| / max(|prev|, 1)
+    AdaptiveRange ranges[kCategoryCount];
+
+    bool Enabled() const {
+        for (const AdaptiveRange& range : ranges) {
+            if (range.minIntervalMs > 0) return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * Sampling rate and measured cost of one hardware category
+ */
+struct CategoryRate {
+    int category = 0;          // Bit index (see CategoryName)
+    uint32_t stretch = 1;      // Updated every stretch-th sampler tick (baseStretch * budgetFactor)
+    uint32_t baseStretch = 1;  // From the sampler interval, or set by the adaptive controller
+    uint32_t budgetFactor = 1; // Governor throttle, a power of two
+    double costNs = 0;         // Sampler-thread CPU time per update (smoothed)
+    uint64_t updates = 0;
+
+    // Adaptive sampling
+    uint32_t minStretch = 0;   // 0: not adaptive
+    uint32_t maxStretch = 0;
+    double changeRate = 0;     // Largest relative sensor change per update (smoothed)
+    uint32_t calmUpdates = 0;  // Consecutive updates below the calm threshold
+    uint64_t nextTick = 0;     // Sampler thread only
+};
+
+/**
+ * One governor adjustment of a category's stretch
+ */
+struct GovernorDecision {
+    double timestamp = 0;      // ms since Unix epoch
+    int category = 0;
+    uint32_t fromStretch = 1;
+    uint32_t toStretch = 1;
+    double usagePercent = 0;   // Measured sampler CPU usage that triggered it
+};
+
+/**
+ * How late sampler ticks start relative to the intended cadence
+ * Bucket i counts delays below 2^i microseconds (and at least 2^(i-1)), the
+ * last one everything longer. A tick that starts after an overrunning sample
+ * counts its delay from the latest due time it passed; the due times before
+ * that are skipped and counted in missedTicks.
+ */
+struct JitterStats {
+    static const int kBuckets = 24;   // Up to 2^23 us, about 8 s
+    uint64_t counts[kBuckets] = {};
+    uint64_t ticks = 0;
+    uint64_t missedTicks = 0;
+    double sumUs = 0;
+    double maxUs = 0;
+
+    void Record(double delayUs);
+};
+
+/**
+ * Snapshot of the sampler's CPU accounting and governor state
+ */
+struct GovernorStats {
+    bool running = false;
+    uint32_t intervalMs = 0;         // Configured sampler interval
+    uint32_t tickMs = 0;             // Wake-up period; category intervals are multiples of it
+    bool adaptive = false;
+    double changeThreshold = 0;
+    double budgetPercent = 0;        // 0 when no budget is set
+    double usagePercent = 0;         // Sampler thread CPU over the last window
+    bool budgetUnreachable = false;  // Every category is at the maximum stretch
+    std::vector<CategoryRate> categories;     // Enabled categories
+    std::vector<GovernorDecision> decisions;  // Most recent last
+    JitterStats jitter;              // Since the sampler was last started
+};
+
+/**
+ * Sampler - native thread that samples the backend at a fixed cadence
+ * Each tick updates the due categories and publishes the value vector to the
+ * backend's sample listeners, without involving any JavaScript thread.
+ *
+ * Categories are updated one at a time so the sampler can account its own
+ * CPU time per category. With a CPU budget, the governor stretches the
+ * interval of the most expensive categories (by powers of two, up to
+ * kMaxStretch ticks) until the sampler thread stays under the budget, and
+ * relaxes them again when there is headroom.
+ *
+ * With adaptive sampling the thread ticks at the smallest configured minimum
+ * interval, and each adaptive category moves its own interval between its
+ * bounds based on how much its sensors changed (see AdaptiveConfig). The
+ * governor's throttle applies on top of the adaptive interval.
+ */
+class Sampler {
+public:
+    static const uint32_t kMaxStretch = 64;
+
+    explicit Sampler(MonitorBackend* backend);
+    ~Sampler();
+
+    /**
+     * Start sampling, or change the interval of a running sampler
+     * @param intervalMs - time between sample starts
+     */
+    void Start(uint32_t intervalMs);
+
+    /**
+     * Stop sampling and join the sampler thread
+     */
+    void Stop();
+
+    /**
+     * Limit the sampler thread's CPU usage
+     * @param percent - share of one core; 0 removes the budget and restores full rate
+     */
+    void SetCpuBudget(double percent);
+
+    /**
+     * Enable or replace adaptive per-category intervals
+     * Categories without a range keep following the sampler interval.
+     */
+    void SetAdaptive(const AdaptiveConfig& config);
+
+    /**
+     * Categories the sampler schedules (the backend's enabled hardware types)
+     */
+    void SetEnabledCategories(uint32_t categoryMask);
+
+    /**
+     * Rates, costs and recent governor decisions
+     */
+    GovernorStats GetGovernorStats();
+
+    bool IsRunning() const { return m_running.load(); }
+    uint32_t GetIntervalMs() const { return m_intervalMs.load(); }
+
+private:
+    void Run();
+
+    // Governor (sampler thread; state shared with GetGovernorStats under m_governorMutex)
+    uint32_t DueCategories(uint64_t tick);
+    void RebaseLocked();
+    void AdaptLocked(uint32_t mask, const double* changes);
+    void BeginWindow();
+    void EndWindow();
+    void AdjustLocked(double usagePercent, double overheadNsPerTick);
+    double PredictLocked(double overheadNsPerTick) const;
+    void RecordLocked(int category, uint32_t budgetFactor, double usagePercent);
+
+    MonitorBackend* m_backend;
+    std::thread m_thread;
+    std::mutex m_controlMutex;   // Serializes Start/Stop
+    std::mutex m_mutex;          // Guards m_stopRequested for the wait
+    std::condition_variable m_wakeup;
+    bool m_stopRequested;
+    std::atomic<bool> m_running;
+    std::atomic<uint32_t> m_intervalMs;
+    std::atomic<uint32_t> m_tickMs;
+
+    std::mutex m_governorMutex;
+    uint32_t m_enabledMask;
+    double m_budgetPercent;
+    double m_usagePercent;
+    bool m_budgetUnreachable;
+    AdaptiveConfig m_adaptive;
+    CategoryRate m_rates[kCategoryCount];
+    std::deque<GovernorDecision> m_decisions;
+    JitterStats m_jitter;
+
+    // Current accounting window (sampler thread only)
+    std::chrono::steady_clock::time_point m_windowStart;
+    uint64_t m_windowCpuNs;
+    uint64_t m_windowCpuTicks;
+    uint64_t m_windowSamples;
+    uint64_t m_categoryTicks[kCategoryCount];
+    uint64_t m_categoryUpdates[kCategoryCount];
+};
@@ -0,0 +1,131 @@
+#include "sensor_format.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const SensorTypeFormat kTypes[] = {
+	{ "Voltage", "Voltages", 3, " V" },
+	{ "Current", "Current", 3, " A" },
+	{ "Power", "Powers", 1, " W" },
+	{ "Clock", "Clocks", 1, " MHz" },
+	{ "Temperature", "Temperatures", 1, " \xC2\xB0" "C" },
+	{ "Load", "Load", 1, " %" },
+	{ "Frequency", "Frequencies", 1, " Hz" },
+	{ "Fan", "Fans", 0, " RPM" },
+	{ "Flow", "Flow", 1, " L/h" },
+	{ "Control", "Controls", 1, " %" },
+	{ "Level", "Levels", 1, " %" },
+	{ "Factor", "Factors", 3, "" },
+	{ "Data", "Data", 1, " GB" },
+	{ "SmallData", "Data", 1, " MB" },
+	{ "Throughput", "Throughput", -1, nullptr },
+	{ "TimeSpan", "TimeSpan", -1, nullptr },
+	{ "Timing", "Timing", 3, " ns" },
+	{ "Energy", "Energy", 0, " mWh" },
+	{ "Noise", "Noise", 0, " dBA" },
+	{ "Conductivity", "Conductivity", 1, " \xC2\xB5S/cm" },
+	{ "Humidity", "Humidity", 0, " %" },
+};
+
+const size_t kTypeCount = sizeof(kTypes) / sizeof(kTypes[0]);
+
+} // namespace
+
+namespace SensorFormat {
+
+size_t TypeCount() {
+	return kTypeCount;
+}
+
+const SensorTypeFormat& Type(size_t index) {
+	return kTypes[index];
+}
+
+int TypeIndex(const std::string& type) {
+	for (size_t i = 0; i < kTypeCount; i++) {
+		if (type == kTypes[i].type) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+std::string FormatValue(double value, const SensorTypeFormat& format) {
+	if (std::isnan(value)) {
+		return "";
+	}
+
+	char buffer[64];
+	if (std::strcmp(format.type, "Throughput") == 0) {
+		const double mb = 1048576.0;
+		if (value < mb) {
+			std::snprintf(buffer, sizeof(buffer), "%.1f KB/s", value / 1024.0);
+		} else {
+			std::snprintf(buffer, sizeof(buffer), "%.1f MB/s", value / mb);
+		}
+	} else if (std::strcmp(format.type, "TimeSpan") == 0) {
+		// TimeSpan "g" format: [d:]h:mm:ss
+		long long total = (long long)std::llround(std::fabs(value));
+		long long days = total / 86400;
+		int hours = (int)(total / 3600 % 24);
+		int minutes = (int)(total / 60 % 60);
+		int seconds = (int)(total % 60);
+		const char* sign = value < 0 ? "-" : "";
+		if (days > 0) {
+			std::snprintf(buffer, sizeof(buffer), "%s%lld:%d:%02d:%02d", sign, days, hours, minutes, seconds);
+		} else {
+			std::snprintf(buffer, sizeof(buffer), "%s%d:%02d:%02d", sign, hours, minutes, seconds);
+		}
+	} else {
+		std::snprintf(buffer, sizeof(buffer), "%.*f%s", format.decimals, value, format.unit);
+	}
+	return buffer;
+}
+
+const char* HardwareImageUrl(const std::string& hardwareType) {
+	static const struct {
+		const char* type;
+		const char* url;
+	} kImages[] = {
+		{ "Motherboard", "images_icon/mainboard.png" },
+		{ "SuperIO", "images_icon/chip.png" },
+		{ "Cpu", "images_icon/cpu.png" },
+		{ "GpuNvidia", "images_icon/nvidia.png" },
+		{ "GpuAmd", "images_icon/ati.png" },
+		{ "GpuIntel", "images_icon/intel.png" },
+		{ "Storage", "images_icon/hdd.png" },
+		{ "Memory", "images_icon/ram.png" },
+		{ "Network", "images_icon/nic.png" },
+		{ "Cooler", "images_icon/fan.png" },
+		{ "EmbeddedController", "images_icon/chip.png" },
+		{ "Psu", "images_icon/power.png" },
+		{ "Battery", "images_icon/battery.png" },
+	};
+	for (const auto& image : kImages) {
+		if (hardwareType == image.type) {
+			return image.url;
+		}
+	}
+	return "images_icon/computer.png";
+}
+
+void AppendJsonString(std::string& out, const std::string& text) {
+	out += '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if ((unsigned char)c < 0x20) {
+			char escape[8];
+			std::snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)c);
+			out += escape;
+		} else {
+			out += c;
+		}
+	}
+	out += '"';
+}
+
+} // namespace SensorFormat
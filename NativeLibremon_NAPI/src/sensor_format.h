@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * data.json formatting of a LibreHardwareMonitor SensorType, as the bridge's
+ * FormatSensorValue and GetSensorTypeName do
+ */
+struct SensorTypeFormat {
+    const char* type;
+    const char* group;     // Caption of the type's group node
+    int decimals;
+    const char* unit;      // nullptr: formatted by FormatValue's special cases
+};
+
+namespace SensorFormat {
+
+/**
+ * Known types in SensorType enum order, which is also the order of the
+ * type groups under a hardware node
+ */
+size_t TypeCount();
+const SensorTypeFormat& Type(size_t index);
+
+/**
+ * Position of a type name in enum order, -1 if unknown
+ */
+int TypeIndex(const std::string& type);
+
+/**
+ * Value text with unit ("45.0 °C"), empty for NaN
+ */
+std::string FormatValue(double value, const SensorTypeFormat& format);
+
+/**
+ * ImageURL of a hardware node, by HardwareType name
+ */
+const char* HardwareImageUrl(const std::string& hardwareType);
+
+/**
+ * Append text as a JSON string literal
+ */
+void AppendJsonString(std::string& out, const std::string& text);
+
+} // namespace SensorFormat
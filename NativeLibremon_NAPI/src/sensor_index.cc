@@ -0,0 +1,179 @@
+#include "sensor_index.h"
+#include <cctype>
+
+namespace {
+
+// Glob match of a sensor name, '*' any run and '?' one character, ignoring case
+bool MatchName(const char* pattern, const char* name) {
+	const char* star = nullptr;
+	const char* resume = nullptr;
+	while (*name != '\0') {
+		if (*pattern == '*') {
+			star = pattern++;
+			resume = name;
+		} else if (*pattern == '?' ||
+		           std::tolower((unsigned char)*pattern) == std::tolower((unsigned char)*name)) {
+			pattern++;
+			name++;
+		} else if (star != nullptr) {
+			pattern = star + 1;
+			name = ++resume;
+		} else {
+			return false;
+		}
+	}
+	while (*pattern == '*') {
+		pattern++;
+	}
+	return *pattern == '\0';
+}
+
+} // namespace
+
+SensorIndex::SensorIndex(std::shared_ptr<const SensorSchema> schema)
+	: m_schema(std::move(schema))
+{
+	const SensorSchema& s = *m_schema;
+
+	// Load factor at most 1/2 keeps probe sequences short
+	size_t capacity = 8;
+	while (capacity < s.sensors.size() * 2) {
+		capacity <<= 1;
+	}
+	m_keys.assign(capacity, 0);
+	m_slots.assign(capacity, 0);
+	m_mask = capacity - 1;
+
+	m_hardwareType.resize(s.hardware.size());
+	for (size_t h = 0; h < s.hardware.size(); h++) {
+		int type = Intern(m_hardwareTypes, s.hardware[h].type);
+		if (type < 0) {
+			type = (int)m_hardwareTypes.size();
+			m_hardwareTypes.push_back(s.hardware[h].type);
+			m_byHardwareType.emplace_back();
+		}
+		m_hardwareType[h] = type;
+	}
+	m_byHardware.resize(s.hardware.size());
+
+	m_sensorType.resize(s.sensors.size());
+	for (size_t i = 0; i < s.sensors.size(); i++) {
+		const SensorInfo& sensor = s.sensors[i];
+
+		uint64_t key = Key(sensor.id.data(), sensor.id.size());
+		uint64_t slot = key & m_mask;
+		bool duplicate = false;
+		while (m_slots[slot] != 0) {
+			if (m_keys[slot] == key && s.sensors[m_slots[slot] - 1].id == sensor.id) {
+				duplicate = true;  // First occurrence wins, like the poll() tree
+				break;
+			}
+			slot = (slot + 1) & m_mask;
+		}
+		if (!duplicate) {
+			m_keys[slot] = key;
+			m_slots[slot] = (uint32_t)i + 1;
+		}
+
+		int type = Intern(m_sensorTypes, sensor.type);
+		if (type < 0) {
+			type = (int)m_sensorTypes.size();
+			m_sensorTypes.push_back(sensor.type);
+			m_bySensorType.emplace_back();
+		}
+		m_sensorType[i] = type;
+		m_bySensorType[type].push_back((uint32_t)i);
+
+		if (sensor.hardware >= 0 && sensor.hardware < (int)s.hardware.size()) {
+			m_byHardware[sensor.hardware].push_back((uint32_t)i);
+			m_byHardwareType[m_hardwareType[sensor.hardware]].push_back((uint32_t)i);
+		}
+	}
+}
+
+uint64_t SensorIndex::Key(const char* id, size_t length) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char)id[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+int SensorIndex::Find(const std::string& id) const {
+	uint64_t key = Key(id.data(), id.size());
+	for (uint64_t slot = key & m_mask; m_slots[slot] != 0; slot = (slot + 1) & m_mask) {
+		if (m_keys[slot] == key) {
+			uint32_t index = m_slots[slot] - 1;
+			if (m_schema->sensors[index].id == id) {
+				return (int)index;
+			}
+		}
+	}
+	return -1;
+}
+
+int SensorIndex::Intern(const std::vector<std::string>& names, const std::string& name) {
+	for (size_t i = 0; i < names.size(); i++) {
+		if (names[i] == name) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+void SensorIndex::Select(const SensorQuery& query, std::vector<uint32_t>& out) const {
+	out.clear();
+	const SensorSchema& s = *m_schema;
+
+	int sensorType = -1;
+	int hardwareType = -1;
+	int hardware = -1;
+	if (!query.sensorType.empty() && (sensorType = Intern(m_sensorTypes, query.sensorType)) < 0) {
+		return;
+	}
+	if (!query.hardwareType.empty() && (hardwareType = Intern(m_hardwareTypes, query.hardwareType)) < 0) {
+		return;
+	}
+	if (!query.hardwareId.empty()) {
+		for (size_t h = 0; h < s.hardware.size() && hardware < 0; h++) {
+			if (s.hardware[h].id == query.hardwareId) {
+				hardware = (int)h;
+			}
+		}
+		if (hardware < 0) {
+			return;
+		}
+	}
+
+	// Walk the shortest inverted list and check the other criteria per sensor
+	const std::vector<uint32_t>* candidates = nullptr;
+	if (sensorType >= 0) {
+		candidates = &m_bySensorType[sensorType];
+	}
+	if (hardwareType >= 0 && (candidates == nullptr || m_byHardwareType[hardwareType].size() < candidates->size())) {
+		candidates = &m_byHardwareType[hardwareType];
+	}
+	if (hardware >= 0 && (candidates == nullptr || m_byHardware[hardware].size() < candidates->size())) {
+		candidates = &m_byHardware[hardware];
+	}
+
+	const char* pattern = query.namePattern.empty() ? nullptr : query.namePattern.c_str();
+	auto matches = [&](uint32_t i) {
+		const SensorInfo& sensor = s.sensors[i];
+		if (sensorType >= 0 && m_sensorType[i] != sensorType) return false;
+		if (hardware >= 0 && sensor.hardware != hardware) return false;
+		if (hardwareType >= 0 && (sensor.hardware < 0 || m_hardwareType[sensor.hardware] != hardwareType)) return false;
+		return pattern == nullptr || MatchName(pattern, sensor.name.c_str());
+	};
+
+	if (candidates != nullptr) {
+		for (uint32_t i : *candidates) {
+			if (matches(i)) out.push_back(i);
+		}
+	} else {
+		for (uint32_t i = 0; i < (uint32_t)s.sensors.size(); i++) {
+			if (matches(i)) out.push_back(i);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "sensor_schema.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Criteria of a sensor query; empty fields match everything
+ */
+struct SensorQuery {
+    std::string hardwareType;  // HardwareType name of the owning hardware (e.g. "Cpu")
+    std::string hardwareId;    // Identifier of the owning hardware
+    std::string sensorType;    // SensorType name (e.g. "Temperature")
+    std::string namePattern;   // Sensor name glob, '*' and '?', case-insensitive
+};
+
+/**
+ * Sensor Index - lookup structures for one schema generation
+ * Built once per generation: an open-addressing hash table of 64-bit sensor
+ * keys (FNV-1a of the sensor id, stable across generations and processes)
+ * to value vector positions, and inverted lists of sensors by sensor type,
+ * hardware type and hardware.
+ */
+class SensorIndex {
+public:
+    explicit SensorIndex(std::shared_ptr<const SensorSchema> schema);
+
+    /**
+     * Stable 64-bit key of a sensor id (FNV-1a)
+     */
+    static uint64_t Key(const char* id, size_t length);
+
+    /**
+     * Value vector position of a sensor
+     * @returns -1 if the id is not in the schema
+     */
+    int Find(const std::string& id) const;
+
+    /**
+     * Positions of the sensors matching a query, in schema order
+     */
+    void Select(const SensorQuery& query, std::vector<uint32_t>& out) const;
+
+    const SensorSchema& Schema() const { return *m_schema; }
+
+private:
+    // Interned type name, -1 if no entry has it
+    static int Intern(const std::vector<std::string>& names, const std::string& name);
+
+    std::shared_ptr<const SensorSchema> m_schema;
+
+    // Hash table: power-of-two slots, m_slots[i] = sensor position + 1 (0: empty)
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_slots;
+    uint64_t m_mask = 0;
+
+    // Inverted lists, each in schema order
+    std::vector<std::string> m_sensorTypes;
+    std::vector<std::string> m_hardwareTypes;
+    std::vector<std::vector<uint32_t>> m_bySensorType;
+    std::vector<std::vector<uint32_t>> m_byHardwareType;
+    std::vector<std::vector<uint32_t>> m_byHardware;
+    std::vector<int> m_sensorType;    // Per sensor: interned sensor type
+    std::vector<int> m_hardwareType;  // Per hardware: interned hardware type
+};
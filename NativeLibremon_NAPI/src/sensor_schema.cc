@@ -0,0 +1,91 @@
+#include "sensor_schema.h"
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+// Split one line into its tab-separated fields
+std::vector<std::string> SplitFields(const char* begin, const char* end) {
+	std::vector<std::string> fields;
+	const char* start = begin;
+	for (const char* p = begin; p <= end; ++p) {
+		if (p == end || *p == '\t') {
+			fields.emplace_back(start, p);
+			start = p + 1;
+		}
+	}
+	return fields;
+}
+
+} // namespace
+
+bool SensorSchema::Parse(const char* text, SensorSchema& schema) {
+	if (text == nullptr) {
+		return false;
+	}
+
+	schema.generation = 0;
+	schema.hardware.clear();
+	schema.sensors.clear();
+
+	bool sawHeader = false;
+	const char* line = text;
+	while (*line != '\0') {
+		const char* end = line;
+		while (*end != '\0' && *end != '\n') {
+			++end;
+		}
+
+		if (end > line) {
+			std::vector<std::string> fields = SplitFields(line, end);
+			const std::string& kind = fields[0];
+
+			if (kind == "G" && fields.size() >= 4) {
+				schema.generation = std::atoi(fields[1].c_str());
+				schema.hardware.reserve(std::atoi(fields[2].c_str()));
+				schema.sensors.reserve(std::atoi(fields[3].c_str()));
+				sawHeader = true;
+			}
+			else if (kind == "H" && fields.size() >= 6) {
+				HardwareInfo info;
+				info.parent = std::atoi(fields[2].c_str());
+				info.type = fields[3];
+				info.id = fields[4];
+				info.name = fields[5];
+				schema.hardware.push_back(std::move(info));
+			}
+			else if (kind == "S" && fields.size() >= 6) {
+				SensorInfo info;
+				info.hardware = std::atoi(fields[2].c_str());
+				info.type = fields[3];
+				info.id = fields[4];
+				info.name = fields[5];
+				schema.sensors.push_back(std::move(info));
+			}
+			else {
+				return false;
+			}
+		}
+
+		line = (*end == '\n') ? end + 1 : end;
+	}
+
+	return sawHeader;
+}
+
+std::string SensorSchema::Format(size_t hardwareCount, size_t sensorCount) const {
+	hardwareCount = hardwareCount < hardware.size() ? hardwareCount : hardware.size();
+	sensorCount = sensorCount < sensors.size() ? sensorCount : sensors.size();
+
+	std::ostringstream text;
+	text << "G\t" << generation << '\t' << hardwareCount << '\t' << sensorCount << '\n';
+	for (size_t i = 0; i < hardwareCount; i++) {
+		const HardwareInfo& info = hardware[i];
+		text << "H\t" << i << '\t' << info.parent << '\t' << info.type << '\t' << info.id << '\t' << info.name << '\n';
+	}
+	for (size_t i = 0; i < sensorCount; i++) {
+		const SensorInfo& info = sensors[i];
+		text << "S\t" << i << '\t' << info.hardware << '\t' << info.type << '\t' << info.id << '\t' << info.name << '\n';
+	}
+	return text.str();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Hardware entry of the sensor schema
+ */
+struct HardwareInfo {
+    int parent = -1;           // Index of the parent hardware, -1 for top level
+    std::string type;          // LibreHardwareMonitor HardwareType name (e.g. "Cpu")
+    std::string id;            // Hardware identifier (e.g. "/intelcpu/0")
+    std::string name;
+};
+
+/**
+ * Sensor entry of the sensor schema
+ * Position in SensorSchema::sensors is the sensor's index in every value vector
+ */
+struct SensorInfo {
+    int hardware = -1;         // Index of the owning hardware
+    std::string type;          // LibreHardwareMonitor SensorType name (e.g. "Temperature")
+    std::string id;            // Sensor identifier (e.g. "/intelcpu/0/temperature/0")
+    std::string name;
+};
+
+/**
+ * Sensor Schema - layout of the value vectors produced by the bridge
+ * Sensors are in the same order as the poll() JSON tree. A new generation is
+ * published by the bridge whenever hardware is added or removed.
+ */
+struct SensorSchema {
+    int32_t generation = 0;
+    std::vector<HardwareInfo> hardware;
+    std::vector<SensorInfo> sensors;
+
+    /**
+     * Parse the tab-separated text returned by the bridge's GetSchema
+     * @param text - schema text ("G", "H" and "S" lines)
+     * @param schema - output
+     * @returns true on success
+     */
+    static bool Parse(const char* text, SensorSchema& schema);
+
+    /**
+     * Write schema text that Parse reads back
+     * @param hardwareCount - leading hardware entries to include
+     * @param sensorCount - leading sensors to include
+     */
+    std::string Format(size_t hardwareCount, size_t sensorCount) const;
+};
@@ -0,0 +1,77 @@
+#include "shared_buffer.h"
+#include <cstring>
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "int32 atomics must be lock-free and unpadded");
+
+SharedBufferSink* SharedBufferSink::Create(Napi::Env env, Napi::Int32Array view) {
+	// napi_get_arraybuffer_info rejects SharedArrayBuffers, but the typed
+	// array info of a view over one yields the shared backing store
+	uint8_t* data = reinterpret_cast<uint8_t*>(view.Data());
+	size_t byteLength = view.ByteLength();
+
+	if (byteLength < kHeaderBytes + sizeof(float)) {
+		Napi::RangeError::New(env, "SharedArrayBuffer too small for header and one value").ThrowAsJavaScriptException();
+		return nullptr;
+	}
+
+	Napi::Object atomics = env.Global().Get("Atomics").As<Napi::Object>();
+	Napi::Function notify = atomics.Get("notify").As<Napi::Function>();
+
+	SharedBufferSink* sink = new SharedBufferSink();
+	sink->m_data = data;
+	sink->m_capacity = (byteLength - kHeaderBytes) / sizeof(float);
+	sink->m_view = Napi::Persistent(view.As<Napi::Object>());
+	sink->m_notify = Napi::ThreadSafeFunction::New(
+		env, notify, "LHM_SharedBufferNotify", 0, 1, sink, Finalize, (void*)nullptr);
+	// Passive output: must not keep the event loop alive on its own
+	sink->m_notify.Unref(env);
+
+	std::memset(data, 0, kHeaderBytes);
+	reinterpret_cast<int32_t*>(data + kCapacityOffset)[0] = (int32_t)sink->m_capacity;
+	return sink;
+}
+
+void SharedBufferSink::Close() {
+	m_notify.Release();
+}
+
+void SharedBufferSink::OnSample(const SampleFrame& frame) {
+	auto* sequence = reinterpret_cast<std::atomic<int32_t>*>(m_data + kSequenceOffset);
+
+	// Seqlock: odd while writing, readers retry if the sequence moved
+	int32_t start = sequence->load(std::memory_order_relaxed);
+	if (start & 1) {
+		start++;
+	}
+	sequence->store(start + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	size_t count = frame.count < m_capacity ? frame.count : m_capacity;
+	std::memcpy(m_data + kHeaderBytes, frame.values, count * sizeof(float));
+	std::memcpy(m_data + kGenerationOffset, &frame.schema->generation, sizeof(int32_t));
+	int32_t total = (int32_t)frame.count;
+	std::memcpy(m_data + kCountOffset, &total, sizeof(int32_t));
+	std::memcpy(m_data + kTimestampOffset, &frame.timestamp, sizeof(double));
+
+	sequence->store(start + 2, std::memory_order_release);
+
+	// Coalesce: one notify in flight is enough to wake every waiter
+	if (!m_notifyPending.exchange(true)) {
+		if (m_notify.NonBlockingCall(this, CallNotify) != napi_ok) {
+			m_notifyPending = false;
+		}
+	}
+}
+
+void SharedBufferSink::CallNotify(Napi::Env env, Napi::Function notify, SharedBufferSink* sink) {
+	sink->m_notifyPending = false;
+	if (env == nullptr || notify.IsEmpty()) {
+		return;
+	}
+	notify.Call({ sink->m_view.Value(), Napi::Number::New(env, (double)(kSequenceOffset / sizeof(int32_t))) });
+}
+
+void SharedBufferSink::Finalize(Napi::Env, void*, SharedBufferSink* sink) {
+	sink->m_view.Reset();
+	delete sink;
+}
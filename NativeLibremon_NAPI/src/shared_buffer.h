@@ -0,0 +1,68 @@
+#pragma once
+
+#include <napi.h>
+#include "monitor_backend.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Shared Buffer Sink - writes every sample into a caller-supplied SharedArrayBuffer
+ *
+ * Layout (little endian, byte offsets):
+ *    0  int32    sequence     even = stable, odd = write in progress (seqlock)
+ *    4  int32    generation   schema generation the values are laid out by
+ *    8  int32    count        sensors in the sample (may exceed capacity)
+ *   12  int32    capacity     value slots available in this buffer
+ *   16  float64  timestamp    ms since Unix epoch
+ *   64  float32  values[capacity], indexed by schema sensor index
+ *
+ * After each write the sink calls Atomics.notify() on the sequence word from
+ * the owning environment's thread, so worker threads can Atomics.wait on it.
+ */
+class SharedBufferSink : public SampleListener {
+public:
+    static constexpr size_t kHeaderBytes = 64;
+    static constexpr size_t kSequenceOffset = 0;
+    static constexpr size_t kGenerationOffset = 4;
+    static constexpr size_t kCountOffset = 8;
+    static constexpr size_t kCapacityOffset = 12;
+    static constexpr size_t kTimestampOffset = 16;
+
+    /**
+     * Create a sink over an Int32Array view of the SharedArrayBuffer
+     * Must be called on the owning environment's thread. The sink is
+     * deleted by its notify function's finalizer after Close().
+     */
+    static SharedBufferSink* Create(Napi::Env env, Napi::Int32Array view);
+
+    /**
+     * Stop notifying; the sink deletes itself once pending notifies drained
+     * The sink must already have been removed from the backend.
+     */
+    void Close();
+
+    /**
+     * Backing memory of the attached buffer (used to find the sink on detach)
+     */
+    const uint8_t* Data() const { return m_data; }
+
+    /**
+     * Value slots available after the header
+     */
+    size_t Capacity() const { return m_capacity; }
+
+    void OnSample(const SampleFrame& frame) override;
+
+private:
+    SharedBufferSink() = default;
+    ~SharedBufferSink() = default;
+
+    static void CallNotify(Napi::Env env, Napi::Function notify, SharedBufferSink* sink);
+    static void Finalize(Napi::Env env, void* data, SharedBufferSink* sink);
+
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0;
+    Napi::ObjectReference m_view;          // Keeps the SharedArrayBuffer alive
+    Napi::ThreadSafeFunction m_notify;     // Atomics.notify, called on the env thread
+    std::atomic<bool> m_notifyPending{false};
+};
@@ -0,0 +1,518 @@
+#include "state_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint8_t kPadding[8] = {};
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+// The mapping grows in steps of this, so a few new sensors do not remap it
+const size_t kMapGranularity = 64 * 1024;
+
+size_t Padded(size_t bytes) {
+	return (bytes + 7) & ~(size_t)7;
+}
+
+double NowMs() {
+	return (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+}
+
+double SteadyMs() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef _WIN32
+std::wstring WidePath(const std::string& path) {
+	int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+	std::wstring wide(length > 0 ? length : 1, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+	return wide;
+}
+#endif
+
+uint32_t ReadU32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+double ReadF64(const uint8_t* p) {
+	double value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+size_t IdBytes(const std::vector<std::string>& ids) {
+	size_t bytes = 0;
+	for (const std::string& id : ids) {
+		bytes += id.size() + 1;
+	}
+	return bytes;
+}
+
+// Appends padded sections to an image
+class ImageWriter {
+public:
+	explicit ImageWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+	void Section(const void* data, size_t bytes) {
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		m_out.insert(m_out.end(), p, p + bytes);
+		m_out.insert(m_out.end(), kPadding, kPadding + (Padded(bytes) - bytes));
+	}
+
+	void Ids(const std::vector<std::string>& ids) {
+		size_t start = m_out.size();
+		for (const std::string& id : ids) {
+			m_out.insert(m_out.end(), id.begin(), id.end());
+			m_out.push_back(0);
+		}
+		size_t bytes = m_out.size() - start;
+		m_out.insert(m_out.end(), kPadding, kPadding + (Padded(bytes) - bytes));
+	}
+
+private:
+	std::vector<uint8_t>& m_out;
+};
+
+// Reads padded sections of an image, failing on the first that overruns it
+class ImageReader {
+public:
+	ImageReader(const uint8_t* data, size_t size, size_t offset)
+		: m_data(data), m_size(size), m_offset(offset) {}
+
+	template <typename T>
+	bool Section(size_t count, std::vector<T>& out) {
+		size_t bytes = count * sizeof(T);
+		if (count > m_size / sizeof(T) || Padded(bytes) > m_size - m_offset) {
+			return false;
+		}
+		out.resize(count);
+		std::memcpy(out.data(), m_data + m_offset, bytes);
+		m_offset += Padded(bytes);
+		return true;
+	}
+
+	bool Ids(size_t bytes, size_t count, std::vector<std::string>& ids) {
+		if (bytes > m_size || Padded(bytes) > m_size - m_offset) {
+			return false;
+		}
+		const char* text = reinterpret_cast<const char*>(m_data + m_offset);
+		ids.clear();
+		ids.reserve(count);
+		size_t start = 0;
+		for (size_t i = 0; i < bytes; i++) {
+			if (text[i] == '\0') {
+				ids.emplace_back(text + start, i - start);
+				start = i + 1;
+			}
+		}
+		m_offset += Padded(bytes);
+		return start == bytes && ids.size() == count;
+	}
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset;
+};
+
+} // namespace
+
+// ---- PersistedState ----
+
+void PersistedState::Resize(size_t sensors) {
+	ids.resize(sensors);
+	latest.resize(sensors, kNaN);
+	min.resize(sensors, kNaN);
+	max.resize(sensors, kNaN);
+	mean.resize(sensors, 0);
+	var.resize(sensors, 0);
+	count.resize(sensors, 0);
+}
+
+bool PersistedState::Parse(const uint8_t* data, size_t size, PersistedState& state, std::string& error) {
+	if (size < StateFormat::kHeaderBytes ||
+	    std::memcmp(data, StateFormat::kMagic, sizeof(StateFormat::kMagic)) != 0) {
+		error = "Not a state file";
+		return false;
+	}
+	if (ReadU32(data + 8) != StateFormat::kVersion) {
+		error = "Unsupported state file version";
+		return false;
+	}
+	if (ReadU32(data + 12) != 1) {
+		error = "State file was not completely written";
+		return false;
+	}
+
+	state = PersistedState();
+	state.savedAt = ReadF64(data + 16);
+	state.latestTimestamp = ReadF64(data + 24);
+	size_t sensors = ReadU32(data + 32);
+	size_t sensorIdBytes = ReadU32(data + 36);
+	size_t columns = ReadU32(data + 40);
+	size_t historyIdBytes = ReadU32(data + 44);
+	size_t rows = ReadU32(data + 48);
+	state.history.config.capacity = ReadU32(data + 52);
+	state.history.config.minIntervalMs = ReadF64(data + 56);
+
+	ImageReader reader(data, size, StateFormat::kHeaderBytes);
+	bool complete = reader.Ids(sensorIdBytes, sensors, state.ids) &&
+		reader.Section(sensors, state.latest) && reader.Section(sensors, state.min) &&
+		reader.Section(sensors, state.max) && reader.Section(sensors, state.mean) &&
+		reader.Section(sensors, state.var) && reader.Section(sensors, state.count) &&
+		reader.Ids(historyIdBytes, columns, state.history.ids) &&
+		reader.Section(rows, state.history.times) &&
+		(rows == 0 || columns <= size / rows) &&
+		reader.Section(columns * rows, state.history.values);
+	if (!complete) {
+		state = PersistedState();
+		error = "State file is truncated";
+		return false;
+	}
+	return true;
+}
+
+void PersistedState::Format(std::vector<uint8_t>& image) const {
+	image.clear();
+	uint8_t header[StateFormat::kHeaderBytes] = {};
+	uint32_t fields[8] = {
+		(uint32_t)ids.size(),
+		(uint32_t)IdBytes(ids),
+		(uint32_t)history.ids.size(),
+		(uint32_t)IdBytes(history.ids),
+		(uint32_t)history.times.size(),
+		history.config.capacity,
+	};
+	uint32_t version = StateFormat::kVersion;
+	uint32_t committed = 1;
+	std::memcpy(header, StateFormat::kMagic, sizeof(StateFormat::kMagic));
+	std::memcpy(header + 8, &version, 4);
+	std::memcpy(header + 12, &committed, 4);
+	std::memcpy(header + 16, &savedAt, 8);
+	std::memcpy(header + 24, &latestTimestamp, 8);
+	std::memcpy(header + 32, fields, 6 * sizeof(uint32_t));
+	std::memcpy(header + 56, &history.config.minIntervalMs, 8);
+
+	size_t n = ids.size();
+	ImageWriter writer(image);
+	writer.Section(header, sizeof(header));
+	writer.Ids(ids);
+	writer.Section(latest.data(), n * sizeof(float));
+	writer.Section(min.data(), n * sizeof(float));
+	writer.Section(max.data(), n * sizeof(float));
+	writer.Section(mean.data(), n * sizeof(double));
+	writer.Section(var.data(), n * sizeof(double));
+	writer.Section(count.data(), n * sizeof(uint32_t));
+	writer.Ids(history.ids);
+	writer.Section(history.times.data(), history.times.size() * sizeof(double));
+	writer.Section(history.values.data(), history.values.size() * sizeof(float));
+}
+
+// ---- StatePersister ----
+
+std::unique_ptr<StatePersister> StatePersister::Open(const StateOptions& options, PersistedState& restored,
+                                                     std::string& error) {
+	std::unique_ptr<StatePersister> persister(new StatePersister());
+	persister->m_options = options;
+	persister->m_stats.path = options.path;
+
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileW(WidePath(options.path).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+	                          nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		// Also when another process has it open for writing
+		error = "Cannot open state file " + options.path;
+		return nullptr;
+	}
+	persister->m_fileHandle = file;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize)) {
+		size = (size_t)fileSize.QuadPart;
+	}
+#else
+	persister->m_fd = open(options.path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (persister->m_fd < 0) {
+		error = "Cannot open state file " + options.path;
+		return nullptr;
+	}
+	// Another process writing the same image would corrupt it
+	if (flock(persister->m_fd, LOCK_EX | LOCK_NB) != 0) {
+		error = "State file is in use by another process: " + options.path;
+		return nullptr;
+	}
+	struct stat info;
+	if (fstat(persister->m_fd, &info) == 0) {
+		size = (size_t)info.st_size;
+	}
+#endif
+
+	restored = PersistedState();
+	if (size > 0) {
+		if (!persister->MapLocked(size, error)) {
+			return nullptr;
+		}
+		// Never overwrite a file that is not ours (wrong path)
+		if (persister->m_size < sizeof(StateFormat::kMagic) ||
+		    std::memcmp(persister->m_data, StateFormat::kMagic, sizeof(StateFormat::kMagic)) != 0) {
+			error = "Not a state file: " + options.path;
+			return nullptr;
+		}
+		std::string ignored;
+		if (PersistedState::Parse(persister->m_data, persister->m_size, restored, ignored)) {
+			persister->m_stats.restored = true;
+			persister->m_stats.restoredSavedAt = restored.savedAt;
+			persister->m_stats.restoredSensors = (uint32_t)restored.ids.size();
+			persister->m_stats.restoredRows = (uint32_t)restored.history.times.size();
+		} else {
+			persister->m_stats.error = ignored + ", starting afresh";
+		}
+	}
+
+	// Restored sensors keep their slots whether or not they exist right now
+	persister->m_tracked = restored;
+	persister->m_tracked.history = HistorySnapshot();
+	persister->m_latestTimestamp = restored.latestTimestamp;
+	for (size_t i = 0; i < restored.ids.size(); i++) {
+		persister->m_slots.emplace(restored.ids[i], i);
+	}
+	return persister;
+}
+
+StatePersister::~StatePersister() {
+	if (m_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_flushMutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+	}
+	UnmapLocked();
+#ifdef _WIN32
+	if (m_fileHandle != nullptr) CloseHandle(m_fileHandle);
+#else
+	if (m_fd >= 0) close(m_fd);
+#endif
+}
+
+void StatePersister::UnmapLocked() {
+#ifdef _WIN32
+	if (m_data != nullptr) UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr) CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	if (m_data != nullptr) munmap(m_data, m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool StatePersister::MapLocked(size_t size, std::string& error) {
+	if (m_data != nullptr && size <= m_size) {
+		return true;
+	}
+	UnmapLocked();
+
+#ifdef _WIN32
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_fileHandle, &fileSize)) {
+		error = "Cannot read the size of state file " + m_options.path;
+		return false;
+	}
+	if ((size_t)fileSize.QuadPart < size) {
+		size = (size + kMapGranularity - 1) / kMapGranularity * kMapGranularity;
+		LARGE_INTEGER end;
+		end.QuadPart = (LONGLONG)size;
+		if (!SetFilePointerEx(m_fileHandle, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_fileHandle)) {
+			error = "Cannot grow state file " + m_options.path;
+			return false;
+		}
+	} else {
+		size = (size_t)fileSize.QuadPart;
+	}
+	m_mapping = CreateFileMappingW(m_fileHandle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+	void* view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		UnmapLocked();
+		error = "Cannot map state file " + m_options.path;
+		return false;
+	}
+#else
+	struct stat info;
+	if (fstat(m_fd, &info) != 0) {
+		error = "Cannot read the size of state file " + m_options.path;
+		return false;
+	}
+	if ((size_t)info.st_size < size) {
+		size = (size + kMapGranularity - 1) / kMapGranularity * kMapGranularity;
+		if (ftruncate(m_fd, (off_t)size) != 0) {
+			error = "Cannot grow state file " + m_options.path;
+			return false;
+		}
+	} else {
+		size = (size_t)info.st_size;
+	}
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (view == MAP_FAILED) {
+		error = "Cannot map state file " + m_options.path;
+		return false;
+	}
+#endif
+	m_data = static_cast<uint8_t*>(view);
+	m_size = size;
+	return true;
+}
+
+size_t StatePersister::SlotLocked(const std::string& id) {
+	auto found = m_slots.find(id);
+	if (found != m_slots.end()) {
+		return found->second;
+	}
+	size_t slot = m_tracked.ids.size();
+	m_tracked.Resize(slot + 1);
+	m_tracked.ids[slot] = id;
+	m_slots.emplace(id, slot);
+	return slot;
+}
+
+void StatePersister::OnSample(const SampleFrame& frame) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!frame.schema) {
+		return;
+	}
+	if (frame.schema != m_schema) {
+		const SensorSchema& schema = *frame.schema;
+		m_slotOf.resize(schema.sensors.size());
+		for (size_t i = 0; i < schema.sensors.size(); i++) {
+			m_slotOf[i] = SlotLocked(schema.sensors[i].id);
+		}
+		m_schema = frame.schema;
+	}
+
+	float* latest = m_tracked.latest.data();
+	float* low = m_tracked.min.data();
+	float* high = m_tracked.max.data();
+	size_t count = std::min(frame.count, m_slotOf.size());
+	for (size_t i = 0; i < count; i++) {
+		float v = frame.values[i];
+		if (std::isnan(v)) {
+			continue;
+		}
+		size_t slot = m_slotOf[i];
+		latest[slot] = v;
+		// Written as negations so a NaN (never read) extreme takes the value
+		if (!(low[slot] <= v)) low[slot] = v;
+		if (!(high[slot] >= v)) high[slot] = v;
+	}
+	m_latestTimestamp = frame.timestamp;
+	m_dirty = true;
+}
+
+void StatePersister::GetExtremes(const std::vector<std::string>& ids, float* min, float* max) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < ids.size(); i++) {
+		auto found = m_slots.find(ids[i]);
+		min[i] = found != m_slots.end() ? m_tracked.min[found->second] : kNaN;
+		max[i] = found != m_slots.end() ? m_tracked.max[found->second] : kNaN;
+	}
+}
+
+void StatePersister::Start(Collect collect) {
+	m_collect = std::move(collect);
+	m_thread = std::thread([this]() { Run(); });
+}
+
+void StatePersister::Stop() {
+	if (!m_thread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_flushMutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	m_thread.join();
+	Flush();
+}
+
+void StatePersister::Run() {
+	std::unique_lock<std::mutex> lock(m_flushMutex);
+	while (!m_stop) {
+		m_wake.wait_for(lock, std::chrono::milliseconds(m_options.flushIntervalMs), [this]() { return m_stop; });
+		if (m_stop) {
+			break;
+		}
+		lock.unlock();
+		Flush();
+		lock.lock();
+	}
+}
+
+// Runs on the flush thread (or after it stopped), which owns the mapping and m_image
+void StatePersister::Flush() {
+	double started = SteadyMs();
+	PersistedState state;
+	std::unordered_map<std::string, size_t> slots;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_dirty) {
+			return;
+		}
+		m_dirty = false;
+		state = m_tracked;
+		slots = m_slots;
+		state.latestTimestamp = m_latestTimestamp;
+	}
+	if (m_collect) {
+		m_collect(state, slots);
+	}
+	state.savedAt = NowMs();
+	state.Format(m_image);
+
+	std::string error;
+	if (MapLocked(m_image.size(), error)) {
+		// Cleared first, set last: an image cut short is never read back
+		uint32_t committed = 0;
+		std::memcpy(m_data + 12, &committed, 4);
+		std::memcpy(m_data + 16, m_image.data() + 16, m_image.size() - 16);
+		std::memcpy(m_data, m_image.data(), 16);
+#ifdef _WIN32
+		// Starts the write-back without waiting for the disk
+		if (!FlushViewOfFile(m_data, m_image.size())) {
+			error = "Cannot flush state file " + m_options.path;
+		}
+#else
+		if (msync(m_data, m_size, MS_ASYNC) != 0) {
+			error = "Cannot flush state file " + m_options.path;
+		}
+#endif
+	}
+
+	std::lock_guard<std::mutex> lock(m_flushMutex);
+	m_stats.flushes++;
+	m_stats.bytes = m_image.size();
+	m_stats.lastFlushMs = SteadyMs() - started;
+	m_stats.error = error;
+}
+
+StateStats StatePersister::GetStats() {
+	std::lock_guard<std::mutex> lock(m_flushMutex);
+	return m_stats;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "history_store.h"
+#include "monitor_backend.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * State file layout (little endian, every section 8-byte aligned)
+ *
+ * Header, 64 bytes:
+ *    0  char[8]  magic            "LHMSTATE"
+ *    8  uint32   version          1
+ *   12  uint32   committed        1 once the image below is complete
+ *   16  float64  savedAt          ms since Unix epoch
+ *   24  float64  latestTimestamp  of the newest sample in the image
+ *   32  uint32   sensorCount
+ *   36  uint32   sensorIdBytes
+ *   40  uint32   historyColumns
+ *   44  uint32   historyIdBytes
+ *   48  uint32   historyRows
+ *   52  uint32   historyCapacity  0: no history was kept
+ *   56  float64  historyMinIntervalMs
+ *
+ * Sections follow, each zero padded to 8 bytes:
+ *   sensor ids (each NUL terminated), float32 latest[sensorCount],
+ *   float32 min[sensorCount], float32 max[sensorCount],
+ *   float64 mean[sensorCount], float64 var[sensorCount], uint32 count[sensorCount],
+ *   history ids (each NUL terminated), float64 times[historyRows],
+ *   float32 values[historyColumns][historyRows]
+ *
+ * The file is rewritten in place: committed is cleared before and set after
+ * every image, so a process killed mid-write leaves a file that is ignored.
+ */
+namespace StateFormat {
+    constexpr char kMagic[8] = { 'L', 'H', 'M', 'S', 'T', 'A', 'T', 'E' };
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kHeaderBytes = 64;
+}
+
+/**
+ * Contents of a state file
+ */
+struct PersistedState {
+    double savedAt = 0;
+    double latestTimestamp = 0;
+
+    // Per sensor id; NaN where never read, count 0 without an anomaly baseline
+    std::vector<std::string> ids;
+    std::vector<float> latest;
+    std::vector<float> min;
+    std::vector<float> max;
+    std::vector<double> mean;
+    std::vector<double> var;
+    std::vector<uint32_t> count;
+
+    HistorySnapshot history;   // config.capacity 0 if no history was kept
+
+    void Resize(size_t sensors);
+
+    /**
+     * Parse a state file image
+     * @returns false (with error set) for a foreign, truncated or uncommitted image
+     */
+    static bool Parse(const uint8_t* data, size_t size, PersistedState& state, std::string& error);
+
+    /**
+     * Serialize into a state file image (committed set)
+     */
+    void Format(std::vector<uint8_t>& image) const;
+};
+
+/**
+ * Process-wide state persistence settings
+ */
+struct StateOptions {
+    std::string path;
+    uint32_t flushIntervalMs = 5000;
+};
+
+/**
+ * Figures of state persistence
+ */
+struct StateStats {
+    std::string path;
+    bool restored = false;         // A committed image was read at startup
+    double restoredSavedAt = 0;    // Its savedAt
+    uint32_t restoredSensors = 0;
+    uint32_t restoredRows = 0;
+    uint64_t flushes = 0;
+    uint64_t bytes = 0;            // Size of the last image
+    double lastFlushMs = 0;        // Time the last flush took (collect, format, copy)
+    std::string error;             // Last flush error
+};
+
+/**
+ * State Persister - keeps the state that should survive a restart in a
+ * memory-mapped file
+ *
+ * Attached to the backend as a SampleListener, it only tracks the latest
+ * value and the minimum/maximum of every sensor id it has seen, in flat
+ * arrays, with no I/O on the sampling thread. A flush thread collects that,
+ * the anomaly baselines and the history ring (through the collect callback)
+ * every flush interval, formats the image and copies it into the mapping,
+ * whose pages the OS writes back asynchronously. Stop() does a last flush.
+ *
+ * Restored extremes and baselines stay attached to their sensor ids whether
+ * or not the sensor exists in the current topology, so hardware that comes
+ * back later picks them up again.
+ */
+class StatePersister : public SampleListener {
+public:
+    using Collect = std::function<void(PersistedState& state, const std::unordered_map<std::string, size_t>& slots)>;
+
+    /**
+     * Open (or create) the state file and read the image it holds
+     * @param restored - receives the image; left empty for a new, truncated or
+     *                   uncommitted file
+     * @returns nullptr (with error set) if the file cannot be opened or mapped,
+     *          or holds something other than a state file
+     */
+    static std::unique_ptr<StatePersister> Open(const StateOptions& options, PersistedState& restored,
+                                                std::string& error);
+
+    ~StatePersister();
+
+    const StateOptions& Options() const { return m_options; }
+
+    void OnSample(const SampleFrame& frame) override;
+
+    /**
+     * Start the flush thread
+     * @param collect - fills the baselines and history of the image; called on
+     *                  the flush thread
+     */
+    void Start(Collect collect);
+
+    /**
+     * Stop the flush thread and write a last image
+     * The collect callback must still be valid.
+     */
+    void Stop();
+
+    /**
+     * Lowest and highest value of sensors since the state file was created
+     * NaN for ids never read.
+     */
+    void GetExtremes(const std::vector<std::string>& ids, float* min, float* max);
+
+    StateStats GetStats();
+
+private:
+    StatePersister() = default;
+
+    void Run();
+    void Flush();
+    size_t SlotLocked(const std::string& id);
+    bool MapLocked(size_t size, std::string& error);
+    void UnmapLocked();
+
+    StateOptions m_options;
+    Collect m_collect;
+
+    // Tracked per sensor id (guarded by m_mutex)
+    std::mutex m_mutex;
+    std::unordered_map<std::string, size_t> m_slots;
+    PersistedState m_tracked;                      // Extremes, latest values; restored baselines
+    std::shared_ptr<const SensorSchema> m_schema;
+    std::vector<size_t> m_slotOf;                  // Per value position of m_schema
+    double m_latestTimestamp = 0;
+    bool m_dirty = false;
+
+    // Flush thread, which owns the mapping and m_image (m_stop and m_stats
+    // guarded by m_flushMutex)
+    std::mutex m_flushMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+    bool m_stop = false;
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    std::vector<uint8_t> m_image;
+    StateStats m_stats;
+};
@@ -0,0 +1,52 @@
+#include "topology_diff.h"
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// Match entries by id; a duplicated id only matches its first occurrence
+template <typename Entry>
+void DiffEntries(const std::vector<Entry>& previous, const std::vector<Entry>& current,
+                 std::vector<int32_t>& added, std::vector<int32_t>& removed,
+                 std::vector<TopologyMove>& moved) {
+	std::unordered_map<std::string, int32_t> positions;
+	positions.reserve(previous.size());
+	for (size_t i = 0; i < previous.size(); i++) {
+		positions.emplace(previous[i].id, (int32_t)i);
+	}
+
+	std::vector<bool> kept(previous.size(), false);
+	for (size_t i = 0; i < current.size(); i++) {
+		auto it = positions.find(current[i].id);
+		if (it == positions.end() || kept[it->second]) {
+			added.push_back((int32_t)i);
+			continue;
+		}
+		kept[it->second] = true;
+		if (it->second != (int32_t)i) {
+			TopologyMove move;
+			move.from = it->second;
+			move.to = (int32_t)i;
+			moved.push_back(move);
+		}
+	}
+	for (size_t i = 0; i < previous.size(); i++) {
+		if (!kept[i]) {
+			removed.push_back((int32_t)i);
+		}
+	}
+}
+
+} // namespace
+
+TopologyDiff TopologyDiff::Compute(std::shared_ptr<const SensorSchema> previous,
+                                   std::shared_ptr<const SensorSchema> current) {
+	TopologyDiff diff;
+	DiffEntries(previous->hardware, current->hardware,
+		diff.addedHardware, diff.removedHardware, diff.movedHardware);
+	DiffEntries(previous->sensors, current->sensors,
+		diff.addedSensors, diff.removedSensors, diff.movedSensors);
+	diff.previous = std::move(previous);
+	diff.current = std::move(current);
+	return diff;
+}
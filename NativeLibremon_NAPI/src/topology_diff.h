@@ -0,0 +1,50 @@
+#pragma once
+
+#include "sensor_schema.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Index of an entry kept across two schema generations whose position changed
+ */
+struct TopologyMove {
+    int32_t from = 0;          // Index in the previous schema
+    int32_t to = 0;            // Index in the current schema
+};
+
+/**
+ * Topology Diff - what changed between two schema generations
+ * Hardware and sensors are matched by id. Added entries are indices into the
+ * current schema, removed ones into the previous schema; kept entries whose
+ * index shifted are listed as moves, so consumers holding value vector
+ * positions can patch them instead of rebuilding from the full schema.
+ */
+struct TopologyDiff {
+    std::shared_ptr<const SensorSchema> previous;
+    std::shared_ptr<const SensorSchema> current;
+    double timestamp = 0;      // ms since Unix epoch when the new schema was loaded
+
+    std::vector<int32_t> addedHardware;
+    std::vector<int32_t> removedHardware;
+    std::vector<TopologyMove> movedHardware;
+    std::vector<int32_t> addedSensors;
+    std::vector<int32_t> removedSensors;
+    std::vector<TopologyMove> movedSensors;
+
+    /**
+     * Diff two schemas
+     * @param previous - schema before the change
+     * @param current - schema after it
+     */
+    static TopologyDiff Compute(std::shared_ptr<const SensorSchema> previous,
+                                std::shared_ptr<const SensorSchema> current);
+
+    /**
+     * Nothing was added, removed or moved (only the generation changed)
+     */
+    bool Empty() const {
+        return addedHardware.empty() && removedHardware.empty() && movedHardware.empty()
+            && addedSensors.empty() && removedSensors.empty() && movedSensors.empty();
+    }
+};
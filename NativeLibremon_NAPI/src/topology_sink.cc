@@ -0,0 +1,108 @@
+#include "topology_sink.h"
+
+namespace {
+
+template <typename Entry>
+Napi::Array MovesToJs(Napi::Env env, const std::vector<TopologyMove>& moves, const std::vector<Entry>& current) {
+	Napi::Array result = Napi::Array::New(env, moves.size());
+	for (size_t i = 0; i < moves.size(); i++) {
+		Napi::Object item = Napi::Object::New(env);
+		item.Set("id", Napi::String::New(env, current[moves[i].to].id));
+		item.Set("from", Napi::Number::New(env, moves[i].from));
+		item.Set("to", Napi::Number::New(env, moves[i].to));
+		result.Set((uint32_t)i, item);
+	}
+	return result;
+}
+
+// Removed entries only carry their previous index and id: the rest is gone with them
+template <typename Entry>
+Napi::Array RemovedToJs(Napi::Env env, const std::vector<int32_t>& removed, const std::vector<Entry>& previous) {
+	Napi::Array result = Napi::Array::New(env, removed.size());
+	for (size_t i = 0; i < removed.size(); i++) {
+		Napi::Object item = Napi::Object::New(env);
+		item.Set("index", Napi::Number::New(env, removed[i]));
+		item.Set("id", Napi::String::New(env, previous[removed[i]].id));
+		result.Set((uint32_t)i, item);
+	}
+	return result;
+}
+
+Napi::Object DiffToJs(Napi::Env env, const TopologyDiff& diff) {
+	const SensorSchema& previous = *diff.previous;
+	const SensorSchema& current = *diff.current;
+
+	Napi::Array addedHardware = Napi::Array::New(env, diff.addedHardware.size());
+	for (size_t i = 0; i < diff.addedHardware.size(); i++) {
+		const HardwareInfo& hw = current.hardware[diff.addedHardware[i]];
+		Napi::Object item = Napi::Object::New(env);
+		item.Set("index", Napi::Number::New(env, diff.addedHardware[i]));
+		item.Set("parent", Napi::Number::New(env, hw.parent));
+		item.Set("type", Napi::String::New(env, hw.type));
+		item.Set("id", Napi::String::New(env, hw.id));
+		item.Set("name", Napi::String::New(env, hw.name));
+		addedHardware.Set((uint32_t)i, item);
+	}
+	Napi::Object hardware = Napi::Object::New(env);
+	hardware.Set("added", addedHardware);
+	hardware.Set("removed", RemovedToJs(env, diff.removedHardware, previous.hardware));
+	hardware.Set("moved", MovesToJs(env, diff.movedHardware, current.hardware));
+
+	Napi::Array addedSensors = Napi::Array::New(env, diff.addedSensors.size());
+	for (size_t i = 0; i < diff.addedSensors.size(); i++) {
+		const SensorInfo& sensor = current.sensors[diff.addedSensors[i]];
+		Napi::Object item = Napi::Object::New(env);
+		item.Set("index", Napi::Number::New(env, diff.addedSensors[i]));
+		item.Set("hardware", Napi::Number::New(env, sensor.hardware));
+		item.Set("type", Napi::String::New(env, sensor.type));
+		item.Set("id", Napi::String::New(env, sensor.id));
+		item.Set("name", Napi::String::New(env, sensor.name));
+		addedSensors.Set((uint32_t)i, item);
+	}
+	Napi::Object sensors = Napi::Object::New(env);
+	sensors.Set("added", addedSensors);
+	sensors.Set("removed", RemovedToJs(env, diff.removedSensors, previous.sensors));
+	sensors.Set("moved", MovesToJs(env, diff.movedSensors, current.sensors));
+
+	Napi::Object result = Napi::Object::New(env);
+	result.Set("generation", Napi::Number::New(env, current.generation));
+	result.Set("previousGeneration", Napi::Number::New(env, previous.generation));
+	result.Set("timestamp", Napi::Number::New(env, diff.timestamp));
+	result.Set("hardware", hardware);
+	result.Set("sensors", sensors);
+	return result;
+}
+
+} // namespace
+
+TopologySink* TopologySink::Create(Napi::Env env, Napi::Function callback) {
+	TopologySink* sink = new TopologySink();
+	sink->m_call = Napi::ThreadSafeFunction::New(
+		env, callback, "LHM_TopologyEvents", 0, 1, sink, Finalize, (void*)nullptr);
+	// Passive output: must not keep the event loop alive on its own
+	sink->m_call.Unref(env);
+	return sink;
+}
+
+void TopologySink::Close() {
+	m_call.Release();
+}
+
+void TopologySink::OnTopology(const TopologyDiff& diff) {
+	// The diff holds the two schemas it refers to, so the copy stays valid until delivered
+	TopologyDiff* queued = new TopologyDiff(diff);
+	if (m_call.NonBlockingCall(queued, CallJs) != napi_ok) {
+		delete queued;
+	}
+}
+
+void TopologySink::CallJs(Napi::Env env, Napi::Function callback, TopologyDiff* diff) {
+	if (env != nullptr && !callback.IsEmpty()) {
+		callback.Call({ DiffToJs(env, *diff) });
+	}
+	delete diff;
+}
+
+void TopologySink::Finalize(Napi::Env, void*, TopologySink* sink) {
+	delete sink;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <napi.h>
+#include "monitor_backend.h"
+
+/**
+ * Topology Sink - delivers schema changes to a JS callback as compact diffs
+ *
+ * Each diff is called with one object:
+ *   { generation, previousGeneration, timestamp,
+ *     hardware: { added: [{ index, parent, type, id, name }],
+ *                 removed: [{ index, id }], moved: [{ id, from, to }] },
+ *     sensors:  { added: [{ index, hardware, type, id, name }],
+ *                 removed: [{ index, id }], moved: [{ id, from, to }] } }
+ * Removed indices and move sources refer to the previous generation, the
+ * rest to the new one. Calls are queued from the sampling thread and made on
+ * the owning environment's thread, in order.
+ */
+class TopologySink : public SampleListener {
+public:
+    /**
+     * Create a sink calling callback
+     * Must be called on the owning environment's thread. The sink is
+     * deleted by its call function's finalizer after Close().
+     */
+    static TopologySink* Create(Napi::Env env, Napi::Function callback);
+
+    /**
+     * Stop calling back; the sink deletes itself once queued diffs are delivered
+     * The sink must already have been removed from the backend.
+     */
+    void Close();
+
+    void OnSample(const SampleFrame&) override {}
+    void OnTopology(const TopologyDiff& diff) override;
+
+private:
+    TopologySink() = default;
+    ~TopologySink() = default;
+
+    static void CallJs(Napi::Env env, Napi::Function callback, TopologyDiff* diff);
+    static void Finalize(Napi::Env env, void* data, TopologySink* sink);
+
+    Napi::ThreadSafeFunction m_call;
+};
@@ -0,0 +1,330 @@
+#include "trace_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint8_t kPadding[8] = {};
+
+size_t Padded(size_t bytes) {
+	return (bytes + 7) & ~(size_t)7;
+}
+
+double SteadySeconds() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string HostName() {
+	const char* name = std::getenv("COMPUTERNAME");
+	if (name == nullptr || *name == '\0') {
+		name = std::getenv("HOSTNAME");
+	}
+	return name != nullptr ? name : "";
+}
+
+#ifdef _WIN32
+std::wstring WidePath(const std::string& path) {
+	int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+	std::wstring wide(length > 0 ? length : 1, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+	return wide;
+}
+#endif
+
+FILE* CreateFileForWrite(const std::string& path) {
+#ifdef _WIN32
+	return _wfopen(WidePath(path).c_str(), L"wb");
+#else
+	return std::fopen(path.c_str(), "wb");
+#endif
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+double ReadF64(const uint8_t* p) {
+	double value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+} // namespace
+
+// ---- TraceWriter ----
+
+std::unique_ptr<TraceWriter> TraceWriter::Create(const std::string& path, std::string& error) {
+	std::unique_ptr<TraceWriter> writer(new TraceWriter());
+	writer->m_file = CreateFileForWrite(path);
+	if (writer->m_file == nullptr) {
+		error = "Cannot create trace file " + path;
+		return nullptr;
+	}
+
+	std::string host = HostName();
+	uint8_t header[TraceFormat::kHeaderBytes] = {};
+	uint32_t version = TraceFormat::kVersion;
+	uint32_t hostBytes = (uint32_t)host.size();
+	double startedAt = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	std::memcpy(header, TraceFormat::kMagic, sizeof(TraceFormat::kMagic));
+	std::memcpy(header + 8, &version, 4);
+	std::memcpy(header + 12, &hostBytes, 4);
+	std::memcpy(header + 16, &startedAt, 8);
+	if (!writer->Write(header, sizeof(header)) || !writer->WritePadded(host.data(), host.size()) ||
+	    std::fflush(writer->m_file) != 0) {
+		error = "Cannot write trace file " + path;
+		return nullptr;
+	}
+	writer->m_lastFlush = SteadySeconds();
+	return writer;
+}
+
+TraceWriter::~TraceWriter() {
+	if (m_file != nullptr) {
+		std::fclose(m_file);
+	}
+}
+
+bool TraceWriter::Write(const void* data, size_t bytes) {
+	if (m_file == nullptr || !m_stats.error.empty()) {
+		return false;
+	}
+	if (bytes > 0 && std::fwrite(data, 1, bytes, m_file) != bytes) {
+		m_stats.error = "Write to trace file failed";
+		return false;
+	}
+	m_stats.bytes += bytes;
+	return true;
+}
+
+bool TraceWriter::WritePadded(const void* data, size_t bytes) {
+	return Write(data, bytes) && Write(kPadding, Padded(bytes) - bytes);
+}
+
+bool TraceWriter::WriteSchema(const SampleFrame& frame) {
+	const SensorSchema& schema = *frame.schema;
+	size_t hardwareCount = std::min(frame.bridgeHardwareCount, schema.hardware.size());
+	size_t sensorCount = std::min(frame.bridgeSensorCount, schema.sensors.size());
+
+	// Derived sensors changing is a new backend generation, not a new bridge layout
+	bool same = m_stats.schemas > 0 && m_recorded.hardware.size() == hardwareCount &&
+		m_recorded.sensors.size() == sensorCount;
+	for (size_t i = 0; same && i < hardwareCount; i++) {
+		const HardwareInfo& a = m_recorded.hardware[i];
+		const HardwareInfo& b = schema.hardware[i];
+		same = a.parent == b.parent && a.id == b.id && a.type == b.type && a.name == b.name;
+	}
+	for (size_t i = 0; same && i < sensorCount; i++) {
+		const SensorInfo& a = m_recorded.sensors[i];
+		const SensorInfo& b = schema.sensors[i];
+		same = a.hardware == b.hardware && a.id == b.id && a.type == b.type && a.name == b.name;
+	}
+	if (same) {
+		return true;
+	}
+
+	m_recorded.generation = (int32_t)m_stats.schemas + 1;
+	m_recorded.hardware.assign(schema.hardware.begin(), schema.hardware.begin() + hardwareCount);
+	m_recorded.sensors.assign(schema.sensors.begin(), schema.sensors.begin() + sensorCount);
+	std::string text = m_recorded.Format(hardwareCount, sensorCount);
+
+	uint32_t head[4] = {
+		TraceFormat::kSchemaRecord,
+		(uint32_t)(8 + Padded(text.size())),
+		(uint32_t)sensorCount,
+		(uint32_t)text.size(),
+	};
+	if (!Write(head, sizeof(head)) || !WritePadded(text.data(), text.size())) {
+		return false;
+	}
+	m_stats.schemas++;
+	return true;
+}
+
+void TraceWriter::OnSample(const SampleFrame& frame) {
+	if (m_file == nullptr || !m_stats.error.empty() || !frame.schema) {
+		return;
+	}
+	if (frame.schema != m_lastSchema) {
+		if (!WriteSchema(frame)) {
+			return;
+		}
+		m_lastSchema = frame.schema;
+	}
+
+	uint32_t count = (uint32_t)std::min(m_recorded.sensors.size(), frame.count);
+	size_t valueBytes = count * sizeof(float);
+	uint32_t head[2] = { TraceFormat::kFrameRecord, (uint32_t)(16 + Padded(valueBytes)) };
+	uint32_t layout[2] = { (uint32_t)m_stats.schemas - 1, count };
+	if (!Write(head, sizeof(head)) || !Write(&frame.timestamp, sizeof(double)) ||
+	    !Write(layout, sizeof(layout)) || !WritePadded(frame.values, valueBytes)) {
+		return;
+	}
+	m_stats.frames++;
+
+	double now = SteadySeconds();
+	if (now - m_lastFlush >= 1.0) {
+		m_lastFlush = now;
+		if (std::fflush(m_file) != 0) {
+			m_stats.error = "Write to trace file failed";
+		}
+	}
+}
+
+TraceStats TraceWriter::Close() {
+	if (m_file != nullptr) {
+		if (std::fclose(m_file) != 0 && m_stats.error.empty()) {
+			m_stats.error = "Write to trace file failed";
+		}
+		m_file = nullptr;
+	}
+	return m_stats;
+}
+
+// ---- TraceReader ----
+
+TraceReader::~TraceReader() {
+	Unmap();
+}
+
+void TraceReader::Unmap() {
+#ifdef _WIN32
+	if (m_data != nullptr) UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr) CloseHandle(m_mapping);
+	if (m_fileHandle != nullptr) CloseHandle(m_fileHandle);
+	m_mapping = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_data != nullptr) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool TraceReader::Open(const std::string& path, std::string& error) {
+	Unmap();
+	m_schemas.clear();
+	m_frameTimes.clear();
+	m_frameSchemas.clear();
+	m_frameOffsets.clear();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		error = "Cannot open trace file " + path;
+		return false;
+	}
+	m_fileHandle = file;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)TraceFormat::kHeaderBytes) {
+		Unmap();
+		error = "Not a sensor trace: " + path;
+		return false;
+	}
+	m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		Unmap();
+		error = "Cannot map trace file " + path;
+		return false;
+	}
+	m_data = static_cast<const uint8_t*>(view);
+	m_size = (size_t)size.QuadPart;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		error = "Cannot open trace file " + path;
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t)TraceFormat::kHeaderBytes) {
+		close(fd);
+		error = "Not a sensor trace: " + path;
+		return false;
+	}
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED) {
+		error = "Cannot map trace file " + path;
+		return false;
+	}
+	m_data = static_cast<const uint8_t*>(view);
+	m_size = (size_t)info.st_size;
+#endif
+
+	if (std::memcmp(m_data, TraceFormat::kMagic, sizeof(TraceFormat::kMagic)) != 0) {
+		Unmap();
+		error = "Not a sensor trace: " + path;
+		return false;
+	}
+	if (ReadU32(m_data + 8) != TraceFormat::kVersion) {
+		Unmap();
+		error = "Unsupported sensor trace version in " + path;
+		return false;
+	}
+	size_t hostBytes = ReadU32(m_data + 12);
+	m_startedAt = ReadF64(m_data + 16);
+	size_t offset = TraceFormat::kHeaderBytes + Padded(hostBytes);
+	if (offset > m_size) {
+		Unmap();
+		error = "Not a sensor trace: " + path;
+		return false;
+	}
+	m_host.assign(reinterpret_cast<const char*>(m_data) + TraceFormat::kHeaderBytes, hostBytes);
+
+	while (offset + 8 <= m_size) {
+		uint32_t type = ReadU32(m_data + offset);
+		size_t bytes = ReadU32(m_data + offset + 4);
+		const uint8_t* payload = m_data + offset + 8;
+		if (bytes % 8 != 0 || bytes > m_size - offset - 8) {
+			break;  // Cut off while recording
+		}
+
+		if (type == TraceFormat::kSchemaRecord && bytes >= 8) {
+			Schema schema;
+			schema.sensorCount = ReadU32(payload);
+			size_t textBytes = ReadU32(payload + 4);
+			if (textBytes > bytes - 8) {
+				break;
+			}
+			schema.text.assign(reinterpret_cast<const char*>(payload) + 8, textBytes);
+			m_schemas.push_back(std::move(schema));
+		} else if (type == TraceFormat::kFrameRecord && bytes >= 16) {
+			uint32_t schema = ReadU32(payload + 8);
+			uint32_t count = ReadU32(payload + 12);
+			if (schema >= m_schemas.size() || count != m_schemas[schema].sensorCount ||
+			    (size_t)count * sizeof(float) > bytes - 16) {
+				break;
+			}
+			// Wall clock steps backwards would break the time search
+			double time = ReadF64(payload);
+			m_frameTimes.push_back(m_frameTimes.empty() ? time : std::max(time, m_frameTimes.back()));
+			m_frameSchemas.push_back(schema);
+			m_frameOffsets.push_back(offset + 8 + 16);
+		}
+		// Unknown record types are skipped
+		offset += 8 + bytes;
+	}
+
+	if (m_frameTimes.empty()) {
+		Unmap();
+		error = "Sensor trace has no frames: " + path;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "monitor_backend.h"
+#include "sensor_schema.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Sensor trace file layout (little endian, every record 8-byte aligned so a
+ * mapped file can be read in place)
+ *
+ * Header, 32 bytes + host name:
+ *    0  char[8]  magic        "LHMTRACE"
+ *    8  uint32   version      1
+ *   12  uint32   hostBytes    length of the host name after the header
+ *   16  float64  startedAt    ms since Unix epoch
+ *   24  uint32   reserved[2]
+ *   32  char     host[hostBytes], zero padded to 8 bytes
+ *
+ * Records follow, each an 8-byte head (uint32 type, uint32 payload bytes,
+ * a multiple of 8) and its payload:
+ *   Schema (1): uint32 sensorCount, uint32 textBytes, schema text (the
+ *               bridge's G/H/S lines), zero padded
+ *   Frame (2):  float64 timestamp (ms since Unix epoch), uint32 schema
+ *               (index of the schema record it is laid out by), uint32 count,
+ *               float32 values[count], zero padded
+ *
+ * A schema record is written once per sensor layout, before the first frame
+ * that uses it. Only the bridge's sensors are recorded; derived sensors are
+ * evaluated again on replay.
+ */
+namespace TraceFormat {
+    constexpr char kMagic[8] = { 'L', 'H', 'M', 'T', 'R', 'A', 'C', 'E' };
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kHeaderBytes = 32;
+    constexpr uint32_t kSchemaRecord = 1;
+    constexpr uint32_t kFrameRecord = 2;
+}
+
+/**
+ * Figures of a recording
+ */
+struct TraceStats {
+    uint64_t frames = 0;
+    uint64_t schemas = 0;
+    uint64_t bytes = 0;
+    std::string error;         // First write error, recording stopped there
+};
+
+/**
+ * Trace Writer - records every published sample to a trace file
+ * Attached to the backend as a SampleListener; writes are buffered and
+ * flushed about once a second, so a crash loses at most the last second.
+ */
+class TraceWriter : public SampleListener {
+public:
+    /**
+     * Create the file and write its header
+     * @returns nullptr (with error set) if the file cannot be created
+     */
+    static std::unique_ptr<TraceWriter> Create(const std::string& path, std::string& error);
+
+    ~TraceWriter();
+
+    void OnSample(const SampleFrame& frame) override;
+
+    /**
+     * Flush and close the file
+     * Must not race OnSample: remove the writer from the backend first.
+     */
+    TraceStats Close();
+
+private:
+    TraceWriter() = default;
+
+    bool Write(const void* data, size_t bytes);
+    bool WritePadded(const void* data, size_t bytes);
+    bool WriteSchema(const SampleFrame& frame);
+
+    FILE* m_file = nullptr;
+    TraceStats m_stats;
+    SensorSchema m_recorded;                       // Bridge part of the current layout
+    std::shared_ptr<const SensorSchema> m_lastSchema;
+    double m_lastFlush = 0;                        // steady seconds
+};
+
+/**
+ * Trace Reader - maps a trace file and indexes its records
+ * A truncated last record (recording cut off) is ignored.
+ */
+class TraceReader {
+public:
+    struct Schema {
+        std::string text;
+        uint32_t sensorCount = 0;
+    };
+
+    TraceReader() = default;
+    ~TraceReader();
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool Open(const std::string& path, std::string& error);
+
+    const std::string& Host() const { return m_host; }
+    double StartedAt() const { return m_startedAt; }
+
+    const std::vector<Schema>& Schemas() const { return m_schemas; }
+
+    size_t FrameCount() const { return m_frameTimes.size(); }
+    double FrameTime(size_t frame) const { return m_frameTimes[frame]; }
+    uint32_t FrameSchema(size_t frame) const { return m_frameSchemas[frame]; }
+
+    /**
+     * Values of a frame, Schemas()[FrameSchema(frame)].sensorCount of them,
+     * pointing into the mapped file
+     */
+    const float* FrameValues(size_t frame) const {
+        return reinterpret_cast<const float*>(m_data + m_frameOffsets[frame]);
+    }
+
+private:
+    void Unmap();
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapping = nullptr;
+#endif
+
+    std::string m_host;
+    double m_startedAt = 0;
+    std::vector<Schema> m_schemas;
+    std::vector<double> m_frameTimes;
+    std::vector<uint32_t> m_frameSchemas;
+    std::vector<size_t> m_frameOffsets;    // Byte offset of each frame's values
+};
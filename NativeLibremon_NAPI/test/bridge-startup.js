@@ -0,0 +1,172 @@
+/**
+ * Bridge startup comparison - hostfxr (managed) bridge vs the ahead-of-time compiled one
+ *
+ * Each run is a fresh process (cold start), which loads the module, calls init() with
+ * the given bridge, polls twice and reports the timings and its resident set size.
+ * Prints the median of every metric per bridge, and the files each bridge needs in the
+ * module folder. Needs Windows and administrator rights, like any live run.
+ *
+ * Usage:
+ *   node test/bridge-startup.js [options]
+ *     --module <dir>            folder with index.js, the addon and both bridges
+ *                               (default ../dist/native-libremon-napi)
+ *     --bridges hostfxr,native  bridges to compare (default both)
+ *     --categories cpu,gpu,...  hardware to enable (default cpu,gpu,motherboard,memory)
+ *     --runs <n>                processes per bridge (default 5)
+ *     --out <file>              also write the results as JSON
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { execFileSync } = require('child_process');
+const { performance } = require('perf_hooks');
+
+const NATIVE_BRIDGE = 'LibreHardwareMonitorBridge.Native.dll';
+const METRICS = [
+	['loadMs', 'require()', 'ms'],
+	['initMs', 'init()', 'ms'],
+	['firstPollMs', 'first poll', 'ms'],
+	['secondPollMs', 'second poll', 'ms'],
+	['rssBytes', 'RSS after polls', 'MB']
+];
+
+function parseArgs(argv) {
+	const options = {
+		module: path.join(__dirname, '..', '..', 'dist', 'native-libremon-napi'),
+		bridges: ['hostfxr', 'native'],
+		categories: ['cpu', 'gpu', 'motherboard', 'memory'],
+		runs: 5,
+		out: null,
+		child: null
+	};
+
+	for (let i = 0; i < argv.length; i++) {
+		const arg = argv[i];
+		const value = () => {
+			if (i + 1 >= argv.length) throw new Error(`Missing value for ${arg}`);
+			return argv[++i];
+		};
+		switch (arg) {
+			case '--module': options.module = path.resolve(value()); break;
+			case '--bridges': options.bridges = value().split(',').filter(Boolean); break;
+			case '--categories': options.categories = value().split(',').filter(Boolean); break;
+			case '--runs': options.runs = parseInt(value(), 10); break;
+			case '--out': options.out = value(); break;
+			case '--child': options.child = value(); break;
+			default: throw new Error(`Unknown option: ${arg}`);
+		}
+	}
+	if (!(options.runs >= 1)) throw new Error('--runs must be at least 1');
+	for (const bridge of options.bridges) {
+		if (bridge !== 'hostfxr' && bridge !== 'native') throw new Error(`Unknown bridge: ${bridge}`);
+	}
+	return options;
+}
+
+// One cold start, in this process; prints a JSON line
+async function runChild(options) {
+	const start = performance.now();
+	const monitor = require(options.module);
+	const loaded = performance.now();
+
+	const config = { bridge: options.child };
+	for (const category of options.categories) config[category] = true;
+	await monitor.init(config);
+	const initialized = performance.now();
+
+	await monitor.poll();
+	const firstPoll = performance.now();
+	await monitor.poll();
+	const secondPoll = performance.now();
+
+	const result = {
+		bridge: monitor.getStats().bridge,
+		loadMs: loaded - start,
+		initMs: initialized - loaded,
+		firstPollMs: firstPoll - initialized,
+		secondPollMs: secondPoll - firstPoll,
+		rssBytes: process.memoryUsage().rss
+	};
+	await monitor.shutdown();
+	process.stdout.write('\n' + JSON.stringify(result) + '\n');
+}
+
+function median(values) {
+	const sorted = values.slice().sort((a, b) => a - b);
+	const mid = sorted.length >> 1;
+	return sorted.length % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+}
+
+// Bytes of the files in the module folder that a bridge needs
+function distributionSize(dir, bridge) {
+	let bytes = 0;
+	let files = 0;
+	for (const file of fs.readdirSync(dir)) {
+		const full = path.join(dir, file);
+		if (!fs.statSync(full).isFile()) continue;
+		const needed = bridge === 'native'
+			? file === NATIVE_BRIDGE || file.endsWith('.node') || file.endsWith('.js') || file === 'package.json'
+			: file !== NATIVE_BRIDGE;
+		if (needed) {
+			bytes += fs.statSync(full).size;
+			files++;
+		}
+	}
+	return { bytes, files };
+}
+
+function runParent(options) {
+	const results = {};
+	for (const bridge of options.bridges) {
+		if (bridge === 'native' && !fs.existsSync(path.join(options.module, NATIVE_BRIDGE))) {
+			console.warn(`Skipping native: no ${NATIVE_BRIDGE} in ${options.module} (npm run build:managed:aot)`);
+			continue;
+		}
+		const runs = [];
+		for (let i = 0; i < options.runs; i++) {
+			const args = [__filename, '--child', bridge, '--module', options.module,
+				'--categories', options.categories.join(',')];
+			const output = execFileSync(process.execPath, args, { encoding: 'utf8', stdio: ['ignore', 'pipe', 'pipe'] });
+			const lines = output.trim().split('\n');
+			const run = JSON.parse(lines[lines.length - 1]);
+			if (run.bridge !== bridge) {
+				throw new Error(`Asked for the ${bridge} bridge, init() used ${run.bridge}`);
+			}
+			runs.push(run);
+		}
+		const summary = { runs, distribution: distributionSize(options.module, bridge) };
+		for (const [key] of METRICS) summary[key] = median(runs.map(run => run[key]));
+		results[bridge] = summary;
+	}
+
+	const bridges = Object.keys(results);
+	const rows = METRICS.map(([key, label, unit]) => [label, ...bridges.map(bridge => {
+		const value = results[bridge][key];
+		return unit === 'MB' ? `${(value / 1048576).toFixed(1)} MB` : `${value.toFixed(1)} ms`;
+	})]);
+	rows.push(['distribution', ...bridges.map(bridge => {
+		const { bytes, files } = results[bridge].distribution;
+		return `${(bytes / 1048576).toFixed(1)} MB / ${files} files`;
+	})]);
+
+	console.log(`Median of ${options.runs} cold starts, categories ${options.categories.join(',')}`);
+	const header = ['', ...bridges];
+	const widths = header.map((_, c) => Math.max(...[header, ...rows].map(row => row[c].length)));
+	for (const row of [header, ...rows]) {
+		console.log(row.map((cell, c) => c === 0 ? cell.padEnd(widths[c]) : cell.padStart(widths[c])).join('  '));
+	}
+
+	if (options.out) {
+		fs.writeFileSync(options.out, JSON.stringify({ module: options.module, categories: options.categories, results }, null, 2));
+	}
+}
+
+const options = parseArgs(process.argv.slice(2));
+if (options.child) {
+	runChild(options).catch(err => {
+		console.error(err);
+		process.exit(1);
+	});
+} else {
+	runParent(options);
+}
@@ -0,0 +1,189 @@
+/**
+ * Replay backend - lib/index.js running on the addon's replay bridge
+ * Drives the real module with init({ replay }) (the addon's poll workers, poll
+ * buffers, listeners and stats) against a recorded trace, so soak runs and tests
+ * are repeatable and work without Windows, admin rights or hardware.
+ *
+ * Recordings: a .lhmtrace file, or recorded poll JSON (a poll JSON file, an
+ * NDJSON file with one poll per line, or a directory of .json files replayed in
+ * name order), converted into a temporary trace with one frame per poll.
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeTrace, layoutFromPoll } = require('./trace-fixture');
+
+const DEFAULT_FIXTURE = path.join(__dirname, '..', '..', 'test', 'sensor-data.json');
+const ADDON_NAME = 'librehardwaremonitor_native.node';
+const LIB_DIR = path.join(__dirname, '..', 'lib');
+// node-gyp drops the lib prefix of the target on Linux and macOS
+const BUILD_ADDONS = [
+	path.join(__dirname, '..', 'build', 'Release', ADDON_NAME),
+	path.join(__dirname, '..', 'build', 'Release', 'rehardwaremonitor_native.node')
+];
+
+let tempDir = null;
+
+function scratchDir() {
+	if (!tempDir) {
+		tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'libremon-replay-'));
+		process.once('exit', () => fs.rmSync(tempDir, { recursive: true, force: true }));
+	}
+	return tempDir;
+}
+
+/**
+ * Path of a file in a directory removed when the process exits
+ */
+function scratchFile(name) {
+	return path.join(scratchDir(), name);
+}
+
+/**
+ * Load lib/index.js with an addon
+ * Uses the module as is when the addon sits next to it (a dist folder, or lib/
+ * after a Windows build); otherwise stages lib/ with the addon from build/Release.
+ * @param {string} [modulePath] - index.js, or a folder containing it
+ */
+function loadModule(modulePath) {
+	if (modulePath) {
+		return require(path.resolve(modulePath));
+	}
+	if (fs.existsSync(path.join(LIB_DIR, ADDON_NAME))) {
+		return require(LIB_DIR);
+	}
+	const addon = BUILD_ADDONS.find((file) => fs.existsSync(file));
+	if (!addon) {
+		throw new Error('No addon found in lib/ or build/Release; run node-gyp rebuild first');
+	}
+	const staged = path.join(scratchDir(), 'lib');
+	fs.mkdirSync(staged, { recursive: true });
+	for (const name of fs.readdirSync(LIB_DIR).filter((file) => file.endsWith('.js'))) {
+		fs.copyFileSync(path.join(LIB_DIR, name), path.join(staged, name));
+	}
+	fs.copyFileSync(addon, path.join(staged, ADDON_NAME));
+	return require(staged);
+}
+
+/**
+ * Poll count times in a row (count frames at speed 0)
+ * @param {object} monitor - the module loadModule returned
+ * @param {number} count
+ * @param {object} [options] - poll() options
+ */
+async function pollFrames(monitor, count, options) {
+	for (let i = 0; i < count; i++) {
+		await monitor.poll(options);
+	}
+}
+
+function loadRecordings(source) {
+	const stat = fs.statSync(source);
+	if (stat.isDirectory()) {
+		return fs.readdirSync(source)
+			.filter((name) => name.endsWith('.json'))
+			.sort()
+			.map((name) => fs.readFileSync(path.join(source, name), 'utf8'));
+	}
+
+	const text = fs.readFileSync(source, 'utf8');
+	if (source.endsWith('.ndjson')) {
+		return text.split('\n').filter((line) => line.trim());
+	}
+	return [text];
+}
+
+/**
+ * Trace file for a recording: .lhmtrace files as they are, poll JSON converted
+ * (a new layout wherever the tree's hardware or sensors change)
+ * @param {string} source
+ * @param {number} [intervalMs=1000] - trace time between converted polls
+ */
+function traceFor(source, intervalMs = 1000) {
+	if (source.endsWith('.lhmtrace')) {
+		return source;
+	}
+	const recordings = loadRecordings(source);
+	if (recordings.length === 0) {
+		throw new Error('No recordings found in ' + source);
+	}
+
+	const layouts = [];
+	const frames = [];
+	const keys = new Map();
+	const startedAt = Date.now();
+	recordings.forEach((text, i) => {
+		const { layout, values } = layoutFromPoll(JSON.parse(text));
+		const key = JSON.stringify(layout);
+		if (!keys.has(key)) {
+			keys.set(key, layouts.length);
+			layouts.push(layout);
+		}
+		frames.push({ time: startedAt + i * intervalMs, layout: keys.get(key), values });
+	});
+	const file = scratchFile(path.basename(source).replace(/\.\w+$/, '') + '.lhmtrace');
+	return writeTrace(file, { host: 'replay', startedAt, layouts, frames });
+}
+
+/**
+ * @param {object} [options]
+ * @param {string} [options.fixture] - recording (.lhmtrace, poll JSON file, .ndjson or directory)
+ * @param {string} [options.module] - index.js to drive (default lib/ with the built addon)
+ * @param {number} [options.speed=1] - trace time per wall-clock time, 0 = one frame per update
+ * @param {number} [options.samplerMs=0] - also run the sampler at this interval
+ * @param {boolean} [options.sharedBuffer=true] - keep a shared buffer listener attached
+ */
+function createReplayBackend(options = {}) {
+	const monitor = loadModule(options.module);
+	const trace = traceFor(options.fixture || DEFAULT_FIXTURE);
+	const samplerMs = options.samplerMs || 0;
+	const sharedBuffer = options.sharedBuffer !== false;
+	let sab = null;
+	let topologyEvents = 0;
+	const onTopology = () => {
+		topologyEvents++;
+	};
+
+	return {
+		trace,
+
+		async init(config = {}) {
+			await monitor.init(Object.assign({}, config, {
+				replay: trace,
+				speed: options.speed !== undefined ? options.speed : 1,
+				loop: true
+			}));
+			monitor.on('topology', onTopology);
+			if (sharedBuffer) {
+				sab = new SharedArrayBuffer(monitor.byteLengthFor(monitor.getSchema().sensors.length));
+				monitor.attachSharedBuffer(sab);
+			}
+			if (samplerMs > 0) {
+				monitor.startSampler({ intervalMs: samplerMs });
+			}
+		},
+
+		poll(pollOptions) {
+			return monitor.poll(pollOptions);
+		},
+
+		getStats() {
+			return Object.assign(monitor.getStats(), { topologyEvents });
+		},
+
+		async shutdown() {
+			if (samplerMs > 0) {
+				monitor.stopSampler();
+			}
+			if (sab) {
+				monitor.detachSharedBuffer(sab);
+				sab = null;
+			}
+			monitor.off('topology', onTopology);
+			await monitor.shutdown();
+		}
+	};
+}
+
+module.exports = { createReplayBackend, loadModule, pollFrames, traceFor, scratchFile, DEFAULT_FIXTURE };
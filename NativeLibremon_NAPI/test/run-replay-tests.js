@@ -0,0 +1,41 @@
+/**
+ * Runs the replay-driven tests, each in a process of its own (the monitor and
+ * the replay are process-wide). Needs the addon built (node-gyp rebuild), but
+ * no hardware, Windows or admin rights.
+ * Usage: node test/run-replay-tests.js [name-filter]
+ */
+
+const path = require('path');
+const { spawnSync } = require('child_process');
+
+const TESTS = [
+	'test-derived-sensors.js',
+	'test-sensor-lookups.js',
+	'test-anomalies.js',
+	'test-history.js',
+	'test-state-file.js',
+	'test-export-arrow.js',
+	'test-update-stamps.js',
+	'test-poll-buffer.js',
+	'test-topology-events.js',
+	'test-filter.js',
+	'test-poll-deadlines.js',
+	'test-burst.js',
+	'test-reconfigure.js',
+	'test-governor.js',
+	'test-adaptive-intervals.js'
+];
+
+const filter = process.argv[2] || '';
+let failed = 0;
+for (const test of TESTS.filter((name) => name.includes(filter))) {
+	const result = spawnSync(process.execPath, [path.join(__dirname, test)], { encoding: 'utf8' });
+	if (result.status === 0) {
+		console.log('✓ ' + test);
+	} else {
+		failed++;
+		console.log('✗ ' + test);
+		process.stdout.write(result.stdout + result.stderr);
+	}
+}
+process.exit(failed > 0 ? 1 : 0);
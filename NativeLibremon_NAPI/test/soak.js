@@ -0,0 +1,376 @@
+/**
+ * Soak harness - long-running poll load with latency, event-loop and memory tracking
+ *
+ * Polls at a fixed total rate from N concurrent pollers for the given duration and
+ * writes a machine-readable report (rewritten at every snapshot, so a crashed or
+ * interrupted run still leaves data behind). Compare two reports with --compare.
+ *
+ * Usage:
+ *   node test/soak.js [options]
+ *     --backend native|replay   native = lib/index.js on the hardware (Windows, admin),
+ *                               replay = lib/index.js on the addon's replay bridge (default)
+ *     --module <path>           module to drive (default ../lib/index.js, or a dist folder;
+ *                               replay stages lib/ with build/Release's addon if lib/ has none)
+ *     --fixture <path>          recording for the replay backend (.lhmtrace, poll JSON file,
+ *                               .ndjson or directory)
+ *     --speed <x>               replay trace time per wall-clock time, 0 = a frame per poll (default 1)
+ *     --sampler <ms>            also run the native sampler at this interval (default off)
+ *     --categories cpu,gpu,...  hardware to enable (default cpu,gpu,motherboard,memory)
+ *     --duration <s>            run time (default 3600)
+ *     --rate <polls/s>          total poll rate across all pollers (default 10)
+ *     --concurrency <n>         concurrent pollers (default 1)
+ *     --snapshot <s>            snapshot interval (default 60)
+ *     --warmup <s>              excluded from memory growth fits (default 60)
+ *     --out <file>              report path (default soak-<timestamp>.json)
+ *   node test/soak.js --compare <baseline.json> <candidate.json> [--threshold <percent>]
+ *     Prints per-metric deltas; exits 1 if any regresses by more than the threshold.
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { execSync } = require('child_process');
+const { performance, monitorEventLoopDelay, createHistogram } = require('perf_hooks');
+const { createReplayBackend } = require('./replay-backend');
+
+const REPORT_FORMAT = 'libremon-soak/1';
+const NS_PER_MS = 1e6;
+const LOOP_RESOLUTION_MS = 10;
+
+function parseArgs(argv) {
+	const options = {
+		backend: 'replay',
+		module: null,
+		fixture: undefined,
+		speed: 1,
+		samplerMs: 0,
+		categories: ['cpu', 'gpu', 'motherboard', 'memory'],
+		durationS: 3600,
+		rate: 10,
+		concurrency: 1,
+		snapshotS: 60,
+		warmupS: 60,
+		out: `soak-${new Date().toISOString().replace(/[:.]/g, '-')}.json`,
+		compare: null,
+		threshold: Infinity
+	};
+
+	for (let i = 0; i < argv.length; i++) {
+		const arg = argv[i];
+		const value = () => {
+			if (i + 1 >= argv.length) throw new Error(`Missing value for ${arg}`);
+			return argv[++i];
+		};
+		switch (arg) {
+			case '--backend': options.backend = value(); break;
+			case '--module': options.module = path.resolve(value()); break;
+			case '--fixture': options.fixture = path.resolve(value()); break;
+			case '--speed': options.speed = Number(value()); break;
+			case '--sampler': options.samplerMs = Number(value()); break;
+			case '--categories': options.categories = value().split(',').filter(Boolean); break;
+			case '--duration': options.durationS = Number(value()); break;
+			case '--rate': options.rate = Number(value()); break;
+			case '--concurrency': options.concurrency = Number(value()); break;
+			case '--snapshot': options.snapshotS = Number(value()); break;
+			case '--warmup': options.warmupS = Number(value()); break;
+			case '--out': options.out = value(); break;
+			case '--compare': options.compare = [value(), value()]; break;
+			case '--threshold': options.threshold = Number(value()); break;
+			default: throw new Error(`Unknown option: ${arg}`);
+		}
+	}
+
+	if (!(options.rate > 0) || !(options.concurrency >= 1) || !(options.durationS > 0) || !(options.snapshotS > 0)) {
+		throw new Error('--rate, --concurrency, --duration and --snapshot must be positive');
+	}
+	if (!(options.speed >= 0) || !(options.samplerMs >= 0)) {
+		throw new Error('--speed and --sampler must not be negative');
+	}
+	return options;
+}
+
+function loadBackend(options) {
+	if (options.backend === 'replay') {
+		return createReplayBackend({
+			fixture: options.fixture,
+			module: options.module,
+			speed: options.speed,
+			samplerMs: options.samplerMs
+		});
+	}
+	if (options.backend === 'native') {
+		return require(options.module || path.join(__dirname, '..', 'lib', 'index.js'));
+	}
+	throw new Error(`Unknown backend: ${options.backend}`);
+}
+
+function buildInfo(options) {
+	const info = {
+		node: process.version,
+		platform: process.platform,
+		arch: process.arch,
+		backend: options.backend,
+		module: options.module,
+		package: require('../package.json').version,
+		commit: null
+	};
+	try {
+		info.commit = execSync('git rev-parse --short HEAD', { cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore'] }).toString().trim();
+	} catch (err) {
+		// Not a checkout (e.g. a dist copy)
+	}
+	return info;
+}
+
+// Histogram values are integer nanoseconds. monitorEventLoopDelay samples
+// include its own timer interval, which is subtracted via offsetMs.
+function summarize(histogram, offsetMs = 0) {
+	if (histogram.count === 0) {
+		return { count: 0, mean: null, p50: null, p90: null, p99: null, p999: null, max: null };
+	}
+	const ms = (ns) => Math.max(0, Math.round((ns / NS_PER_MS - offsetMs) * 1000) / 1000);
+	return {
+		count: histogram.count,
+		mean: ms(histogram.mean),
+		p50: ms(histogram.percentile(50)),
+		p90: ms(histogram.percentile(90)),
+		p99: ms(histogram.percentile(99)),
+		p999: ms(histogram.percentile(99.9)),
+		max: ms(histogram.max)
+	};
+}
+
+function memorySnapshot(backend) {
+	const usage = process.memoryUsage();
+	let stats = null;
+	try {
+		stats = backend.getStats ? backend.getStats() : null;
+	} catch (err) {
+		// Backend not initialized or getStats not supported by this build
+	}
+	return {
+		rss: usage.rss,
+		heapUsed: usage.heapUsed,
+		external: usage.external,
+		arrayBuffers: usage.arrayBuffers,
+		nativeHeapBytes: stats ? stats.nativeHeapBytes : null,
+		managed: stats ? stats.managed : null
+	};
+}
+
+// Least-squares slope of value over time, in bytes per hour
+function growthPerHour(points) {
+	const valid = points.filter((p) => typeof p.value === 'number');
+	if (valid.length < 3) {
+		return null;
+	}
+	const n = valid.length;
+	const meanT = valid.reduce((sum, p) => sum + p.t, 0) / n;
+	const meanV = valid.reduce((sum, p) => sum + p.value, 0) / n;
+	let num = 0;
+	let den = 0;
+	for (const p of valid) {
+		num += (p.t - meanT) * (p.value - meanV);
+		den += (p.t - meanT) * (p.t - meanT);
+	}
+	return den === 0 ? 0 : Math.round(num / den * 3600 * 1000);
+}
+
+function growth(snapshots, warmupMs) {
+	const steady = snapshots.filter((s) => s.t >= warmupMs);
+	const series = (pick) => growthPerHour(steady.map((s) => ({ t: s.t, value: pick(s.memory) })));
+	return {
+		rss: series((m) => m.rss),
+		heapUsed: series((m) => m.heapUsed),
+		external: series((m) => m.external),
+		nativeHeap: series((m) => m.nativeHeapBytes),
+		managedLive: series((m) => (m.managed ? m.managed.liveBytes : null)),
+		managedCommitted: series((m) => (m.managed ? m.managed.committedBytes : null))
+	};
+}
+
+async function runSoak(options) {
+	const backend = loadBackend(options);
+	const config = {};
+	for (const category of options.categories) {
+		config[category] = true;
+	}
+
+	console.log(`Soak: ${options.backend} backend, ${options.rate} polls/s, ${options.concurrency} poller(s), ${options.durationS} s`);
+	console.log(`Report: ${path.resolve(options.out)}`);
+	await backend.init(config);
+
+	const latency = createHistogram();
+	const windowLatency = createHistogram();
+	const loopDelay = monitorEventLoopDelay({ resolution: LOOP_RESOLUTION_MS });
+	const windowLoopDelay = monitorEventLoopDelay({ resolution: LOOP_RESOLUTION_MS });
+	loopDelay.enable();
+	windowLoopDelay.enable();
+
+	const report = {
+		format: REPORT_FORMAT,
+		build: buildInfo(options),
+		config: {
+			backend: options.backend,
+			categories: options.categories,
+			rate: options.rate,
+			concurrency: options.concurrency,
+			durationS: options.durationS,
+			snapshotS: options.snapshotS,
+			warmupS: options.warmupS,
+			samplerMs: options.samplerMs,
+			replaySpeed: options.backend === 'replay' ? options.speed : null
+		},
+		startedAt: new Date().toISOString(),
+		elapsedMs: 0,
+		completed: false,
+		polls: { total: 0, errors: 0, late: 0, lastError: null },
+		latencyMs: null,
+		eventLoopDelayMs: null,
+		memory: { start: memorySnapshot(backend), end: null, growthBytesPerHour: null },
+		snapshots: []
+	};
+
+	const start = performance.now();
+	const endAt = start + options.durationS * 1000;
+	const periodMs = 1000 / options.rate * options.concurrency;
+	let stopping = false;
+
+	const writeReport = () => {
+		report.elapsedMs = Math.round(performance.now() - start);
+		report.latencyMs = summarize(latency);
+		report.eventLoopDelayMs = summarize(loopDelay, LOOP_RESOLUTION_MS);
+		report.memory.end = memorySnapshot(backend);
+		report.memory.growthBytesPerHour = growth(report.snapshots, options.warmupS * 1000);
+		fs.writeFileSync(options.out, JSON.stringify(report, null, 2));
+	};
+
+	const takeSnapshot = () => {
+		const snapshot = {
+			t: Math.round(performance.now() - start),
+			polls: report.polls.total,
+			errors: report.polls.errors,
+			latencyMs: summarize(windowLatency),
+			eventLoopDelayMs: summarize(windowLoopDelay, LOOP_RESOLUTION_MS),
+			memory: memorySnapshot(backend)
+		};
+		report.snapshots.push(snapshot);
+		windowLatency.reset();
+		windowLoopDelay.reset();
+		writeReport();
+
+		const mb = (bytes) => (bytes == null ? 'n/a' : (bytes / 1048576).toFixed(1) + ' MB');
+		console.log(`[${(snapshot.t / 1000).toFixed(0)} s] polls=${snapshot.polls} ` +
+			`p50=${snapshot.latencyMs.p50} p99=${snapshot.latencyMs.p99} p999=${snapshot.latencyMs.p999} ms ` +
+			`loop p99=${snapshot.eventLoopDelayMs.p99} ms rss=${mb(snapshot.memory.rss)} ` +
+			`native=${mb(snapshot.memory.nativeHeapBytes)} managed=${mb(snapshot.memory.managed && snapshot.memory.managed.liveBytes)}`);
+	};
+
+	// Each poller owns every concurrency-th slot of the schedule; deadlines are
+	// absolute so a slow poll delays only itself, and is counted as late
+	const poller = async (index) => {
+		let deadline = start + index * (periodMs / options.concurrency);
+		while (!stopping && deadline < endAt) {
+			const wait = deadline - performance.now();
+			if (wait > 0) {
+				await new Promise((resolve) => setTimeout(resolve, wait));
+			} else if (wait < -periodMs) {
+				report.polls.late++;
+				deadline = performance.now();
+			}
+			if (stopping) break;
+
+			const t0 = process.hrtime.bigint();
+			try {
+				await backend.poll();
+			} catch (err) {
+				report.polls.errors++;
+				report.polls.lastError = err.message;
+			}
+			const ns = Number(process.hrtime.bigint() - t0);
+			latency.record(Math.max(1, ns));
+			windowLatency.record(Math.max(1, ns));
+			report.polls.total++;
+			deadline += periodMs;
+		}
+	};
+
+	const snapshotTimer = setInterval(takeSnapshot, options.snapshotS * 1000);
+	const onSignal = () => {
+		console.log('\nInterrupted, finishing report...');
+		stopping = true;
+	};
+	process.once('SIGINT', onSignal);
+
+	await Promise.all(Array.from({ length: options.concurrency }, (_, i) => poller(i)));
+
+	clearInterval(snapshotTimer);
+	process.removeListener('SIGINT', onSignal);
+	takeSnapshot();
+	loopDelay.disable();
+	windowLoopDelay.disable();
+	report.completed = !stopping;
+	writeReport();
+	await backend.shutdown();
+
+	console.log('\nSummary');
+	console.log('  polls:', report.polls.total, 'errors:', report.polls.errors, 'late:', report.polls.late);
+	console.log('  latency ms:', JSON.stringify(report.latencyMs));
+	console.log('  event loop delay ms:', JSON.stringify(report.eventLoopDelayMs));
+	console.log('  growth bytes/hour:', JSON.stringify(report.memory.growthBytesPerHour));
+	return report;
+}
+
+// Metrics compared by --compare; all are "lower is better"
+const COMPARED_METRICS = [
+	['latencyMs.p50', (r) => r.latencyMs.p50],
+	['latencyMs.p99', (r) => r.latencyMs.p99],
+	['latencyMs.p999', (r) => r.latencyMs.p999],
+	['eventLoopDelayMs.p99', (r) => r.eventLoopDelayMs.p99],
+	['eventLoopDelayMs.max', (r) => r.eventLoopDelayMs.max],
+	['growth.rss', (r) => r.memory.growthBytesPerHour.rss],
+	['growth.heapUsed', (r) => r.memory.growthBytesPerHour.heapUsed],
+	['growth.nativeHeap', (r) => r.memory.growthBytesPerHour.nativeHeap],
+	['growth.managedLive', (r) => r.memory.growthBytesPerHour.managedLive]
+];
+
+function compareReports(baselinePath, candidatePath, thresholdPercent) {
+	const baseline = JSON.parse(fs.readFileSync(baselinePath, 'utf8'));
+	const candidate = JSON.parse(fs.readFileSync(candidatePath, 'utf8'));
+	for (const report of [baseline, candidate]) {
+		if (report.format !== REPORT_FORMAT) {
+			throw new Error(`Unsupported report format: ${report.format}`);
+		}
+	}
+	if (JSON.stringify(baseline.config) !== JSON.stringify(candidate.config)) {
+		console.warn('Warning: reports were produced with different configurations');
+	}
+
+	console.log(`${'metric'.padEnd(24)} ${'baseline'.padStart(14)} ${'candidate'.padStart(14)} ${'delta'.padStart(9)}`);
+	let regressions = 0;
+	for (const [name, pick] of COMPARED_METRICS) {
+		const a = pick(baseline);
+		const b = pick(candidate);
+		if (a == null || b == null) {
+			continue;
+		}
+		const delta = a === 0 ? (b === 0 ? 0 : Infinity) : (b - a) / Math.abs(a) * 100;
+		const regressed = delta > thresholdPercent;
+		regressions += regressed ? 1 : 0;
+		console.log(`${name.padEnd(24)} ${String(a).padStart(14)} ${String(b).padStart(14)} ${(delta.toFixed(1) + '%').padStart(9)}${regressed ? '  REGRESSION' : ''}`);
+	}
+	return regressions;
+}
+
+async function main() {
+	const options = parseArgs(process.argv.slice(2));
+	if (options.compare) {
+		const regressions = compareReports(options.compare[0], options.compare[1], options.threshold);
+		process.exit(regressions > 0 ? 1 : 0);
+	}
+	await runSoak(options);
+}
+
+main().catch((err) => {
+	console.error('\n✗ Soak failed:', err.message);
+	process.exit(1);
+});
@@ -0,0 +1,103 @@
+/**
+ * Adaptive sampler interval test on the replay bridge (no hardware needed)
+ * The CPU is busy until the trace ends; the GPU is flat, then busy from
+ * GPU_FROM on. Calm categories back off to their maximum interval and busy
+ * ones drop to their minimum.
+ * Usage: node test/test-adaptive-intervals.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const CHANGE_THRESHOLD = 0.01;
+const MIN_MS = 10;
+const MAX_MS = 80;
+const INTERVAL_MS = 1000;
+// Frames step once per category update at speed 0, about 100-200 a second here
+const GPU_FROM = 400;
+const FRAMES = 700;
+const TIMEOUT_MS = 15000;
+
+// Changes by at least 2% from any frame to one less than 50 frames later
+const busy = (frame) => 10 + (frame % 50) * 10;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+async function waitFor(monitor, predicate, what) {
+	const deadline = Date.now() + TIMEOUT_MS;
+	for (;;) {
+		const sampler = monitor.getStats().sampler;
+		if (predicate(sampler)) {
+			return sampler;
+		}
+		assert.ok(Date.now() < deadline, 'timed out waiting for ' + what);
+		await sleep(20);
+	}
+}
+
+const rateOf = (sampler, category) => sampler.categories.find((rate) => rate.category === category);
+const intervalOf = (sampler, category) => rateOf(sampler, category).intervalMs;
+
+async function main() {
+	console.log('Testing adaptive sampler intervals (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('adaptive.lhmtrace'), buildFrames({
+		count: FRAMES,
+		value: (frame, sensor) => {
+			if (sensor.id.startsWith('/intelcpu/')) return busy(frame);
+			if (sensor.id.startsWith('/gpu-nvidia/')) return frame < GPU_FROM ? 50 : busy(frame);
+			return 1;
+		}
+	}));
+	const range = { minIntervalMs: MIN_MS, maxIntervalMs: MAX_MS };
+	await monitor.init({
+		replay: trace,
+		speed: 0,
+		loop: false,
+		adaptive: { changeThreshold: CHANGE_THRESHOLD, cpu: range, gpu: range }
+	});
+
+	// 1. Ranges reported; the sampler ticks at the finest minimum
+	monitor.startSampler({ intervalMs: INTERVAL_MS });
+	const start = monitor.getStats().sampler;
+	assert.strictEqual(start.adaptive, true);
+	assert.strictEqual(start.changeThreshold, CHANGE_THRESHOLD);
+	assert.strictEqual(start.tickMs, MIN_MS);
+	assert.deepStrictEqual(rateOf(start, 'cpu').adaptive, Object.assign({ changeRate: 0 }, range));
+	assert.strictEqual(intervalOf(start, 'cpu'), MIN_MS);
+	assert.strictEqual(rateOf(start, 'motherboard').adaptive, null);
+	assert.strictEqual(intervalOf(start, 'motherboard'), INTERVAL_MS);
+	console.log(`   ✓ Ticking every ${start.tickMs} ms`);
+
+	// 2. The flat GPU backs off to its maximum while the busy CPU stays at its minimum
+	const calm = await waitFor(monitor, (sampler) => intervalOf(sampler, 'gpu') === MAX_MS, 'the GPU to back off');
+	assert.strictEqual(intervalOf(calm, 'cpu'), MIN_MS);
+	assert.ok(rateOf(calm, 'gpu').adaptive.changeRate < CHANGE_THRESHOLD);
+	assert.ok(rateOf(calm, 'cpu').adaptive.changeRate >= CHANGE_THRESHOLD);
+	assert.strictEqual(intervalOf(calm, 'motherboard'), INTERVAL_MS, 'other categories keep the interval');
+	console.log(`   ✓ Calm GPU at ${MAX_MS} ms, busy CPU at ${MIN_MS} ms`);
+
+	// 3. Activity brings the GPU back to its minimum quickly
+	const active = await waitFor(monitor, (sampler) => intervalOf(sampler, 'gpu') === MIN_MS, 'the GPU to speed up');
+	assert.strictEqual(intervalOf(active, 'cpu'), MIN_MS);
+	console.log('   ✓ Busy GPU back at ' + MIN_MS + ' ms');
+
+	// 4. Once the trace holds its last frame both back off
+	const held = await waitFor(monitor,
+		(sampler) => intervalOf(sampler, 'cpu') === MAX_MS && intervalOf(sampler, 'gpu') === MAX_MS, 'both to back off');
+	assert.ok(held.categories.every((rate) => !rate.throttled), 'no budget involved');
+	assert.deepStrictEqual(held.decisions, [], 'adaptive changes are not budget decisions');
+	monitor.stopSampler();
+	await monitor.shutdown();
+	console.log('   ✓ Both at ' + MAX_MS + ' ms after the trace ends');
+
+	console.log('\nAll adaptive interval tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
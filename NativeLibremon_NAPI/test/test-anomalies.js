@@ -0,0 +1,100 @@
+/**
+ * Anomaly detection test on the replay bridge (no hardware needed)
+ * Usage: node test/test-anomalies.js
+ */
+
+const assert = require('assert');
+const { loadModule, pollFrames, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const SPIKE_FROM = 30;
+const SPIKE_TO = 33;
+const FRAMES = 45;
+
+// Steady values with a little noise; the fan and the CPU load spike in the same frames
+const value = (frame, sensor, index) => {
+	const noise = ((frame * 7 + index * 3) % 5 - 2) * 0.002;
+	const spike = frame >= SPIKE_FROM && frame < SPIKE_TO;
+	switch (sensor.type) {
+		case 'Fan': return spike ? 3000 : 1000 * (1 + noise);
+		case 'Load': return spike ? 100 : 20 * (1 + noise);
+		default: return 50 * (1 + noise);
+	}
+};
+
+async function main() {
+	console.log('Testing anomaly detection (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('anomalies.lhmtrace'), buildFrames({ count: FRAMES, value }));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Off until configured
+	assert.strictEqual(monitor.getAnomalies().enabled, false);
+	assert.throws(() => monitor.setAnomalyDetection({ defaults: { alpha: 2 } }), TypeError);
+	assert.throws(() => monitor.setAnomalyDetection({ defaults: { warmup: 0 } }), TypeError);
+	assert.throws(() => monitor.setAnomalyDetection({ seasonal: { slots: 0 } }), TypeError);
+	monitor.setAnomalyDetection({
+		defaults: { alpha: 0.1, threshold: 4, warmup: 10 },
+		types: { Load: false }
+	});
+	assert.strictEqual(monitor.getAnomalies().enabled, true);
+	console.log('   ✓ Configuration validated');
+
+	// 2. Steady values raise nothing
+	await pollFrames(monitor, SPIKE_FROM);
+	let state = monitor.getAnomalies();
+	assert.deepStrictEqual(state.active, []);
+	assert.deepStrictEqual(state.events, []);
+	console.log('   ✓ No anomalies while steady');
+
+	// 3. The fan spike is raised; the Load type is skipped
+	await monitor.poll();
+	state = monitor.getAnomalies();
+	assert.strictEqual(state.active.length, 1, JSON.stringify(state.active));
+	const active = state.active[0];
+	assert.strictEqual(active.id, '/lpc/nct6798d/0/fan/0');
+	assert.strictEqual(active.type, 'Fan');
+	assert.strictEqual(active.value, 3000);
+	assert.ok(Math.abs(active.mean - 1000) < 10, 'mean is the steady baseline: ' + active.mean);
+	assert.ok(active.score >= 4, 'score past the threshold: ' + active.score);
+	assert.strictEqual(state.events.length, 1);
+	const raised = state.events[0];
+	assert.strictEqual(raised.state, 'raised');
+	assert.strictEqual(raised.id, active.id);
+	assert.strictEqual(state.sequence, raised.sequence);
+	assert.ok(!state.active.some((a) => a.type === 'Load'), 'Load is disabled');
+	console.log(`   ✓ Spike raised (score ${active.score.toFixed(1)})`);
+
+	// 4. Events since a sequence; back to normal clears with the peak score
+	await pollFrames(monitor, FRAMES - SPIKE_FROM - 1);
+	const since = raised.sequence;
+	state = monitor.getAnomalies({ since });
+	assert.deepStrictEqual(state.active, []);
+	assert.strictEqual(state.events.length, 1, JSON.stringify(state.events));
+	const cleared = state.events[0];
+	assert.strictEqual(cleared.state, 'cleared');
+	assert.strictEqual(cleared.id, raised.id);
+	assert.ok(cleared.sequence > since);
+	assert.ok(cleared.peakScore >= active.score);
+	assert.strictEqual(monitor.getAnomalies({ since: cleared.sequence }).events.length, 0);
+	assert.strictEqual(monitor.getAnomalies().events.length, 2, 'since=0 returns every kept event');
+	assert.throws(() => monitor.getAnomalies({ since: -1 }), TypeError);
+	console.log('   ✓ Cleared after the spike, events since a sequence');
+
+	// 5. Disabling drops the baselines
+	monitor.setAnomalyDetection(null);
+	state = monitor.getAnomalies();
+	assert.strictEqual(state.enabled, false);
+	assert.deepStrictEqual(state.active, []);
+	console.log('   ✓ Disabled');
+
+	await monitor.shutdown();
+	console.log('\nAll anomaly detection tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,98 @@
+/**
+ * captureBurst() test on the replay bridge (no hardware needed)
+ * Every burst sample steps one frame, so values give away which frame each row read.
+ * Usage: node test/test-burst.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+const CPU_POWER = '/intelcpu/0/power/0';
+const FAN = '/lpc/nct6798d/0/fan/0';
+const SWAP_AT = 60;
+
+// TEST_LAYOUT with one more CPU sensor, from frame SWAP_AT on
+const GROWN_LAYOUT = {
+	hardware: TEST_LAYOUT.hardware,
+	sensors: TEST_LAYOUT.sensors.concat([{ id: '/intelcpu/0/clock/0', name: 'Bus Speed', type: 'Clock', hardware: 0 }])
+};
+
+const value = (frame, sensor, index) => 1000 * index + frame;
+const frameOf = (burst, row, column) => burst.values[row * burst.sensors.length + column] - 1000 *
+	TEST_LAYOUT.sensors.findIndex((sensor) => sensor.id === burst.sensors[column]);
+
+async function main() {
+	console.log('Testing captureBurst (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('burst.lhmtrace'), buildFrames({
+		count: 200,
+		layouts: [TEST_LAYOUT, GROWN_LAYOUT],
+		layoutAt: (frame) => (frame < SWAP_AT ? 0 : 1),
+		value
+	}));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Arguments and sensors validated
+	await assert.rejects(monitor.captureBurst({ sensors: [] }), TypeError);
+	await assert.rejects(monitor.captureBurst({ sensors: [FAN], intervalMs: 0 }), TypeError);
+	await assert.rejects(monitor.captureBurst({ sensors: ['/nope'] }), /Unknown sensor/);
+	monitor.defineSensor('fanTwice', `${FAN} * 2`);
+	await assert.rejects(monitor.captureBurst({ sensors: ['/derived/fanTwice'] }), /Derived sensors/);
+	monitor.removeSensor('fanTwice');
+	console.log('   ✓ Arguments validated');
+
+	// 2. One row per interval, every row a new frame for both columns
+	const burst = await monitor.captureBurst({ sensors: [CPU_POWER, FAN], intervalMs: 5, durationMs: 100 });
+	assert.deepStrictEqual(burst.sensors, [CPU_POWER, FAN]);
+	assert.strictEqual(burst.intervalMs, 5);
+	assert.strictEqual(burst.truncated, false);
+	assert.strictEqual(burst.count + burst.missed, 20, 'rows plus missed ticks fill the window');
+	assert.strictEqual(burst.timestamps.length, burst.count);
+	assert.strictEqual(burst.values.length, burst.count * 2);
+	assert.ok(Math.abs(burst.startedAt - Date.now()) < 60000);
+	const first = frameOf(burst, 0, 0);
+	for (let row = 0; row < burst.count; row++) {
+		assert.strictEqual(frameOf(burst, row, 0), first + row, 'CPU row ' + row);
+		assert.strictEqual(frameOf(burst, row, 1), first + row, 'fan row ' + row);
+	}
+	console.log(`   ✓ ${burst.count} rows from frame ${first} (${burst.missed} missed)`);
+
+	// 3. Timestamps keep the interval grid
+	assert.ok(burst.timestamps[0] >= 0 && burst.timestamps[0] < 1, 'first row at the start');
+	for (let row = 1; row < burst.count; row++) {
+		assert.ok(burst.timestamps[row] > burst.timestamps[row - 1], 'monotonic');
+		assert.ok(burst.timestamps[row] >= row * 5 - 1, 'not ahead of the grid');
+	}
+	const spanMs = burst.timestamps[burst.count - 1];
+	assert.ok(spanMs >= 85 && spanMs < 200, 'about 95 ms of samples: ' + spanMs.toFixed(1));
+	console.log(`   ✓ ${(spanMs / (burst.count - 1)).toFixed(2)} ms between rows`);
+
+	// 4. Polls carry on from the frame after the burst
+	await monitor.poll();
+	assert.strictEqual(monitor.get(CPU_POWER), 3000 + first + burst.count);
+	console.log('   ✓ Polls continue after it');
+
+	// 5. A layout change ends the burst early
+	const generation = monitor.getSchema().generation;
+	const start = monitor.get(CPU_POWER) - 3000 + 1;
+	const cut = await monitor.captureBurst({ sensors: [CPU_POWER], intervalMs: 2, durationMs: 400 });
+	assert.strictEqual(cut.truncated, true);
+	assert.strictEqual(monitor.getSchema().generation, generation + 1);
+	// The row that stepped into the new layout is the last one
+	assert.strictEqual(cut.count, SWAP_AT - start + 1);
+	for (let row = 0; row < cut.count - 1; row++) {
+		assert.strictEqual(frameOf(cut, row, 0), start + row);
+	}
+	console.log(`   ✓ Truncated after ${cut.count} of 200 rows by the layout change`);
+
+	await monitor.shutdown();
+	console.log('\nAll burst tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
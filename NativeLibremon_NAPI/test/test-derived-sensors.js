@@ -0,0 +1,114 @@
+/**
+ * Derived sensor test on the replay bridge (no hardware needed)
+ * Usage: node test/test-derived-sensors.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+// Core #1 = 40 + frame, Core #2 = 50 + frame, CPU/GPU power 20/100 + frame, others 1
+const value = (frame, sensor) => {
+	switch (sensor.id) {
+		case '/intelcpu/0/temperature/0': return 40 + frame;
+		case '/intelcpu/0/temperature/1': return 50 + frame;
+		case '/intelcpu/0/power/0': return 20 + frame;
+		case '/gpu-nvidia/0/power/0': return 100 + frame;
+		default: return 1;
+	}
+};
+
+function findSensor(node, id) {
+	if (node.SensorId === id) return node;
+	for (const child of node.Children || []) {
+		const found = findSensor(child, id);
+		if (found) return found;
+	}
+	return null;
+}
+
+async function main() {
+	console.log('Testing derived sensors (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('derived.lhmtrace'), buildFrames({ count: 10, value }));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Definitions: arithmetic, globs, aggregates, derived inputs
+	const power = monitor.defineSensor('systemPower', '/intelcpu/0/power/0 + sum(\'/gpu-*/*/power/*\')', { type: 'Power' });
+	monitor.defineSensor('coreAvg', 'avg(\'/intelcpu/0/temperature/*\')', { type: 'Temperature' });
+	monitor.defineSensor('spread', 'abs(/intelcpu/0/temperature/0 - /intelcpu/0/temperature/1)');
+	monitor.defineSensor('halfPower', '/derived/systemPower / 2', { type: 'Power' });
+	monitor.defineSensor('hottest', 'max(/intelcpu/0/temperature/0, /gpu-nvidia/0/temperature/0, 45)');
+	assert.strictEqual(power, '/derived/systemPower', 'defineSensor returns the id');
+	const defined = monitor.getDerivedSensors();
+	assert.deepStrictEqual(defined.map((d) => d.id),
+		['/derived/systemPower', '/derived/coreAvg', '/derived/spread', '/derived/halfPower', '/derived/hottest']);
+	assert.strictEqual(defined[0].type, 'Power');
+	assert.strictEqual(defined[2].type, 'Factor', 'type defaults to Factor');
+	console.log('   ✓ Definitions listed in order');
+
+	// 2. Values after polls, in the schema, lookups and the poll tree
+	await monitor.poll();
+	const tree = await monitor.poll();   // Frame 1
+	const expected = {
+		'/derived/systemPower': 21 + 101,
+		'/derived/coreAvg': (41 + 51) / 2,
+		'/derived/spread': 10,
+		'/derived/halfPower': (21 + 101) / 2,
+		'/derived/hottest': 45
+	};
+	for (const [id, want] of Object.entries(expected)) {
+		assert.strictEqual(monitor.get(id), want, id);
+	}
+	const schemaIds = monitor.getSchema().sensors.map((s) => s.id);
+	assert.deepStrictEqual(schemaIds.slice(-5), Object.keys(expected), 'derived sensors follow the bridge sensors');
+	const node = findSensor(tree, '/derived/systemPower');
+	assert.ok(node, 'derived sensor appears in the poll tree');
+	assert.strictEqual(node.Type, 'Power');
+	assert.ok(node.Value.startsWith('122'), 'formatted like a Power sensor: ' + node.Value);
+	console.log('   ✓ Values in get(), getSchema() and poll()');
+
+	// 3. rate() and integral() advance with the updates
+	monitor.defineSensor('coreRate', 'rate(/intelcpu/0/temperature/0)');
+	monitor.defineSensor('coreIntegral', 'integral(/intelcpu/0/temperature/0)');
+	await monitor.poll();
+	await new Promise((resolve) => setTimeout(resolve, 50));
+	await monitor.poll();
+	assert.ok(monitor.get('/derived/coreRate') > 0, 'rising input gives a positive rate');
+	assert.ok(monitor.get('/derived/coreIntegral') > 0, 'positive input integrates up');
+	console.log('   ✓ rate() and integral()');
+
+	// 4. Errors: syntax, unknown ids, arity, types, self references, names
+	assert.throws(() => monitor.defineSensor('bad', '1 +'), Error);
+	assert.throws(() => monitor.defineSensor('bad', '/nope/0/power/0 * 2'), /nope/);
+	assert.throws(() => monitor.defineSensor('bad', 'abs(1, 2)'), Error);
+	assert.throws(() => monitor.defineSensor('bad', '1', { type: 'NoSuchType' }), Error);
+	assert.throws(() => monitor.defineSensor('bad', '/derived/bad + 1'), Error, 'no self reference');
+	assert.throws(() => monitor.defineSensor('', '1'), Error);
+	assert.ok(!monitor.getDerivedSensors().some((d) => d.name === 'bad'), 'failed definitions leave nothing behind');
+	console.log('   ✓ Invalid definitions rejected');
+
+	// 5. Redefinition and removal
+	monitor.defineSensor('spread', '/intelcpu/0/temperature/1 - /intelcpu/0/temperature/0');
+	await monitor.poll();
+	assert.strictEqual(monitor.get('/derived/spread'), 10);
+	assert.strictEqual(monitor.removeSensor('spread'), true);
+	assert.strictEqual(monitor.removeSensor('spread'), false);
+	await monitor.poll();
+	assert.strictEqual(monitor.get('/derived/spread'), null, 'removed sensor is gone');
+	assert.ok(!monitor.getSchema().sensors.some((s) => s.id === '/derived/spread'));
+	console.log('   ✓ Redefinition and removal');
+
+	for (const { name } of monitor.getDerivedSensors()) {
+		monitor.removeSensor(name);
+	}
+	await monitor.shutdown();
+	console.log('\nAll derived sensor tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
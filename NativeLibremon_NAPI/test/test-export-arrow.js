@@ -0,0 +1,230 @@
+/**
+ * exportArrow() round-trip test on the replay bridge (no hardware needed)
+ * Reads the stream back with a small Arrow IPC reader (Message.fbs,
+ * Schema.fbs) and compares it with history() over the same window.
+ * Usage: node test/test-export-arrow.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const CORE = '/intelcpu/0/temperature/0';
+const GPU_POWER = '/gpu-nvidia/0/power/0';
+const VCORE = '/lpc/nct6798d/0/voltage/0';
+
+const HEADER_SCHEMA = 1;
+const HEADER_RECORD_BATCH = 3;
+const TYPE_FLOATING_POINT = 3;
+const TYPE_TIMESTAMP = 10;
+
+// Sensor i reads 10 * (i + 1) + frame / 4; the voltage has no value in odd frames
+const value = (frame, sensor, index) => {
+	if (sensor.type === 'Voltage' && frame % 2 === 1) return NaN;
+	return 10 * (index + 1) + frame / 4;
+};
+
+// Flatbuffer tables, vectors and strings of one message
+class FlatReader {
+	constructor(view, base) {
+		this.view = view;
+		this.root = base + view.getUint32(base, true);
+	}
+
+	field(table, id) {
+		const vtable = table - this.view.getInt32(table, true);
+		const slot = 4 + 2 * id;
+		if (slot >= this.view.getUint16(vtable, true)) return 0;
+		const offset = this.view.getUint16(vtable + slot, true);
+		return offset ? table + offset : 0;
+	}
+
+	scalar(table, id, read, fallback = 0) {
+		const at = this.field(table, id);
+		return at ? read(at) : fallback;
+	}
+
+	u8(table, id) { return this.scalar(table, id, (at) => this.view.getUint8(at)); }
+	i16(table, id) { return this.scalar(table, id, (at) => this.view.getInt16(at, true)); }
+	i64(table, id) { return this.scalar(table, id, (at) => Number(this.view.getBigInt64(at, true))); }
+
+	ref(table, id) {
+		const at = this.field(table, id);
+		return at ? at + this.view.getUint32(at, true) : 0;
+	}
+
+	string(table, id) {
+		const at = this.ref(table, id);
+		if (!at) return null;
+		const bytes = new Uint8Array(this.view.buffer, this.view.byteOffset + at + 4, this.view.getUint32(at, true));
+		return Buffer.from(bytes).toString('utf8');
+	}
+
+	tables(table, id) {
+		const at = this.ref(table, id);
+		if (!at) return [];
+		return Array.from({ length: this.view.getUint32(at, true) }, (_, i) => {
+			const element = at + 4 + 4 * i;
+			return element + this.view.getUint32(element, true);
+		});
+	}
+
+	// Vector of { a: int64, b: int64 } structs (FieldNode, Buffer)
+	pairs(table, id) {
+		const at = this.ref(table, id);
+		return Array.from({ length: this.view.getUint32(at, true) }, (_, i) => [
+			Number(this.view.getBigInt64(at + 4 + 16 * i, true)),
+			Number(this.view.getBigInt64(at + 12 + 16 * i, true))
+		]);
+	}
+}
+
+// Encapsulated stream messages: { type, reader, header, body }, up to the end marker
+function readMessages(buffer) {
+	const view = new DataView(buffer);
+	const messages = [];
+	let position = 0;
+	for (;;) {
+		assert.strictEqual(view.getUint32(position, true), 0xFFFFFFFF, 'continuation marker at ' + position);
+		const length = view.getInt32(position + 4, true);
+		position += 8;
+		if (length === 0) break;
+		assert.strictEqual((position + length) % 8, 0, 'message body 8-byte aligned');
+		const reader = new FlatReader(new DataView(buffer, position, length), 0);
+		const message = reader.root;
+		assert.strictEqual(reader.i16(message, 0), 4, 'metadata V5');
+		const bodyLength = reader.i64(message, 3);
+		position += length;
+		messages.push({
+			type: reader.u8(message, 1),
+			reader,
+			header: reader.ref(message, 2),
+			body: new DataView(buffer, position, bodyLength)
+		});
+		position += bodyLength;
+	}
+	assert.strictEqual(position, buffer.byteLength, 'nothing after the end marker');
+	return messages;
+}
+
+function readSchema({ reader, header }) {
+	return reader.tables(header, 1).map((field) => {
+		const type = reader.ref(field, 3);
+		const metadata = {};
+		for (const entry of reader.tables(field, 6)) {
+			metadata[reader.string(entry, 0)] = reader.string(entry, 1);
+		}
+		return {
+			name: reader.string(field, 0),
+			nullable: reader.u8(field, 1) === 1,
+			typeType: reader.u8(field, 2),
+			unit: reader.i16(type, 0),
+			timezone: reader.string(type, 1),
+			metadata
+		};
+	});
+}
+
+// Columns of a record batch: timestamps (BigInt us), then one value array per float column
+function readBatch({ reader, header, body }) {
+	const rows = reader.i64(header, 0);
+	const nodes = reader.pairs(header, 1);
+	const buffers = reader.pairs(header, 2);
+	const timestamps = Array.from({ length: rows }, (_, r) => body.getBigInt64(buffers[1][0] + 8 * r, true));
+	const columns = [];
+	for (let c = 1; c < nodes.length; c++) {
+		const [validityOffset, validityLength] = buffers[2 * c];
+		const [dataOffset] = buffers[2 * c + 1];
+		const values = [];
+		for (let r = 0; r < rows; r++) {
+			const valid = validityLength === 0 || (body.getUint8(validityOffset + (r >> 3)) >> (r & 7)) & 1;
+			values.push(valid ? body.getFloat32(dataOffset + 4 * r, true) : null);
+		}
+		assert.strictEqual(nodes[c][0], rows);
+		assert.strictEqual(nodes[c][1], values.filter((v) => v === null).length, 'null count');
+		columns.push(values);
+	}
+	return { rows, timestamps, columns };
+}
+
+async function main() {
+	console.log('Testing exportArrow (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('arrow.lhmtrace'), buildFrames({ count: 30, value }));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Arguments and history required
+	assert.throws(() => monitor.exportArrow(CORE, -Infinity, Infinity), TypeError);
+	assert.throws(() => monitor.exportArrow([CORE, CORE], -Infinity, Infinity), TypeError);
+	await assert.rejects(monitor.exportArrow([CORE], -Infinity, Infinity), /setHistory/);
+	console.log('   ✓ Arguments validated');
+
+	monitor.setHistory({ capacity: 100 });
+	for (let i = 0; i < 20; i++) {
+		await monitor.poll();
+	}
+	const ids = [CORE, GPU_POWER, VCORE, '/nope'];
+	const buffer = await monitor.exportArrow(ids, -Infinity, Infinity);
+	assert.ok(buffer instanceof ArrayBuffer);
+	const messages = readMessages(buffer);
+	assert.deepStrictEqual(messages.map((m) => m.type), [HEADER_SCHEMA, HEADER_RECORD_BATCH]);
+	console.log(`   ✓ Stream framing (${buffer.byteLength} bytes)`);
+
+	// 2. Schema: timestamp column, one nullable float32 column per id with metadata
+	const fields = readSchema(messages[0]);
+	assert.deepStrictEqual(fields.map((f) => f.name), ['timestamp', ...ids]);
+	assert.strictEqual(fields[0].typeType, TYPE_TIMESTAMP);
+	assert.strictEqual(fields[0].unit, 2, 'microseconds');
+	assert.strictEqual(fields[0].timezone, 'UTC');
+	assert.strictEqual(fields[0].nullable, false);
+	for (const field of fields.slice(1)) {
+		assert.strictEqual(field.typeType, TYPE_FLOATING_POINT);
+		assert.strictEqual(field.unit, 1, 'single precision');
+		assert.strictEqual(field.nullable, true);
+	}
+	assert.deepStrictEqual(fields[1].metadata, {
+		SensorId: CORE,
+		SensorName: 'Core #1',
+		SensorType: 'Temperature',
+		HardwareId: '/intelcpu/0',
+		HardwareName: 'Test CPU'
+	});
+	assert.deepStrictEqual(fields[4].metadata, { SensorId: '/nope' }, 'unknown ids only carry their id');
+	console.log('   ✓ Schema and field metadata');
+
+	// 3. Values match history() over the same window; NaN comes back as null
+	const batch = readBatch(messages[1]);
+	const stored = await monitor.history(ids, -Infinity, Infinity, { points: 1000 });
+	assert.strictEqual(batch.rows, stored.rows);
+	assert.strictEqual(batch.rows, 20);
+	const times = stored.series[0].timestamps;
+	batch.timestamps.forEach((us, r) => {
+		assert.strictEqual(us, BigInt(Math.round(times[r] * 1000)), 'timestamp ' + r);
+	});
+	for (let c = 0; c < 3; c++) {
+		const expected = Array.from(stored.series[c].values, (v) => (Number.isNaN(v) ? null : v));
+		assert.deepStrictEqual(batch.columns[c], expected, ids[c]);
+	}
+	assert.ok(batch.columns[2].includes(null), 'voltage gaps are nulls');
+	assert.ok(batch.columns[3].every((v) => v === null), 'unknown ids are all null');
+	console.log('   ✓ Values round-trip');
+
+	// 4. Time windows and empty exports
+	const window = readBatch(readMessages(await monitor.exportArrow([CORE], times[5], times[9]))[1]);
+	assert.strictEqual(window.rows, 5);
+	assert.deepStrictEqual(window.columns[0], Array.from(stored.series[0].values.slice(5, 10)));
+	const empty = readMessages(await monitor.exportArrow([CORE], times[19] + 1000, Infinity));
+	assert.strictEqual(readBatch(empty[1]).rows, 0);
+	console.log('   ✓ Windows and empty exports');
+
+	monitor.setHistory(null);
+	await monitor.shutdown();
+	console.log('\nAll exportArrow tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,142 @@
+/**
+ * Hardware/sensor filter test on the replay bridge (no hardware needed)
+ * Covers setFilter()/init({ filter }) lists and the legacy poll() presets.
+ * Usage: node test/test-filter.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+// TEST_LAYOUT with a physical and a virtual NIC, and a DIMM
+const FILTER_LAYOUT = {
+	hardware: TEST_LAYOUT.hardware.concat([
+		{ id: '/nic/%7B1%7D', name: 'Ethernet', type: 'Network', parent: -1 },
+		{ id: '/nic/%7B2%7D', name: 'vEthernet (Default Switch)', type: 'Network', parent: -1 },
+		{ id: '/memory/dimm/0', name: 'DIMM #1', type: 'Memory', parent: -1 }
+	]),
+	sensors: TEST_LAYOUT.sensors.concat([
+		{ id: '/nic/%7B1%7D/throughput/0', name: 'Download Speed', type: 'Throughput', hardware: 4 },
+		{ id: '/nic/%7B2%7D/throughput/0', name: 'Download Speed', type: 'Throughput', hardware: 5 },
+		{ id: '/memory/dimm/0/temperature/0', name: 'DIMM Temperature', type: 'Temperature', hardware: 6 }
+	])
+};
+const ALL_HARDWARE = FILTER_LAYOUT.hardware.map((hw) => hw.id);
+const ALL_SENSORS = FILTER_LAYOUT.sensors.map((sensor) => sensor.id);
+
+// HardwareIds in the poll tree, in tree order
+function treeHardware(tree) {
+	const ids = [];
+	const walk = (node) => {
+		if (node.HardwareId) ids.push(node.HardwareId);
+		for (const child of node.Children || []) walk(child);
+	};
+	walk(tree);
+	return ids;
+}
+
+function schemaIds(monitor) {
+	const schema = monitor.getSchema();
+	return { hardware: schema.hardware.map((hw) => hw.id), sensors: schema.sensors.map((sensor) => sensor.id) };
+}
+
+async function main() {
+	console.log('Testing filters (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('filter.lhmtrace'), buildFrames({
+		count: 40,
+		layouts: [FILTER_LAYOUT],
+		value: (frame, sensor, index) => 100 * index + frame
+	}));
+	const events = [];
+	const onTopology = (diff) => events.push(diff);
+	monitor.on('topology', onTopology);
+
+	// 1. init({ filter }): excluded hardware leaves the schema, the values and the tree
+	await monitor.init({ replay: trace, speed: 0, loop: false, filter: { excludeNames: ['GPU'] } });
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ALL_HARDWARE.filter((id) => id !== '/gpu-nvidia/0'));
+	assert.ok(!schemaIds(monitor).sensors.some((id) => id.startsWith('/gpu-nvidia/')));
+	assert.ok(!treeHardware(await monitor.poll()).includes('/gpu-nvidia/0'));
+	assert.strictEqual(monitor.get('/intelcpu/0/power/0'), 300, 'first frame');
+	assert.strictEqual(monitor.get('/gpu-nvidia/0/power/0'), null);
+	console.log('   ✓ Name exclude from init()');
+
+	// 2. HardwareId prefixes take the sub-hardware along; each filter is a new generation
+	let generation = monitor.getSchema().generation;
+	monitor.setFilter({ excludeHardwareIds: ['/mother'] });
+	assert.strictEqual(monitor.getSchema().generation, generation + 1);
+	assert.deepStrictEqual(schemaIds(monitor).hardware,
+		ALL_HARDWARE.filter((id) => id !== '/motherboard' && id !== '/lpc/nct6798d/0'));
+	assert.deepStrictEqual(treeHardware(await monitor.poll()), schemaIds(monitor).hardware);
+	monitor.setFilter({ excludeHardwareIds: ['/nct6798d'] });
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ALL_HARDWARE, 'ids match by prefix only');
+	console.log('   ✓ HardwareId prefix exclude');
+
+	// 3. Sensor types, case-insensitive; unknown names are ignored
+	monitor.setFilter({ excludeSensorTypes: ['temperature', 'Bogus'] });
+	const { sensors } = schemaIds(monitor);
+	assert.deepStrictEqual(sensors, FILTER_LAYOUT.sensors.filter((s) => s.type !== 'Temperature').map((s) => s.id));
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ALL_HARDWARE, 'hardware kept without its temperatures');
+	const tree = await monitor.poll();
+	assert.ok(!JSON.stringify(tree).includes('/temperature/'));
+	monitor.setFilter({ includeSensorTypes: ['Power'] });
+	assert.deepStrictEqual(schemaIds(monitor).sensors, ['/intelcpu/0/power/0', '/gpu-nvidia/0/power/0']);
+	console.log('   ✓ Sensor type exclude and include');
+
+	// 4. Includes keep ancestors and descendants of a match
+	monitor.setFilter({ includeHardwareIds: ['/lpc/'] });
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ['/motherboard', '/lpc/nct6798d/0']);
+	monitor.setFilter({ includeNames: ['Board'] });
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ['/motherboard', '/lpc/nct6798d/0']);
+	monitor.setFilter({ includeNames: ['CPU', 'Ethernet'], excludeNames: ['vEthernet'] });
+	assert.deepStrictEqual(schemaIds(monitor).hardware, ['/intelcpu/0', '/nic/%7B1%7D']);
+	const included = await monitor.poll();
+	assert.deepStrictEqual(treeHardware(included), ['/intelcpu/0', '/nic/%7B1%7D']);
+	console.log('   ✓ Name and HardwareId include');
+
+	// 5. Clearing the filter brings every sensor back, Min/Max kept through the filter
+	monitor.setFilter(null);
+	assert.deepStrictEqual(schemaIds(monitor), { hardware: ALL_HARDWARE, sensors: ALL_SENSORS });
+	await monitor.poll();
+	const frame = monitor.get('/intelcpu/0/power/0') - 300;
+	const gpuIndex = ALL_SENSORS.indexOf('/gpu-nvidia/0/power/0');
+	assert.strictEqual(monitor.get('/gpu-nvidia/0/power/0'), 100 * gpuIndex + frame);
+	const gpu = (await monitor.poll()).Children[0].Children.find((hw) => hw.HardwareId === '/gpu-nvidia/0');
+	assert.strictEqual(gpu.Children.find((group) => group.Text === 'Powers').Children[0].Min, `${100 * gpuIndex}.0 W`,
+		'Min from the first frame');
+	console.log('   ✓ Cleared');
+
+	// 6. Presets drop hardware from that poll's tree only: no new schema, no topology event
+	await new Promise((resolve) => setImmediate(resolve));
+	events.length = 0;
+	generation = monitor.getSchema().generation;
+	const filtered = await monitor.poll({ filterVirtualNics: true, filterDIMMs: true });
+	assert.deepStrictEqual(treeHardware(filtered),
+		ALL_HARDWARE.filter((id) => id !== '/nic/%7B2%7D' && id !== '/memory/dimm/0'));
+	const lazy = await monitor.poll({ lazy: true, filterDIMMs: true });
+	assert.deepStrictEqual(treeHardware(lazy.toJSON()), ALL_HARDWARE.filter((id) => id !== '/memory/dimm/0'));
+	assert.deepStrictEqual(treeHardware(await monitor.poll()), ALL_HARDWARE, 'next poll unfiltered');
+	await new Promise((resolve) => setImmediate(resolve));
+	assert.strictEqual(monitor.getSchema().generation, generation);
+	assert.deepStrictEqual(schemaIds(monitor), { hardware: ALL_HARDWARE, sensors: ALL_SENSORS });
+	assert.strictEqual(events.length, 0);
+	console.log('   ✓ Presets per poll');
+
+	// 7. Filters do not outlive shutdown()
+	monitor.setFilter({ excludeNames: ['DIMM'] });
+	await monitor.shutdown();
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+	assert.deepStrictEqual(schemaIds(monitor), { hardware: ALL_HARDWARE, sensors: ALL_SENSORS });
+	monitor.off('topology', onTopology);
+	await monitor.shutdown();
+	console.log('   ✓ Reset by shutdown()');
+
+	console.log('\nAll filter tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,103 @@
+/**
+ * CPU budget governor test on the replay bridge (no hardware needed)
+ * updateMs makes every hardware update spend CPU time, so the sampler goes over
+ * its budget and throttles, then relaxes once reconfigure() drops the GPU.
+ * Usage: node test/test-governor.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const BUDGET_PERCENT = 25;
+const INTERVAL_MS = 10;
+// CPU and GPU at 2 ms per 10 ms tick: about 40% of a core, so both are halved;
+// the CPU alone (20%) fits again
+const UPDATE_MS = 2;
+// Governor windows last at least 2 s
+const WINDOW_TIMEOUT_MS = 10000;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+async function waitFor(monitor, predicate, what) {
+	const deadline = Date.now() + WINDOW_TIMEOUT_MS;
+	for (;;) {
+		const sampler = monitor.getStats().sampler;
+		if (predicate(sampler)) {
+			return sampler;
+		}
+		assert.ok(Date.now() < deadline, 'timed out waiting for ' + what);
+		await sleep(50);
+	}
+}
+
+const decisionsOf = (sampler, action) => sampler.decisions.filter((decision) => decision.action === action);
+const rateOf = (sampler, category) => sampler.categories.find((rate) => rate.category === category);
+
+async function main() {
+	console.log('Testing the CPU budget governor (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('governor.lhmtrace'), buildFrames({ count: 50, value: (frame) => frame }));
+	await monitor.init({
+		replay: trace,
+		speed: 0,
+		loop: true,
+		updateMs: UPDATE_MS,
+		motherboard: false,
+		cpuBudgetPercent: BUDGET_PERCENT
+	});
+
+	// 1. Budget reported, nothing decided before the first window
+	monitor.startSampler({ intervalMs: INTERVAL_MS });
+	const idle = monitor.getStats().sampler;
+	assert.strictEqual(idle.cpuBudgetPercent, BUDGET_PERCENT);
+	assert.deepStrictEqual(idle.decisions, []);
+	assert.ok(idle.categories.every((rate) => rate.intervalMs === INTERVAL_MS && !rate.throttled));
+	console.log('   ✓ Budget set, no decisions yet');
+
+	// 2. Over budget: the costliest categories are halved until the model fits
+	const throttled = await waitFor(monitor, (sampler) => decisionsOf(sampler, 'throttle').length > 0, 'throttling');
+	assert.ok(throttled.cpuPercent > BUDGET_PERCENT, 'measured over budget: ' + throttled.cpuPercent);
+	for (const decision of decisionsOf(throttled, 'throttle')) {
+		assert.ok(['cpu', 'gpu'].includes(decision.category), decision.category);
+		assert.strictEqual(decision.toIntervalMs, decision.fromIntervalMs * 2);
+		assert.ok(decision.usagePercent > BUDGET_PERCENT);
+		assert.ok(typeof decision.timestamp === 'number');
+	}
+	const cpu = rateOf(throttled, 'cpu');
+	assert.ok(cpu.throttled && cpu.intervalMs > INTERVAL_MS, 'cpu slowed down');
+	assert.ok(cpu.costMs >= UPDATE_MS * 0.5, 'cpu cost measured: ' + cpu.costMs);
+	assert.strictEqual(throttled.budgetUnreachable, false);
+	console.log(`   ✓ Throttled at ${throttled.cpuPercent.toFixed(1)}% (cpu every ${cpu.intervalMs} ms)`);
+
+	// 3. Load drops: one category relaxed per window, halving its interval
+	await monitor.reconfigure({ gpu: false });
+	const throttleCount = throttled.decisions.length;
+	const relaxed = await waitFor(monitor, (sampler) => decisionsOf(sampler, 'relax').length > 0, 'relaxing');
+	const relax = decisionsOf(relaxed, 'relax')[0];
+	assert.strictEqual(relax.category, 'cpu');
+	assert.strictEqual(relax.toIntervalMs, relax.fromIntervalMs / 2);
+	assert.ok(relax.usagePercent < BUDGET_PERCENT * 0.7, 'relaxed with headroom: ' + relax.usagePercent);
+	assert.ok(relaxed.decisions.length > throttleCount);
+	assert.strictEqual(rateOf(relaxed, 'gpu'), undefined);
+	console.log(`   ✓ Relaxed cpu to ${relax.toIntervalMs} ms at ${relax.usagePercent.toFixed(1)}%`);
+
+	// 4. Back at the requested rate, and staying there within the budget
+	await sleep(2500);
+	const settled = monitor.getStats().sampler;
+	assert.strictEqual(rateOf(settled, 'cpu').intervalMs, INTERVAL_MS);
+	assert.strictEqual(rateOf(settled, 'cpu').throttled, false);
+	assert.strictEqual(decisionsOf(settled, 'throttle').length, decisionsOf(throttled, 'throttle').length, 'not throttled again');
+	monitor.stopSampler();
+	await monitor.shutdown();
+	console.log('   ✓ Settled within the budget');
+
+	console.log('\nAll governor tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
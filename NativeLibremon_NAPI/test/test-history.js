@@ -0,0 +1,107 @@
+/**
+ * Sample history test on the replay bridge (no hardware needed)
+ * Usage: node test/test-history.js
+ */
+
+const assert = require('assert');
+const { loadModule, pollFrames, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const CORE = '/intelcpu/0/temperature/0';
+const VCORE = '/lpc/nct6798d/0/voltage/0';
+
+// Core #1 reads the frame number; the voltage has no value in odd frames
+const value = (frame, sensor) => {
+	if (sensor.type === 'Voltage') return frame % 2 === 1 ? NaN : frame;
+	return sensor.id === CORE ? frame : 1;
+};
+
+const range = (from, to) => Array.from({ length: to - from + 1 }, (_, i) => from + i);
+
+async function main() {
+	console.log('Testing sample history (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('history.lhmtrace'), buildFrames({ count: 40, value }));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Off until configured
+	await assert.rejects(monitor.history([CORE], -Infinity, Infinity), /setHistory/);
+	assert.throws(() => monitor.setHistory({ capacity: 0 }), TypeError);
+	assert.throws(() => monitor.setHistory({ minIntervalMs: -1 }), TypeError);
+	assert.throws(() => monitor.history(CORE, -Infinity, Infinity), TypeError);
+	assert.throws(() => monitor.history([CORE], 'now', Infinity), TypeError);
+	assert.throws(() => monitor.history([CORE], -Infinity, Infinity, { method: 'mean' }), TypeError);
+	assert.throws(() => monitor.history([CORE], -Infinity, Infinity, { points: 2 }), TypeError);
+	console.log('   ✓ Configuration validated');
+
+	// 2. The ring keeps the newest capacity samples
+	monitor.setHistory({ capacity: 20 });
+	await pollFrames(monitor, 30);  // Frames 0-29
+	const all = await monitor.history([CORE, '/nope', VCORE], -Infinity, Infinity);
+	assert.strictEqual(all.rows, 20);
+	const [core, unknown, vcore] = all.series;
+	assert.strictEqual(core.id, CORE);
+	assert.strictEqual(core.known, true);
+	assert.ok(core.timestamps instanceof Float64Array);
+	assert.ok(core.values instanceof Float32Array);
+	assert.deepStrictEqual(Array.from(core.values), range(10, 29));
+	for (let i = 1; i < core.timestamps.length; i++) {
+		assert.ok(core.timestamps[i] >= core.timestamps[i - 1], 'timestamps ascend');
+	}
+	assert.strictEqual(unknown.known, false);
+	assert.strictEqual(unknown.values.length, 0);
+	assert.ok(Number.isNaN(vcore.values[1]), 'stored windows keep NaN');
+	assert.strictEqual(vcore.values[0], 10);
+	console.log('   ✓ Capacity, known ids and stored values');
+
+	// 3. Windows are inclusive on both ends; Dates work too
+	const t = core.timestamps;
+	const window = await monitor.history([CORE], t[5], t[9]);
+	assert.strictEqual(window.rows, 5);
+	assert.deepStrictEqual(Array.from(window.series[0].values), range(15, 19));
+	const dated = await monitor.history([CORE], new Date(Math.floor(t[0])), new Date(Math.ceil(t[19])));
+	assert.strictEqual(dated.rows, 20);
+	const empty = await monitor.history([CORE], t[19] + 1000, Infinity);
+	assert.strictEqual(empty.rows, 0);
+	assert.strictEqual(empty.series[0].values.length, 0);
+	console.log('   ✓ Time windows');
+
+	// 4. Downsampling caps the points and drops NaN
+	const lttb = await monitor.history([CORE, VCORE], -Infinity, Infinity, { points: 5 });
+	assert.strictEqual(lttb.rows, 20);
+	assert.strictEqual(lttb.series[0].values.length, 5);
+	assert.strictEqual(lttb.series[0].values[0], 10, 'lttb keeps the first point');
+	assert.strictEqual(lttb.series[0].values[4], 29, 'lttb keeps the last point');
+	assert.ok(lttb.series[1].values.length <= 5);
+	assert.ok(!lttb.series[1].values.some(Number.isNaN), 'downsampled series have no NaN');
+	const minmax = await monitor.history([CORE], -Infinity, Infinity, { points: 4, method: 'minmax' });
+	const picked = Array.from(minmax.series[0].values);
+	assert.ok(picked.length <= 4);
+	assert.ok(picked.includes(10) && picked.includes(29), 'minmax keeps the extremes: ' + picked);
+	console.log('   ✓ lttb and minmax downsampling');
+
+	// 5. Shrinking keeps the newest samples; minIntervalMs skips close samples
+	monitor.setHistory({ capacity: 5 });
+	let shrunk = await monitor.history([CORE], -Infinity, Infinity);
+	assert.deepStrictEqual(Array.from(shrunk.series[0].values), range(25, 29));
+	monitor.setHistory({ capacity: 5, minIntervalMs: 60000 });
+	await pollFrames(monitor, 2);
+	shrunk = await monitor.history([CORE], -Infinity, Infinity);
+	assert.deepStrictEqual(Array.from(shrunk.series[0].values), range(25, 29), 'samples within minIntervalMs skipped');
+	console.log('   ✓ Resize and minIntervalMs');
+
+	// 6. Disabling drops the samples
+	monitor.setHistory(null);
+	await assert.rejects(monitor.history([CORE], -Infinity, Infinity), /setHistory/);
+	console.log('   ✓ Disabled');
+
+	await monitor.shutdown();
+	console.log('\nAll history tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,91 @@
+/**
+ * Poll buffer reuse test on the replay bridge (no hardware needed)
+ * The replay bridge writes poll JSON straight into the addon's buffer (pollInto),
+ * so each poll costs one copy and allocations only happen when the tree outgrows it.
+ * Usage: node test/test-poll-buffer.js
+ */
+
+const assert = require('assert');
+const { loadModule, pollFrames, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+const SMALL_FRAMES = 10;
+
+// The SuperIO chip grows 300 temperatures from frame SMALL_FRAMES on
+const BIG_LAYOUT = {
+	hardware: TEST_LAYOUT.hardware,
+	sensors: TEST_LAYOUT.sensors.concat(Array.from({ length: 300 }, (_, i) => ({
+		id: `/lpc/nct6798d/0/temperature/${i}`,
+		name: `Temperature #${i + 1}`,
+		type: 'Temperature',
+		hardware: 3
+	})))
+};
+
+const pollBuffer = (monitor) => monitor.getStats().pollBuffer;
+
+async function main() {
+	console.log('Testing poll buffer reuse (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('poll-buffer.lhmtrace'), buildFrames({
+		count: 40,
+		layouts: [TEST_LAYOUT, BIG_LAYOUT],
+		layoutAt: (frame) => (frame < SMALL_FRAMES ? 0 : 1),
+		value: (frame, sensor, index) => 20 + frame + index
+	}));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. Nothing counted before the first poll
+	assert.deepStrictEqual(pollBuffer(monitor), { polls: 0, copies: 0, copiedBytes: 0, allocations: 0 });
+	console.log('   ✓ Counters start at zero');
+
+	// 2. One copy per poll; allocations stop once the buffer fits the tree
+	await pollFrames(monitor, 2);
+	const warm = pollBuffer(monitor);
+	assert.strictEqual(warm.polls, 2);
+	assert.strictEqual(warm.copies, 2);
+	assert.ok(warm.allocations >= 1, 'first poll sizes the buffer');
+	await pollFrames(monitor, 4);
+	await pollFrames(monitor, 4, { lazy: true });
+	const steady = pollBuffer(monitor);
+	assert.strictEqual(steady.polls, 10);
+	assert.strictEqual(steady.copies, steady.polls, 'one copy per poll (plain and lazy)');
+	assert.strictEqual(steady.allocations, warm.allocations, 'no allocations in steady state');
+	const smallBytes = (steady.copiedBytes - warm.copiedBytes) / 8;
+	assert.ok(smallBytes > 0);
+	console.log(`   ✓ Steady state: ${steady.allocations} allocations over ${steady.polls} polls`);
+
+	// 3. A bigger tree grows the buffer once, then reuses it
+	await monitor.poll();   // First frame of the big layout
+	const grown = pollBuffer(monitor);
+	assert.ok(grown.allocations > steady.allocations, 'buffer grew for the bigger tree');
+	assert.ok(grown.copiedBytes - steady.copiedBytes > smallBytes * 10, 'copies follow the tree size');
+	await pollFrames(monitor, 10);
+	const regrown = pollBuffer(monitor);
+	assert.strictEqual(regrown.copies, regrown.polls);
+	assert.strictEqual(regrown.allocations, grown.allocations, 'no allocations after growing');
+	console.log(`   ✓ Grew once for the bigger tree (${grown.allocations} allocations)`);
+
+	// 4. Sampler updates do not go through the poll buffer
+	monitor.startSampler({ intervalMs: 10 });
+	await new Promise((resolve) => setTimeout(resolve, 100));
+	monitor.stopSampler();
+	assert.deepStrictEqual(pollBuffer(monitor), regrown);
+	console.log('   ✓ Sampler leaves the poll buffer alone');
+
+	// 5. Counters start over with the next init
+	await monitor.shutdown();
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+	assert.strictEqual(pollBuffer(monitor).polls, 0);
+	await monitor.shutdown();
+	console.log('   ✓ Reset by init()');
+
+	console.log('\nAll poll buffer tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,127 @@
+/**
+ * poll({ signal, deadlineMs }) test on the replay bridge (no hardware needed)
+ * Each of the four hardware takes UPDATE_MS to update and each tree WRITE_MS to
+ * write, so deadlines truncate polls the way slow hardware would.
+ * Usage: node test/test-poll-deadlines.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const UPDATE_MS = 40;
+const WRITE_MS = 60;
+const FULL_POLL_MS = 4 * UPDATE_MS + WRITE_MS;
+const FAN = '/lpc/nct6798d/0/fan/0';
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+function hardwareNodes(tree) {
+	const nodes = new Map();
+	const walk = (node) => {
+		if (node.HardwareId) nodes.set(node.HardwareId, node);
+		for (const child of node.Children || []) walk(child);
+	};
+	walk(tree);
+	return nodes;
+}
+
+const cancellation = (monitor) => monitor.getStats().cancellation;
+
+async function main() {
+	console.log('Testing poll deadlines (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('deadlines.lhmtrace'), buildFrames({
+		count: 50,
+		value: (frame, sensor, index) => 100 * index + frame
+	}));
+	await assert.rejects(monitor.init({ replay: trace, updateMs: -1 }), TypeError);
+	await monitor.init({ replay: trace, speed: 0, loop: false, updateMs: UPDATE_MS, writeMs: WRITE_MS });
+
+	// 1. No deadline: every hardware updated, nothing counted
+	const full = hardwareNodes(await monitor.poll());
+	assert.deepStrictEqual(cancellation(monitor),
+		{ aborted: 0, timedOut: 0, dropped: 0, abandoned: 0, truncated: 0, overrunMs: 0 });
+	console.log('   ✓ Plain polls update everything');
+
+	// 2. The bridge gets three quarters of the time left: 150 of 200 ms fit three
+	//    40 ms updates, and the SuperIO keeps its stamps and previous frame values
+	const deadlineMs = 200;
+	const started = Date.now();
+	const truncated = hardwareNodes(await monitor.poll({ deadlineMs }));
+	assert.ok(Date.now() - started < deadlineMs, 'resolved before the deadline');
+	for (const id of ['/intelcpu/0', '/gpu-nvidia/0', '/motherboard']) {
+		assert.ok(truncated.get(id).UpdateStart > full.get(id).UpdateEnd, id + ' updated');
+	}
+	const superIo = truncated.get('/lpc/nct6798d/0');
+	assert.strictEqual(superIo.UpdateStart, full.get('/lpc/nct6798d/0').UpdateStart, 'SuperIO skipped');
+	assert.strictEqual(superIo.UpdateEnd, full.get('/lpc/nct6798d/0').UpdateEnd);
+	assert.strictEqual(monitor.get(FAN), 100 * 6 + 0, 'fan still at frame 0');
+	assert.strictEqual(monitor.get('/intelcpu/0/load/0'), 100 * 2 + 1, 'CPU at frame 1');
+	let stats = cancellation(monitor);
+	assert.strictEqual(stats.truncated, 1);
+	assert.strictEqual(stats.timedOut, 0);
+	console.log('   ✓ Budget keeps a quarter back; skipped hardware keeps its values');
+
+	// 3. Writing the tree ran past the budget; the overrun is smoothed over polls
+	const budgetMs = deadlineMs * 3 / 4;
+	const overrunMs = 3 * UPDATE_MS + WRITE_MS - budgetMs;
+	assert.ok(stats.overrunMs > 0 && stats.overrunMs <= overrunMs / 8 + 2, 'first overrun: ' + stats.overrunMs);
+	await monitor.poll({ deadlineMs });
+	const smoothed = cancellation(monitor).overrunMs;
+	assert.ok(smoothed > stats.overrunMs && smoothed < overrunMs, 'smoothed: ' + smoothed);
+	await monitor.poll();
+	assert.strictEqual(cancellation(monitor).overrunMs, smoothed, 'plain polls leave it alone');
+	console.log(`   ✓ Overrun smoothed (${smoothed.toFixed(1)} ms of ${overrunMs} ms)`);
+
+	// 4. Deadline and abort while queued behind another poll: dropped before the bridge
+	stats = cancellation(monitor);
+	const running = monitor.poll();
+	await assert.rejects(monitor.poll({ deadlineMs: 30 }), { name: 'TimeoutError' });
+	const controller = new AbortController();
+	const queued = monitor.poll({ signal: controller.signal });
+	setTimeout(() => controller.abort(), 10);
+	await assert.rejects(queued, { name: 'AbortError' });
+	await running;
+	await sleep(50);
+	assert.deepStrictEqual(cancellation(monitor), Object.assign({}, stats, {
+		aborted: stats.aborted + 1,
+		timedOut: stats.timedOut + 1,
+		dropped: stats.dropped + 2
+	}));
+	const polls = monitor.getStats().polls;
+	console.log('   ✓ Queued polls dropped');
+
+	// 5. Aborted in the bridge: the poll runs to completion, its result is discarded
+	const inBridge = new AbortController();
+	const abandoned = monitor.poll({ signal: inBridge.signal });
+	setTimeout(() => inBridge.abort(), UPDATE_MS);
+	await assert.rejects(abandoned, { name: 'AbortError' });
+	await sleep(FULL_POLL_MS + 50);
+	stats = cancellation(monitor);
+	assert.strictEqual(stats.aborted, 2);
+	assert.strictEqual(stats.abandoned, 1);
+	assert.strictEqual(stats.dropped, 2);
+	assert.strictEqual(monitor.getStats().polls, polls + 1, 'it reached the bridge');
+	console.log('   ✓ Running poll abandoned');
+
+	// 6. A deadline too short for any update: everything skipped, still late for the tree
+	await assert.rejects(monitor.poll({ deadlineMs: 20 }), { name: 'TimeoutError' });
+	await sleep(FULL_POLL_MS);
+	const late = cancellation(monitor);
+	assert.strictEqual(late.timedOut, 2);
+	assert.strictEqual(late.abandoned, 2);
+	assert.strictEqual(late.truncated, stats.truncated + 1);
+	assert.ok(late.overrunMs > stats.overrunMs, 'late tree raises the margin');
+	console.log('   ✓ Timed out in the bridge');
+
+	await monitor.shutdown();
+	console.log('\nAll poll deadline tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,113 @@
+/**
+ * reconfigure() test on the replay bridge (no hardware needed)
+ * Hardware flags show or hide the recorded hardware of their type, so toggling
+ * one changes the schema and the categories the native sampler schedules.
+ * Usage: node test/test-reconfigure.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+const GPU = '/gpu-nvidia/0';
+const GPU_POWER = '/gpu-nvidia/0/power/0';
+const CPU_POWER = '/intelcpu/0/power/0';
+
+const ALL_CATEGORIES = ['cpu', 'gpu', 'motherboard', 'memory', 'storage', 'network', 'psu', 'controller', 'battery', 'other'];
+
+const hardwareIds = (monitor) => monitor.getSchema().hardware.map((hw) => hw.id);
+const sensorIds = (monitor) => monitor.getSchema().sensors.map((sensor) => sensor.id);
+const samplerCategories = (monitor) => monitor.getStats().sampler.categories.map((rate) => rate.category);
+
+function treeIds(tree) {
+	const ids = [];
+	const walk = (node) => {
+		if (node.HardwareId) ids.push(node.HardwareId);
+		for (const child of node.Children || []) walk(child);
+	};
+	walk(tree);
+	return ids;
+}
+
+async function main() {
+	console.log('Testing reconfigure (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('reconfigure.lhmtrace'), buildFrames({
+		count: 20,
+		value: (frame, sensor, index) => 10 * (index + 1) + frame
+	}));
+
+	// 1. Every recorded hardware type is on by default on replay; init() flags hide types
+	await monitor.init({ replay: trace, speed: 0, loop: true });
+	const config = monitor.getConfig();
+	for (const key of ALL_CATEGORIES.filter((name) => name !== 'other')) {
+		assert.strictEqual(config[key], true, key);
+	}
+	assert.deepStrictEqual(hardwareIds(monitor), TEST_LAYOUT.hardware.map((hw) => hw.id));
+	await monitor.shutdown();
+
+	await monitor.init({ replay: trace, speed: 0, loop: true, gpu: false });
+	assert.strictEqual(monitor.getConfig().gpu, false);
+	assert.ok(!hardwareIds(monitor).includes(GPU), 'GPU hidden by init()');
+	await monitor.shutdown();
+	console.log('   ✓ init() flags select the recorded hardware');
+
+	// 2. Turning the GPU off removes its hardware and sensors in a new generation
+	await monitor.init({ replay: trace, speed: 0, loop: true });
+	await monitor.poll();
+	const generation = monitor.getSchema().generation;
+	assert.strictEqual(monitor.get(GPU_POWER), 60);
+	monitor.startSampler({ intervalMs: 20 });
+	assert.deepStrictEqual(samplerCategories(monitor), ALL_CATEGORIES);
+
+	const updated = await monitor.reconfigure({ gpu: false });
+	assert.strictEqual(updated.gpu, false);
+	assert.deepStrictEqual(updated, monitor.getConfig(), 'resolves with the configuration in effect');
+	assert.strictEqual(updated.cpu, true, 'other flags kept');
+	await monitor.poll();
+	assert.ok(monitor.getSchema().generation > generation, 'new schema generation');
+	assert.deepStrictEqual(hardwareIds(monitor), ['/intelcpu/0', '/motherboard', '/lpc/nct6798d/0']);
+	assert.ok(!sensorIds(monitor).some((id) => id.startsWith(GPU + '/')), 'GPU sensors removed');
+	assert.ok(!treeIds(await monitor.poll()).includes(GPU), 'GPU left out of poll()');
+	assert.strictEqual(monitor.get(GPU_POWER), null);
+	assert.notStrictEqual(monitor.get(CPU_POWER), null);
+	console.log('   ✓ GPU removed from the schema and poll()');
+
+	// 3. The sampler no longer schedules the disabled category
+	assert.deepStrictEqual(samplerCategories(monitor), ALL_CATEGORIES.filter((name) => name !== 'gpu'));
+	const samples = monitor.getStats().samples;
+	await new Promise((resolve) => setTimeout(resolve, 100));
+	assert.ok(monitor.getStats().samples > samples, 'enabled categories still sampled');
+	console.log('   ✓ Sampler mask follows the configuration');
+
+	// 4. Turning it back on restores the GPU, its values and the sampler category
+	const before = monitor.getSchema().generation;
+	await monitor.reconfigure({ gpu: true });
+	await monitor.poll();
+	assert.ok(monitor.getSchema().generation > before);
+	assert.deepStrictEqual(hardwareIds(monitor), TEST_LAYOUT.hardware.map((hw) => hw.id));
+	assert.deepStrictEqual(sensorIds(monitor), TEST_LAYOUT.sensors.map((sensor) => sensor.id));
+	assert.strictEqual(typeof monitor.get(GPU_POWER), 'number');
+	assert.deepStrictEqual(samplerCategories(monitor), ALL_CATEGORIES);
+	console.log('   ✓ GPU restored');
+
+	// 5. Flags that change no recorded hardware keep the schema; bad flags are rejected
+	const unchanged = monitor.getSchema().generation;
+	assert.strictEqual((await monitor.reconfigure({ dimmDetection: true, storage: false })).dimmDetection, true);
+	await monitor.poll();
+	assert.strictEqual(monitor.getSchema().generation, unchanged, 'no new generation');
+	await assert.rejects(monitor.reconfigure({ gpu: 1 }), TypeError);
+	await assert.rejects(monitor.reconfigure({ fans: true }), TypeError);
+	monitor.stopSampler();
+	await monitor.shutdown();
+	console.log('   ✓ Schema kept when no recorded hardware changes');
+
+	console.log('\nAll reconfigure tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,89 @@
+/**
+ * get/getMany/query lookup test on the replay bridge (no hardware needed)
+ * Usage: node test/test-sensor-lookups.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+// Sensor i reads 10 * (i + 1) + frame; the voltage has no value in odd frames
+const value = (frame, sensor, index) => {
+	if (sensor.type === 'Voltage' && frame % 2 === 1) return NaN;
+	return 10 * (index + 1) + frame;
+};
+
+async function main() {
+	console.log('Testing sensor lookups (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('lookups.lhmtrace'), buildFrames({ count: 10, value }));
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+
+	// 1. get(): first lookup reads the bridge's current values (frame 0)
+	assert.strictEqual(monitor.get('/intelcpu/0/temperature/0'), 10);
+	assert.strictEqual(monitor.get('/lpc/nct6798d/0/fan/0'), 70);
+	assert.strictEqual(monitor.get('/nope/0/temperature/0'), null, 'unknown id');
+	assert.throws(() => monitor.get(42), TypeError);
+	console.log('   ✓ get()');
+
+	// 2. Lookups follow polls
+	await monitor.poll();   // Frame 0
+	await monitor.poll();   // Frame 1
+	assert.strictEqual(monitor.get('/intelcpu/0/temperature/0'), 11);
+	assert.strictEqual(monitor.get('/lpc/nct6798d/0/voltage/0'), null, 'no value reads null');
+	console.log('   ✓ Values follow polls');
+
+	// 3. getMany(): one slot per id, NaN for unknown or missing
+	const ids = ['/gpu-nvidia/0/power/0', '/nope', '/intelcpu/0/load/0', '/lpc/nct6798d/0/voltage/0'];
+	const many = monitor.getMany(ids);
+	assert.ok(many instanceof Float32Array);
+	assert.strictEqual(many.length, ids.length);
+	assert.strictEqual(many[0], 61);
+	assert.ok(Number.isNaN(many[1]));
+	assert.strictEqual(many[2], 31);
+	assert.ok(Number.isNaN(many[3]));
+	assert.strictEqual(monitor.getMany([]).length, 0);
+	assert.throws(() => monitor.getMany('/intelcpu/0/load/0'), TypeError);
+	console.log('   ✓ getMany()');
+
+	// 4. query(): criteria combine, results in schema order with values
+	const temps = monitor.query({ sensorType: 'Temperature' });
+	assert.deepStrictEqual(temps.map((s) => s.id),
+		['/intelcpu/0/temperature/0', '/intelcpu/0/temperature/1', '/gpu-nvidia/0/temperature/0']);
+	const cpuTemps = monitor.query({ hardwareType: 'Cpu', sensorType: 'Temperature' });
+	assert.deepStrictEqual(cpuTemps.map((s) => s.id), ['/intelcpu/0/temperature/0', '/intelcpu/0/temperature/1']);
+	const first = cpuTemps[0];
+	assert.strictEqual(first.name, 'Core #1');
+	assert.strictEqual(first.type, 'Temperature');
+	assert.strictEqual(first.hardwareId, '/intelcpu/0');
+	assert.strictEqual(first.hardwareType, 'Cpu');
+	assert.strictEqual(first.index, 0);
+	assert.strictEqual(first.value, 11);
+	const cores = monitor.query({ namePattern: 'core #?' });
+	assert.deepStrictEqual(cores.map((s) => s.name), ['Core #1', 'Core #2'], 'glob is case-insensitive');
+	assert.deepStrictEqual(monitor.query({ hardwareId: '/lpc/nct6798d/0' }).map((s) => s.type), ['Fan', 'Voltage']);
+	assert.strictEqual(monitor.query({ hardwareId: '/lpc/nct6798d/0', sensorType: 'Voltage' })[0].value, null);
+	assert.strictEqual(monitor.query({ namePattern: '*' }).length, TEST_LAYOUT.sensors.length);
+	assert.deepStrictEqual(monitor.query({ sensorType: 'Clock' }), []);
+	assert.deepStrictEqual(monitor.query({ hardwareType: 'Cpu', sensorType: 'Fan' }), []);
+	assert.throws(() => monitor.query(null), TypeError);
+	console.log('   ✓ query()');
+
+	// 5. Derived sensors are indexed too
+	monitor.defineSensor('cpuSum', 'sum(\'/intelcpu/0/temperature/*\')', { type: 'Temperature' });
+	await monitor.poll();   // Frame 2
+	assert.strictEqual(monitor.get('/derived/cpuSum'), 12 + 22);
+	assert.ok(monitor.query({ sensorType: 'Temperature' }).some((s) => s.id === '/derived/cpuSum'));
+	monitor.removeSensor('cpuSum');
+	console.log('   ✓ Derived sensors indexed');
+
+	await monitor.shutdown();
+	console.log('\nAll sensor lookup tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,90 @@
+/**
+ * State file restore test on the replay bridge (no hardware needed)
+ * Usage: node test/test-state-file.js
+ */
+
+const assert = require('assert');
+const fs = require('fs');
+const { loadModule, pollFrames, scratchFile } = require('./replay-backend');
+const { buildFrames, writeTrace } = require('./trace-fixture');
+
+const CORE = '/intelcpu/0/temperature/0';
+const FAN = '/lpc/nct6798d/0/fan/0';
+
+// First run: Core #1 climbs 50-59; second run: it sits at 40
+const firstRun = (frame, sensor) => (sensor.id === CORE ? 50 + frame : 1000);
+const secondRun = (frame, sensor) => (sensor.id === CORE ? 40 : 1000);
+
+async function main() {
+	console.log('Testing state file restore (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const stateFile = scratchFile('state.bin');
+	const first = writeTrace(scratchFile('state-first.lhmtrace'), buildFrames({ count: 20, value: firstRun }));
+	const second = writeTrace(scratchFile('state-second.lhmtrace'), buildFrames({ count: 20, value: secondRun }));
+
+	// 1. Options validated
+	await assert.rejects(monitor.init({ replay: first, stateFile: '' }), TypeError);
+	await assert.rejects(monitor.init({ replay: first, stateFile, stateFlushMs: 50 }), TypeError);
+	console.log('   ✓ Options validated');
+
+	// 2. A new file starts empty and is flushed while running
+	await monitor.init({ replay: first, speed: 0, loop: false, stateFile, stateFlushMs: 100 });
+	let state = monitor.getStats().state;
+	assert.strictEqual(state.path, stateFile);
+	assert.strictEqual(state.restored, false);
+	assert.strictEqual(state.restoredRows, 0);
+	monitor.setHistory({ capacity: 50 });
+	await pollFrames(monitor, 10);  // Frames 0-9
+	await new Promise((resolve) => setTimeout(resolve, 350));
+	state = monitor.getStats().state;
+	assert.ok(state.flushes > 0, 'flushed periodically');
+	assert.ok(state.bytes > 0);
+	assert.strictEqual(state.error, null);
+	let extremes = monitor.getExtremes([CORE, '/nope']);
+	assert.strictEqual(extremes.min[0], 50);
+	assert.strictEqual(extremes.max[0], 59);
+	assert.ok(Number.isNaN(extremes.min[1]) && Number.isNaN(extremes.max[1]), 'unknown ids read NaN');
+	await monitor.shutdown();
+	assert.ok(fs.statSync(stateFile).size > 0, 'written on shutdown');
+	console.log(`   ✓ Flushed (${state.flushes} flushes, ${state.bytes} bytes)`);
+
+	// 3. The next run restores the history and the extremes
+	await monitor.init({ replay: second, speed: 0, loop: false, stateFile, stateFlushMs: 100 });
+	state = monitor.getStats().state;
+	assert.strictEqual(state.restored, true);
+	assert.strictEqual(state.restoredSensors, 8);
+	assert.strictEqual(state.restoredRows, 10);
+	assert.ok(state.restoredSavedAt <= Date.now() && state.restoredSavedAt > Date.now() - 60000);
+	const restored = await monitor.history([CORE], -Infinity, Infinity);
+	assert.strictEqual(restored.rows, 10, 'history enabled by the restore');
+	assert.deepStrictEqual(Array.from(restored.series[0].values), [50, 51, 52, 53, 54, 55, 56, 57, 58, 59]);
+	extremes = monitor.getExtremes([CORE, FAN]);
+	assert.strictEqual(extremes.max[0], 59);
+	assert.strictEqual(extremes.max[1], 1000);
+	console.log('   ✓ History and extremes restored');
+
+	// 4. Restored state keeps growing
+	await pollFrames(monitor, 3);
+	extremes = monitor.getExtremes([CORE]);
+	assert.strictEqual(extremes.min[0], 40, 'new minimum');
+	assert.strictEqual(extremes.max[0], 59, 'maximum from the first run');
+	const grown = await monitor.history([CORE], -Infinity, Infinity);
+	assert.strictEqual(grown.rows, 13);
+	assert.strictEqual(grown.series[0].values[12], 40);
+	await monitor.shutdown();
+	console.log('   ✓ Restored state extended');
+
+	// 5. A file that is not a state file fails init
+	fs.writeFileSync(stateFile, 'not a state file');
+	await assert.rejects(monitor.init({ replay: second, speed: 0, stateFile }), /Not a state file/);
+	console.log('   ✓ Corrupt file rejected');
+
+	console.log('\nAll state file tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,145 @@
+/**
+ * Topology event test on the replay bridge (no hardware needed)
+ * The trace swaps the GPU for an NVMe drive in frames 4-7 and back from frame 8.
+ * Usage: node test/test-topology-events.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+const SWAP_FROM = 4;
+const SWAP_TO = 8;
+
+// TEST_LAYOUT without the GPU, with an NVMe drive at the end
+function swappedLayout() {
+	const kept = TEST_LAYOUT.hardware.filter((hw) => hw.id !== '/gpu-nvidia/0');
+	const indexOf = (id) => (id === '/nvme/0' ? kept.length : kept.findIndex((hw) => hw.id === id));
+	const hardware = kept
+		.map((hw) => Object.assign({}, hw, { parent: hw.parent >= 0 ? indexOf(TEST_LAYOUT.hardware[hw.parent].id) : -1 }))
+		.concat([{ id: '/nvme/0', name: 'Test SSD', type: 'Storage', parent: -1 }]);
+	const sensors = TEST_LAYOUT.sensors
+		.filter((sensor) => !sensor.id.startsWith('/gpu-nvidia/'))
+		.map((sensor) => Object.assign({}, sensor, { hardware: indexOf(TEST_LAYOUT.hardware[sensor.hardware].id) }))
+		.concat([{ id: '/nvme/0/temperature/0', name: 'Composite', type: 'Temperature', hardware: indexOf('/nvme/0') }]);
+	return { hardware, sensors };
+}
+
+const ids = (entries) => entries.map((entry) => entry.id);
+
+// Sensor positions patched from diffs, as the README suggests
+function applyDiff(positions, diff) {
+	for (const { id } of diff.sensors.removed) positions.delete(id);
+	for (const { id, to } of diff.sensors.moved) positions.set(id, to);
+	for (const { id, index } of diff.sensors.added) positions.set(id, index);
+}
+
+function schemaPositions(monitor) {
+	return new Map(monitor.getSchema().sensors.map((sensor, index) => [sensor.id, index]));
+}
+
+async function main() {
+	console.log('Testing topology events (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('topology.lhmtrace'), buildFrames({
+		count: 12,
+		layouts: [TEST_LAYOUT, swappedLayout()],
+		layoutAt: (frame) => (frame >= SWAP_FROM && frame < SWAP_TO ? 1 : 0),
+		value: (frame, sensor, index) => frame + index
+	}));
+
+	const events = [];
+	const onTopology = (diff) => events.push(diff);
+	assert.throws(() => monitor.on('schema', onTopology), TypeError);
+	monitor.on('topology', onTopology);
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+	const positions = schemaPositions(monitor);
+
+	// Diffs are queued by the poll; let them reach the listener
+	const pollFrame = async () => {
+		await monitor.poll();
+		await new Promise((resolve) => setImmediate(resolve));
+	};
+
+	// 1. No event for the first schema or while it holds
+	for (let frame = 0; frame < SWAP_FROM; frame++) {
+		await pollFrame();
+	}
+	assert.strictEqual(events.length, 0);
+	assert.strictEqual(monitor.getSchema().generation, 1);
+	console.log('   ✓ Quiet while the topology holds');
+
+	// 2. Removal and addition in one diff, indices by generation
+	await pollFrame();
+	assert.strictEqual(events.length, 1);
+	const swap = events[0];
+	assert.strictEqual(swap.generation, 2);
+	assert.strictEqual(swap.previousGeneration, 1);
+	assert.ok(Math.abs(swap.timestamp - Date.now()) < 60000, 'wall-clock timestamp');
+	assert.deepStrictEqual(swap.hardware.removed, [{ index: 1, id: '/gpu-nvidia/0' }]);
+	assert.deepStrictEqual(swap.hardware.added, [{ index: 3, parent: -1, type: 'Storage', id: '/nvme/0', name: 'Test SSD' }]);
+	assert.deepStrictEqual(swap.hardware.moved, [
+		{ id: '/motherboard', from: 2, to: 1 },
+		{ id: '/lpc/nct6798d/0', from: 3, to: 2 }
+	]);
+	assert.deepStrictEqual(ids(swap.sensors.removed), ['/gpu-nvidia/0/temperature/0', '/gpu-nvidia/0/power/0']);
+	assert.deepStrictEqual(swap.sensors.added, [
+		{ index: 6, hardware: 3, type: 'Temperature', id: '/nvme/0/temperature/0', name: 'Composite' }
+	]);
+	assert.deepStrictEqual(ids(swap.sensors.moved), ['/lpc/nct6798d/0/fan/0', '/lpc/nct6798d/0/voltage/0']);
+	applyDiff(positions, swap);
+	assert.deepStrictEqual(positions, schemaPositions(monitor), 'patched positions match getSchema()');
+	assert.strictEqual(monitor.get('/nvme/0/temperature/0'), SWAP_FROM + 6);
+	assert.strictEqual(monitor.get('/gpu-nvidia/0/power/0'), null);
+	console.log('   ✓ GPU removed, NVMe added, moves listed');
+
+	// 3. Swapping back reverses the diff
+	for (let frame = SWAP_FROM + 1; frame <= SWAP_TO; frame++) {
+		await pollFrame();
+	}
+	assert.strictEqual(events.length, 2);
+	const back = events[1];
+	assert.strictEqual(back.generation, 3);
+	assert.strictEqual(back.previousGeneration, 2);
+	assert.deepStrictEqual(ids(back.hardware.added), ['/gpu-nvidia/0']);
+	assert.deepStrictEqual(ids(back.hardware.removed), ['/nvme/0']);
+	assert.deepStrictEqual(ids(back.sensors.added), ['/gpu-nvidia/0/temperature/0', '/gpu-nvidia/0/power/0']);
+	assert.deepStrictEqual(ids(back.sensors.removed), ['/nvme/0/temperature/0']);
+	applyDiff(positions, back);
+	assert.deepStrictEqual(positions, schemaPositions(monitor));
+	console.log('   ✓ Swapped back');
+
+	// 4. Derived sensors change the topology too
+	monitor.defineSensor('cpuPower', '/intelcpu/0/power/0 * 2', { type: 'Power' });
+	await pollFrame();
+	assert.strictEqual(events.length, 3);
+	assert.deepStrictEqual(ids(events[2].sensors.added), ['/derived/cpuPower']);
+	monitor.removeSensor('cpuPower');
+	await pollFrame();
+	assert.strictEqual(events.length, 4);
+	assert.deepStrictEqual(ids(events[3].sensors.removed), ['/derived/cpuPower']);
+	console.log('   ✓ Derived sensor added and removed');
+
+	// 5. Listeners survive shutdown()/init() without an event for the new first schema; off() detaches
+	await monitor.shutdown();
+	await monitor.init({ replay: trace, speed: 0, loop: false });
+	await pollFrame();
+	assert.strictEqual(events.length, 4);
+	monitor.off('topology', onTopology);
+	for (let frame = 1; frame <= SWAP_FROM; frame++) {
+		await pollFrame();
+	}
+	assert.strictEqual(monitor.getSchema().generation, 2, 'topology changed');
+	assert.strictEqual(events.length, 4, 'no event after off()');
+	await monitor.shutdown();
+	console.log('   ✓ Across init() and off()');
+
+	console.log('\nAll topology event tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
@@ -0,0 +1,97 @@
+/**
+ * Hardware update stamps and sampler jitter test on the replay bridge (no hardware needed)
+ * Usage: node test/test-update-stamps.js
+ */
+
+const assert = require('assert');
+const { loadModule, scratchFile } = require('./replay-backend');
+const { TEST_LAYOUT, buildFrames, writeTrace } = require('./trace-fixture');
+
+// Stamps are rounded to the microsecond
+const STAMP_EPSILON_MS = 0.001;
+
+const nowMs = () => Number(process.hrtime.bigint()) / 1e6;
+
+function hardwareStamps(tree) {
+	const stamps = new Map();
+	const walk = (node) => {
+		if (node.HardwareId) {
+			stamps.set(node.HardwareId, { start: node.UpdateStart, end: node.UpdateEnd });
+		}
+		for (const child of node.Children || []) {
+			walk(child);
+		}
+	};
+	walk(tree);
+	return stamps;
+}
+
+async function main() {
+	console.log('Testing update stamps and sampler jitter (replay)');
+	console.log('='.repeat(60));
+
+	const monitor = loadModule();
+	const trace = writeTrace(scratchFile('stamps.lhmtrace'), buildFrames({ count: 10, value: (frame) => frame }));
+	await monitor.init({ replay: trace, speed: 0, loop: true });
+
+	// 1. Every hardware node is stamped during the poll, on the process.hrtime clock
+	const before = nowMs();
+	const first = hardwareStamps(await monitor.poll());
+	const after = nowMs();
+	assert.deepStrictEqual([...first.keys()], TEST_LAYOUT.hardware.map((hw) => hw.id));
+	for (const [id, { start, end }] of first) {
+		assert.strictEqual(typeof start, 'number', id);
+		assert.ok(start >= before - STAMP_EPSILON_MS, `${id} started after the poll was issued`);
+		assert.ok(end >= start, `${id} ends after it starts`);
+		assert.ok(end <= after + STAMP_EPSILON_MS, `${id} ended before the poll resolved`);
+	}
+	console.log('   ✓ Stamps within the poll, on the hrtime clock');
+
+	// 2. Stamps advance monotonically from poll to poll, in both tree forms
+	await new Promise((resolve) => setTimeout(resolve, 5));
+	const second = hardwareStamps(await monitor.poll());
+	for (const [id, { start }] of second) {
+		assert.ok(start > first.get(id).end, `${id} stamped again`);
+	}
+	const lazy = await monitor.poll({ lazy: true });
+	const third = hardwareStamps(lazy.toJSON());
+	for (const [id, { start, end }] of third) {
+		assert.ok(start > second.get(id).end && end >= start, `${id} (lazy)`);
+	}
+	const cpu = lazy.Children[0].Children[0];
+	assert.strictEqual(cpu.UpdateEnd, third.get(cpu.HardwareId).end, 'lazy getters read the same stamps');
+	console.log('   ✓ Monotonic across polls (plain and lazy)');
+
+	// 3. Jitter starts empty, and counts every sampler tick
+	assert.strictEqual(monitor.getStats().sampler.jitter.ticks, 0);
+	monitor.startSampler({ intervalMs: 20 });
+	await new Promise((resolve) => setTimeout(resolve, 400));
+	const jitter = monitor.getStats().sampler.jitter;
+	monitor.stopSampler();
+	assert.ok(jitter.ticks >= 5, 'sampler ticked: ' + jitter.ticks);
+	assert.ok(Number.isInteger(jitter.missedTicks) && jitter.missedTicks >= 0);
+	assert.strictEqual(jitter.histogram.reduce((sum, bucket) => sum + bucket.count, 0), jitter.ticks,
+		'every tick lands in a bucket');
+	jitter.histogram.forEach((bucket, i) => {
+		assert.ok(Math.abs(bucket.upToMs - 0.001 * 2 ** i) < 1e-9, 'power-of-two bounds from 1 us');
+	});
+	assert.ok(jitter.meanMs >= 0 && jitter.meanMs <= jitter.maxMs);
+	assert.ok(jitter.p50Ms <= jitter.p99Ms && jitter.p99Ms <= jitter.maxMs);
+	assert.ok(jitter.maxMs <= jitter.histogram[jitter.histogram.length - 1].upToMs, 'max within the last bucket');
+	console.log(`   ✓ Jitter over ${jitter.ticks} ticks (p50 ${jitter.p50Ms} ms, max ${jitter.maxMs.toFixed(3)} ms)`);
+
+	// 4. Counters kept after stopSampler(), reset by the next startSampler()
+	assert.strictEqual(monitor.getStats().sampler.jitter.ticks, jitter.ticks);
+	monitor.startSampler({ intervalMs: 20 });
+	assert.ok(monitor.getStats().sampler.jitter.ticks < jitter.ticks, 'reset on start');
+	monitor.stopSampler();
+	console.log('   ✓ Counters reset per sampler run');
+
+	await monitor.shutdown();
+	console.log('\nAll update stamp tests passed');
+}
+
+main().catch((err) => {
+	console.error(err);
+	process.exit(1);
+});
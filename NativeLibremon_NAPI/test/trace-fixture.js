@@ -0,0 +1,225 @@
+/**
+ * Trace fixtures - sensor traces (src/trace_file.h) for replay-driven runs
+ *
+ * A layout lists the hardware and sensors of one schema generation:
+ *   { hardware: [{ id, name, type, parent }], sensors: [{ id, name, type, hardware }] }
+ * where parent and hardware are indices into layout.hardware (-1: top level).
+ * A frame is { time, layout, values }: ms since Unix epoch, the index of its
+ * layout, and one value per sensor of that layout (NaN: no value).
+ *
+ * layoutFromPoll() turns a recorded poll JSON tree (such as test/sensor-data.json)
+ * into a layout and its values, so recorded polls can be replayed by the addon.
+ * TEST_LAYOUT and buildFrames() give the replay-driven tests a small machine with
+ * values they choose per frame.
+ */
+
+const fs = require('fs');
+
+const MAGIC = 'LHMTRACE';
+const VERSION = 1;
+const HEADER_BYTES = 32;
+const SCHEMA_RECORD = 1;
+const FRAME_RECORD = 2;
+
+// HardwareType of the first HardwareId segment; other segments map to 'Other'
+const HARDWARE_TYPES = {
+	intelcpu: 'Cpu',
+	amdcpu: 'Cpu',
+	'gpu-nvidia': 'GpuNvidia',
+	'gpu-amd': 'GpuAmd',
+	'gpu-intel-integrated': 'GpuIntel',
+	'gpu-intel': 'GpuIntel',
+	motherboard: 'Motherboard',
+	lpc: 'SuperIO',
+	memory: 'Memory',
+	ram: 'Memory',
+	hdd: 'Storage',
+	ssd: 'Storage',
+	nvme: 'Storage',
+	nic: 'Network',
+	psu: 'Psu',
+	battery: 'Battery'
+};
+
+// CPU, GPU and a motherboard with its SuperIO chip
+const TEST_LAYOUT = {
+	hardware: [
+		{ id: '/intelcpu/0', name: 'Test CPU', type: 'Cpu', parent: -1 },
+		{ id: '/gpu-nvidia/0', name: 'Test GPU', type: 'GpuNvidia', parent: -1 },
+		{ id: '/motherboard', name: 'Test Board', type: 'Motherboard', parent: -1 },
+		{ id: '/lpc/nct6798d/0', name: 'Nuvoton NCT6798D', type: 'SuperIO', parent: 2 }
+	],
+	sensors: [
+		{ id: '/intelcpu/0/temperature/0', name: 'Core #1', type: 'Temperature', hardware: 0 },
+		{ id: '/intelcpu/0/temperature/1', name: 'Core #2', type: 'Temperature', hardware: 0 },
+		{ id: '/intelcpu/0/load/0', name: 'CPU Total', type: 'Load', hardware: 0 },
+		{ id: '/intelcpu/0/power/0', name: 'CPU Package', type: 'Power', hardware: 0 },
+		{ id: '/gpu-nvidia/0/temperature/0', name: 'GPU Core', type: 'Temperature', hardware: 1 },
+		{ id: '/gpu-nvidia/0/power/0', name: 'GPU Package', type: 'Power', hardware: 1 },
+		{ id: '/lpc/nct6798d/0/fan/0', name: 'Fan #1', type: 'Fan', hardware: 3 },
+		{ id: '/lpc/nct6798d/0/voltage/0', name: 'Vcore', type: 'Voltage', hardware: 3 }
+	]
+};
+
+/**
+ * Frames with values chosen per frame and sensor
+ * @param {object} options
+ * @param {number} options.count - frames
+ * @param {function(number, object, number): number} options.value - (frame, sensor, index)
+ * @param {function(number): number} [options.layoutAt] - layout index of a frame (default 0)
+ * @param {object[]} [options.layouts] - layouts layoutAt indexes (default [TEST_LAYOUT])
+ * @param {number} [options.startedAt=Date.now()]
+ * @param {number} [options.intervalMs=1000]
+ */
+function buildFrames(options) {
+	const layouts = options.layouts || [TEST_LAYOUT];
+	const layoutAt = options.layoutAt || (() => 0);
+	const startedAt = options.startedAt !== undefined ? options.startedAt : Date.now();
+	const intervalMs = options.intervalMs !== undefined ? options.intervalMs : 1000;
+	const frames = [];
+	for (let i = 0; i < options.count; i++) {
+		const layout = layoutAt(i);
+		const values = layouts[layout].sensors.map((sensor, index) => options.value(i, sensor, index));
+		frames.push({ time: startedAt + i * intervalMs, layout, values });
+	}
+	return { host: 'fixture', startedAt, layouts, frames };
+}
+
+function padded(bytes) {
+	return (bytes + 7) & ~7;
+}
+
+function hardwareTypeOf(hardwareId) {
+	const segment = hardwareId.split('/')[1] || '';
+	return HARDWARE_TYPES[segment] || 'Other';
+}
+
+// Schema text as the bridge's GetSchema writes it (G/H/S lines)
+function schemaText(layout, generation) {
+	const lines = [`G\t${generation}\t${layout.hardware.length}\t${layout.sensors.length}`];
+	layout.hardware.forEach((hw, i) => {
+		lines.push(`H\t${i}\t${hw.parent}\t${hw.type}\t${hw.id}\t${hw.name}`);
+	});
+	layout.sensors.forEach((sensor, i) => {
+		lines.push(`S\t${i}\t${sensor.hardware}\t${sensor.type}\t${sensor.id}\t${sensor.name}`);
+	});
+	return lines.join('\n') + '\n';
+}
+
+function record(type, payload) {
+	const head = Buffer.alloc(8);
+	head.writeUInt32LE(type, 0);
+	head.writeUInt32LE(payload.length, 4);
+	return [head, payload];
+}
+
+/**
+ * Encode a trace
+ * @param {object} trace - { host, startedAt, layouts, frames }
+ * @returns {Buffer}
+ */
+function encodeTrace(trace) {
+	const host = Buffer.from(trace.host || 'fixture', 'utf8');
+	const frames = trace.frames || [];
+	const header = Buffer.alloc(HEADER_BYTES + padded(host.length));
+	header.write(MAGIC, 0, 'latin1');
+	header.writeUInt32LE(VERSION, 8);
+	header.writeUInt32LE(host.length, 12);
+	header.writeDoubleLE(trace.startedAt !== undefined ? trace.startedAt : (frames.length ? frames[0].time : Date.now()), 16);
+	host.copy(header, HEADER_BYTES);
+
+	const chunks = [header];
+	const written = new Map();  // Layout index -> schema record index
+	for (const frame of frames) {
+		const layout = trace.layouts[frame.layout];
+		if (!layout) {
+			throw new Error('Frame refers to unknown layout ' + frame.layout);
+		}
+		if (frame.values.length !== layout.sensors.length) {
+			throw new Error(`Frame has ${frame.values.length} values for ${layout.sensors.length} sensors`);
+		}
+		if (!written.has(frame.layout)) {
+			// Generations count from 1, in recording order
+			const text = Buffer.from(schemaText(layout, written.size + 1), 'utf8');
+			const payload = Buffer.alloc(8 + padded(text.length));
+			payload.writeUInt32LE(layout.sensors.length, 0);
+			payload.writeUInt32LE(text.length, 4);
+			text.copy(payload, 8);
+			chunks.push(...record(SCHEMA_RECORD, payload));
+			written.set(frame.layout, written.size);
+		}
+
+		const payload = Buffer.alloc(16 + padded(frame.values.length * 4));
+		payload.writeDoubleLE(frame.time, 0);
+		payload.writeUInt32LE(written.get(frame.layout), 8);
+		payload.writeUInt32LE(frame.values.length, 12);
+		frame.values.forEach((value, i) => {
+			payload.writeFloatLE(value === null || value === undefined ? NaN : value, 16 + i * 4);
+		});
+		chunks.push(...record(FRAME_RECORD, payload));
+	}
+	return Buffer.concat(chunks);
+}
+
+/**
+ * Write a trace file
+ * @param {string} file
+ * @param {object} trace - { host, startedAt, layouts, frames }
+ */
+function writeTrace(file, trace) {
+	fs.writeFileSync(file, encodeTrace(trace));
+	return file;
+}
+
+// Number of a formatted web endpoint value ("1,232 V", "1.024,5 MHz", "45.0 %")
+function parseValue(text) {
+	if (typeof text !== 'string') return NaN;
+	let number = text.trim().split(/\s+/)[0];
+	if (number.includes(',') && number.includes('.')) {
+		number = number.replace(/\./g, '');
+	}
+	number = number.replace(',', '.');
+	return number === '' ? NaN : Number(number);
+}
+
+/**
+ * Layout and current values of a poll JSON tree (root -> computer -> hardware)
+ * @param {object} tree - parsed poll() result or web endpoint recording
+ * @returns {{ layout: object, values: number[] }}
+ */
+function layoutFromPoll(tree) {
+	const layout = { hardware: [], sensors: [] };
+	const values = [];
+
+	const walk = (node, hardware) => {
+		for (const child of node.Children || []) {
+			if (child.HardwareId) {
+				const index = layout.hardware.length;
+				layout.hardware.push({
+					id: child.HardwareId,
+					name: child.Text,
+					type: hardwareTypeOf(child.HardwareId),
+					parent: hardware
+				});
+				walk(child, index);
+			} else if (child.SensorId) {
+				layout.sensors.push({ id: child.SensorId, name: child.Text, type: child.Type, hardware });
+				values.push(parseValue(child.Value));
+			} else {
+				// Root, computer or sensor type group
+				walk(child, hardware);
+			}
+		}
+	};
+	walk(tree, -1);
+	return { layout, values };
+}
+
+module.exports = {
+	TEST_LAYOUT,
+	buildFrames,
+	encodeTrace,
+	writeTrace,
+	layoutFromPoll,
+	parseValue
+};
@@ -1,7 +1,10 @@
 using System;
+using System.Buffers;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
 using System.Runtime.InteropServices;
+using System.Text;
 using System.Text.Json;
 using LibreHardwareMonitor.Hardware;
 
@@ -16,6 +19,42 @@ namespace LibreHardwareMonitorNative
         private Computer? _computer;
         // Track storage flag to avoid polling HDD sensors when excluded
         private static bool _storageEnabled;
+        // Compiled include/exclude filter applied before updating and serializing (null = keep all)
+        private static HardwareFilter? _filter;
+        // Monotonic start/end of each hardware's last Update(), in Stopwatch ticks
+        private static readonly Dictionary<IHardware, (long Start, long End)> _updateTimes = new(ReferenceEqualityComparer.Instance);
+        // Poll tree serialization, reused by every poll (calls are serialized by the native side)
+        private static readonly ArrayBufferWriter<byte> _pollOutput = new(64 * 1024);
+        private static Utf8JsonWriter? _pollWriter;
+        // PollInto: the tree in _pollOutput did not fit the caller's buffer yet
+        private static bool _pollPending;
+        private static int _pollPendingSkipped;
+        // Legacy poll() presets (the addon's FilterPreset bits) of the tree being written
+        private static int _pollPresets;
+        private const int PresetVirtualNics = 1 << 0;
+        private const int PresetDimms = 1 << 1;
+        private static readonly SearchValues<string> VirtualNicNames = SearchValues.Create(new[]
+        {
+            "-QoS Packet Scheduler", "-WFP ", "-VirtualBox NDIS", "-Hyper-V Virtual Switch",
+            "-Native WiFi Filter", "-Virtual WiFi Filter", "vEthernet", "vSwitch", "(Kerneldebugger)"
+        }, StringComparison.Ordinal);
+        
+        // Flattened sensor layout shared by GetSchema/ReadValues, rebuilt when the topology changes
+        private SensorSchema? _schema;
+        private int _schemaGeneration;
+        private bool _schemaDirty = true;
+        
+        // Category bits for Update(), in HardwareConfig order
+        private const int CategoryCpu = 1 << 0;
+        private const int CategoryGpu = 1 << 1;
+        private const int CategoryMotherboard = 1 << 2;
+        private const int CategoryMemory = 1 << 3;
+        private const int CategoryStorage = 1 << 4;
+        private const int CategoryNetwork = 1 << 5;
+        private const int CategoryPsu = 1 << 6;
+        private const int CategoryController = 1 << 7;
+        private const int CategoryBattery = 1 << 8;
+        private const int CategoryOther = 1 << 9;    // Hardware types without a config flag
         
         // Delegate types for native interop - MUST use Cdecl calling convention to match C++
         // Use I1 (1-byte bool) to match C++ bool size
@@ -33,15 +72,59 @@ namespace LibreHardwareMonitorNative
             [MarshalAs(UnmanagedType.I1)] bool dimmDetection,
             [MarshalAs(UnmanagedType.I1)] bool physicalNetworkOnly);
         
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int ReconfigureDelegate(
+            [MarshalAs(UnmanagedType.I1)] bool cpu,
+            [MarshalAs(UnmanagedType.I1)] bool gpu,
+            [MarshalAs(UnmanagedType.I1)] bool motherboard,
+            [MarshalAs(UnmanagedType.I1)] bool memory,
+            [MarshalAs(UnmanagedType.I1)] bool storage,
+            [MarshalAs(UnmanagedType.I1)] bool network,
+            [MarshalAs(UnmanagedType.I1)] bool psu,
+            [MarshalAs(UnmanagedType.I1)] bool controller,
+            [MarshalAs(UnmanagedType.I1)] bool battery,
+            [MarshalAs(UnmanagedType.I1)] bool dimmDetection,
+            [MarshalAs(UnmanagedType.I1)] bool physicalNetworkOnly);
+        
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate IntPtr PollDelegate();
         
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate IntPtr PollWithinDelegate(int budgetMs, IntPtr skippedHardware);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int PollIntoDelegate(IntPtr buffer, int capacity, int budgetMs, int filterPresets, IntPtr skippedHardware);
+        
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate void FreeStringDelegate(IntPtr ptr);
         
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate void ShutdownDelegate();
         
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate IntPtr GetSchemaDelegate();
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int GetSchemaGenerationDelegate();
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int UpdateDelegate(int categoryMask);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int ReadValuesDelegate(IntPtr values, IntPtr mins, IntPtr maxs, int capacity);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int SetFilterDelegate(IntPtr filterJson);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int GetMemoryStatsDelegate(IntPtr stats, int capacity);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int UpdateHardwareDelegate(IntPtr indices, int count);
+        
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int ReadSensorValuesDelegate(IntPtr indices, IntPtr values, int count);
+        
         /// <summary>
         /// Initialize the hardware monitor with specified configuration
         /// </summary>
@@ -80,6 +163,10 @@ namespace LibreHardwareMonitorNative
                     IsBatteryEnabled = battery
                 };
                 
+                instance._computer.HardwareAdded += instance.OnHardwareAdded;
+                instance._computer.HardwareRemoved += instance.OnHardwareRemoved;
+                instance._schemaDirty = true;
+                
                 instance._computer.Open();
                 
                 return 0; // Success
@@ -92,39 +179,208 @@ namespace LibreHardwareMonitorNative
         }
         
         /// <summary>
-        /// <summary>
-        /// Poll sensors and return JSON data
+        /// Enable or disable hardware categories on the open Computer.
+        /// Each Is*Enabled setter opens or closes only its own group; the hardware
+        /// that comes and goes raises HardwareAdded/HardwareRemoved, which bumps
+        /// the schema generation.
         /// </summary>
-        public static IntPtr Poll()
+        public static int Reconfigure(
+            bool cpu,
+            bool gpu,
+            bool motherboard,
+            bool memory,
+            bool storage,
+            bool network,
+            bool psu,
+            bool controller,
+            bool battery,
+            bool dimmDetection,
+            bool physicalNetworkOnly)
         {
             try
             {
                 var instance = Instance;
+                var computer = instance._computer;
+                if (computer == null)
+                {
+                    return -1;
+                }
                 
-                if (instance._computer == null)
+                // DIMM detection and physical-only networking are read when the memory
+                // and network groups are created, so changing them reopens the group
+                if (computer.IsDimmDetectionEnabled != dimmDetection && computer.IsMemoryEnabled)
                 {
-                    return IntPtr.Zero;
+                    computer.IsMemoryEnabled = false;
                 }
+                if (computer.IsPhysicalNetworkOnly != physicalNetworkOnly && computer.IsNetworkEnabled)
+                {
+                    computer.IsNetworkEnabled = false;
+                }
+                computer.IsDimmDetectionEnabled = dimmDetection;
+                computer.IsPhysicalNetworkOnly = physicalNetworkOnly;
                 
-                // Update all hardware sensors (recursively)
-                foreach (var hardware in instance._computer.Hardware)
+                computer.IsCpuEnabled = cpu;
+                computer.IsGpuEnabled = gpu;
+                computer.IsMotherboardEnabled = motherboard;
+                computer.IsMemoryEnabled = memory;
+                computer.IsStorageEnabled = storage;
+                computer.IsNetworkEnabled = network;
+                computer.IsPsuEnabled = psu;
+                computer.IsControllerEnabled = controller;
+                computer.IsBatteryEnabled = battery;
+                _storageEnabled = storage;
+                instance._schemaDirty = true;
+                
+                return 0;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_Reconfigure failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Poll sensors and return JSON data
+        /// </summary>
+        public static IntPtr Poll()
+        {
+            int skipped = 0;
+            return PollUntil(long.MaxValue, ref skipped);
+        }
+        
+        /// <summary>
+        /// Poll sensors, but update no further hardware once budgetMs have passed.
+        /// Hardware not reached keeps its previous values and UpdateStart/UpdateEnd;
+        /// their number is written to skippedHardware (an int*, may be null).
+        /// </summary>
+        public static unsafe IntPtr PollWithin(int budgetMs, IntPtr skippedHardware)
+        {
+            long deadline = Stopwatch.GetTimestamp() + Math.Max(0, budgetMs) * Stopwatch.Frequency / 1000;
+            int skipped = 0;
+            IntPtr json = PollUntil(deadline, ref skipped);
+            if (skippedHardware != IntPtr.Zero)
+            {
+                *(int*)skippedHardware = skipped;
+            }
+            return json;
+        }
+        
+        /// <summary>
+        /// Poll sensors into a caller-owned buffer of capacity bytes, as NUL-terminated
+        /// UTF-8 JSON, updating no further hardware once budgetMs have passed
+        /// (budgetMs &lt; 0: no deadline; skippedHardware as for PollWithin).
+        /// filterPresets leaves hardware out of this tree only (virtual NIC / NDIS
+        /// filter adapters, individual DIMMs); they are still updated, and the
+        /// filter and schema are unchanged.
+        /// Returns the JSON length, 0 on failure, or -(bytes needed) if the buffer is
+        /// too small; the tree is then kept, and the next call copies it without
+        /// updating the hardware again. Steady-state calls allocate nothing here.
+        /// </summary>
+        public static unsafe int PollInto(IntPtr buffer, int capacity, int budgetMs, int filterPresets, IntPtr skippedHardware)
+        {
+            try
+            {
+                if (!_pollPending)
                 {
-                    if (ShouldSkipHardware(hardware))
+                    long deadline = budgetMs < 0 ? long.MaxValue
+                        : Stopwatch.GetTimestamp() + (long)budgetMs * Stopwatch.Frequency / 1000;
+                    int skipped = 0;
+                    _pollPresets = filterPresets;
+                    try
                     {
-                        continue;
+                        if (!SerializePoll(deadline, ref skipped))
+                        {
+                            return 0;
+                        }
                     }
-                    UpdateHardwareRecursive(hardware);
+                    finally
+                    {
+                        _pollPresets = 0;
+                    }
+                    _pollPendingSkipped = skipped;
                 }
                 
-                // Build JSON structure matching web endpoint format
-                var root = BuildHardwareTree(instance._computer.Hardware);
-                var json = JsonSerializer.Serialize(root, new JsonSerializerOptions
+                var json = _pollOutput.WrittenSpan;
+                if (buffer == IntPtr.Zero || capacity < json.Length + 1)
+                {
+                    _pollPending = true;
+                    return -(json.Length + 1);
+                }
+                _pollPending = false;
+                
+                var target = new Span<byte>((void*)buffer, json.Length + 1);
+                json.CopyTo(target);
+                target[json.Length] = 0;
+                if (skippedHardware != IntPtr.Zero)
+                {
+                    *(int*)skippedHardware = _pollPendingSkipped;
+                }
+                return json.Length;
+            }
+            catch (Exception ex)
+            {
+                _pollPending = false;
+                Console.WriteLine($"LHM_PollInto failed: {ex.Message}");
+                return 0;
+            }
+        }
+        
+        // Update the hardware (none past the deadline, in Stopwatch ticks) and write
+        // the JSON tree matching the web endpoint format into _pollOutput
+        private static bool SerializePoll(long deadline, ref int skipped)
+        {
+            var instance = Instance;
+            
+            if (instance._computer == null)
+            {
+                return false;
+            }
+            
+            // Update all hardware sensors (recursively)
+            foreach (var hardware in instance._computer.Hardware)
+            {
+                if (ShouldSkipHardware(hardware))
+                {
+                    continue;
+                }
+                UpdateHardwareRecursive(hardware, deadline, ref skipped);
+            }
+            
+            _pollOutput.ResetWrittenCount();
+            if (_pollWriter == null)
+            {
+                _pollWriter = new Utf8JsonWriter(_pollOutput);
+            }
+            else
+            {
+                _pollWriter.Reset(_pollOutput);
+            }
+            WriteHardwareTree(_pollWriter, instance._computer.Hardware);
+            _pollWriter.Flush();
+            return true;
+        }
+        
+        private static IntPtr PollUntil(long deadline, ref int skipped)
+        {
+            try
+            {
+                _pollPending = false;
+                if (!SerializePoll(deadline, ref skipped))
                 {
-                    WriteIndented = false
-                });
+                    return IntPtr.Zero;
+                }
                 
-                // Allocate unmanaged memory for the JSON string
-                return Marshal.StringToCoTaskMemUTF8(json);
+                // Copy to unmanaged memory as a NUL-terminated UTF-8 string
+                var json = _pollOutput.WrittenSpan;
+                IntPtr ptr = Marshal.AllocCoTaskMem(json.Length + 1);
+                unsafe
+                {
+                    var target = new Span<byte>((void*)ptr, json.Length + 1);
+                    json.CopyTo(target);
+                    target[json.Length] = 0;
+                }
+                return ptr;
             }
             catch (Exception ex)
             {
@@ -155,11 +411,19 @@ namespace LibreHardwareMonitorNative
                 
                 if (instance._computer != null)
                 {
+                    instance._computer.HardwareAdded -= instance.OnHardwareAdded;
+                    instance._computer.HardwareRemoved -= instance.OnHardwareRemoved;
                     instance._computer.Close();
                     instance._computer = null;
                 }
+                
+                instance._schema = null;
+                instance._schemaDirty = true;
 
                 _storageEnabled = false;
+                _filter = null;
+                _updateTimes.Clear();
+                _pollPending = false;
             }
             catch (Exception ex)
             {
@@ -167,137 +431,757 @@ namespace LibreHardwareMonitorNative
             }
         }
         
+        /// <summary>
+        /// Describe the value layout used by ReadValues as tab-separated text:
+        /// a "G" line (generation, hardware count, sensor count), then one "H" line
+        /// per hardware and one "S" line per sensor, in the tree order of WriteHardwareNodes
+        /// </summary>
+        public static IntPtr GetSchema()
+        {
+            try
+            {
+                var schema = EnsureSchema(Instance);
+                if (schema == null)
+                {
+                    return IntPtr.Zero;
+                }
+                
+                var sb = new StringBuilder();
+                sb.Append("G\t").Append(Instance._schemaGeneration)
+                  .Append('\t').Append(schema.Hardware.Count)
+                  .Append('\t').Append(schema.Sensors.Count).Append('\n');
+                
+                for (int i = 0; i < schema.Hardware.Count; i++)
+                {
+                    var hardware = schema.Hardware[i];
+                    sb.Append("H\t").Append(i)
+                      .Append('\t').Append(schema.HardwareParents[i])
+                      .Append('\t').Append(hardware.HardwareType)
+                      .Append('\t').Append(SchemaField(hardware.Identifier.ToString()))
+                      .Append('\t').Append(SchemaField(hardware.Name)).Append('\n');
+                }
+                
+                for (int i = 0; i < schema.Sensors.Count; i++)
+                {
+                    var sensor = schema.Sensors[i];
+                    sb.Append("S\t").Append(i)
+                      .Append('\t').Append(schema.SensorOwners[i])
+                      .Append('\t').Append(sensor.SensorType)
+                      .Append('\t').Append(SchemaField(sensor.Identifier.ToString()))
+                      .Append('\t').Append(SchemaField(sensor.Name)).Append('\n');
+                }
+                
+                return Marshal.StringToCoTaskMemUTF8(sb.ToString());
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_GetSchema failed: {ex.Message}");
+                return IntPtr.Zero;
+            }
+        }
+        
+        /// <summary>
+        /// Current schema generation; changes whenever hardware is added or removed
+        /// </summary>
+        public static int GetSchemaGeneration()
+        {
+            try
+            {
+                EnsureSchema(Instance);
+                return Instance._schemaGeneration;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_GetSchemaGeneration failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Update the hardware of the selected categories without building any JSON
+        /// </summary>
+        public static int Update(int categoryMask)
+        {
+            try
+            {
+                var instance = Instance;
+                
+                if (instance._computer == null)
+                {
+                    return -1;
+                }
+                
+                foreach (var hardware in instance._computer.Hardware)
+                {
+                    if ((categoryMask & GetCategoryBit(hardware.HardwareType)) == 0)
+                    {
+                        continue;
+                    }
+                    UpdateHardwareRecursive(hardware);
+                }
+                
+                return 0;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_Update failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Copy current sensor values into caller-owned float arrays, indexed as in GetSchema.
+        /// Missing values are written as NaN; mins/maxs may be null.
+        /// Returns the sensor count, or -count if capacity is too small.
+        /// </summary>
+        public static unsafe int ReadValues(IntPtr values, IntPtr mins, IntPtr maxs, int capacity)
+        {
+            try
+            {
+                var schema = EnsureSchema(Instance);
+                if (schema == null)
+                {
+                    return 0;
+                }
+                
+                var sensors = schema.Sensors;
+                if (capacity < sensors.Count)
+                {
+                    return -sensors.Count;
+                }
+                
+                float* valuePtr = (float*)values;
+                float* minPtr = (float*)mins;
+                float* maxPtr = (float*)maxs;
+                
+                for (int i = 0; i < sensors.Count; i++)
+                {
+                    var sensor = sensors[i];
+                    if (valuePtr != null) valuePtr[i] = sensor.Value ?? float.NaN;
+                    if (minPtr != null) minPtr[i] = sensor.Min ?? float.NaN;
+                    if (maxPtr != null) maxPtr[i] = sensor.Max ?? float.NaN;
+                }
+                
+                return sensors.Count;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_ReadValues failed: {ex.Message}");
+                return 0;
+            }
+        }
+        
+        /// <summary>
+        /// Update only the listed hardware (schema hardware indices), without their
+        /// sub-hardware. Used for short high-rate bursts on a few sensors.
+        /// Returns 0, -1 on failure, or -2 if an index is outside the current schema.
+        /// </summary>
+        public static unsafe int UpdateHardware(IntPtr indices, int count)
+        {
+            try
+            {
+                var schema = EnsureSchema(Instance);
+                if (schema == null)
+                {
+                    return -1;
+                }
+                
+                int* indexPtr = (int*)indices;
+                for (int i = 0; i < count; i++)
+                {
+                    if ((uint)indexPtr[i] >= (uint)schema.Hardware.Count)
+                    {
+                        return -2;
+                    }
+                }
+                for (int i = 0; i < count; i++)
+                {
+                    UpdateTimed(schema.Hardware[indexPtr[i]]);
+                }
+                
+                return 0;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_UpdateHardware failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Copy the current values of the listed sensors (schema sensor indices);
+        /// missing values are written as NaN.
+        /// Returns count, -1 on failure, or -2 if an index is outside the current schema.
+        /// </summary>
+        public static unsafe int ReadSensorValues(IntPtr indices, IntPtr values, int count)
+        {
+            try
+            {
+                var schema = EnsureSchema(Instance);
+                if (schema == null)
+                {
+                    return -1;
+                }
+                
+                int* indexPtr = (int*)indices;
+                float* valuePtr = (float*)values;
+                var sensors = schema.Sensors;
+                for (int i = 0; i < count; i++)
+                {
+                    if ((uint)indexPtr[i] >= (uint)sensors.Count)
+                    {
+                        return -2;
+                    }
+                    valuePtr[i] = sensors[indexPtr[i]].Value ?? float.NaN;
+                }
+                
+                return count;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_ReadSensorValues failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Replace the hardware/sensor filter. Takes a UTF-8 JSON object with optional
+        /// string arrays excludeNames, excludeHardwareIds, excludeSensorTypes,
+        /// includeNames, includeHardwareIds, includeSensorTypes; null or "{}" clears it.
+        /// Filtered hardware is neither updated nor serialized.
+        /// </summary>
+        public static int SetFilter(IntPtr filterJson)
+        {
+            try
+            {
+                string? json = filterJson == IntPtr.Zero ? null : Marshal.PtrToStringUTF8(filterJson);
+                _filter = HardwareFilter.Parse(json);
+                Instance._schemaDirty = true;
+                return 0;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_SetFilter failed: {ex.Message}");
+                return -1;
+            }
+        }
+        
+        /// <summary>
+        /// Managed heap statistics for soak runs, written as int64 in this order:
+        /// live bytes, heap size, committed bytes, total allocated bytes,
+        /// gen0/gen1/gen2 collection counts. Cheap: no collection is forced.
+        /// Returns the number of fields written.
+        /// </summary>
+        public static unsafe int GetMemoryStats(IntPtr stats, int capacity)
+        {
+            try
+            {
+                var info = GC.GetGCMemoryInfo();
+                Span<long> fields = stackalloc long[]
+                {
+                    GC.GetTotalMemory(false),
+                    info.HeapSizeBytes,
+                    info.TotalCommittedBytes,
+                    GC.GetTotalAllocatedBytes(false),
+                    GC.CollectionCount(0),
+                    GC.CollectionCount(1),
+                    GC.CollectionCount(2)
+                };
+                
+                int count = Math.Min(capacity, fields.Length);
+                fields.Slice(0, count).CopyTo(new Span<long>((long*)stats, count));
+                return count;
+            }
+            catch (Exception ex)
+            {
+                Console.WriteLine($"LHM_GetMemoryStats failed: {ex.Message}");
+                return 0;
+            }
+        }
+        
         // Singleton instance
         private static HardwareMonitorBridge? _instance;
         private static HardwareMonitorBridge Instance => _instance ??= new HardwareMonitorBridge();
         
         // Helper method to recursively update hardware and sub-hardware
         private static void UpdateHardwareRecursive(IHardware hardware)
+        {
+            int skipped = 0;
+            UpdateHardwareRecursive(hardware, long.MaxValue, ref skipped);
+        }
+        
+        // Same, counting instead of updating the hardware that the deadline (Stopwatch ticks)
+        // has passed for, or that its last update says would not finish before it
+        private static void UpdateHardwareRecursive(IHardware hardware, long deadline, ref int skipped)
         {
             if (ShouldSkipHardware(hardware))
             {
                 return;
             }
 
+            if (deadline != long.MaxValue && !FitsBefore(hardware, deadline))
+            {
+                skipped++;
+            }
+            else
+            {
+                UpdateTimed(hardware);
+            }
+            foreach (var subHardware in hardware.SubHardware)
+            {
+                UpdateHardwareRecursive(subHardware, deadline, ref skipped);
+            }
+        }
+        
+        // Whether the hardware can start now and, going by its last update, finish by the deadline
+        private static bool FitsBefore(IHardware hardware, long deadline)
+        {
+            long now = Stopwatch.GetTimestamp();
+            if (_updateTimes.TryGetValue(hardware, out var times))
+            {
+                now += times.End - times.Start;
+            }
+            return now < deadline;
+        }
+        
+        // Update one hardware (not its sub-hardware) and record when it ran
+        private static void UpdateTimed(IHardware hardware)
+        {
+            long start = Stopwatch.GetTimestamp();
             hardware.Update();
+            _updateTimes[hardware] = (start, Stopwatch.GetTimestamp());
+        }
+        
+        // Stopwatch ticks as ms on the clock of Node's process.hrtime()
+        // (QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere), to the microsecond
+        private static double MonotonicMs(long ticks)
+        {
+            return Math.Round(ticks * (1000.0 / Stopwatch.Frequency), 3);
+        }
+        
+        // Writes the hardware tree. Property order matches the web endpoint's
+        // (the native side appends derived sensors after the last "]}]}"), and
+        // it is written directly rather than serialized from objects so that no
+        // reflection is needed (NativeAOT build).
+        private static void WriteHardwareTree(Utf8JsonWriter writer, IEnumerable<IHardware> hardware)
+        {
+            writer.WriteStartObject();
+            writer.WriteNumber("id", 0);
+            writer.WriteString("Text", "Sensor");
+            writer.WriteString("Min", "Min");      // Header labels for web endpoint compatibility
+            writer.WriteString("Value", "Value");
+            writer.WriteString("Max", "Max");
+            writer.WriteString("ImageURL", "");
+            writer.WriteStartArray("Children");
+            
+            writer.WriteStartObject();
+            writer.WriteNumber("id", 1);
+            writer.WriteString("Text", Environment.MachineName);
+            writer.WriteString("Min", "");
+            writer.WriteString("Value", "");
+            writer.WriteString("Max", "");
+            writer.WriteString("ImageURL", "images_icon/computer.png");
+            writer.WriteStartArray("Children");
+            WriteHardwareNodes(writer, hardware, startId: 2);
+            writer.WriteEndArray();
+            writer.WriteEndObject();
+            
+            writer.WriteEndArray();
+            writer.WriteEndObject();
+        }
+        
+        private static void WriteHardwareNodes(Utf8JsonWriter writer, IEnumerable<IHardware> hardwareList, int startId = 1)
+        {
+            int id = startId;
+            
+            foreach (var hardware in hardwareList)
+            {
+                if (ShouldSkipHardware(hardware) || IsPresetExcluded(hardware))
+                {
+                    continue;
+                }
+                
+                writer.WriteStartObject();
+                writer.WriteNumber("id", id++);
+                writer.WriteString("Text", hardware.Name);
+                writer.WriteStartArray("Children");
+                WriteSensorNodes(writer, hardware.Sensors, ref id);
+                WriteHardwareNodes(writer, hardware.SubHardware);
+                writer.WriteEndArray();
+                writer.WriteString("Min", "");
+                writer.WriteString("Value", "");
+                writer.WriteString("Max", "");
+                writer.WriteString("HardwareId", hardware.Identifier.ToString());
+                if (_updateTimes.TryGetValue(hardware, out var times))
+                {
+                    writer.WriteNumber("UpdateStart", MonotonicMs(times.Start));
+                    writer.WriteNumber("UpdateEnd", MonotonicMs(times.End));
+                }
+                writer.WriteString("ImageURL", GetHardwareImageUrl(hardware.HardwareType));
+                writer.WriteEndObject();
+            }
+        }
+
+        private static bool ShouldSkipHardware(IHardware hardware)
+        {
+            if (!_storageEnabled && hardware.HardwareType == HardwareType.Storage)
+            {
+                return true;
+            }
+            return _filter != null && _filter.IsHardwareExcluded(hardware);
+        }
+        
+        // Hardware the presets of the poll being written leave out of its tree
+        private static bool IsPresetExcluded(IHardware hardware)
+        {
+            if (_pollPresets == 0)
+            {
+                return false;
+            }
+            if ((_pollPresets & PresetDimms) != 0
+                && hardware.Identifier.ToString().Contains("/memory/dimm/", StringComparison.Ordinal))
+            {
+                return true;
+            }
+            return (_pollPresets & PresetVirtualNics) != 0 && hardware.HardwareType == HardwareType.Network
+                && hardware.Name.AsSpan().IndexOfAny(VirtualNicNames) >= 0;
+        }
+        
+        private static bool IsSensorFiltered(ISensor sensor)
+        {
+            return _filter != null && _filter.IsSensorExcluded(sensor);
+        }
+        
+        private void OnHardwareAdded(IHardware hardware)
+        {
+            _schemaDirty = true;
+            WatchSensors(hardware, true);
+        }
+        
+        private void OnHardwareRemoved(IHardware hardware)
+        {
+            _schemaDirty = true;
+            WatchSensors(hardware, false);
+            _filter?.Forget(hardware);
+            ForgetUpdateTimes(hardware);
+        }
+        
+        // Sensors that appear or go away on a live hardware (a NIC's link speed,
+        // a fan header that starts reporting) change the schema as hardware does
+        private void WatchSensors(IHardware hardware, bool watch)
+        {
+            if (watch)
+            {
+                hardware.SensorAdded += OnSensorChanged;
+                hardware.SensorRemoved += OnSensorChanged;
+            }
+            else
+            {
+                hardware.SensorAdded -= OnSensorChanged;
+                hardware.SensorRemoved -= OnSensorChanged;
+            }
+            foreach (var subHardware in hardware.SubHardware)
+            {
+                WatchSensors(subHardware, watch);
+            }
+        }
+        
+        private void OnSensorChanged(ISensor sensor)
+        {
+            _schemaDirty = true;
+        }
+        
+        private static void ForgetUpdateTimes(IHardware hardware)
+        {
+            _updateTimes.Remove(hardware);
             foreach (var subHardware in hardware.SubHardware)
             {
-                UpdateHardwareRecursive(subHardware);
+                ForgetUpdateTimes(subHardware);
             }
         }
         
-        // Helper method to build hardware tree
-        private static object BuildHardwareTree(IEnumerable<IHardware> hardware)
+        // Include/exclude rules compiled once per SetFilter call.
+        // Name substrings and HardwareId prefixes go through SearchValues (multi-pattern
+        // matcher); sensor types become a bit mask; per-hardware decisions are cached.
+        private sealed class HardwareFilter
         {
-            // Get computer name from environment
-            string computerName = Environment.MachineName;
+            private SearchValues<string>? _excludeNames;
+            private SearchValues<string>? _excludeIdPrefixes;
+            private SearchValues<string>? _includeNames;
+            private SearchValues<string>? _includeIdPrefixes;
+            private ulong _excludeSensorTypes;
+            private ulong _includeSensorTypes;  // 0 = every type
+            private readonly Dictionary<IHardware, bool> _decisions = new(ReferenceEqualityComparer.Instance);
+            
+            private bool HasInclude => _includeNames != null || _includeIdPrefixes != null;
+            
+            public static HardwareFilter? Parse(string? json)
+            {
+                if (string.IsNullOrWhiteSpace(json))
+                {
+                    return null;
+                }
+                
+                using var doc = JsonDocument.Parse(json);
+                var root = doc.RootElement;
+                if (root.ValueKind != JsonValueKind.Object)
+                {
+                    return null;
+                }
+                
+                var filter = new HardwareFilter
+                {
+                    _excludeNames = CompilePatterns(root, "excludeNames"),
+                    _excludeIdPrefixes = CompilePatterns(root, "excludeHardwareIds"),
+                    _includeNames = CompilePatterns(root, "includeNames"),
+                    _includeIdPrefixes = CompilePatterns(root, "includeHardwareIds"),
+                    _excludeSensorTypes = CompileSensorTypes(root, "excludeSensorTypes"),
+                    _includeSensorTypes = CompileSensorTypes(root, "includeSensorTypes")
+                };
+                
+                bool empty = filter._excludeNames == null && filter._excludeIdPrefixes == null
+                    && !filter.HasInclude && filter._excludeSensorTypes == 0 && filter._includeSensorTypes == 0;
+                return empty ? null : filter;
+            }
+            
+            public bool IsHardwareExcluded(IHardware hardware)
+            {
+                if (!_decisions.TryGetValue(hardware, out bool excluded))
+                {
+                    excluded = Evaluate(hardware);
+                    _decisions[hardware] = excluded;
+                }
+                return excluded;
+            }
+            
+            public bool IsSensorExcluded(ISensor sensor)
+            {
+                ulong bit = 1UL << ((int)sensor.SensorType & 63);
+                if ((_excludeSensorTypes & bit) != 0)
+                {
+                    return true;
+                }
+                return _includeSensorTypes != 0 && (_includeSensorTypes & bit) == 0;
+            }
+            
+            public void Forget(IHardware hardware)
+            {
+                _decisions.Remove(hardware);
+                foreach (var subHardware in hardware.SubHardware)
+                {
+                    Forget(subHardware);
+                }
+            }
             
-            return new
+            private bool Evaluate(IHardware hardware)
             {
-                id = 0,
-                Text = "Sensor",
-                Min = "Min",      // Header labels for web endpoint compatibility
-                Value = "Value",
-                Max = "Max",
-                ImageURL = "",
-                Children = new[]
+                if (hardware.Parent != null && IsHardwareExcluded(hardware.Parent))
+                {
+                    return true;
+                }
+                
+                if (Matches(hardware, _excludeNames, _excludeIdPrefixes))
+                {
+                    return true;
+                }
+                
+                if (!HasInclude)
+                {
+                    return false;
+                }
+                
+                // Kept if it, an ancestor or a descendant matches (an included
+                // SuperIO keeps its motherboard; an included motherboard keeps its SuperIO)
+                for (var ancestor = hardware.Parent; ancestor != null; ancestor = ancestor.Parent)
                 {
-                    new
+                    if (Matches(ancestor, _includeNames, _includeIdPrefixes))
                     {
-                        id = 1,
-                        Text = computerName,
-                        Min = "",
-                        Value = "",
-                        Max = "",
-                        ImageURL = "images_icon/computer.png",
-                        Children = BuildHardwareNodes(hardware, startId: 2)
+                        return false;
                     }
                 }
-            };
+                return !MatchesIncludeDeep(hardware);
+            }
+            
+            private bool MatchesIncludeDeep(IHardware hardware)
+            {
+                if (Matches(hardware, _includeNames, _includeIdPrefixes))
+                {
+                    return true;
+                }
+                foreach (var subHardware in hardware.SubHardware)
+                {
+                    if (MatchesIncludeDeep(subHardware))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            
+            private static bool Matches(IHardware hardware, SearchValues<string>? names, SearchValues<string>? idPrefixes)
+            {
+                if (names != null && hardware.Name.AsSpan().IndexOfAny(names) >= 0)
+                {
+                    return true;
+                }
+                // Earliest match at position 0 means some pattern is a prefix
+                return idPrefixes != null && hardware.Identifier.ToString().AsSpan().IndexOfAny(idPrefixes) == 0;
+            }
+            
+            private static SearchValues<string>? CompilePatterns(JsonElement root, string property)
+            {
+                if (!root.TryGetProperty(property, out var array) || array.ValueKind != JsonValueKind.Array)
+                {
+                    return null;
+                }
+                
+                var patterns = new List<string>();
+                foreach (var item in array.EnumerateArray())
+                {
+                    var pattern = item.GetString();
+                    if (!string.IsNullOrEmpty(pattern))
+                    {
+                        patterns.Add(pattern);
+                    }
+                }
+                return patterns.Count == 0 ? null : SearchValues.Create(patterns.ToArray(), StringComparison.Ordinal);
+            }
+            
+            private static ulong CompileSensorTypes(JsonElement root, string property)
+            {
+                ulong mask = 0;
+                if (!root.TryGetProperty(property, out var array) || array.ValueKind != JsonValueKind.Array)
+                {
+                    return mask;
+                }
+                
+                foreach (var item in array.EnumerateArray())
+                {
+                    if (Enum.TryParse<SensorType>(item.GetString(), ignoreCase: true, out var type))
+                    {
+                        mask |= 1UL << ((int)type & 63);
+                    }
+                    else
+                    {
+                        Console.WriteLine($"LHM_SetFilter: unknown sensor type '{item.GetString()}'");
+                    }
+                }
+                return mask;
+            }
         }
         
-        private static List<object> BuildHardwareNodes(IEnumerable<IHardware> hardwareList, int startId = 1)
+        // Flattened view of the tree in WriteHardwareNodes/WriteSensorNodes order
+        private sealed class SensorSchema
         {
-            var nodes = new List<object>();
-            int id = startId;
+            public readonly List<IHardware> Hardware = new();
+            public readonly List<int> HardwareParents = new();
+            public readonly List<ISensor> Sensors = new();
+            public readonly List<int> SensorOwners = new();
+        }
+        
+        private static SensorSchema? EnsureSchema(HardwareMonitorBridge instance)
+        {
+            if (instance._computer == null)
+            {
+                return null;
+            }
+            
+            if (instance._schemaDirty || instance._schema == null)
+            {
+                var schema = new SensorSchema();
+                CollectSchema(instance._computer.Hardware, -1, schema);
+                instance._schema = schema;
+                instance._schemaGeneration++;
+                instance._schemaDirty = false;
+            }
             
+            return instance._schema;
+        }
+        
+        private static void CollectSchema(IEnumerable<IHardware> hardwareList, int parentIndex, SensorSchema schema)
+        {
             foreach (var hardware in hardwareList)
             {
                 if (ShouldSkipHardware(hardware))
                 {
                     continue;
                 }
-
-                var hwNode = new
-                {
-                    id = id++,
-                    Text = hardware.Name,
-                    Children = BuildSensorNodes(hardware.Sensors, ref id)
-                        .Concat(BuildHardwareNodes(hardware.SubHardware))
-                        .ToList(),
-                    Min = "",
-                    Value = "",
-                    Max = "",
-                    HardwareId = hardware.Identifier.ToString(),  // Add HardwareId
-                    ImageURL = GetHardwareImageUrl(hardware.HardwareType)
-                };
                 
-                nodes.Add(hwNode);
+                int hardwareIndex = schema.Hardware.Count;
+                schema.Hardware.Add(hardware);
+                schema.HardwareParents.Add(parentIndex);
+                
+                // Stable sort by enum value: same order as the groups in WriteSensorNodes
+                foreach (var sensor in hardware.Sensors.Where(s => !IsSensorFiltered(s)).OrderBy(s => (int)s.SensorType))
+                {
+                    schema.Sensors.Add(sensor);
+                    schema.SensorOwners.Add(hardwareIndex);
+                }
+                
+                CollectSchema(hardware.SubHardware, hardwareIndex, schema);
             }
-            
-            return nodes;
         }
-
-        private static bool ShouldSkipHardware(IHardware hardware)
+        
+        private static string SchemaField(string value)
         {
-            return !_storageEnabled && hardware.HardwareType == HardwareType.Storage;
+            return value.Replace('\t', ' ').Replace('\n', ' ').Replace('\r', ' ');
         }
         
-        private static List<object> BuildSensorNodes(IEnumerable<ISensor> sensors, ref int id)
+        private static int GetCategoryBit(HardwareType type)
+        {
+            return type switch
+            {
+                HardwareType.Cpu => CategoryCpu,
+                HardwareType.GpuNvidia or HardwareType.GpuAmd or HardwareType.GpuIntel => CategoryGpu,
+                HardwareType.Motherboard or HardwareType.SuperIO or HardwareType.EmbeddedController => CategoryMotherboard,
+                HardwareType.Memory => CategoryMemory,
+                HardwareType.Storage => CategoryStorage,
+                HardwareType.Network => CategoryNetwork,
+                HardwareType.Psu => CategoryPsu,
+                HardwareType.Cooler => CategoryController,
+                HardwareType.Battery => CategoryBattery,
+                _ => CategoryOther
+            };
+        }
+        
+        private static void WriteSensorNodes(Utf8JsonWriter writer, IEnumerable<ISensor> sensors, ref int id)
         {
-            var nodes = new List<object>();
-            
             // Group sensors by type and sort by the enum order (matches web endpoint ordering)
             var grouped = sensors
+                .Where(s => !IsSensorFiltered(s))
                 .GroupBy(s => s.SensorType)
                 .OrderBy(g => (int)g.Key);  // Sort by enum value to match web endpoint
             
             foreach (var group in grouped)
             {
-                var groupId = id++;
-                var sensorChildren = new List<object>();
+                writer.WriteStartObject();
+                writer.WriteNumber("id", id++);
+                writer.WriteString("Text", GetSensorTypeName(group.Key));
+                writer.WriteStartArray("Children");
                 
                 foreach (var sensor in group)
                 {
-                    sensorChildren.Add(new
-                    {
-                        id = id++,
-                        Text = sensor.Name,
-                        Children = new List<object>(),
-                        Min = FormatSensorValue(sensor.Min, sensor.SensorType),
-                        Value = FormatSensorValue(sensor.Value, sensor.SensorType),
-                        Max = FormatSensorValue(sensor.Max, sensor.SensorType),
-                        SensorId = sensor.Identifier.ToString(),  // Add SensorId
-                        Type = sensor.SensorType.ToString(),       // Add Type
-                        ImageURL = ""
-                    });
-                }
-                
-                var groupNode = new
-                {
-                    id = groupId,
-                    Text = GetSensorTypeName(group.Key),
-                    Children = sensorChildren,
-                    Min = "",
-                    Value = "",
-                    Max = "",
-                    ImageURL = ""
-                };
+                    writer.WriteStartObject();
+                    writer.WriteNumber("id", id++);
+                    writer.WriteString("Text", sensor.Name);
+                    writer.WriteStartArray("Children");
+                    writer.WriteEndArray();
+                    writer.WriteString("Min", FormatSensorValue(sensor.Min, sensor.SensorType));
+                    writer.WriteString("Value", FormatSensorValue(sensor.Value, sensor.SensorType));
+                    writer.WriteString("Max", FormatSensorValue(sensor.Max, sensor.SensorType));
+                    writer.WriteString("SensorId", sensor.Identifier.ToString());
+                    writer.WriteString("Type", sensor.SensorType.ToString());
+                    writer.WriteString("ImageURL", "");
+                    writer.WriteEndObject();
+                }
                 
-                nodes.Add(groupNode);
+                writer.WriteEndArray();
+                writer.WriteString("Min", "");
+                writer.WriteString("Value", "");
+                writer.WriteString("Max", "");
+                writer.WriteString("ImageURL", "");
+                writer.WriteEndObject();
             }
-            
-            return nodes;
         }
         
         private static string GetHardwareImageUrl(HardwareType type)
@@ -0,0 +1,83 @@
+#if NATIVE_AOT
+using System;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace LibreHardwareMonitorNative
+{
+    /// <summary>
+    /// C exports of the ahead-of-time compiled bridge (LibreHardwareMonitorBridge.Native.dll).
+    /// Each LHM_* entry point has the signature of the matching *Delegate in
+    /// HardwareMonitorBridge and forwards to it, so the native addon can load the
+    /// bridge with LoadLibrary/GetProcAddress instead of through hostfxr.
+    /// bool parameters arrive as one byte (C++ bool); UnmanagedCallersOnly methods
+    /// only take blittable types. The forwarded methods catch their own exceptions,
+    /// which must not escape into native code.
+    /// </summary>
+    public static class NativeExports
+    {
+        [UnmanagedCallersOnly(EntryPoint = "LHM_Initialize", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int Initialize(
+            byte cpu, byte gpu, byte motherboard, byte memory, byte storage, byte network,
+            byte psu, byte controller, byte battery, byte dimmDetection, byte physicalNetworkOnly)
+        {
+            return HardwareMonitorBridge.Initialize(
+                cpu != 0, gpu != 0, motherboard != 0, memory != 0, storage != 0, network != 0,
+                psu != 0, controller != 0, battery != 0, dimmDetection != 0, physicalNetworkOnly != 0);
+        }
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_Reconfigure", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int Reconfigure(
+            byte cpu, byte gpu, byte motherboard, byte memory, byte storage, byte network,
+            byte psu, byte controller, byte battery, byte dimmDetection, byte physicalNetworkOnly)
+        {
+            return HardwareMonitorBridge.Reconfigure(
+                cpu != 0, gpu != 0, motherboard != 0, memory != 0, storage != 0, network != 0,
+                psu != 0, controller != 0, battery != 0, dimmDetection != 0, physicalNetworkOnly != 0);
+        }
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_Poll", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static IntPtr Poll() => HardwareMonitorBridge.Poll();
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_PollWithin", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static IntPtr PollWithin(int budgetMs, IntPtr skippedHardware)
+            => HardwareMonitorBridge.PollWithin(budgetMs, skippedHardware);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_PollInto", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int PollInto(IntPtr buffer, int capacity, int budgetMs, int filterPresets, IntPtr skippedHardware)
+            => HardwareMonitorBridge.PollInto(buffer, capacity, budgetMs, filterPresets, skippedHardware);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_FreeString", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static void FreeString(IntPtr ptr) => HardwareMonitorBridge.FreeString(ptr);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_Shutdown", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static void Shutdown() => HardwareMonitorBridge.Shutdown();
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_GetSchema", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static IntPtr GetSchema() => HardwareMonitorBridge.GetSchema();
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_GetSchemaGeneration", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int GetSchemaGeneration() => HardwareMonitorBridge.GetSchemaGeneration();
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_Update", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int Update(int categoryMask) => HardwareMonitorBridge.Update(categoryMask);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_ReadValues", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int ReadValues(IntPtr values, IntPtr mins, IntPtr maxs, int capacity)
+            => HardwareMonitorBridge.ReadValues(values, mins, maxs, capacity);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_SetFilter", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int SetFilter(IntPtr filterJson) => HardwareMonitorBridge.SetFilter(filterJson);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_GetMemoryStats", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int GetMemoryStats(IntPtr stats, int capacity) => HardwareMonitorBridge.GetMemoryStats(stats, capacity);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_UpdateHardware", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int UpdateHardware(IntPtr indices, int count) => HardwareMonitorBridge.UpdateHardware(indices, count);
+
+        [UnmanagedCallersOnly(EntryPoint = "LHM_ReadSensorValues", CallConvs = new[] { typeof(CallConvCdecl) })]
+        public static int ReadSensorValues(IntPtr indices, IntPtr values, int count)
+            => HardwareMonitorBridge.ReadSensorValues(indices, values, count);
+    }
+}
+#endif
@@ -0,0 +1,267 @@
+using System.Buffers.Binary;
+using System.Text;
+
+namespace LibreMonCLI;
+
+/// <summary>
+/// Length-prefixed binary framing, negotiated with {"cmd":"binary","version":1}
+/// Every frame (little endian): u32 length of the rest | u8 type | u32 requestId | payload
+/// Requests are answered in order; the client may pipeline any number of them.
+/// </summary>
+public static class BinaryProtocol
+{
+    public const int Version = 1;
+    public const int HeaderSize = 9;                 // length + type + requestId
+    public const int MaxFrameSize = 16 * 1024 * 1024;
+
+    // Client -> daemon
+    public const byte FrameCommand = 0x01;           // UTF-8 JSON command (same as NDJSON mode)
+    public const byte FramePoll = 0x02;              // no payload: value-only poll
+
+    // Daemon -> client
+    public const byte FrameResponse = 0x81;          // UTF-8 JSON response
+    public const byte FrameSchema = 0x82;            // UTF-8 JSON SchemaData, sent before the first values of a generation
+    public const byte FrameValues = 0x83;            // i32 generation | f64 timestamp | i32 count | f32[count]
+    public const byte FrameDelta = 0x84;             // i32 generation | f64 timestamp | i32 changed | (u32 index, f32 value)[changed]
+
+    public const int ValuesHeaderSize = 16;
+}
+
+/// <summary>
+/// Buffered stdin reader that can switch from line to frame reading
+/// without losing bytes already read past the negotiation line
+/// </summary>
+public sealed class DaemonInput
+{
+    private readonly Stream _stream;
+    private byte[] _buffer = new byte[64 * 1024];
+    private int _start;
+    private int _end;
+
+    public DaemonInput(Stream stream)
+    {
+        _stream = stream;
+    }
+
+    /// <summary>
+    /// Read one UTF-8 line (without the line terminator), null at EOF
+    /// </summary>
+    public async Task<string?> ReadLineAsync()
+    {
+        int scanned = _start;
+        while (true)
+        {
+            int newline = Array.IndexOf(_buffer, (byte)'\n', scanned, _end - scanned);
+            if (newline >= 0)
+            {
+                int length = newline - _start;
+                if (length > 0 && _buffer[newline - 1] == (byte)'\r')
+                    length--;
+
+                var line = Encoding.UTF8.GetString(_buffer, _start, length);
+                _start = newline + 1;
+                return line;
+            }
+
+            scanned = _end;
+            int offset = _start;
+            if (!await FillAsync())
+            {
+                if (_start == _end)
+                    return null;
+
+                var rest = Encoding.UTF8.GetString(_buffer, _start, _end - _start);
+                _start = _end;
+                return rest;
+            }
+            scanned -= offset - _start;  // FillAsync may have compacted the buffer
+        }
+    }
+
+    /// <summary>
+    /// Read one frame; payload is valid until the next call
+    /// </summary>
+    /// <returns>false at EOF on a frame boundary</returns>
+    public async Task<(bool ok, byte type, uint requestId, ArraySegment<byte> payload)> ReadFrameAsync()
+    {
+        if (!await EnsureAsync(4))
+            return (false, 0, 0, default);
+
+        int length = BinaryPrimitives.ReadInt32LittleEndian(_buffer.AsSpan(_start, 4));
+        if (length < BinaryProtocol.HeaderSize - 4 || length > BinaryProtocol.MaxFrameSize)
+            throw new InvalidDataException($"Invalid frame length: {length}");
+
+        if (!await EnsureAsync(4 + length))
+            throw new EndOfStreamException("Truncated frame");
+
+        byte type = _buffer[_start + 4];
+        uint requestId = BinaryPrimitives.ReadUInt32LittleEndian(_buffer.AsSpan(_start + 5, 4));
+        var payload = new ArraySegment<byte>(_buffer, _start + BinaryProtocol.HeaderSize, 4 + length - BinaryProtocol.HeaderSize);
+        _start += 4 + length;
+        return (true, type, requestId, payload);
+    }
+
+    private async Task<bool> EnsureAsync(int count)
+    {
+        while (_end - _start < count)
+        {
+            if (_buffer.Length < count)
+            {
+                var larger = new byte[Math.Max(count, _buffer.Length * 2)];
+                Buffer.BlockCopy(_buffer, _start, larger, 0, _end - _start);
+                _end -= _start;
+                _start = 0;
+                _buffer = larger;
+            }
+
+            if (!await FillAsync())
+            {
+                if (_end == _start)
+                    return false;
+                throw new EndOfStreamException("Truncated frame");
+            }
+        }
+        return true;
+    }
+
+    private async Task<bool> FillAsync()
+    {
+        if (_start > 0 && _end == _buffer.Length)
+        {
+            Buffer.BlockCopy(_buffer, _start, _buffer, 0, _end - _start);
+            _end -= _start;
+            _start = 0;
+        }
+        else if (_start == 0 && _end == _buffer.Length)
+        {
+            Array.Resize(ref _buffer, _buffer.Length * 2);
+        }
+
+        int read = await _stream.ReadAsync(_buffer.AsMemory(_end, _buffer.Length - _end));
+        if (read <= 0)
+            return false;
+
+        _end += read;
+        return true;
+    }
+}
+
+/// <summary>
+/// Writes binary frames to stdout, reusing one output buffer
+/// Safe to call from the request loop and a subscription concurrently.
+/// </summary>
+public sealed class FrameWriter
+{
+    private readonly Stream _stream;
+    private readonly SemaphoreSlim _gate = new(1, 1);
+    private byte[] _buffer = new byte[64 * 1024];
+
+    public FrameWriter(Stream stream)
+    {
+        _stream = stream;
+    }
+
+    public async Task WriteJsonAsync(byte type, uint requestId, string json)
+    {
+        await _gate.WaitAsync();
+        try
+        {
+            await SendAsync(EncodeJson(type, requestId, json));
+        }
+        finally
+        {
+            _gate.Release();
+        }
+    }
+
+    public async Task WriteValuesAsync(uint requestId, int generation, double timestamp, ReadOnlyMemory<float> values)
+    {
+        await _gate.WaitAsync();
+        try
+        {
+            await SendAsync(EncodeValues(requestId, generation, timestamp, values.Span));
+        }
+        finally
+        {
+            _gate.Release();
+        }
+    }
+
+    /// <summary>
+    /// Write the values at the given indices only
+    /// </summary>
+    public async Task WriteDeltaAsync(uint requestId, int generation, double timestamp, ReadOnlyMemory<int> indices, float[] values)
+    {
+        await _gate.WaitAsync();
+        try
+        {
+            await SendAsync(EncodeDelta(requestId, generation, timestamp, indices.Span, values));
+        }
+        finally
+        {
+            _gate.Release();
+        }
+    }
+
+    private int EncodeJson(byte type, uint requestId, string json)
+    {
+        int payloadLength = Encoding.UTF8.GetByteCount(json);
+        var frame = Begin(type, requestId, payloadLength);
+        Encoding.UTF8.GetBytes(json, frame.Slice(BinaryProtocol.HeaderSize));
+        return BinaryProtocol.HeaderSize + payloadLength;
+    }
+
+    private int EncodeValues(uint requestId, int generation, double timestamp, ReadOnlySpan<float> values)
+    {
+        int payloadLength = BinaryProtocol.ValuesHeaderSize + values.Length * sizeof(float);
+        var frame = Begin(BinaryProtocol.FrameValues, requestId, payloadLength);
+        var payload = frame.Slice(BinaryProtocol.HeaderSize);
+        BinaryPrimitives.WriteInt32LittleEndian(payload, generation);
+        BinaryPrimitives.WriteDoubleLittleEndian(payload.Slice(4), timestamp);
+        BinaryPrimitives.WriteInt32LittleEndian(payload.Slice(12), values.Length);
+
+        var data = payload.Slice(BinaryProtocol.ValuesHeaderSize);
+        for (int i = 0; i < values.Length; i++)
+        {
+            BinaryPrimitives.WriteSingleLittleEndian(data.Slice(i * sizeof(float)), values[i]);
+        }
+        return BinaryProtocol.HeaderSize + payloadLength;
+    }
+
+    private int EncodeDelta(uint requestId, int generation, double timestamp, ReadOnlySpan<int> indices, float[] values)
+    {
+        int payloadLength = BinaryProtocol.ValuesHeaderSize + indices.Length * 8;
+        var frame = Begin(BinaryProtocol.FrameDelta, requestId, payloadLength);
+        var payload = frame.Slice(BinaryProtocol.HeaderSize);
+        BinaryPrimitives.WriteInt32LittleEndian(payload, generation);
+        BinaryPrimitives.WriteDoubleLittleEndian(payload.Slice(4), timestamp);
+        BinaryPrimitives.WriteInt32LittleEndian(payload.Slice(12), indices.Length);
+
+        var data = payload.Slice(BinaryProtocol.ValuesHeaderSize);
+        for (int i = 0; i < indices.Length; i++)
+        {
+            BinaryPrimitives.WriteUInt32LittleEndian(data.Slice(i * 8), (uint)indices[i]);
+            BinaryPrimitives.WriteSingleLittleEndian(data.Slice(i * 8 + 4), values[indices[i]]);
+        }
+        return BinaryProtocol.HeaderSize + payloadLength;
+    }
+
+    private Span<byte> Begin(byte type, uint requestId, int payloadLength)
+    {
+        int total = BinaryProtocol.HeaderSize + payloadLength;
+        if (_buffer.Length < total)
+            _buffer = new byte[Math.Max(total, _buffer.Length * 2)];
+
+        var frame = _buffer.AsSpan(0, total);
+        BinaryPrimitives.WriteInt32LittleEndian(frame, total - 4);
+        frame[4] = type;
+        BinaryPrimitives.WriteUInt32LittleEndian(frame.Slice(5), requestId);
+        return frame;
+    }
+
+    private async Task SendAsync(int length)
+    {
+        await _stream.WriteAsync(_buffer.AsMemory(0, length));
+        await _stream.FlushAsync();
+    }
+}
@@ -14,6 +14,12 @@ public class HardwareMonitor
     private static bool _useFlatMode = false;
     private static readonly object _lock = new();
     
+    // Value-vector layout for binary polls, rebuilt when hardware is added/removed
+    private static SchemaData? _schema;
+    private static ISensor[] _schemaSensors = Array.Empty<ISensor>();
+    private static int _schemaGeneration = 0;
+    private static bool _schemaDirty = true;
+    
     public static bool IsInitialized
     {
         get
@@ -61,7 +67,10 @@ public class HardwareMonitor
             };
             
             Console.Error.WriteLine($"DEBUG: Opening computer with storage enabled: {_computer.IsStorageEnabled}");
+            _computer.HardwareAdded += OnHardwareChanged;
+            _computer.HardwareRemoved += OnHardwareChanged;
             _computer.Open();
+            _schemaDirty = true;
             
             // Debug: Check what hardware was actually added
             Console.Error.WriteLine($"DEBUG: Hardware count after Open: {_computer.Hardware.Count}");
@@ -105,6 +114,51 @@ public class HardwareMonitor
         }
     }
     
+    /// <summary>
+    /// Current value-vector layout (see CollectValues)
+    /// </summary>
+    public static SchemaData GetSchema()
+    {
+        lock (_lock)
+        {
+            if (!_isInitialized || _computer == null)
+                throw new InvalidOperationException("Not initialized");
+            
+            return EnsureSchema();
+        }
+    }
+    
+    /// <summary>
+    /// Update all hardware and copy every sensor value in schema order (NaN = no value)
+    /// Builds no JSON; used by binary value polls.
+    /// </summary>
+    /// <param name="values">Reused output array, grown when needed</param>
+    /// <returns>Sensor count and the schema the values are laid out by</returns>
+    public static (int count, SchemaData schema) CollectValues(ref float[] values)
+    {
+        lock (_lock)
+        {
+            if (!_isInitialized || _computer == null)
+                throw new InvalidOperationException("Not initialized");
+            
+            foreach (var hardware in _computer.Hardware)
+            {
+                UpdateHardwareRecursive(hardware);
+            }
+            
+            var schema = EnsureSchema();
+            var sensors = _schemaSensors;
+            if (values.Length < sensors.Length)
+                values = new float[sensors.Length];
+            
+            for (int i = 0; i < sensors.Length; i++)
+            {
+                values[i] = sensors[i].Value ?? float.NaN;
+            }
+            return (sensors.Length, schema);
+        }
+    }
+    
     /// <summary>
     /// Shutdown and cleanup
     /// </summary>
@@ -114,11 +168,70 @@ public class HardwareMonitor
         {
             if (_computer != null)
             {
+                _computer.HardwareAdded -= OnHardwareChanged;
+                _computer.HardwareRemoved -= OnHardwareChanged;
                 _computer.Close();
                 _computer = null;
             }
             _isInitialized = false;
             _useFlatMode = false;
+            _schema = null;
+            _schemaSensors = Array.Empty<ISensor>();
+            _schemaDirty = true;
+        }
+    }
+    
+    private static void OnHardwareChanged(IHardware hardware)
+    {
+        _schemaDirty = true;
+    }
+    
+    /// <summary>
+    /// Rebuild the schema if hardware changed (caller holds _lock)
+    /// Hardware depth-first; sensors grouped by type in enum order like BuildSensorGroups,
+    /// but including sensors that currently have no value.
+    /// </summary>
+    private static SchemaData EnsureSchema()
+    {
+        if (_schema != null && !_schemaDirty)
+            return _schema;
+        
+        var schema = new SchemaData { generation = ++_schemaGeneration };
+        var sensors = new List<ISensor>();
+        AddSchemaHardware(_computer!.Hardware, -1, schema, sensors);
+        
+        _schema = schema;
+        _schemaSensors = sensors.ToArray();
+        _schemaDirty = false;
+        return schema;
+    }
+    
+    private static void AddSchemaHardware(IEnumerable<IHardware> hardwareList, int parent, SchemaData schema, List<ISensor> sensors)
+    {
+        foreach (var hardware in hardwareList)
+        {
+            int index = schema.hardware.Count;
+            schema.hardware.Add(new SchemaHardware
+            {
+                parent = parent,
+                type = hardware.HardwareType.ToString(),
+                id = hardware.Identifier.ToString(),
+                name = hardware.Name
+            });
+            
+            foreach (var sensor in hardware.Sensors.OrderBy(s => (int)s.SensorType))
+            {
+                schema.sensors.Add(new SchemaSensor
+                {
+                    hardware = index,
+                    type = sensor.SensorType.ToString(),
+                    id = sensor.Identifier.ToString(),
+                    name = sensor.Name
+                });
+                sensors.Add(sensor);
+            }
+            
+            AddSchemaHardware(hardware.SubHardware, index, schema, sensors);
         }
     }
     
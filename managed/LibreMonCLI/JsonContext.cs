@@ -13,12 +13,19 @@ namespace LibreMonCLI;
 [JsonSerializable(typeof(PollCommand))]
 [JsonSerializable(typeof(ShutdownCommand))]
 [JsonSerializable(typeof(VersionCommand))]
+[JsonSerializable(typeof(ProtocolCommand))]
+[JsonSerializable(typeof(SubscribeCommand))]
 [JsonSerializable(typeof(Response))]
 [JsonSerializable(typeof(InitResponse))]
 [JsonSerializable(typeof(PollResponse))]
 [JsonSerializable(typeof(ShutdownResponse))]
 [JsonSerializable(typeof(VersionResponse))]
 [JsonSerializable(typeof(ErrorResponse))]
+[JsonSerializable(typeof(ProtocolResponse))]
+[JsonSerializable(typeof(SubscribeResponse))]
+[JsonSerializable(typeof(SchemaData))]
+[JsonSerializable(typeof(SchemaHardware))]
+[JsonSerializable(typeof(SchemaSensor))]
 [JsonSerializable(typeof(RawData))]
 [JsonSerializable(typeof(RawNode))]
 [JsonSerializable(typeof(FlatData))]
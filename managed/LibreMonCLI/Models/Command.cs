@@ -37,3 +37,20 @@ public class ShutdownCommand : Command
 public class VersionCommand : Command
 {
 }
+
+/// <summary>
+/// Switch the connection to binary framing (see BinaryProtocol)
+/// </summary>
+public class ProtocolCommand : Command
+{
+    public int version { get; set; } = 1;
+}
+
+/// <summary>
+/// subscribe / rate command (binary protocol only)
+/// </summary>
+public class SubscribeCommand : Command
+{
+    public int intervalMs { get; set; } = 1000;
+    public bool delta { get; set; } = false;
+}
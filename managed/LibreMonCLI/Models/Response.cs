@@ -47,6 +47,28 @@ public class VersionResponse : Response
     public string? platform { get; set; }
 }
 
+/// <summary>
+/// Protocol switch response (last NDJSON line before binary frames)
+/// </summary>
+public class ProtocolResponse : Response
+{
+    public string? protocol { get; set; }
+    public int version { get; set; }
+}
+
+/// <summary>
+/// subscribe / rate / unsubscribe response
+/// Frames of the subscription carry the request ID of the subscribe command.
+/// </summary>
+public class SubscribeResponse : Response
+{
+    public bool subscribed { get; set; }
+    public uint subscriptionId { get; set; }
+    public int intervalMs { get; set; }
+    public bool delta { get; set; }
+    public long coalesced { get; set; }
+}
+
 /// <summary>
 /// Error response
 /// </summary>
@@ -0,0 +1,34 @@
+namespace LibreMonCLI.Models;
+
+/// <summary>
+/// Sensor layout of binary value frames
+/// values[i] belongs to sensors[i]; sent once per generation
+/// </summary>
+public class SchemaData
+{
+    public int generation { get; set; }
+    public List<SchemaHardware> hardware { get; set; } = new();
+    public List<SchemaSensor> sensors { get; set; } = new();
+}
+
+/// <summary>
+/// Hardware entry (depth-first order, parent = index or -1)
+/// </summary>
+public class SchemaHardware
+{
+    public int parent { get; set; } = -1;
+    public string type { get; set; } = string.Empty;
+    public string id { get; set; } = string.Empty;
+    public string name { get; set; } = string.Empty;
+}
+
+/// <summary>
+/// Sensor entry (hardware = index into hardware)
+/// </summary>
+public class SchemaSensor
+{
+    public int hardware { get; set; }
+    public string type { get; set; } = string.Empty;
+    public string id { get; set; } = string.Empty;
+    public string name { get; set; } = string.Empty;
+}
@@ -46,10 +46,12 @@ class Program
     
     /// <summary>
     /// Run daemon mode: read newline-delimited JSON from stdin, write responses to stdout
+    /// {"cmd":"binary"} switches both directions to length-prefixed frames (see BinaryProtocol)
     /// </summary>
     static async Task<int> RunDaemonMode()
     {
         bool shouldExit = false;
+        var input = new DaemonInput(Console.OpenStandardInput());
         
         // Daemon loop: read commands from stdin until shutdown
         while (!shouldExit)
@@ -57,7 +59,7 @@ class Program
             try
             {
                 // Read one line from stdin (blocking)
-                var line = await Console.In.ReadLineAsync();
+                var line = await input.ReadLineAsync();
                 
                 // EOF or null means stdin closed
                 if (line == null)
@@ -67,42 +69,20 @@ class Program
                 if (string.IsNullOrWhiteSpace(line))
                     continue;
                 
-                // Parse JSON command
-                Command? command;
-                try
-                {
-                    command = JsonSerializer.Deserialize(line, JsonContext.Default.Command);
-                }
-                catch (JsonException ex)
-                {
-                    // Invalid JSON input
-                    var error = new ErrorResponse($"Invalid JSON: {ex.Message}", "INVALID_JSON");
-                    await WriteResponse(error);
-                    continue;
-                }
+                var (response, cmd) = HandleCommandJson(line);
                 
-                if (command == null || string.IsNullOrEmpty(command.cmd))
+                if (cmd == "binary" && response.success)
                 {
-                    var error = new ErrorResponse("Missing 'cmd' field", "INVALID_COMMAND");
-                    await WriteResponse(error);
-                    continue;
+                    // Last NDJSON line; everything after it is framed
+                    await WriteResponse(response);
+                    return await RunBinaryMode(input);
                 }
                 
-                // Route to appropriate handler
-                Response response = command.cmd.ToLowerInvariant() switch
-                {
-                    "init" => HandleInitCommand(line),
-                    "poll" => CommandHandler.HandlePoll(),
-                    "shutdown" => CommandHandler.HandleShutdown(),
-                    "version" => CommandHandler.HandleVersion(),
-                    _ => new ErrorResponse($"Unknown command: {command.cmd}", "UNKNOWN_COMMAND")
-                };
-                
                 // Write JSON response to stdout with newline
                 await WriteResponse(response);
                 
                 // Exit daemon loop if shutdown command
-                if (command.cmd.ToLowerInvariant() == "shutdown")
+                if (cmd == "shutdown")
                     shouldExit = true;
             }
             catch (Exception ex)
@@ -119,6 +99,216 @@ class Program
         return 0; // Clean exit
     }
     
+    /// <summary>
+    /// Binary daemon loop: answer framed requests in order, value-only polls
+    /// carry a schema frame only when the layout generation changed
+    /// </summary>
+    static async Task<int> RunBinaryMode(DaemonInput input)
+    {
+        var output = new FrameWriter(Console.OpenStandardOutput());
+        var values = Array.Empty<float>();
+        int sentGeneration = 0;
+        Subscription? subscription = null;
+        
+        while (true)
+        {
+            var (ok, type, requestId, payload) = await input.ReadFrameAsync();
+            if (!ok)
+                break;
+            
+            try
+            {
+                if (type == BinaryProtocol.FramePoll)
+                {
+                    if (!HardwareMonitor.IsInitialized)
+                    {
+                        var error = new ErrorResponse("Not initialized. Send 'init' command first.", "NOT_INITIALIZED");
+                        await output.WriteJsonAsync(BinaryProtocol.FrameResponse, requestId, SerializeResponse(error));
+                        continue;
+                    }
+                    
+                    var (count, schema) = HardwareMonitor.CollectValues(ref values);
+                    var timestamp = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+                    if (schema.generation != sentGeneration)
+                    {
+                        await output.WriteJsonAsync(BinaryProtocol.FrameSchema, requestId,
+                            JsonSerializer.Serialize(schema, JsonContext.Default.SchemaData));
+                        sentGeneration = schema.generation;
+                    }
+                    await output.WriteValuesAsync(requestId, schema.generation, timestamp, values.AsMemory(0, count));
+                }
+                else if (type == BinaryProtocol.FrameCommand)
+                {
+                    var json = System.Text.Encoding.UTF8.GetString(payload.AsSpan());
+                    var cmd = PeekCommandName(json);
+                    
+                    if (cmd is "subscribe" or "rate" or "unsubscribe")
+                    {
+                        Response subscribeResponse;
+                        (subscribeResponse, subscription) = await HandleSubscriptionCommand(cmd, json, requestId, output, subscription);
+                        await output.WriteJsonAsync(BinaryProtocol.FrameResponse, requestId, SerializeResponse(subscribeResponse));
+                        subscription?.Start();
+                        continue;
+                    }
+                    
+                    // The subscription samples the Computer; stop it before it goes away
+                    if (subscription != null && (cmd == "init" || cmd == "shutdown"))
+                    {
+                        await subscription.StopAsync();
+                        subscription = null;
+                    }
+                    
+                    Response response;
+                    (response, cmd) = HandleCommandJson(json);
+                    if (cmd == "init" || cmd == "shutdown")
+                        sentGeneration = 0;
+                    
+                    await output.WriteJsonAsync(BinaryProtocol.FrameResponse, requestId, SerializeResponse(response));
+                    
+                    if (cmd == "shutdown")
+                        break;
+                }
+                else
+                {
+                    var error = new ErrorResponse($"Unknown frame type: 0x{type:X2}", "UNKNOWN_COMMAND");
+                    await output.WriteJsonAsync(BinaryProtocol.FrameResponse, requestId, SerializeResponse(error));
+                }
+            }
+            catch (Exception ex)
+            {
+                await Console.Error.WriteLineAsync($"Error: {ex.Message}");
+                await Console.Error.WriteLineAsync(ex.StackTrace);
+                
+                var error = new ErrorResponse($"Internal error: {ex.Message}", "INTERNAL_ERROR");
+                await output.WriteJsonAsync(BinaryProtocol.FrameResponse, requestId, SerializeResponse(error));
+            }
+        }
+        
+        if (subscription != null)
+            await subscription.StopAsync();
+        
+        return 0;
+    }
+    
+    /// <summary>
+    /// subscribe / rate / unsubscribe (binary protocol only, one subscription per connection)
+    /// </summary>
+    /// <returns>Response and the connection's subscription afterwards</returns>
+    static async Task<(Response response, Subscription? subscription)> HandleSubscriptionCommand(
+        string cmd, string json, uint requestId, FrameWriter output, Subscription? subscription)
+    {
+        SubscribeCommand? command;
+        try
+        {
+            command = JsonSerializer.Deserialize(json, JsonContext.Default.SubscribeCommand);
+        }
+        catch (JsonException ex)
+        {
+            return (new ErrorResponse($"Invalid {cmd} command: {ex.Message}", "INVALID_JSON"), subscription);
+        }
+        
+        if (cmd == "unsubscribe")
+        {
+            if (subscription == null)
+                return (new ErrorResponse("Not subscribed", "NOT_SUBSCRIBED"), null);
+            
+            // Returns after the last frame is written, so the response is the end of the stream
+            await subscription.StopAsync();
+            return (DescribeSubscription(subscription, subscribed: false), null);
+        }
+        
+        if (command == null || command.intervalMs < Subscription.MinIntervalMs)
+            return (new ErrorResponse($"intervalMs must be at least {Subscription.MinIntervalMs}", "INVALID_COMMAND"), subscription);
+        
+        if (cmd == "rate")
+        {
+            if (subscription == null)
+                return (new ErrorResponse("Not subscribed", "NOT_SUBSCRIBED"), null);
+            
+            subscription.SetInterval(command.intervalMs);
+            return (DescribeSubscription(subscription, subscribed: true), subscription);
+        }
+        
+        if (subscription != null)
+            return (new ErrorResponse("Already subscribed; use 'rate' or 'unsubscribe'", "ALREADY_SUBSCRIBED"), subscription);
+        
+        if (!HardwareMonitor.IsInitialized)
+            return (new ErrorResponse("Not initialized. Send 'init' command first.", "NOT_INITIALIZED"), null);
+        
+        // Started by the caller once this response is written
+        subscription = new Subscription(output, requestId, command.intervalMs, command.delta);
+        return (DescribeSubscription(subscription, subscribed: true), subscription);
+    }
+    
+    static SubscribeResponse DescribeSubscription(Subscription subscription, bool subscribed)
+    {
+        return new SubscribeResponse
+        {
+            success = true,
+            subscribed = subscribed,
+            subscriptionId = subscription.RequestId,
+            intervalMs = subscription.IntervalMs,
+            delta = subscription.Delta,
+            coalesced = subscription.Coalesced
+        };
+    }
+    
+    /// <summary>
+    /// Lower-cased "cmd" of a JSON command, null if it has none
+    /// </summary>
+    static string? PeekCommandName(string json)
+    {
+        try
+        {
+            var command = JsonSerializer.Deserialize(json, JsonContext.Default.Command);
+            return string.IsNullOrEmpty(command?.cmd) ? null : command.cmd.ToLowerInvariant();
+        }
+        catch (JsonException)
+        {
+            return null;
+        }
+    }
+    
+    /// <summary>
+    /// Parse and route one JSON command (shared by NDJSON and binary mode)
+    /// </summary>
+    /// <returns>Response and lower-cased command name (null if invalid)</returns>
+    static (Response response, string? cmd) HandleCommandJson(string json)
+    {
+        // Parse JSON command
+        Command? command;
+        try
+        {
+            command = JsonSerializer.Deserialize(json, JsonContext.Default.Command);
+        }
+        catch (JsonException ex)
+        {
+            // Invalid JSON input
+            return (new ErrorResponse($"Invalid JSON: {ex.Message}", "INVALID_JSON"), null);
+        }
+        
+        if (command == null || string.IsNullOrEmpty(command.cmd))
+        {
+            return (new ErrorResponse("Missing 'cmd' field", "INVALID_COMMAND"), null);
+        }
+        
+        var cmd = command.cmd.ToLowerInvariant();
+        
+        // Route to appropriate handler
+        Response response = cmd switch
+        {
+            "init" => HandleInitCommand(json),
+            "poll" => CommandHandler.HandlePoll(),
+            "shutdown" => CommandHandler.HandleShutdown(),
+            "version" => CommandHandler.HandleVersion(),
+            "binary" => HandleProtocolCommand(json),
+            "subscribe" or "rate" or "unsubscribe" => new ErrorResponse($"'{command.cmd}' requires the binary protocol", "BINARY_REQUIRED"),
+            _ => new ErrorResponse($"Unknown command: {command.cmd}", "UNKNOWN_COMMAND")
+        };
+        
+        return (response, cmd);
+    }
+    
     /// <summary>
     /// Run demo mode: initialize all hardware, perform one poll, show results, wait for user input
     /// </summary>
@@ -204,10 +394,44 @@ class Program
         }
     }
     
+    /// <summary>
+    /// Handle binary protocol switch (only version 1 exists)
+    /// </summary>
+    static Response HandleProtocolCommand(string json)
+    {
+        try
+        {
+            var protocolCmd = JsonSerializer.Deserialize(json, JsonContext.Default.ProtocolCommand);
+            if (protocolCmd == null || protocolCmd.version != BinaryProtocol.Version)
+            {
+                return new ErrorResponse($"Unsupported binary protocol version (supported: {BinaryProtocol.Version})", "UNSUPPORTED_PROTOCOL");
+            }
+            return new ProtocolResponse
+            {
+                success = true,
+                protocol = "binary",
+                version = BinaryProtocol.Version
+            };
+        }
+        catch (JsonException ex)
+        {
+            return new ErrorResponse($"Invalid binary command: {ex.Message}", "INVALID_JSON");
+        }
+    }
+    
     /// <summary>
     /// Write response to stdout as newline-delimited JSON
     /// </summary>
     static async Task WriteResponse(Response response)
+    {
+        await Console.Out.WriteLineAsync(SerializeResponse(response));
+        await Console.Out.FlushAsync();
+    }
+    
+    /// <summary>
+    /// Serialize a response with the source-generated type info
+    /// </summary>
+    static string SerializeResponse(Response response)
     {
         string json;
         
@@ -236,12 +460,15 @@ class Program
             json = JsonSerializer.Serialize(shutdownResp, JsonContext.Default.ShutdownResponse);
         else if (response is VersionResponse versionResp)
             json = JsonSerializer.Serialize(versionResp, JsonContext.Default.VersionResponse);
+        else if (response is SubscribeResponse subscribeResp)
+            json = JsonSerializer.Serialize(subscribeResp, JsonContext.Default.SubscribeResponse);
+        else if (response is ProtocolResponse protocolResp)
+            json = JsonSerializer.Serialize(protocolResp, JsonContext.Default.ProtocolResponse);
         else if (response is ErrorResponse errorResp)
             json = JsonSerializer.Serialize(errorResp, JsonContext.Default.ErrorResponse);
         else
             json = JsonSerializer.Serialize(response, JsonContext.Default.Response);
         
-        await Console.Out.WriteLineAsync(json);
-        await Console.Out.FlushAsync();
+        return json;
     }
 }
@@ -0,0 +1,252 @@
+using System.Buffers;
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+using System.Threading.Channels;
+using LibreMonCLI.Models;
+
+namespace LibreMonCLI;
+
+/// <summary>
+/// Server-push sampling for one binary connection
+/// A dedicated thread samples on absolute deadlines; a writer task streams the
+/// samples. The two are joined by a one-slot channel that drops the older
+/// sample, so a slow reader makes samples coalesce instead of piling up in the pipe.
+/// </summary>
+public sealed class Subscription
+{
+    public const int MinIntervalMs = 10;
+
+    // Pooled = Values came from ArrayPool (CollectValues allocates when it must grow)
+    private readonly record struct Sample(float[] Values, bool Pooled, int Count, SchemaData Schema, double Timestamp);
+
+    private readonly FrameWriter _output;
+    private readonly uint _requestId;
+    private readonly bool _delta;
+    private readonly Channel<Sample> _samples;
+    private readonly AutoResetEvent _wake = new(false);
+    private readonly Thread _thread;
+    private Task? _writer;
+    private bool _started;
+    private volatile int _intervalMs;
+    private volatile bool _stopping;
+    private long _coalesced;
+
+    // Last values written to the client (delta base), touched by the writer only
+    private float[] _sent = Array.Empty<float>();
+    private int _sentCount;
+    private int _sentGeneration;
+
+    public Subscription(FrameWriter output, uint requestId, int intervalMs, bool delta)
+    {
+        _output = output;
+        _requestId = requestId;
+        _delta = delta;
+        _intervalMs = intervalMs;
+        _samples = Channel.CreateBounded<Sample>(
+            new BoundedChannelOptions(1)
+            {
+                FullMode = BoundedChannelFullMode.DropOldest,
+                SingleReader = true,
+                SingleWriter = true
+            },
+            dropped =>
+            {
+                Interlocked.Increment(ref _coalesced);
+                Return(dropped);
+            });
+
+        _thread = new Thread(SampleLoop) { IsBackground = true, Name = "LibreMon subscription" };
+    }
+
+    public uint RequestId => _requestId;
+    public bool Delta => _delta;
+    public int IntervalMs => _intervalMs;
+
+    /// <summary>
+    /// Samples dropped because the client had not taken the previous one yet
+    /// </summary>
+    public long Coalesced => Interlocked.Read(ref _coalesced);
+
+    /// <summary>
+    /// Start sampling (no-op if already started)
+    /// Called once the subscribe response is written, so it precedes the first frame.
+    /// </summary>
+    public void Start()
+    {
+        if (_started)
+            return;
+        _started = true;
+        TimerResolution.Begin();
+        _writer = Task.Run(WriteLoop);
+        _thread.Start();
+    }
+
+    /// <summary>
+    /// Change the sampling interval; applies from the next tick
+    /// </summary>
+    public void SetInterval(int intervalMs)
+    {
+        _intervalMs = intervalMs;
+        _wake.Set();
+    }
+
+    /// <summary>
+    /// Stop sampling and wait until the last queued frame is written
+    /// No frame for this subscription is written after this returns.
+    /// </summary>
+    public async Task StopAsync()
+    {
+        _stopping = true;
+        _wake.Set();
+        if (_started)
+        {
+            await Task.Run(() => _thread.Join());
+            _samples.Writer.TryComplete();
+            await _writer!;
+            TimerResolution.End();
+        }
+        _wake.Dispose();
+    }
+
+    private void SampleLoop()
+    {
+        var clock = Stopwatch.StartNew();
+        double next = 0;
+        bool loggedError = false;
+        int sizeHint = 64;
+
+        while (!_stopping)
+        {
+            try
+            {
+                var rented = ArrayPool<float>.Shared.Rent(sizeHint);
+                var buffer = rented;
+                var (count, schema) = HardwareMonitor.CollectValues(ref buffer);
+                var timestamp = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+                bool pooled = ReferenceEquals(buffer, rented);
+                if (!pooled)
+                    ArrayPool<float>.Shared.Return(rented);
+                sizeHint = Math.Max(sizeHint, count);
+
+                var sample = new Sample(buffer, pooled, count, schema, timestamp);
+                if (!_samples.Writer.TryWrite(sample))
+                    Return(sample);
+                loggedError = false;
+            }
+            catch (Exception ex)
+            {
+                if (!loggedError)
+                    Console.Error.WriteLine($"Subscription sample failed: {ex.Message}");
+                loggedError = true;
+            }
+
+            // Absolute deadlines: update time does not accumulate as drift;
+            // ticks missed by a slow update are skipped, not bunched up
+            int interval = _intervalMs;
+            double now = clock.Elapsed.TotalMilliseconds;
+            next += interval;
+            if (next < now)
+                next = now + interval - (now - next) % interval;
+
+            while (!_stopping)
+            {
+                int wait = (int)Math.Ceiling(next - clock.Elapsed.TotalMilliseconds);
+                if (wait <= 0)
+                    break;
+                if (_wake.WaitOne(wait) && interval != _intervalMs)
+                {
+                    // Rate change: restart the schedule from now
+                    next = clock.Elapsed.TotalMilliseconds + _intervalMs;
+                    interval = _intervalMs;
+                }
+            }
+        }
+    }
+
+    private async Task WriteLoop()
+    {
+        var indices = Array.Empty<int>();
+
+        await foreach (var sample in _samples.Reader.ReadAllAsync())
+        {
+            try
+            {
+                var values = sample.Values;
+                bool newLayout = sample.Schema.generation != _sentGeneration;
+                if (newLayout)
+                {
+                    await _output.WriteJsonAsync(BinaryProtocol.FrameSchema, _requestId,
+                        System.Text.Json.JsonSerializer.Serialize(sample.Schema, JsonContext.Default.SchemaData));
+                    _sentGeneration = sample.Schema.generation;
+                }
+
+                if (!_delta || newLayout || sample.Count != _sentCount)
+                {
+                    await _output.WriteValuesAsync(_requestId, sample.Schema.generation, sample.Timestamp,
+                        values.AsMemory(0, sample.Count));
+                }
+                else
+                {
+                    if (indices.Length < sample.Count)
+                        indices = new int[sample.Count];
+
+                    // Bitwise compare so NaN -> NaN is unchanged
+                    int changed = 0;
+                    for (int i = 0; i < sample.Count; i++)
+                    {
+                        if (BitConverter.SingleToInt32Bits(values[i]) != BitConverter.SingleToInt32Bits(_sent[i]))
+                            indices[changed++] = i;
+                    }
+                    await _output.WriteDeltaAsync(_requestId, sample.Schema.generation, sample.Timestamp,
+                        indices.AsMemory(0, changed), values);
+                }
+
+                if (_sent.Length < sample.Count)
+                    _sent = new float[sample.Count];
+                Array.Copy(values, _sent, sample.Count);
+                _sentCount = sample.Count;
+            }
+            catch (Exception ex)
+            {
+                Console.Error.WriteLine($"Subscription write failed: {ex.Message}");
+            }
+            finally
+            {
+                Return(sample);
+            }
+        }
+    }
+
+    private static void Return(Sample sample)
+    {
+        if (sample.Pooled)
+            ArrayPool<float>.Shared.Return(sample.Values);
+    }
+
+    /// <summary>
+    /// Raise the Windows timer resolution to 1 ms while any subscription runs
+    /// (the default 15.6 ms tick would quantize every wait)
+    /// </summary>
+    private static class TimerResolution
+    {
+        private static int _users;
+
+        [DllImport("winmm.dll")]
+        private static extern uint timeBeginPeriod(uint period);
+
+        [DllImport("winmm.dll")]
+        private static extern uint timeEndPeriod(uint period);
+
+        public static void Begin()
+        {
+            if (Interlocked.Increment(ref _users) == 1 && OperatingSystem.IsWindows())
+                timeBeginPeriod(1);
+        }
+
+        public static void End()
+        {
+            if (Interlocked.Decrement(ref _users) == 0 && OperatingSystem.IsWindows())
+                timeEndPeriod(1);
+        }
+    }
+}
@@ -2,6 +2,7 @@ const { spawn } = require('child_process');
 const { EventEmitter } = require('events');
 const readline = require('readline');
 const path = require('path');
+const protocol = require('./protocol');
 
 /**
  * LibreMonCLI Client - Node.js wrapper for persistent daemon
@@ -14,19 +15,35 @@ const path = require('path');
  * await client.init({ cpu: true, gpu: true, flat: true });
  * const data = await client.poll();
  * await client.shutdown();
+ *
+ * @example
+ * // Binary framing: pipelined requests, value-only polls
+ * const client = new LibreMonClient(null, { protocol: 'binary' });
+ * await client.start();
+ * await client.init({ cpu: true });
+ * const { schema, values } = await client.pollValues();
  */
 class LibreMonClient extends EventEmitter {
   /**
    * Create a new client
-   * @param {string|null} exePath - Path to LibreMonCLI.exe (defaults to dist/NativeLibre_CLI/LibreMonCLI.exe)
+   * @param {string|null} exePath - Path to LibreMonCLI.exe (defaults to dist/NativeLibre_CLI/LibreMonCLI.exe);
+   *   a .js path is run with the current Node.js binary (stand-in daemons for tests)
+   * @param {object} [options]
+   * @param {string} [options.protocol='json'] - 'json' (NDJSON) or 'binary' (negotiated on start)
    */
-  constructor(exePath = null) {
+  constructor(exePath = null, options = {}) {
     super();
     this.exePath = exePath || path.join(__dirname, '..', '..', '..', 'dist', 'NativeLibre_CLI', 'LibreMonCLI.exe');
+    this.requestedProtocol = options.protocol || 'json';
+    this.protocol = 'json';
     this.process = null;
     this.rl = null;
+    this.decoder = null;
     this.isInitialized = false;
+    this.schema = null;
+    this.subscription = null;
     this.responseHandlers = new Map();
+    this.lineQueue = [];
     this.commandId = 0;
   }
 
@@ -40,7 +57,9 @@ class LibreMonClient extends EventEmitter {
         return reject(new Error('Daemon already started'));
       }
 
-      this.process = spawn(this.exePath, ['--daemon'], {
+      const isScript = this.exePath.endsWith('.js');
+      this.process = spawn(isScript ? process.execPath : this.exePath,
+        isScript ? [this.exePath, '--daemon'] : ['--daemon'], {
         stdio: ['pipe', 'pipe', 'pipe']
       });
 
@@ -50,18 +69,20 @@ class LibreMonClient extends EventEmitter {
         crlfDelay: Infinity
       });
 
-      // Handle stdout responses
+      // Handle stdout responses (answered in request order)
       this.rl.on('line', (line) => {
+        let response;
         try {
-          const response = JSON.parse(line);
-          this.emit('response', response);
-
-          // Call pending response handlers
-          this.responseHandlers.forEach((handler, id) => {
-            handler(response);
-          });
+          response = JSON.parse(line);
         } catch (err) {
           this.emit('error', new Error(`Invalid JSON from daemon: ${line}`));
+          return;
+        }
+        this.emit('response', response);
+
+        const id = this.lineQueue.shift();
+        if (id !== undefined) {
+          this.settle(id, response);
         }
       });
 
@@ -78,6 +99,13 @@ class LibreMonClient extends EventEmitter {
         this.isInitialized = false;
         this.process = null;
         this.rl = null;
+        this.decoder = null;
+        this.protocol = 'json';
+        this.subscription = null;
+        this.lineQueue = [];
+        for (const id of [...this.responseHandlers.keys()]) {
+          this.fail(id, new Error('Daemon exited'));
+        }
       });
 
       // Handle spawn errors
@@ -93,53 +121,162 @@ class LibreMonClient extends EventEmitter {
           reject(new Error('Daemon process died immediately'));
         }
       }, 100);
+    }).then(() => {
+      if (this.requestedProtocol === 'binary') {
+        return this.enableBinary();
+      }
     });
   }
 
   /**
-   * Send command and wait for response
-   * @param {object} cmd - Command object
-   * @param {number} timeout - Timeout in milliseconds (default: 5000)
+   * Switch the connection to length-prefixed binary frames
+   * After this, requests are matched by ID and may be pipelined.
+   * @returns {Promise<void>}
+   */
+  async enableBinary() {
+    if (this.protocol === 'binary') {
+      return;
+    }
+    // The ack is the last NDJSON line the daemon writes; stop line parsing
+    // before any frame can arrive
+    await this.sendCommand({ cmd: 'binary', version: protocol.VERSION });
+
+    this.rl.close();
+    this.rl = null;
+    this.decoder = new protocol.FrameDecoder();
+    this.protocol = 'binary';
+    this.process.stdout.on('data', (chunk) => {
+      let frames;
+      try {
+        frames = this.decoder.push(chunk);
+      } catch (err) {
+        this.emit('error', err);
+        this.kill();
+        return;
+      }
+      for (const frame of frames) {
+        this.handleFrame(frame);
+      }
+    });
+    this.process.stdout.resume();
+  }
+
+  handleFrame(frame) {
+    switch (frame.type) {
+      case protocol.FRAME_RESPONSE: {
+        const response = JSON.parse(frame.payload.toString('utf8'));
+        this.emit('response', response);
+        this.settle(frame.requestId, response);
+        break;
+      }
+      case protocol.FRAME_SCHEMA:
+        // Precedes the first values of a new generation
+        this.schema = JSON.parse(frame.payload.toString('utf8'));
+        this.emit('schema', this.schema);
+        break;
+      case protocol.FRAME_VALUES: {
+        const sample = protocol.decodeValues(frame.payload);
+        sample.schema = this.schema;
+        const sub = this.subscription;
+        if (sub && frame.requestId === sub.id) {
+          sub.values = sample.values;
+          this.emit('sample', { ...sample, changed: sample.values.length });
+          break;
+        }
+        const handler = this.responseHandlers.get(frame.requestId);
+        if (handler) {
+          this.responseHandlers.delete(frame.requestId);
+          clearTimeout(handler.timeoutHandle);
+          handler.resolve(sample);
+        }
+        break;
+      }
+      case protocol.FRAME_DELTA: {
+        const sub = this.subscription;
+        if (!sub || frame.requestId !== sub.id || !sub.values) {
+          break; // Stale frame of an ended subscription
+        }
+        const delta = protocol.applyDelta(frame.payload, sub.values);
+        this.emit('sample', { ...delta, values: sub.values, schema: this.schema });
+        break;
+      }
+      default:
+        this.emit('error', new Error(`Unknown frame type from daemon: 0x${frame.type.toString(16)}`));
+    }
+  }
+
+  settle(id, response) {
+    const handler = this.responseHandlers.get(id);
+    if (!handler) {
+      return; // Already timed out
+    }
+    this.responseHandlers.delete(id);
+    clearTimeout(handler.timeoutHandle);
+
+    if (response.success) {
+      handler.resolve(response);
+    } else {
+      handler.reject(new Error(response.error || 'Unknown error'));
+    }
+  }
+
+  fail(id, err) {
+    const handler = this.responseHandlers.get(id);
+    if (handler) {
+      this.responseHandlers.delete(id);
+      clearTimeout(handler.timeoutHandle);
+      handler.reject(err);
+    }
+  }
+
+  /**
+   * Register a pending request and write its bytes
    * @returns {Promise<object>}
    */
-  async sendCommand(cmd, timeout = 5000) {
+  request(data, timeout) {
     return new Promise((resolve, reject) => {
       if (!this.process || this.process.killed) {
         return reject(new Error('Daemon not running'));
       }
 
-      const commandId = this.commandId++;
-      let timeoutHandle;
+      // IDs are u32 on the wire; 0 is reserved for unsolicited frames
+      this.commandId = (this.commandId % 0xFFFFFFFF) + 1;
+      const commandId = this.commandId;
 
-      const handler = (response) => {
-        clearTimeout(timeoutHandle);
-        this.responseHandlers.delete(commandId);
-
-        if (response.success) {
-          resolve(response);
-        } else {
-          reject(new Error(response.error || 'Unknown error'));
-        }
-      };
-
-      timeoutHandle = setTimeout(() => {
+      const timeoutHandle = setTimeout(() => {
         this.responseHandlers.delete(commandId);
         reject(new Error('Command timeout'));
       }, timeout);
 
-      this.responseHandlers.set(commandId, handler);
+      this.responseHandlers.set(commandId, { resolve, reject, timeoutHandle });
 
       try {
-        const json = JSON.stringify(cmd);
-        this.process.stdin.write(json + '\n');
+        const bytes = typeof data === 'function' ? data(commandId) : data;
+        if (this.protocol === 'json') {
+          this.lineQueue.push(commandId);
+        }
+        this.process.stdin.write(bytes);
       } catch (err) {
-        this.responseHandlers.delete(commandId);
-        clearTimeout(timeoutHandle);
-        reject(err);
+        this.fail(commandId, err);
       }
     });
   }
 
+  /**
+   * Send command and wait for response
+   * @param {object} cmd - Command object
+   * @param {number} timeout - Timeout in milliseconds (default: 5000)
+   * @returns {Promise<object>}
+   */
+  async sendCommand(cmd, timeout = 5000) {
+    const json = JSON.stringify(cmd);
+    if (this.protocol === 'binary') {
+      const payload = Buffer.from(json, 'utf8');
+      return this.request((id) => protocol.encodeFrame(protocol.FRAME_COMMAND, id, payload), timeout);
+    }
+    return this.request(json + '\n', timeout);
+  }
+
   /**
    * Initialize hardware monitoring
    * @param {object} options - Hardware options
@@ -196,6 +333,79 @@ class LibreMonClient extends EventEmitter {
     return this.sendCommand({ cmd: 'poll' });
   }
 
+  /**
+   * Poll sensor values only (binary protocol)
+   * values[i] belongs to schema.sensors[i]; NaN = no value. The schema is
+   * sent by the daemon once per hardware layout generation and cached.
+   * @param {number} timeout - Timeout in milliseconds (default: 5000)
+   * @returns {Promise<{generation:number, timestamp:number, values:Float32Array, schema:object}>}
+   */
+  async pollValues(timeout = 5000) {
+    if (this.protocol !== 'binary') {
+      throw new Error('pollValues() requires the binary protocol');
+    }
+    if (!this.isInitialized) {
+      throw new Error('Not initialized. Call init() first.');
+    }
+    return this.request((id) => protocol.encodeFrame(protocol.FRAME_POLL, id), timeout);
+  }
+
+  /**
+   * Have the daemon sample on its own timer and push every sample (binary protocol)
+   * Emits 'sample' events: { generation, timestamp, values, schema, changed }.
+   * With delta: true only changed values cross the pipe; `values` is then one
+   * Float32Array updated in place, copy it to keep a sample. A slow reader
+   * makes the daemon drop older samples instead of queueing them.
+   * @param {object} [options]
+   * @param {number} [options.intervalMs=1000]
+   * @param {boolean} [options.delta=false]
+   * @returns {Promise<object>} subscribe response
+   */
+  async subscribe(options = {}) {
+    if (this.protocol !== 'binary') {
+      throw new Error('subscribe() requires the binary protocol');
+    }
+    if (this.subscription) {
+      throw new Error('Already subscribed');
+    }
+    const { intervalMs = 1000, delta = false } = options;
+    const payload = Buffer.from(JSON.stringify({ cmd: 'subscribe', intervalMs, delta }), 'utf8');
+
+    // Frames can follow the response in the same chunk; know the ID up front
+    const sub = { id: 0, values: null };
+    this.subscription = sub;
+    try {
+      return await this.request((id) => {
+        sub.id = id;
+        return protocol.encodeFrame(protocol.FRAME_COMMAND, id, payload);
+      }, 5000);
+    } catch (err) {
+      if (this.subscription === sub) {
+        this.subscription = null;
+      }
+      throw err;
+    }
+  }
+
+  /**
+   * Change the interval of the running subscription
+   * @param {number} intervalMs
+   * @returns {Promise<object>}
+   */
+  async setRate(intervalMs) {
+    return this.sendCommand({ cmd: 'rate', intervalMs });
+  }
+
+  /**
+   * Stop the subscription; no 'sample' event follows the returned promise
+   * @returns {Promise<object>} response with the count of coalesced samples
+   */
+  async unsubscribe() {
+    const response = await this.sendCommand({ cmd: 'unsubscribe' });
+    this.subscription = null;
+    return response;
+  }
+
   /**
    * Get version information
    * @returns {Promise<object>}
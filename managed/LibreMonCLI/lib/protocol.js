@@ -0,0 +1,181 @@
+/**
+ * Binary framing shared by the client and test stand-ins (see BinaryProtocol.cs)
+ *
+ * Frame (little endian): u32 length of the rest | u8 type | u32 requestId | payload
+ * Values payload: i32 generation | f64 timestamp | i32 count | f32[count]
+ * Delta payload:  i32 generation | f64 timestamp | i32 changed | (u32 index, f32 value)[changed]
+ */
+
+const VERSION = 1;
+const HEADER_SIZE = 9;
+const MAX_FRAME_SIZE = 16 * 1024 * 1024;
+const VALUES_HEADER_SIZE = 16;
+
+const FRAME_COMMAND = 0x01;
+const FRAME_POLL = 0x02;
+const FRAME_RESPONSE = 0x81;
+const FRAME_SCHEMA = 0x82;
+const FRAME_VALUES = 0x83;
+const FRAME_DELTA = 0x84;
+
+/**
+ * Build one frame
+ * @param {number} type
+ * @param {number} requestId
+ * @param {Buffer} [payload]
+ * @returns {Buffer}
+ */
+function encodeFrame(type, requestId, payload = Buffer.alloc(0)) {
+  const frame = Buffer.allocUnsafe(HEADER_SIZE + payload.length);
+  frame.writeUInt32LE(frame.length - 4, 0);
+  frame.writeUInt8(type, 4);
+  frame.writeUInt32LE(requestId >>> 0, 5);
+  payload.copy(frame, HEADER_SIZE);
+  return frame;
+}
+
+/**
+ * @param {number} generation
+ * @param {number} timestamp
+ * @param {ArrayLike<number>} values
+ * @returns {Buffer}
+ */
+function encodeValues(generation, timestamp, values) {
+  const payload = Buffer.allocUnsafe(VALUES_HEADER_SIZE + values.length * 4);
+  payload.writeInt32LE(generation, 0);
+  payload.writeDoubleLE(timestamp, 4);
+  payload.writeInt32LE(values.length, 12);
+  for (let i = 0; i < values.length; i++) {
+    payload.writeFloatLE(values[i], VALUES_HEADER_SIZE + i * 4);
+  }
+  return payload;
+}
+
+/**
+ * @param {Buffer} payload
+ * @returns {{generation:number, timestamp:number, values:Float32Array}}
+ */
+function decodeValues(payload) {
+  const count = payload.readInt32LE(12);
+  // Copy out: the payload is rarely 4-byte aligned inside the stream chunk
+  const values = new Float32Array(count);
+  new Uint8Array(values.buffer).set(payload.subarray(VALUES_HEADER_SIZE, VALUES_HEADER_SIZE + count * 4));
+  return {
+    generation: payload.readInt32LE(0),
+    timestamp: payload.readDoubleLE(4),
+    values
+  };
+}
+
+/**
+ * @param {number} generation
+ * @param {number} timestamp
+ * @param {number[]} indices - changed sensor indices
+ * @param {ArrayLike<number>} values - full value vector
+ * @returns {Buffer}
+ */
+function encodeDelta(generation, timestamp, indices, values) {
+  const payload = Buffer.allocUnsafe(VALUES_HEADER_SIZE + indices.length * 8);
+  payload.writeInt32LE(generation, 0);
+  payload.writeDoubleLE(timestamp, 4);
+  payload.writeInt32LE(indices.length, 12);
+  for (let i = 0; i < indices.length; i++) {
+    payload.writeUInt32LE(indices[i], VALUES_HEADER_SIZE + i * 8);
+    payload.writeFloatLE(values[indices[i]], VALUES_HEADER_SIZE + i * 8 + 4);
+  }
+  return payload;
+}
+
+/**
+ * Apply a delta payload to the previous value vector in place
+ * @param {Buffer} payload
+ * @param {Float32Array} values
+ * @returns {{generation:number, timestamp:number, changed:number}}
+ */
+function applyDelta(payload, values) {
+  const changed = payload.readInt32LE(12);
+  for (let i = 0; i < changed; i++) {
+    const offset = VALUES_HEADER_SIZE + i * 8;
+    values[payload.readUInt32LE(offset)] = payload.readFloatLE(offset + 4);
+  }
+  return {
+    generation: payload.readInt32LE(0),
+    timestamp: payload.readDoubleLE(4),
+    changed
+  };
+}
+
+/**
+ * Incremental frame parser: push() stream chunks, get complete frames back
+ */
+class FrameDecoder {
+  constructor() {
+    this.chunks = [];
+    this.length = 0;
+  }
+
+  /**
+   * @param {Buffer} chunk
+   * @returns {{type:number, requestId:number, payload:Buffer}[]}
+   */
+  push(chunk) {
+    this.chunks.push(chunk);
+    this.length += chunk.length;
+
+    const frames = [];
+    while (this.length >= 4) {
+      const head = this.peek(4);
+      const frameLength = head.readUInt32LE(0);
+      if (frameLength < HEADER_SIZE - 4 || frameLength > MAX_FRAME_SIZE) {
+        throw new Error(`Invalid frame length: ${frameLength}`);
+      }
+      if (this.length < 4 + frameLength) {
+        break;
+      }
+
+      const frame = this.take(4 + frameLength);
+      frames.push({
+        type: frame.readUInt8(4),
+        requestId: frame.readUInt32LE(5),
+        payload: frame.subarray(HEADER_SIZE)
+      });
+    }
+    return frames;
+  }
+
+  // Merge only when a frame spans chunks
+  peek(count) {
+    if (this.chunks[0].length < count) {
+      this.chunks = [Buffer.concat(this.chunks)];
+    }
+    return this.chunks[0];
+  }
+
+  take(count) {
+    const first = this.peek(count);
+    const frame = first.subarray(0, count);
+    if (first.length === count) {
+      this.chunks.shift();
+    } else {
+      this.chunks[0] = first.subarray(count);
+    }
+    this.length -= count;
+    return frame;
+  }
+}
+
+module.exports = {
+  VERSION,
+  FRAME_COMMAND,
+  FRAME_POLL,
+  FRAME_RESPONSE,
+  FRAME_SCHEMA,
+  FRAME_VALUES,
+  FRAME_DELTA,
+  encodeFrame,
+  encodeValues,
+  encodeDelta,
+  decodeValues,
+  applyDelta,
+  FrameDecoder
+};
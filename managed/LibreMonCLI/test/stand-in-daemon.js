@@ -0,0 +1,226 @@
+/**
+ * Stand-in for LibreMonCLI.exe --daemon
+ * Speaks the same NDJSON and binary protocol with synthetic sensors, so the
+ * client can be tested without Windows, admin rights or real hardware.
+ *
+ * Extra command (stand-in only): {"cmd":"hotplug"} adds a hardware entry
+ * and bumps the schema generation.
+ */
+
+const readline = require('readline');
+const protocol = require('../lib/protocol');
+
+let initialized = false;
+let generation = 0;
+let schema = null;
+let pollCount = 0;
+
+function buildSchema(hardwareCount) {
+  const next = { generation: ++generation, hardware: [], sensors: [] };
+  for (let h = 0; h < hardwareCount; h++) {
+    next.hardware.push({ parent: -1, type: 'Cpu', id: `/standin/${h}`, name: `Stand-in CPU #${h}` });
+    for (let s = 0; s < 4; s++) {
+      next.sensors.push({ hardware: h, type: 'Load', id: `/standin/${h}/load/${s}`, name: `Core #${s}` });
+    }
+  }
+  return next;
+}
+
+function sampleValues() {
+  pollCount++;
+  const values = new Float32Array(schema.sensors.length);
+  for (let i = 0; i < values.length; i++) {
+    values[i] = i === 0 ? NaN : pollCount + i / 10;
+  }
+  return values;
+}
+
+function handleCommand(json) {
+  let cmd;
+  try {
+    cmd = JSON.parse(json);
+  } catch (err) {
+    return { success: false, error: `Invalid JSON: ${err.message}`, errorCode: 'INVALID_JSON' };
+  }
+
+  switch ((cmd.cmd || '').toLowerCase()) {
+    case 'init':
+      if (initialized) {
+        return { success: false, error: 'Already initialized', errorCode: 'ALREADY_INITIALIZED' };
+      }
+      initialized = true;
+      schema = buildSchema(1);
+      return { success: true, initialized: cmd.flags || [], mode: cmd.flat ? 'flat' : 'raw' };
+    case 'poll': {
+      if (!initialized) {
+        return { success: false, error: "Not initialized. Send 'init' command first.", errorCode: 'NOT_INITIALIZED' };
+      }
+      const values = sampleValues();
+      const children = schema.sensors.map((sensor, i) => ({ id: sensor.id, Text: sensor.name, Value: String(values[i]) }));
+      return { success: true, timestamp: Date.now(), mode: 'raw', data: { Children: children } };
+    }
+    case 'hotplug':
+      schema = buildSchema(schema.hardware.length + 1);
+      return { success: true };
+    case 'binary':
+      if (cmd.version !== protocol.VERSION) {
+        return { success: false, error: 'Unsupported binary protocol version', errorCode: 'UNSUPPORTED_PROTOCOL' };
+      }
+      return { success: true, protocol: 'binary', version: protocol.VERSION };
+    case 'version':
+      return { success: true, version: 'stand-in', librehardwaremonitor: 'none', platform: process.platform };
+    case 'shutdown':
+      initialized = false;
+      return { success: true, message: 'Hardware monitoring closed, daemon exiting' };
+    default:
+      return { success: false, error: `Unknown command: ${cmd.cmd}`, errorCode: 'UNKNOWN_COMMAND' };
+  }
+}
+
+/**
+ * Push sampling like Subscription.cs: timer on absolute deadlines, and when
+ * stdout is backed up the pending sample is replaced (coalesced), not queued
+ */
+function createSubscription(id, cmd, send, sendJson) {
+  const sub = { id, intervalMs: cmd.intervalMs || 1000, delta: !!cmd.delta, coalesced: 0 };
+  let pending = null;
+  let blocked = false;
+  let sent = null;
+  let sentGeneration = 0;
+  let timer = null;
+  let next = performance.now();
+
+  const flush = () => {
+    while (pending && !blocked) {
+      const sample = pending;
+      pending = null;
+      if (sample.schema.generation !== sentGeneration) {
+        sendJson(protocol.FRAME_SCHEMA, id, sample.schema);
+        sentGeneration = sample.schema.generation;
+        sent = null;
+      }
+      let ok;
+      if (sub.delta && sent && sent.length === sample.values.length) {
+        const changed = [];
+        for (let i = 0; i < sample.values.length; i++) {
+          if (!Object.is(sample.values[i], sent[i])) changed.push(i);
+        }
+        ok = send(protocol.FRAME_DELTA, id, protocol.encodeDelta(sample.schema.generation, sample.timestamp, changed, sample.values));
+      } else {
+        ok = send(protocol.FRAME_VALUES, id, protocol.encodeValues(sample.schema.generation, sample.timestamp, sample.values));
+      }
+      sent = sample.values;
+      if (!ok) {
+        blocked = true;
+        process.stdout.once('drain', () => {
+          blocked = false;
+          flush();
+        });
+      }
+    }
+  };
+
+  const tick = () => {
+    if (pending) sub.coalesced++;
+    pending = { schema, values: sampleValues(), timestamp: Date.now() };
+    flush();
+    next += sub.intervalMs;
+    timer = setTimeout(tick, Math.max(0, next - performance.now()));
+  };
+
+  sub.start = () => {
+    next = performance.now();
+    tick();
+  };
+  sub.setInterval = (intervalMs) => {
+    sub.intervalMs = intervalMs;
+    clearTimeout(timer);
+    next = performance.now() + intervalMs;
+    timer = setTimeout(tick, intervalMs);
+  };
+  sub.stop = () => {
+    clearTimeout(timer);
+    pending = null;
+  };
+  return sub;
+}
+
+function describe(sub, subscribed) {
+  return { success: true, subscribed, subscriptionId: sub.id, intervalMs: sub.intervalMs, delta: sub.delta, coalesced: sub.coalesced };
+}
+
+function runBinary() {
+  const decoder = new protocol.FrameDecoder();
+  let sentGeneration = 0;
+  let subscription = null;
+
+  const send = (type, id, payload) => process.stdout.write(protocol.encodeFrame(type, id, payload));
+  const sendJson = (type, id, obj) => send(type, id, Buffer.from(JSON.stringify(obj), 'utf8'));
+
+  process.stdin.on('data', (chunk) => {
+    for (const frame of decoder.push(chunk)) {
+      if (frame.type === protocol.FRAME_POLL) {
+        if (!initialized) {
+          sendJson(protocol.FRAME_RESPONSE, frame.requestId, { success: false, error: 'Not initialized', errorCode: 'NOT_INITIALIZED' });
+          continue;
+        }
+        const values = sampleValues();
+        if (schema.generation !== sentGeneration) {
+          sendJson(protocol.FRAME_SCHEMA, frame.requestId, schema);
+          sentGeneration = schema.generation;
+        }
+        send(protocol.FRAME_VALUES, frame.requestId, protocol.encodeValues(schema.generation, Date.now(), values));
+      } else if (frame.type === protocol.FRAME_COMMAND) {
+        const cmd = JSON.parse(frame.payload.toString('utf8'));
+        if (cmd.cmd === 'subscribe') {
+          if (subscription) {
+            sendJson(protocol.FRAME_RESPONSE, frame.requestId, { success: false, error: 'Already subscribed', errorCode: 'ALREADY_SUBSCRIBED' });
+            continue;
+          }
+          subscription = createSubscription(frame.requestId, cmd, send, sendJson);
+          sendJson(protocol.FRAME_RESPONSE, frame.requestId, describe(subscription, true));
+          subscription.start();
+          continue;
+        }
+        if (cmd.cmd === 'rate' || cmd.cmd === 'unsubscribe') {
+          if (!subscription) {
+            sendJson(protocol.FRAME_RESPONSE, frame.requestId, { success: false, error: 'Not subscribed', errorCode: 'NOT_SUBSCRIBED' });
+          } else if (cmd.cmd === 'rate') {
+            subscription.setInterval(cmd.intervalMs);
+            sendJson(protocol.FRAME_RESPONSE, frame.requestId, describe(subscription, true));
+          } else {
+            subscription.stop();
+            sendJson(protocol.FRAME_RESPONSE, frame.requestId, describe(subscription, false));
+            subscription = null;
+          }
+          continue;
+        }
+
+        const response = handleCommand(frame.payload.toString('utf8'));
+        sendJson(protocol.FRAME_RESPONSE, frame.requestId, response);
+        if (JSON.parse(frame.payload.toString('utf8')).cmd === 'shutdown') {
+          process.exit(0);
+        }
+      } else {
+        sendJson(protocol.FRAME_RESPONSE, frame.requestId, { success: false, error: 'Unknown frame type', errorCode: 'UNKNOWN_COMMAND' });
+      }
+    }
+  });
+}
+
+const rl = readline.createInterface({ input: process.stdin, crlfDelay: Infinity });
+rl.on('line', (line) => {
+  if (!line.trim()) {
+    return;
+  }
+  const response = handleCommand(line);
+  process.stdout.write(JSON.stringify(response) + '\n');
+
+  if (response.protocol === 'binary') {
+    rl.close();
+    runBinary();
+    process.stdin.resume();
+  } else if (JSON.parse(line).cmd === 'shutdown') {
+    process.exit(0);
+  }
+});
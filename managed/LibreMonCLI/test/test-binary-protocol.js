@@ -0,0 +1,112 @@
+/**
+ * Binary protocol test against the stand-in daemon (no hardware needed)
+ * Usage: node test/test-binary-protocol.js [path-to-daemon]
+ * Pass dist/NativeLibre_CLI/LibreMonCLI.exe to run it against the real daemon.
+ */
+
+const assert = require('assert');
+const path = require('path');
+const { LibreMonClient } = require('../lib');
+
+const daemonPath = process.argv[2] || path.join(__dirname, 'stand-in-daemon.js');
+const PIPELINE_DEPTH = 200;
+
+async function waitFor(condition, timeoutMs = 5000) {
+  const deadline = Date.now() + timeoutMs;
+  while (!condition()) {
+    if (Date.now() > deadline) {
+      throw new Error('Timed out waiting for condition');
+    }
+    await new Promise((resolve) => setTimeout(resolve, 10));
+  }
+}
+
+async function main() {
+  console.log('Testing LibreMonCLI binary protocol');
+  console.log('Daemon:', daemonPath);
+  console.log('='.repeat(60));
+
+  // 1. NDJSON mode still works and answers in order
+  const jsonClient = new LibreMonClient(daemonPath);
+  await jsonClient.start();
+  await jsonClient.init({ cpu: true });
+  const [a, b] = await Promise.all([jsonClient.poll(), jsonClient.version()]);
+  assert.ok(a.data, 'poll response carries data');
+  assert.ok(b.version, 'version response follows poll response');
+  await jsonClient.shutdown();
+  console.log('   ✓ NDJSON mode');
+
+  // 2. Binary negotiation, full JSON poll over a command frame
+  const client = new LibreMonClient(daemonPath, { protocol: 'binary' });
+  await client.start();
+  assert.strictEqual(client.protocol, 'binary');
+  await client.init({ cpu: true });
+  const full = await client.poll();
+  assert.ok(full.data, 'JSON poll works in binary mode');
+  console.log('   ✓ Binary negotiation');
+
+  // 3. Value-only polls: schema once, then values only
+  let schemaFrames = 0;
+  client.on('schema', () => schemaFrames++);
+  const first = await client.pollValues();
+  assert.ok(first.schema, 'first value poll has a schema');
+  assert.strictEqual(first.values.length, first.schema.sensors.length);
+  assert.strictEqual(first.generation, first.schema.generation);
+  assert.ok(first.values instanceof Float32Array);
+  const second = await client.pollValues();
+  assert.strictEqual(schemaFrames, 1, 'schema is not resent for the same generation');
+  assert.ok(second.values[1] > first.values[1], 'values advance between polls');
+  console.log(`   ✓ Value polls (${first.values.length} sensors, schema sent once)`);
+
+  // 4. Pipelining: many requests in flight, answered by ID
+  const start = process.hrtime.bigint();
+  const results = await Promise.all(Array.from({ length: PIPELINE_DEPTH }, () => client.pollValues()));
+  const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+  for (let i = 1; i < results.length; i++) {
+    assert.ok(results[i].values[1] > results[i - 1].values[1], 'pipelined responses keep request order');
+  }
+  console.log(`   ✓ ${PIPELINE_DEPTH} pipelined polls in ${elapsedMs.toFixed(1)} ms`);
+
+  // 5. Layout change: new schema frame precedes the new generation
+  if (daemonPath.endsWith('stand-in-daemon.js')) {
+    await client.sendCommand({ cmd: 'hotplug' });
+    const after = await client.pollValues();
+    assert.strictEqual(schemaFrames, 2, 'schema resent after layout change');
+    assert.strictEqual(after.generation, first.generation + 1);
+    assert.strictEqual(after.values.length, after.schema.sensors.length);
+    console.log('   ✓ Schema resent on layout change');
+  }
+
+  // 6. Subscription: daemon-timed push, delta frames, rate change mid-stream
+  const samples = [];
+  const onSample = (sample) => samples.push({ timestamp: sample.timestamp, changed: sample.changed, values: sample.values.slice() });
+  client.on('sample', onSample);
+  const sub = await client.subscribe({ intervalMs: 20, delta: true });
+  assert.ok(sub.subscribed);
+  await waitFor(() => samples.length >= 10);
+  assert.strictEqual(samples[0].changed, samples[0].values.length, 'first subscription frame is full');
+  assert.ok(samples.slice(1).every((sample) => sample.changed < sample.values.length), 'later frames are deltas');
+  assert.ok(Number.isNaN(samples[5].values[0]), 'NaN survives delta reconstruction');
+
+  await client.setRate(60);
+  const before = samples.length;
+  await new Promise((resolve) => setTimeout(resolve, 300));
+  const gotAtSlowRate = samples.length - before;
+  assert.ok(gotAtSlowRate >= 3 && gotAtSlowRate <= 7, `rate change applied (${gotAtSlowRate} samples in 300 ms at 60 ms)`);
+
+  const end = await client.unsubscribe();
+  assert.strictEqual(end.subscribed, false);
+  const afterUnsubscribe = samples.length;
+  await new Promise((resolve) => setTimeout(resolve, 100));
+  assert.strictEqual(samples.length, afterUnsubscribe, 'no samples after unsubscribe');
+  client.off('sample', onSample);
+  console.log(`   ✓ Subscription (${samples.length} pushed samples, ${end.coalesced} coalesced)`);
+
+  await client.shutdown();
+  console.log('\n✓ All binary protocol checks passed');
+}
+
+main().catch((err) => {
+  console.error('\n✗ Test failed:', err.message);
+  process.exit(1);
+});